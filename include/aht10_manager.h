@@ -16,11 +16,27 @@
  * Measurement range: Temp -40°C to +85°C, Humidity 0-100% RH
  * 
  * Features:
- * - Non-blocking temperature and humidity reading
+ * - Non-blocking two-phase measurement driven by update():
+ *   trigger (0xAC) -> return -> collect the 6-byte result on a later tick
+ *   once the busy bit clears. The bus is never held for the ~75 ms conversion.
+ * - One cached measurement shared by every reader (ProbeManager, OLED)
  * - Error handling and last valid values on read failure
- * - Health check via I2C
+ * - Health from measurement freshness, without extra bus traffic
  */
 
+// Measurement cadence and conversion timing
+#define AHT10_MEASURE_INTERVAL_MS   5000   // New measurement this often
+#define AHT10_CONVERSION_MS         80     // Datasheet: max 75 ms
+#define AHT10_CONVERSION_TIMEOUT_MS 500    // Give up on a conversion after this
+#define AHT10_STALE_MS              (3 * AHT10_MEASURE_INTERVAL_MS)
+
+// Commands and status bits
+#define AHT10_CMD_CALIBRATE         0xE1   // + 0x08 0x00
+#define AHT10_CMD_TRIGGER           0xAC   // + 0x33 0x00
+#define AHT10_CMD_SOFT_RESET        0xBA
+#define AHT10_STATUS_BUSY           0x80
+#define AHT10_STATUS_CALIBRATED     0x08
+
 class AHT10Manager {
 public:
   // Singleton instance accessor
@@ -33,15 +49,18 @@ public:
   bool begin();
   void end();
 
+  // Advance the trigger/collect state machine; call every loop iteration
+  void update();
+
   // Sensor readings
-  bool readSensor();              // Read sensor (non-blocking, returns success)
+  bool readSensor();              // Cached measurement is fresh (no bus traffic)
   float getTemperature();         // Get last temperature reading (°C)
   float getHumidity();            // Get last humidity reading (%)
   uint32_t getLastReadTime();     // Get timestamp of last successful read
 
   // Status
   bool isInitialized() { return initialized; }
-  bool isHealthy();               // Check if sensor responds to I2C
+  bool isHealthy();               // Recent measurement and no repeated failures
   String getLastError() { return lastError; }
 
 private:
@@ -52,7 +71,19 @@ private:
   AHT10Manager(const AHT10Manager&) = delete;
   AHT10Manager& operator=(const AHT10Manager&) = delete;
 
+  enum Phase : uint8_t {
+    PHASE_IDLE = 0,       // Waiting for the next measurement slot
+    PHASE_CONVERTING      // Triggered, result not collected yet
+  };
+
+  bool trigger();
+  bool collect();
+
   bool initialized = false;
+  Phase phase = PHASE_IDLE;
+  uint32_t triggeredAt = 0;
+  uint32_t lastTriggerTime = 0;
+  uint8_t failures = 0;           // Consecutive failed measurements
   float temperature = 0.0f;
   float humidity = 0.0f;
   uint32_t lastReadTime = 0;
@@ -72,10 +72,30 @@
 #define SEESAW_I2C_ADDRESS 0x36     // Seesaw default address
 #define SEESAW_DISPLAY_BUS 0        // Uses Bus 0 (Wire/I2C0) - GPIO8/9
 
+// Probe sensors (AHT10, ADS1110 ADCs at 0x48-0x4B) - XIAO S3
+#define PROBE_DISPLAY_BUS 0         // Uses Bus 0 (Wire/I2C0) - GPIO8/9
+
 // Slave Controller (ATmega328P) - XIAO S3
 #define SLAVE_I2C_BUS 1     // Uses Bus 1 (Wire1/I2C1 - GPIO5/6)
 #define SLAVE_SDA_PIN 5     // GPIO5 on XIAO S3 (D4) - Bus 1 (Wire1 SDA)
 #define SLAVE_SCL_PIN 6     // GPIO6 on XIAO S3 (D5) - Bus 1 (Wire1 SCL)
+#define SLAVE_ATTN_PIN -1   // ATmega attention line (open drain, active low), e.g. 44 (D7); -1 = not wired, poll instead
+
+// I2C device routing (address -> bus) used by I2CManager::write()/read()
+// Addresses not listed here are discovered on first use or by scanBus() and
+// remembered until reboot; a miss is held for I2C_ROUTE_MISS_HOLD_MS.
+#define I2C_ROUTE_TABLE { \
+  {0x30, SLAVE_I2C_BUS},                  /* MS11 slave controller (app) */ \
+  {0x14, SLAVE_I2C_BUS},                  /* Twiboot bootloader */ \
+  {OLED_I2C_ADDRESS, OLED_DISPLAY_BUS},   /* SSD1306 OLED */ \
+  {LCD_I2C_ADDRESS, LCD_DISPLAY_BUS},     /* PCF8574 LCD backpack */ \
+  {SEESAW_I2C_ADDRESS, SEESAW_DISPLAY_BUS}, /* Seesaw rotary encoder */ \
+  {0x38, PROBE_DISPLAY_BUS},              /* AHT10 */ \
+  {0x48, PROBE_DISPLAY_BUS},              /* ADS1110 probe ADCs (A0-A3 variants) */ \
+  {0x49, PROBE_DISPLAY_BUS},              \
+  {0x4A, PROBE_DISPLAY_BUS},              \
+  {0x4B, PROBE_DISPLAY_BUS},              \
+}
 
 // Temperature Probe Manager
 #define PROBE_MANAGER_ENABLED 1     // Enable probe manager for temperature readings
@@ -298,4 +318,50 @@
 
 #define PROBE_CAL_MS11_OFFSET 0.0f        // °C offset for MS11-control temp
 
+// Filter chain defaults for every probe (probe_filter.h), overridden per
+// probe from NVS / probe_cal.txt
+#define PROBE_FILTER_DEFAULT_MEDIAN true  // Median-of-5 spike rejection
+#define PROBE_FILTER_DEFAULT_ALPHA 0.3f   // EMA weight of a new sample (1.0 = off)
+#define PROBE_FILTER_DEFAULT_MAX_RATE 5.0f  // °C per second (0 = off)
+
+// ADS1110 probe front end: NTC from the excitation rail to the ADC input,
+// series resistor from the input to ground (PGA 1, 2.048 V full scale).
+// With these values the input clips near 134 °C.
+#define PROBE_NTC_EXCITATION_MV 3300.0f   // Divider supply
+#define PROBE_NTC_SERIES_OHMS 4700.0f     // Low-side resistor
+#define PROBE_NTC_R25_OHMS 100000.0f      // NTC resistance at 25 °C
+#define PROBE_NTC_BETA 3950.0f            // NTC B25/85
+
+// ============================================================================
+// OVEN CONTROL DEFAULTS
+// ============================================================================
+// Starting point for OvenController; gains and feed-forward saved in NVS
+// ("oven_pid") override them. Tuned against tools/plant_sim.cpp - rerun it
+// after changing anything here.
+
+#define OVEN_PID_DEFAULT_KP 5.0f          // % demand per °C error
+#define OVEN_PID_DEFAULT_KI 0.01f         // % per °C·s
+#define OVEN_PID_DEFAULT_KD 100.0f        // % per °C/s (on measurement)
+#define OVEN_FF_DEFAULT_BIAS 0.0f         // % demand
+#define OVEN_FF_DEFAULT_PER_DEGREE 0.2f   // % demand per °C of setpoint
+#define OVEN_DERIVATIVE_TAU_S 10.0f       // Derivative filter (oven reads whole °C)
+#define OVEN_DEMAND_SLEW_PER_S 5.0f       // Max demand change, % per second
+#define OVEN_RAMP_DEFAULT_PER_MIN 5.0f    // Setpoint ramp, 0 = step
+
+#define OVEN_AUGER_WINDOW_MS 20000        // Auger time-proportioning window
+#define OVEN_AUGER_MIN_PULSE_MS 1000      // Shortest auger on/off pulse
+#define OVEN_FAN_MIN_PERCENT 20           // Fan at 0 % demand
+#define OVEN_FAN_MAX_PERCENT 100          // Fan at 100 % demand
+
+// Relay autotune (POST /api/oven/autotune); see pid_autotune.h
+#define OVEN_AUTOTUNE_AMPLITUDE 20.0f     // Relay step either side of the bias, % demand
+#define OVEN_AUTOTUNE_HYSTERESIS_C 1.0f   // Switching band around the setpoint
+#define OVEN_AUTOTUNE_CYCLES 3            // Consistent cycles averaged for Ku/Pu
+#define OVEN_AUTOTUNE_MAX_CYCLES 12       // Give up (keep the old gains) after this many
+#define OVEN_AUTOTUNE_TIMEOUT_MIN 240
+#define OVEN_AUTOTUNE_MAX_DEVIATION_C 30  // Fault if the oven overshoots the setpoint by this
+
+#define OVEN_MAX_TEMP_C 300               // Fault (auger off) above this
+#define OVEN_SHUTDOWN_FAN_PERCENT 30      // Fan after stop/fault: burns the pot out
+
 #endif // CONFIG_H
@@ -0,0 +1,79 @@
+#ifndef COOK_MENU_H
+#define COOK_MENU_H
+
+#include <Arduino.h>
+#include "cook_profile_store.h"
+
+// ============================================================================
+// COOK MENU (encoder + LCD)
+// ============================================================================
+// Turning the encoder opens the menu on the LCD; turning scrolls, a press
+// selects. Without a program it lists the stored profiles (press starts
+// one); while a program runs it offers "Next stage" and "Stop program".
+// The menu closes after COOK_MENU_TIMEOUT_MS without input.
+//
+// A program notification takes over the LCD for COOK_NOTICE_SHOW_MS (a
+// press dismisses it). While a program runs and the menu is closed, the
+// Ready screen shows programLine() instead of "Ready.".
+//
+// Runs in the loop task. The encoder button is read by the NeoPixel
+// handler (it blinks on presses) and handed over through onButton().
+
+#define COOK_MENU_POLL_MS       100     // Encoder delta read interval
+#define COOK_MENU_STATUS_MS     500     // OvenController status refresh
+#define COOK_MENU_TIMEOUT_MS    10000
+#define COOK_NOTICE_SHOW_MS     15000
+
+class CookMenu {
+public:
+  // Singleton
+  static CookMenu& getInstance() {
+    static CookMenu instance;
+    return instance;
+  }
+
+  // Call from the loop; `available` = the LCD is showing the Ready screen.
+  // Returns true while the menu or a notice owns the LCD.
+  bool update(uint32_t nowMs, bool available);
+
+  // Encoder button pressed
+  void onButton() { pressPending = true; }
+
+  // "2/3 135C 01:23" while a program runs, "" otherwise
+  const char* programLine() const { return line; }
+
+private:
+  CookMenu() = default;
+  ~CookMenu() = default;
+  CookMenu(const CookMenu&) = delete;
+  CookMenu& operator=(const CookMenu&) = delete;
+
+  enum View : uint8_t { VIEW_CLOSED = 0, VIEW_MENU, VIEW_NOTICE };
+  enum Action : uint8_t { ITEM_PROFILE = 0, ITEM_NEXT, ITEM_STOP, ITEM_BACK };
+
+  View view = VIEW_CLOSED;
+  bool dirty = false;
+  bool pressPending = false;
+  bool programRunning = false;
+  uint8_t selected = 0;
+  uint32_t lastPollMs = 0;
+  uint32_t lastStatusMs = 0;
+  uint32_t viewSinceMs = 0;       // Menu: last input; notice: shown at
+  uint16_t seenNotifySeq = 0;
+  bool notifySeqKnown = false;
+  char notice[COOK_STAGE_NAME_LENGTH + 1] = "";
+  char line[17] = "";
+
+  CookProfileStore::Entry profiles[COOK_PROFILE_MAX_FILES];
+  uint8_t profileCount = 0;
+
+  void refreshStatus(uint32_t nowMs);
+  void open(uint32_t nowMs);
+  void close();
+  uint8_t itemCount() const;
+  Action itemAction(uint8_t index) const;
+  void select();
+  void render();
+};
+
+#endif // COOK_MENU_H
@@ -0,0 +1,72 @@
+#ifndef COOK_PROFILE_STORE_H
+#define COOK_PROFILE_STORE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "cook_program.h"
+
+// ============================================================================
+// COOK PROFILE STORE (LittleFS)
+// ============================================================================
+// One file per profile in COOK_PROFILE_DIR, in the binary format from
+// cook_program.h (a few hundred bytes each). The file name is derived from
+// the profile name; the name itself lives in the header. Saves go through
+// a temporary file and a rename, so a power cut never leaves half a profile.
+//
+// JSON is only the REST representation; units are the user's, not the
+// stored fixed-point ones:
+//
+//   {"name":"Brisket","stages":[
+//     {"name":"Smoke","setpoint":110,"fan":null,"notify":false,"triggers":[
+//       {"type":"probe_above","probe":1,"value":68,"hold":0}]},
+//     {"name":"Finish","setpoint":135,"notify":true,"triggers":[
+//       {"type":"elapsed","value":7200}]},
+//     {"name":"Hold","setpoint":75,"triggers":[]}]}
+//
+// value: s (elapsed), °C (probe_*), °C/min (rate_*); probe: index or
+// "oven"; hold (probe_*) and window (rate_*) in s.
+
+#define COOK_PROFILE_DIR        "/cook"
+#define COOK_PROFILE_EXTENSION  ".ckpf"
+#define COOK_PROFILE_MAX_FILES  16
+#define COOK_PROFILE_JSON_MAX   4096   // Largest accepted REST body
+#define COOK_TRIGGER_MAX_VALUE  1.0e6f // JSON trigger values (s, °C, °C/min); value * 100 stays in int32
+
+class CookProfileStore {
+public:
+  struct Entry {
+    char name[COOK_NAME_LENGTH];
+    uint8_t stageCount;
+  };
+
+  // Singleton
+  static CookProfileStore& getInstance() {
+    static CookProfileStore instance;
+    return instance;
+  }
+
+  bool save(const CookProfile& profile);
+  bool load(const char* name, CookProfile& profile);
+  bool remove(const char* name);
+
+  // Stored profiles (header only), sorted by name; returns the count
+  uint8_t list(Entry* out, uint8_t max);
+
+  String getLastError() const { return lastError; }
+
+  // REST representation
+  static bool fromJson(JsonObject json, CookProfile& profile, String& error);
+  static void toJson(const CookProfile& profile, JsonObject json);
+
+private:
+  CookProfileStore() = default;
+  ~CookProfileStore() = default;
+  CookProfileStore(const CookProfileStore&) = delete;
+  CookProfileStore& operator=(const CookProfileStore&) = delete;
+
+  String lastError;
+
+  static String pathFor(const char* name);
+};
+
+#endif // COOK_PROFILE_STORE_H
@@ -0,0 +1,173 @@
+#ifndef COOK_PROGRAM_H
+#define COOK_PROGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================================
+// COOK PROGRAMS (portable)
+// ============================================================================
+// A cook profile is a list of stages. Entering a stage runs its actions:
+//
+//   setpoint   new oven target (stage 0 must set one)
+//   fan        fixed fan % instead of the PID's fan mapping (COOK_FAN_AUTO = none)
+//   notify     raise a notification carrying the stage name
+//
+// The stage ends when any of its triggers fires; the next stage starts, and
+// after the last one the program is finished. A stage without triggers
+// holds until it is advanced by hand:
+//
+//   ELAPSED      `value` s since the stage started (at most COOK_MAX_ELAPSED_S)
+//   PROBE_ABOVE  probe >= value (centi-°C) for `param` s
+//   PROBE_BELOW  probe <= value (centi-°C) for `param` s
+//   RATE_BELOW   probe rises slower than value (centi-°C/min) over a `param` s window (stall)
+//   RATE_ABOVE   probe rises faster than value (centi-°C/min) over a `param` s window
+//
+// "Smoke at 110 °C until probe 1 hits 68 °C, then 135 °C for 2 h, then
+// hold at 75 °C" is three stages: {110, PROBE_ABOVE 1 6800}, {135,
+// ELAPSED 7200}, {75}.
+//
+// CookEngine only evaluates the current stage's triggers, each in O(1)
+// with its own small state, so a tick costs O(active triggers). Probes are
+// read through a callback for the same reason: only the probes the active
+// triggers refer to are looked at.
+//
+// Stored format (LittleFS, see cook_profile_store.h), all little-endian:
+//
+//   CookProfileHeader                     36 bytes
+//   per stage: CookStageRecord            24 bytes
+//              CookTrigger x triggerCount  8 bytes each
+//
+// Like pid_controller.h this has no Arduino dependencies.
+
+#define COOK_PROFILE_MAGIC            "CKPF"
+#define COOK_PROFILE_FORMAT_VERSION   1
+#define COOK_MAX_STAGES               16
+#define COOK_MAX_TRIGGERS             4
+#define COOK_NAME_LENGTH              24     // Including the terminator
+#define COOK_STAGE_NAME_LENGTH        16     // Fits an LCD line; not terminated when full
+#define COOK_FAN_AUTO                 0xFF
+#define COOK_PROBE_OVEN               0xFE   // Trigger probe index for the oven temperature
+#define COOK_PROBE_COUNT              8      // ProbeManager::MAX_PROBES
+#define COOK_MAX_SETPOINT             30000  // centi-°C, OVEN_MAX_TEMP_C * 100 (asserted in oven_controller.cpp)
+#define COOK_RATE_DEFAULT_WINDOW_S    300
+#define COOK_MAX_ELAPSED_S            (7UL * 24 * 3600)  // Elapsed trigger limit (value * 1000 must fit in ms)
+#define COOK_PROFILE_MAX_SIZE         (sizeof(CookProfileHeader) + \
+                                       COOK_MAX_STAGES * (sizeof(CookStageRecord) + \
+                                                          COOK_MAX_TRIGGERS * sizeof(CookTrigger)))
+
+enum CookTriggerType : uint8_t {
+  TRIGGER_ELAPSED = 0,
+  TRIGGER_PROBE_ABOVE,
+  TRIGGER_PROBE_BELOW,
+  TRIGGER_RATE_BELOW,
+  TRIGGER_RATE_ABOVE,
+  TRIGGER_TYPE_COUNT
+};
+
+// Stage flags
+#define COOK_STAGE_NOTIFY   0x01
+
+struct __attribute__((packed)) CookProfileHeader {
+  char magic[4];
+  uint8_t formatVersion;
+  uint8_t stageCount;
+  uint16_t size;                  // Whole file, header included
+  char name[COOK_NAME_LENGTH];    // Terminated
+  uint32_t reserved;
+};
+
+struct __attribute__((packed)) CookStageRecord {
+  char name[COOK_STAGE_NAME_LENGTH];
+  int16_t setpoint;               // centi-°C below COOK_MAX_SETPOINT, 0 = keep the current target
+  uint8_t fanPercent;             // COOK_FAN_AUTO = PID fan
+  uint8_t flags;                  // COOK_STAGE_*
+  uint8_t triggerCount;
+  uint8_t reserved[3];
+};
+
+struct __attribute__((packed)) CookTrigger {
+  uint8_t type;                   // CookTriggerType
+  uint8_t probe;                  // ProbeManager index (< COOK_PROBE_COUNT) or COOK_PROBE_OVEN
+  uint16_t param;                 // Hold time / rate window, s
+  int32_t value;                  // s, centi-°C or centi-°C/min by type
+};
+
+static_assert(sizeof(CookProfileHeader) == 36, "CookProfileHeader layout changed");
+static_assert(sizeof(CookStageRecord) == 24, "CookStageRecord layout changed");
+static_assert(sizeof(CookTrigger) == 8, "CookTrigger layout changed");
+static_assert(COOK_MAX_SETPOINT <= INT16_MAX, "COOK_MAX_SETPOINT must fit CookStageRecord::setpoint");
+
+struct CookStage {
+  CookStageRecord record;
+  CookTrigger triggers[COOK_MAX_TRIGGERS];
+};
+
+struct CookProfile {
+  char name[COOK_NAME_LENGTH] = "";
+  uint8_t stageCount = 0;
+  CookStage stages[COOK_MAX_STAGES];
+
+  // nullptr when valid, otherwise why not
+  const char* validate() const;
+
+  // Bytes written, 0 if `max` is too small or the profile is invalid
+  size_t encode(uint8_t* out, size_t max) const;
+  // nullptr on success, otherwise why the data was rejected
+  const char* decode(const uint8_t* data, size_t length);
+
+  // Stage name as a terminated string
+  static void stageName(const CookStage& stage, char out[COOK_STAGE_NAME_LENGTH + 1]);
+};
+
+// Reads a trigger input in °C; false if it is not available right now
+typedef bool (*CookInputReader)(uint8_t probe, float& value, void* context);
+
+class CookEngine {
+public:
+  enum Event : uint8_t {
+    COOK_NONE = 0,
+    COOK_STAGE_CHANGED,           // getStage() is the new stage; run its actions
+    COOK_FINISHED
+  };
+
+  void start(const CookProfile& profile, uint32_t nowMs);
+  void stop() { running = false; }
+  bool isRunning() const { return running; }
+
+  // Evaluate the active triggers
+  Event tick(CookInputReader reader, void* context, uint32_t nowMs);
+  // Skip to the next stage by hand
+  Event advance(uint32_t nowMs);
+
+  const CookProfile& getProfile() const { return profile; }
+  const CookStage& getStage() const { return profile.stages[stage]; }
+  uint8_t getStageIndex() const { return stage; }
+  uint32_t getStageElapsedMs(uint32_t nowMs) const { return nowMs - stageStartMs; }
+  int8_t getLastTrigger() const { return lastTrigger; }   // Fired in the previous stage, -1 = by hand
+
+  static const char* triggerName(uint8_t type);
+  static bool parseTriggerType(const char* name, uint8_t& type);
+
+private:
+  struct TriggerState {
+    bool holding;                 // Threshold met since holdSinceMs
+    uint32_t holdSinceMs;
+    bool hasReference;            // Rate window started
+    float reference;
+    uint32_t referenceMs;
+  };
+
+  CookProfile profile;
+  bool running = false;
+  uint8_t stage = 0;
+  uint32_t stageStartMs = 0;
+  int8_t lastTrigger = -1;
+  TriggerState state[COOK_MAX_TRIGGERS];
+
+  void enterStage(uint8_t index, uint32_t nowMs);
+  bool evaluate(const CookTrigger& trigger, TriggerState& ts, CookInputReader reader,
+                void* context, uint32_t nowMs);
+};
+
+#endif // COOK_PROGRAM_H
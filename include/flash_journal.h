@@ -0,0 +1,72 @@
+#ifndef FLASH_JOURNAL_H
+#define FLASH_JOURNAL_H
+
+#include <Arduino.h>
+#include "ms11_registers.h"
+
+// ============================================================================
+// MS11-CONTROL FLASH JOURNAL (NVS)
+// ============================================================================
+// Records a running slave update so a brown-out cannot leave the ATmega
+// half-programmed without anyone noticing: target board, image path and
+// SHA-256, phase, and the number of image pages already committed. On the next boot
+// checkAndUpdateMS11Firmware() finds the journal and SlaveFlasher resumes
+// the image at the last checkpoint; earlier pages are not rewritten but
+// still covered by the final read-back verify.
+//
+// Checkpoints are written every FLASH_JOURNAL_PAGE_INTERVAL pages - resuming
+// a few pages early only rewrites them with the same data.
+
+#define FLASH_JOURNAL_NAMESPACE     "ms11_journal"
+#define FLASH_JOURNAL_PAGE_INTERVAL 4
+
+class FlashJournal {
+public:
+  enum Phase : uint8_t {
+    JOURNAL_IDLE = 0,       // No update in progress
+    JOURNAL_WRITING,        // Pages [0, page) are committed
+    JOURNAL_VERIFYING,      // All pages written
+    JOURNAL_EXITING         // Verified, returning to the application
+  };
+
+  struct Entry {
+    Phase phase = JOURNAL_IDLE;
+    uint16_t page = 0;
+    uint8_t address = ms11::SLAVE_ADDRESS;  // Application address of the board
+    uint8_t sha256[32] = {0};
+    String path;
+  };
+
+  // Singleton
+  static FlashJournal& getInstance() {
+    static FlashJournal instance;
+    return instance;
+  }
+
+  // Read the journal; false if no update was in progress
+  bool load(Entry& entry);
+
+  // New or resumed update of `path` (identified by the image digest) on the
+  // board at `address`
+  void begin(const String& path, const uint8_t sha256[32], uint8_t address, uint16_t page = 0);
+
+  // `pages` image pages are committed (written at checkpoint intervals)
+  void checkpoint(uint16_t pages);
+
+  void setPhase(Phase phase);
+
+  // Update finished (or abandoned)
+  void clear();
+
+  static const char* phaseName(Phase phase);
+
+private:
+  FlashJournal() = default;
+  ~FlashJournal() = default;
+  FlashJournal(const FlashJournal&) = delete;
+  FlashJournal& operator=(const FlashJournal&) = delete;
+
+  uint16_t lastCheckpoint = 0;
+};
+
+#endif // FLASH_JOURNAL_H
@@ -0,0 +1,164 @@
+#ifndef I2C_BUS_BACKEND_H
+#define I2C_BUS_BACKEND_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// ============================================================================
+// I2C BUS BACKEND
+// ============================================================================
+// Transaction-level interface between I2CManager and the physical bus.
+// I2CManager owns one backend per bus; everything above it (SlaveController,
+// ProbeManager, MD11SlaveUpdate) only talks to I2CManager, so swapping the
+// backend (e.g. for the simulated bus) needs no changes elsewhere.
+//
+// Result codes follow the Arduino Wire convention:
+//   0 = ACK, 1 = data too long, 2 = NACK on address, 3 = NACK on data,
+//   4 = other error, 5 = timeout
+
+class I2CBusBackend {
+public:
+  virtual ~I2CBusBackend() {}
+
+  // Lifecycle
+  virtual bool begin(int sda, int scl, uint32_t frequency) = 0;
+  virtual void end() = 0;
+
+  // Bus configuration
+  virtual bool setClock(uint32_t frequency) = 0;
+  virtual uint32_t getClock() = 0;
+  virtual void setTimeout(uint16_t timeout_ms) = 0;
+
+  // Write bytes to device (length 0 = address-only probe)
+  virtual uint8_t write(uint8_t address, const uint8_t* data, size_t length,
+                        bool sendStop = true) = 0;
+
+  // Read bytes from device, returns number of bytes received
+  virtual size_t read(uint8_t address, uint8_t* buffer, size_t length,
+                      bool sendStop = true) = 0;
+
+  // Bus recovery: true if SDA or SCL is held low while the bus is idle
+  virtual bool isLineStuck() = 0;
+
+  // Clock out up to 9 SCL pulses until SDA is released, issue a STOP and
+  // re-initialize the peripheral. Returns true if both lines are high afterwards.
+  virtual bool recover() = 0;
+
+  // Human-readable backend name (for diagnostics)
+  virtual const char* name() const = 0;
+};
+
+// ============================================================================
+// TwoWire backend (ESP32 hardware I2C peripheral)
+// ============================================================================
+
+class TwoWireBackend : public I2CBusBackend {
+public:
+  explicit TwoWireBackend(TwoWire& wire, const char* label) : wire(wire), label(label) {}
+
+  bool begin(int sda, int scl, uint32_t frequency) override {
+    sdaPin = sda;
+    sclPin = scl;
+    clockHz = frequency;
+    return wire.begin(sda, scl, frequency);
+  }
+
+  void end() override {
+    wire.end();
+  }
+
+  bool setClock(uint32_t frequency) override {
+    if (!wire.setClock(frequency)) {
+      return false;
+    }
+    clockHz = frequency;
+    return true;
+  }
+
+  uint32_t getClock() override {
+    return wire.getClock();
+  }
+
+  void setTimeout(uint16_t timeout_ms) override {
+    timeoutMs = timeout_ms;
+    wire.setTimeout(timeout_ms);
+  }
+
+  uint8_t write(uint8_t address, const uint8_t* data, size_t length, bool sendStop) override {
+    wire.beginTransmission(address);
+    if (data && length > 0) {
+      wire.write(data, length);
+    }
+    return wire.endTransmission(sendStop);
+  }
+
+  size_t read(uint8_t address, uint8_t* buffer, size_t length, bool sendStop) override {
+    size_t received = wire.requestFrom((uint16_t)address, length, sendStop);
+    size_t count = 0;
+    while (count < received && count < length && wire.available()) {
+      buffer[count++] = wire.read();
+    }
+    return count;
+  }
+
+  bool isLineStuck() override {
+    if (sdaPin < 0 || sclPin < 0) {
+      return false;
+    }
+    return digitalRead(sdaPin) == LOW || digitalRead(sclPin) == LOW;
+  }
+
+  bool recover() override {
+    if (sdaPin < 0 || sclPin < 0) {
+      return false;
+    }
+
+    // Take the pins away from the peripheral and bit-bang at ~100kHz
+    wire.end();
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(5);
+
+    // A slave interrupted mid-byte releases SDA after at most 9 clocks
+    for (uint8_t i = 0; i < 9 && digitalRead(sdaPin) == LOW; i++) {
+      digitalWrite(sclPin, LOW);
+      delayMicroseconds(5);
+      digitalWrite(sclPin, HIGH);
+      delayMicroseconds(5);
+    }
+
+    // STOP condition: SDA rises while SCL is high
+    pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(sclPin, LOW);
+    digitalWrite(sdaPin, LOW);
+    delayMicroseconds(5);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(sdaPin, HIGH);
+    delayMicroseconds(5);
+
+    pinMode(sdaPin, INPUT_PULLUP);
+    pinMode(sclPin, INPUT_PULLUP);
+    bool released = (digitalRead(sdaPin) == HIGH && digitalRead(sclPin) == HIGH);
+
+    wire.begin(sdaPin, sclPin, clockHz);
+    wire.setTimeout(timeoutMs);
+    return released;
+  }
+
+  const char* name() const override { return label; }
+
+  // Underlying peripheral (needed by libraries that only accept TwoWire)
+  TwoWire& getWire() { return wire; }
+
+private:
+  TwoWire& wire;
+  const char* label;
+  int sdaPin = -1;
+  int sclPin = -1;
+  uint32_t clockHz = 100000;
+  uint16_t timeoutMs = 50;
+};
+
+#endif // I2C_BUS_BACKEND_H
@@ -3,8 +3,12 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <atomic>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "i2c_bus_backend.h"
 
 // ============================================================================
 // I2C BUS CONFIGURATION (PINS SWAPPED FOR COMPATIBILITY)
@@ -56,6 +60,108 @@ enum I2CErrorCode {
   I2C_ERROR_UNKNOWN = 255
 };
 
+// ============================================================================
+// DEVICE ROUTING & TRACE
+// ============================================================================
+// write()/read() pick the bus from a routing table (address -> bus) seeded
+// from I2C_ROUTE_TABLE in config.h and extended by setRoute(), scanBus() and
+// discovery. A discovery miss is held for I2C_ROUTE_MISS_HOLD_MS: an absent
+// device then costs one failed transaction, not a ping on each bus. The
+// table is shared by every task and guarded by a spinlock.
+//
+// Per-transaction tracing is compiled out unless built with
+// -D I2C_TRACE_ENABLED (optionally -D I2C_TRACE_SINK=Serial1).
+
+#define I2C_ROUTE_UNKNOWN 0xFF
+#define I2C_ROUTE_ABSENT  0xFE    // Discovery miss, held until routeMissAt + hold
+#define I2C_ROUTE_MISS_HOLD_MS 30000
+
+struct I2CRoute {
+  uint8_t address;
+  uint8_t bus;  // I2CBus value
+};
+
+#ifdef I2C_TRACE_ENABLED
+#ifndef I2C_TRACE_SINK
+#define I2C_TRACE_SINK Serial
+#endif
+#define I2C_TRACE(fmt, ...) I2C_TRACE_SINK.printf("[I2C] " fmt "\n", ##__VA_ARGS__)
+#else
+#define I2C_TRACE(fmt, ...) do {} while (0)
+#endif
+
+// ============================================================================
+// ASYNC TRANSACTION QUEUE
+// ============================================================================
+// Each bus has a worker task that executes queued transactions in the
+// background. Callers submit a descriptor and return immediately; the
+// result is delivered via the completion callback (runs in worker task).
+
+#define I2C_TXN_MAX_DATA      32    // Max bytes copied into a transaction
+#define I2C_QUEUE_DEPTH       16    // Queue slots per bus per priority
+#define I2C_WORKER_STACK      3072  // Worker task stack (bytes)
+#define I2C_WORKER_PRIORITY   3     // Above loopTask (1), below WiFi
+#define I2C_WORKER_CORE       1     // Same core as loop(), keeps Wire access local
+
+// ============================================================================
+// BUS RECOVERY & CLOCK NEGOTIATION
+// ============================================================================
+// A bus-level fault (Wire timeout/bus error, or SDA/SCL held low after a
+// failed transaction) triggers recovery after I2C_RECOVERY_FAULT_THRESHOLD
+// consecutive faults, or immediately if a line is stuck: 9 SCL pulses + STOP,
+// peripheral re-init and one clock step down (halved). maintain() later
+// probes upward (doubling) once a bus has been fault-free for the holdoff
+// period and every known device still ACKs at the faster rate. An ACK says
+// nothing about data integrity, so a Standard-mode device that is present
+// (the PCF8574 LCD) caps the bus at its own limit instead.
+
+#define I2C_SLAVE_CLOCK_HZ            100000  // Initial slave bus clock
+#define I2C_SLAVE_MAX_CLOCK_HZ        100000  // ATmega TWI slave, keep conservative
+#define I2C_SLAVE_FRAMED_MAX_CLOCK_HZ 400000  // Ceiling once CRC-framed protocol v3 is negotiated
+#define I2C_DISPLAY_CLOCK_HZ          100000  // Initial display bus clock
+#define I2C_DISPLAY_MAX_CLOCK_HZ      400000  // SSD1306/seesaw/AHT10 are Fast-mode...
+#define I2C_PCF8574_MAX_CLOCK_HZ      100000  // ...the PCF8574 LCD backpack is not: caps the bus while it ACKs
+#define I2C_MIN_CLOCK_HZ              25000   // Floor for back-off
+#define I2C_RECOVERY_FAULT_THRESHOLD  3       // Consecutive faults before recovery
+#define I2C_CLOCK_PROBE_INTERVAL_MS   30000   // Fault-free time before probing upward
+#define I2C_CLOCK_PROBE_MAX_HOLDOFF_MS 600000 // Holdoff cap after failed probes
+#define I2C_CLOCK_PROBE_PINGS         8       // ACKs required per device at the new rate
+#define I2C_ACK_POLL_SPIN_US          20000   // Probe back-to-back this long (page programming)...
+#define I2C_ACK_POLL_INTERVAL_US      200     // ...with this gap
+#define I2C_ACK_POLL_SLOW_MS          20      // then yield between probes (device start-up)
+
+enum I2CTransactionType {
+  I2C_TXN_WRITE = 0,       // Write txData
+  I2C_TXN_WRITE_READ = 1,  // Write txData (e.g. register), then read rxLength bytes
+  I2C_TXN_READ = 2         // Read rxLength bytes
+};
+
+enum I2CTransactionPriority {
+  I2C_PRIORITY_HIGH = 0,   // Control writes (executed first)
+  I2C_PRIORITY_NORMAL = 1  // Register dumps, display frames
+};
+
+struct I2CTransaction;
+
+// Completion callback: result is I2C_OK on success, I2C_ERROR_TIMEOUT if the
+// transaction was dropped because its deadline expired before execution.
+typedef void (*I2CCompletionCallback)(const I2CTransaction& txn, I2CErrorCode result, void* context);
+
+struct I2CTransaction {
+  I2CTransactionType type = I2C_TXN_WRITE;
+  I2CTransactionPriority priority = I2C_PRIORITY_NORMAL;
+  I2CBus bus = I2C_BUS_SLAVE;
+  uint8_t address = 0;
+  uint8_t txData[I2C_TXN_MAX_DATA] = {0};
+  uint8_t txLength = 0;
+  uint8_t* rxBuffer = nullptr;  // Caller-owned, must stay valid until completion
+  uint8_t rxLength = 0;
+  uint8_t retries = 0;
+  uint32_t deadline_ms = 0;     // millis() deadline, 0 = never stale
+  I2CCompletionCallback callback = nullptr;
+  void* context = nullptr;
+};
+
 class I2CManager {
 public:
   // Singleton pattern
@@ -80,17 +186,26 @@ public:
   bool readRegister(uint8_t address, uint8_t reg, uint8_t& value, 
                     uint16_t timeout_ms = 100, uint8_t retries = 2);
   
-  // Read multi-byte register (e.g., int16_t)
+  // Read multi-byte register (e.g., int16_t) or a burst of consecutive registers
   bool readRegisterMulti(uint8_t address, uint8_t reg, uint8_t* buffer, 
-                         uint16_t length, uint16_t timeout_ms = 100);
+                         uint16_t length, uint16_t timeout_ms = 100, uint8_t retries = 2);
   
-  // Generic write (raw bytes)
+  // Generic write (raw bytes), routed to the device's bus
   bool write(uint8_t address, const uint8_t* data, uint16_t length, 
              uint16_t timeout_ms = 100);
   
-  // Generic read
+  // Generic read, routed to the device's bus
   bool read(uint8_t address, uint8_t* buffer, uint16_t length, 
             uint16_t timeout_ms = 100);
+  
+  // Write then read under one bus lock (no retries - framed callers retry themselves)
+  bool writeRead(uint8_t address, const uint8_t* txData, uint16_t txLength,
+                 uint8_t* rxBuffer, uint16_t rxLength, uint16_t timeout_ms = 100);
+  
+  // Device routing (address -> bus)
+  I2CBus routeFor(uint8_t address);
+  void setRoute(uint8_t address, I2CBus bus);
+  bool hasRoute(uint8_t address);
 
   // ========================================================================
   // Display Bus API (100kHz, Non-critical)
@@ -104,19 +219,68 @@ public:
   bool displayRead(uint8_t address, uint8_t* buffer, uint16_t length, 
                    uint16_t timeout_ms = 50);
 
+  // ========================================================================
+  // Async API (background worker task per bus)
+  // ========================================================================
+  
+  // Queue a transaction; returns false if the queue is full or not initialized
+  bool submit(const I2CTransaction& txn, uint32_t queueTimeout_ms = 0);
+  
+  // Convenience: queue a register write (reg, value)
+  bool submitWriteRegister(uint8_t address, uint8_t reg, uint8_t value,
+                           I2CTransactionPriority priority = I2C_PRIORITY_HIGH,
+                           I2CCompletionCallback callback = nullptr, void* context = nullptr);
+  
+  // Queue statistics per bus
+  struct QueueStats {
+    uint32_t submitted = 0;
+    uint32_t completed = 0;
+    uint32_t failed = 0;
+    uint32_t dropped = 0;   // Deadline expired before execution
+    uint32_t rejected = 0;  // Queue full
+  };
+  QueueStats getQueueStats(I2CBus bus);
+
   // ========================================================================
   // Diagnostics
   // ========================================================================
   
-  // Scan bus for devices (uses slave bus)
-  bool scanBus(uint8_t* foundAddresses, uint8_t maxDevices, uint8_t& count);
+  // Recovery & negotiated clock per bus
+  struct BusHealth {
+    uint32_t clockHz = 0;         // Current (negotiated) clock
+    uint32_t maxClockHz = 0;      // Upper limit for this bus
+    uint32_t recoveries = 0;      // Stuck-bus recoveries performed
+    uint32_t faults = 0;          // Timeouts, bus errors, stuck lines
+    uint32_t clockChanges = 0;
+    uint32_t lastRecoveryMs = 0;  // millis() of last recovery, 0 = never
+  };
+  BusHealth getBusHealth(I2CBus bus);
+  
+  // Change the clock ceiling for upward probing (lowers the clock if above it)
+  bool setMaxClock(I2CBus bus, uint32_t frequency);
+  
+  // Periodic housekeeping (upward clock probing), call from loop()
+  void maintain();
+  
+  // Scan bus for devices, learning routes for unknown addresses
+  bool scanBus(uint8_t* foundAddresses, uint8_t maxDevices, uint8_t& count,
+               I2CBus bus = I2C_BUS_SLAVE);
   
   // Quick ping test (for connection health)
   bool ping(uint8_t address, I2CBus bus = I2C_BUS_SLAVE);
   
-  // Get last error
-  I2CErrorCode getLastErrorCode() { return lastErrorCode; }
-  String getLastError() { return lastErrorMsg; }
+  // ACK polling: address-only probes until the device acknowledges (flash
+  // page being programmed, bootloader starting). waitedUs receives the time
+  // until the ACK.
+  bool waitForAck(uint8_t address, uint32_t timeout_ms, uint32_t* waitedUs = nullptr);
+  
+  // Get last error (set by every task using the manager, latest wins)
+  I2CErrorCode getLastErrorCode() { return (I2CErrorCode)(lastError.load(std::memory_order_relaxed) & 0xFF); }
+  String getLastError();
+  static const char* errorMessage(I2CErrorCode code);
+  
+  // Backend access (metered wrapper, see MeteredBusBackend::getInner())
+  I2CBusBackend* getBackend(I2CBus bus) { return (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus; }
   
   // Status checks
   bool isInitialized() { return initialized; }
@@ -135,16 +299,16 @@ private:
 
   // State
   bool initialized = false;
-  TwoWire* slaveBus = nullptr;    // I2C0: GPIO5/6 @ 100kHz
-  TwoWire* displayBus = nullptr;  // I2C1: GPIO8/9 @ 100kHz
+  I2CBusBackend* slaveBus = nullptr;    // I2C1: GPIO5/6 @ 100kHz
+  I2CBusBackend* displayBus = nullptr;  // I2C0: GPIO8/9 @ 100kHz
   
   // Thread-safety (one mutex per bus)
   SemaphoreHandle_t slaveMutex = nullptr;
   SemaphoreHandle_t displayMutex = nullptr;
   
-  // Error tracking
-  I2CErrorCode lastErrorCode = I2C_OK;
-  String lastErrorMsg;
+  // Error tracking: code | Wire error << 8 in one word, so readers never mix
+  // two failures and no task rewrites a shared heap String
+  std::atomic<uint16_t> lastError{I2C_OK};
   
   // Helper: Lock acquisition with timeout
   bool acquireLock(SemaphoreHandle_t mutex, uint32_t timeout_ms);
@@ -153,9 +317,60 @@ private:
   // Helper: Parse Wire error codes
   void setError(I2CErrorCode code, uint8_t wireError = 0);
   
-  // Helper: Perform write with timeout
-  bool performWrite(TwoWire* wire, uint8_t address, const uint8_t* data, 
-                    uint16_t length, uint16_t timeout_ms);
+
+  // Device routing table, indexed by 7-bit address
+  uint8_t routes[0x80];
+  uint32_t routeMissAt[0x80] = {};   // millis() of the last discovery miss (I2C_ROUTE_ABSENT)
+  portMUX_TYPE routeMux = portMUX_INITIALIZER_UNLOCKED;
+
+  // Recovery / clock negotiation state (one per bus)
+  struct BusState {
+    BusHealth health;
+    uint8_t consecutiveFaults = 0;
+    uint32_t lastChangeMs = 0;
+    uint32_t faultsAtLastChange = 0;
+    uint32_t probeHoldoffMs = I2C_CLOCK_PROBE_INTERVAL_MS;
+  };
+  BusState slaveState;
+  BusState displayState;
+  uint32_t lastMaintainMs = 0;
+  
+  // Backend calls with fault tracking (caller holds the bus mutex)
+  uint8_t busWrite(I2CBus bus, uint8_t address, const uint8_t* data, size_t length);
+  bool busRead(I2CBus bus, uint8_t address, uint8_t* buffer, size_t length);
+  void onBusFault(I2CBus bus, uint8_t wireError);
+  void recoverBus(I2CBus bus, bool lineStuck);
+  bool applyClock(I2CBus bus, uint32_t frequency);
+  void probeClockUp(I2CBus bus);
+
+  // Queue counters, bumped by submitters and the worker without a lock
+  // (relaxed atomics, like I2CMetrics)
+  struct AtomicQueueStats {
+    std::atomic<uint32_t> submitted{0};
+    std::atomic<uint32_t> completed{0};
+    std::atomic<uint32_t> failed{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> rejected{0};
+
+    QueueStats snapshot() const;
+  };
+
+  // Async worker state (one per bus)
+  struct BusWorker {
+    I2CBus bus;
+    QueueHandle_t highQueue = nullptr;
+    QueueHandle_t normalQueue = nullptr;
+    SemaphoreHandle_t pending = nullptr;  // Counts queued transactions
+    TaskHandle_t task = nullptr;
+    AtomicQueueStats stats;
+  };
+  BusWorker slaveWorker;
+  BusWorker displayWorker;
+
+  bool startWorker(BusWorker& worker, const char* name);
+  void stopWorker(BusWorker& worker);
+  static void workerTask(void* param);
+  I2CErrorCode executeTransaction(const I2CTransaction& txn);
 };
 
 #endif // I2C_MANAGER_H
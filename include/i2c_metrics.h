@@ -0,0 +1,145 @@
+#ifndef I2C_METRICS_H
+#define I2C_METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "i2c_bus_backend.h"
+
+// ============================================================================
+// I2C METRICS
+// ============================================================================
+// Lock-free per-bus and per-address counters plus log-linear ("HDR-style")
+// latency histograms. Every backend write()/read() issued by I2CManager is
+// timed, so callers on different tasks never overwrite each other's data
+// (unlike I2CManager::getLastError()).
+//
+// All counters are 32-bit atomics updated with relaxed ordering; readers get
+// a consistent-enough view for diagnostics without taking the bus mutex.
+
+#define I2C_METRICS_BUS_COUNT       2     // I2C_BUS_DISPLAY, I2C_BUS_SLAVE
+#define I2C_METRICS_ADDR_SLOTS      16    // Tracked addresses per bus
+#define I2C_HIST_SUB_BITS           3     // 8 sub-buckets per power of two (~12% resolution)
+#define I2C_HIST_MAX_EXPONENT       23    // Values up to 2^24 us (~16 s)
+
+// Latency histogram (microseconds)
+// Values < 8 us get an exact bucket; above that each power of two is split
+// into 8 linear sub-buckets. Larger values are clamped into the last bucket.
+class I2CLatencyHistogram {
+public:
+  static constexpr uint8_t SUB_BUCKETS = 1 << I2C_HIST_SUB_BITS;
+  static constexpr uint16_t BUCKET_COUNT =
+      SUB_BUCKETS + (I2C_HIST_MAX_EXPONENT - I2C_HIST_SUB_BITS + 1) * SUB_BUCKETS;
+
+  void record(uint32_t valueUs);
+  void reset();
+
+  uint32_t getCount() const { return count.load(std::memory_order_relaxed); }
+  uint32_t getMax() const { return maxValue.load(std::memory_order_relaxed); }
+
+  // Upper edge of the bucket containing the given percentile (0-100)
+  uint32_t percentile(float pct) const;
+
+  static uint16_t bucketFor(uint32_t valueUs);
+  static uint32_t bucketLowerBound(uint16_t bucket);
+
+private:
+  std::atomic<uint32_t> buckets[BUCKET_COUNT] = {};
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint32_t> maxValue{0};
+};
+
+// Counters for one device address
+struct I2CAddressMetrics {
+  std::atomic<uint8_t> address{0};        // 0 = free slot
+  std::atomic<uint32_t> transactions{0};  // write() + read() calls
+  std::atomic<uint32_t> bytes{0};         // Payload bytes moved (ACKed)
+  std::atomic<uint32_t> nacks{0};         // Address/data NACK or short read
+  std::atomic<uint32_t> timeouts{0};      // Wire error 5
+  std::atomic<uint32_t> errors{0};        // Other Wire errors
+  std::atomic<uint32_t> retries{0};       // Retry attempts by I2CManager
+};
+
+// Counters for one bus
+struct I2CBusMetrics {
+  I2CAddressMetrics addresses[I2C_METRICS_ADDR_SLOTS];
+  std::atomic<uint32_t> untracked{0};     // Transactions to addresses without a slot
+
+  I2CLatencyHistogram writeLatency;       // endTransmission()
+  I2CLatencyHistogram readLatency;        // requestFrom()
+  I2CLatencyHistogram lockWait;           // Mutex wait (acquired)
+  std::atomic<uint32_t> lockTimeouts{0};  // Mutex not acquired in time
+};
+
+class I2CMetrics {
+public:
+  // Singleton pattern
+  static I2CMetrics& getInstance() {
+    static I2CMetrics instance;
+    return instance;
+  }
+
+  // Recording (safe from any task)
+  void recordWrite(uint8_t bus, uint8_t address, size_t length, uint8_t wireError, uint32_t elapsedUs);
+  void recordRead(uint8_t bus, uint8_t address, size_t requested, size_t received, uint32_t elapsedUs);
+  void recordRetry(uint8_t bus, uint8_t address);
+  void recordLockWait(uint8_t bus, uint32_t waitUs, bool acquired);
+
+  // Access (bus index = I2CBus value)
+  const I2CBusMetrics& getBus(uint8_t bus) const { return buses[bus < I2C_METRICS_BUS_COUNT ? bus : 0]; }
+
+  // Clear all counters and histograms
+  void reset();
+
+private:
+  I2CMetrics() {}
+  I2CMetrics(const I2CMetrics&) = delete;
+  I2CMetrics& operator=(const I2CMetrics&) = delete;
+
+  I2CBusMetrics buses[I2C_METRICS_BUS_COUNT];
+
+  // Find or claim the slot for an address (nullptr if table full)
+  I2CAddressMetrics* slotFor(uint8_t bus, uint8_t address);
+};
+
+// ============================================================================
+// Metered backend (decorator)
+// ============================================================================
+// Wraps a backend and records every write()/read() into I2CMetrics.
+
+class MeteredBusBackend : public I2CBusBackend {
+public:
+  MeteredBusBackend(I2CBusBackend& inner, uint8_t bus) : inner(inner), bus(bus) {}
+
+  bool begin(int sda, int scl, uint32_t frequency) override { return inner.begin(sda, scl, frequency); }
+  void end() override { inner.end(); }
+  bool setClock(uint32_t frequency) override { return inner.setClock(frequency); }
+  uint32_t getClock() override { return inner.getClock(); }
+  void setTimeout(uint16_t timeout_ms) override { inner.setTimeout(timeout_ms); }
+  bool isLineStuck() override { return inner.isLineStuck(); }
+  bool recover() override { return inner.recover(); }
+
+  uint8_t write(uint8_t address, const uint8_t* data, size_t length, bool sendStop = true) override {
+    uint32_t start = micros();
+    uint8_t error = inner.write(address, data, length, sendStop);
+    I2CMetrics::getInstance().recordWrite(bus, address, length, error, micros() - start);
+    return error;
+  }
+
+  size_t read(uint8_t address, uint8_t* buffer, size_t length, bool sendStop = true) override {
+    uint32_t start = micros();
+    size_t received = inner.read(address, buffer, length, sendStop);
+    I2CMetrics::getInstance().recordRead(bus, address, length, received, micros() - start);
+    return received;
+  }
+
+  const char* name() const override { return inner.name(); }
+
+  // Wrapped backend (e.g. SimBus for its own statistics)
+  I2CBusBackend& getInner() { return inner; }
+
+private:
+  I2CBusBackend& inner;
+  uint8_t bus;
+};
+
+#endif // I2C_METRICS_H
@@ -0,0 +1,263 @@
+#ifndef I2C_SIM_BUS_H
+#define I2C_SIM_BUS_H
+
+#include <Arduino.h>
+#include "i2c_bus_backend.h"
+#include "ms11_registers.h"
+
+// ============================================================================
+// SIMULATED I2C BUS (build flag: -D I2C_SIM_BUS)
+// ============================================================================
+// In-process I2C backend hosting virtual devices, so the full manager stack
+// (SlaveController, ProbeManager, MD11SlaveUpdate) runs without hardware.
+// Every transaction is counted and charged a simulated wire time based on
+// the configured clock (9 bits per byte + START/STOP).
+//
+// Slave bus:   ATmega328P model (app @ 0x30, twiboot @ 0x14)
+// Display bus: PCF8574 LCD (0x27), SSD1306 (0x3C), AHT10 (0x38), seesaw (0x36),
+//              ADS1110 meat probe (0x48)
+//
+// Note: third-party display libraries talk to Wire directly and bypass
+// I2CManager, so they do not see the simulated devices.
+
+// Virtual device interface
+class SimDevice {
+public:
+  virtual ~SimDevice() {}
+  virtual bool respondsTo(uint8_t address) const = 0;
+  // Master write (length 0 = probe), return false to NACK
+  virtual bool onWrite(uint8_t address, const uint8_t* data, size_t length) = 0;
+  // Master read, return number of bytes supplied
+  virtual size_t onRead(uint8_t address, uint8_t* buffer, size_t length) = 0;
+  virtual const char* name() const = 0;
+};
+
+class SimAtmega328;
+
+class SimBus : public I2CBusBackend {
+public:
+  // Pre-populated bus instances used by I2CManager
+  static SimBus& slaveInstance();
+  static SimBus& displayInstance();
+  
+  // ATmega model on the slave bus (test hooks, attention line)
+  static SimAtmega328& slaveDevice();
+
+  explicit SimBus(const char* label) : label(label) {}
+
+  // Device management
+  bool attach(SimDevice* device);
+  void detachAll() { deviceCount = 0; }
+
+  // I2CBusBackend
+  bool begin(int sda, int scl, uint32_t frequency) override;
+  void end() override { running = false; }
+  bool setClock(uint32_t frequency) override;
+  uint32_t getClock() override { return clockHz; }
+  void setTimeout(uint16_t timeout_ms) override {}
+  uint8_t write(uint8_t address, const uint8_t* data, size_t length, bool sendStop = true) override;
+  size_t read(uint8_t address, uint8_t* buffer, size_t length, bool sendStop = true) override;
+  bool isLineStuck() override { return stuck; }
+  bool recover() override;
+  const char* name() const override { return label; }
+
+  // Fault injection: hold SDA low (every transaction times out until recover())
+  void setStuck(bool held) { stuck = held; }
+
+  // Statistics
+  struct Stats {
+    uint32_t transactions = 0;
+    uint32_t nacks = 0;
+    uint32_t bytes = 0;
+    uint64_t busTimeUs = 0;   // Simulated time on the wire
+    uint32_t recoveries = 0;
+  };
+  Stats getStats() const { return stats; }
+  void resetStats() { stats = Stats(); }
+  void printStats() const;
+
+private:
+  static constexpr uint8_t MAX_DEVICES = 8;
+
+  const char* label;
+  SimDevice* devices[MAX_DEVICES] = {nullptr};
+  uint8_t deviceCount = 0;
+  uint32_t clockHz = 100000;
+  bool running = false;
+  bool stuck = false;
+  Stats stats;
+
+  SimDevice* find(uint8_t address);
+  void charge(size_t bytes);
+};
+
+// ============================================================================
+// Virtual devices
+// ============================================================================
+
+// ATmega328P running MS11-control (0x30) with twiboot (0x14)
+class SimAtmega328 : public SimDevice {
+public:
+  static constexpr uint16_t FLASH_SIZE = 32768;
+  static constexpr uint16_t BOOTLOADER_START = 0x7C00;
+  static constexpr uint16_t EEPROM_SIZE = 1024;
+  static constexpr uint8_t PAGE_SIZE = 128;
+  static constexpr uint32_t PAGE_PROGRAM_US = 4500;  // Erase + write, twiboot NACKs meanwhile
+
+  SimAtmega328();
+
+  bool respondsTo(uint8_t address) const override;
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override;
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override;
+  const char* name() const override { return "ATmega328P (MS11-control)"; }
+
+  // Test hooks
+  void setOvenTemp(int16_t value);
+  void setSystemTemp(int16_t q8_8);
+  void setErrorCode(uint8_t code);
+  void setConnected(bool present) { connected = present; }
+  void setProtocolVersion(uint8_t version);          // 0x02 = no v3 framing
+  void injectFrameErrors(uint8_t count) { corruptResponses = count; }  // Flip a bit in the next framed responses
+  bool isFramed() const { return framed; }
+  void raiseEvent(uint8_t flags);                    // Set ms11::EVENT_* bits, assert ATTN
+  void simulateReset();                              // Reboot: outputs off, framing off, EVENT_RESET
+  void loadFlash(uint16_t address, const uint8_t* data, size_t length);  // Program via ISP, not twiboot
+  void powerFailAfterPages(uint32_t pages);          // Drop off the bus after `pages` more page commits (0 = off)
+
+  // Attention line (active while EventFlags != 0); handler runs in the
+  // context of whoever changed the state, like an edge interrupt would
+  typedef void (*AttentionHandler)(void* context);
+  void setAttentionHandler(AttentionHandler handler, void* context) {
+    attentionHandler = handler;
+    attentionContext = context;
+  }
+  bool isAttentionAsserted() const { return connected && !bootloader && regs[ms11::EventFlags::address] != 0; }
+  bool isInBootloader() const { return bootloader; }
+  bool isLedOn() const { return ledOn; }
+  uint32_t getPageWrites() const { return pageWrites; }
+  const uint8_t* getFlash() const { return flash; }
+  uint8_t* getEeprom() { return eeprom; }
+
+private:
+  bool connected = true;
+  bool bootloader = false;
+  bool ledOn = false;
+
+  // Application register file
+  uint8_t regs[256];
+  uint8_t regPointer = 0;
+  uint8_t version[4];
+
+  // Protocol v3 framing (ms11_frame.h)
+  bool framed = false;
+  bool framedRead = false;    // Pointer was set by a framed read request
+  uint8_t responseSeq = 0;
+  uint8_t lastWriteSeq = 0;   // Repeats of the last applied frame are ignored
+  uint8_t corruptResponses = 0;
+
+  AttentionHandler attentionHandler = nullptr;
+  void* attentionContext = nullptr;
+
+  // Twiboot state
+  uint8_t flash[FLASH_SIZE];
+  uint8_t eeprom[EEPROM_SIZE];
+  uint8_t bootCmd = 0;
+  uint8_t memType = 0;
+  uint16_t memAddress = 0;
+  uint32_t pageWrites = 0;
+  uint32_t powerFailAt = 0;   // pageWrites value that cuts the power, 0 = none
+  uint32_t busyUntilUs = 0;   // Programming a page
+  bool programming = false;
+
+  bool appWrite(const uint8_t* data, size_t length);
+  bool framedWrite(const uint8_t* data, size_t length);
+  bool applyRegisters(const uint8_t* data, size_t length);
+  bool bootWrite(const uint8_t* data, size_t length);
+  size_t bootRead(uint8_t* buffer, size_t length);
+};
+
+// PCF8574 LCD backpack (0x27)
+class SimPCF8574 : public SimDevice {
+public:
+  bool respondsTo(uint8_t address) const override { return address == 0x27; }
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override;
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override;
+  const char* name() const override { return "PCF8574 LCD"; }
+  uint32_t getWrites() const { return writes; }
+
+private:
+  uint8_t port = 0xFF;
+  uint32_t writes = 0;
+};
+
+// SSD1306 OLED (0x3C)
+class SimSSD1306 : public SimDevice {
+public:
+  bool respondsTo(uint8_t address) const override { return address == 0x3C; }
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override;
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override;
+  const char* name() const override { return "SSD1306 OLED"; }
+  uint32_t getCommandBytes() const { return commandBytes; }
+  uint32_t getDataBytes() const { return dataBytes; }
+
+private:
+  uint32_t commandBytes = 0;
+  uint32_t dataBytes = 0;
+};
+
+// AHT10 temperature/humidity (0x38), ~75ms conversion
+class SimAHT10 : public SimDevice {
+public:
+  bool respondsTo(uint8_t address) const override { return address == 0x38; }
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override;
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override;
+  const char* name() const override { return "AHT10"; }
+  void setClimate(float tempC, float humidityPct) { temperature = tempC; humidity = humidityPct; }
+
+private:
+  static constexpr uint32_t CONVERSION_MS = 75;
+  float temperature = 21.5f;
+  float humidity = 45.0f;
+  bool calibrated = false;
+  bool measuring = false;
+  uint32_t triggerTime = 0;
+};
+
+// ADS1110 ADC behind the NTC divider from config.h (0x48-0x4B).
+// Powers up in 15 SPS continuous mode like the real part; ST/DRDY reads 0
+// once per conversion period and is set again by the read.
+class SimADS1110 : public SimDevice {
+public:
+  explicit SimADS1110(uint8_t address) : address(address) {}
+  bool respondsTo(uint8_t addr) const override { return addr == address; }
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override;
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override;
+  const char* name() const override { return "ADS1110 ADC"; }
+  void setTemperature(float tempC) { temperature = tempC; }
+  void setUnplugged(bool open) { unplugged = open; }
+
+private:
+  uint8_t address;
+  uint8_t config = 0x0C;        // Power-on: continuous, 15 SPS, PGA 1
+  float temperature = 21.5f;
+  bool unplugged = false;
+  uint32_t lastReadMs = 0;
+  int16_t outputCode();
+};
+
+// Adafruit seesaw rotary encoder (0x36)
+class SimSeesaw : public SimDevice {
+public:
+  bool respondsTo(uint8_t address) const override { return address == 0x36; }
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override;
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override;
+  const char* name() const override { return "Seesaw encoder"; }
+  void setEncoderPosition(int32_t position) { encoderPosition = position; }
+
+private:
+  uint8_t module = 0;
+  uint8_t function = 0;
+  int32_t encoderPosition = 0;
+};
+
+#endif // I2C_SIM_BUS_H
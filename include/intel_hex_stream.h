@@ -0,0 +1,94 @@
+#ifndef INTEL_HEX_STREAM_H
+#define INTEL_HEX_STREAM_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// STREAMING INTEL HEX DECODER
+// ============================================================================
+// Incremental, allocation-free decoder: feed() accepts arbitrary slices of
+// the file (LittleFS reads, HTTP body chunks) and emits each completed flash
+// page through a callback. Only one record and one page are buffered (~400
+// bytes), independent of the file size.
+//
+// Records are delimited by their byte count, not by line endings, so CR/LF
+// variants and text around the records (e.g. a JSON string wrapper with
+// escaped newlines) are skipped. Every record's checksum is verified before
+// any of its data reaches a page.
+//
+// Pages must arrive in order (as avr-objcopy writes them); revisiting an
+// already emitted page is rejected instead of re-erasing it.
+
+#define HEX_PAGE_SIZE         128     // ATmega328P flash page
+#define HEX_BOOTLOADER_START  0x7C00  // twiboot section, data here is skipped
+#define HEX_FLASH_END         0x8000  // 32 KB flash
+#define HEX_MAX_RECORD_DATA   255
+
+// Called with a completed page (unused bytes are 0xFF). Return false to abort.
+typedef bool (*HexPageCallback)(uint16_t pageAddress, const uint8_t* page, uint16_t size, void* context);
+
+class IntelHexStream {
+public:
+  enum Result : uint8_t {
+    HEX_OK = 0,          // More input expected
+    HEX_DONE,            // EOF record processed, last page emitted
+    HEX_ERROR_SYNTAX,    // Non-hex character or line break inside a record
+    HEX_ERROR_CHECKSUM,  // Record checksum mismatch
+    HEX_ERROR_RECORD,    // Unsupported record type or malformed record
+    HEX_ERROR_ADDRESS,   // Data beyond flash or page revisited
+    HEX_ERROR_WRITE,     // Page callback failed
+    HEX_ERROR_TRUNCATED  // Input ended without an EOF record
+  };
+
+  IntelHexStream(HexPageCallback callback, void* context);
+
+  // Start a new file
+  void reset();
+
+  // Decode the next slice; stops at the first error (sticky until reset())
+  Result feed(const uint8_t* data, size_t length);
+
+  // End of input: HEX_DONE if the EOF record was seen, otherwise an error
+  Result finish();
+
+  Result getResult() const { return result; }
+  const char* getErrorString() const;
+  uint32_t getLine() const { return records + 1; }  // Record being decoded (1-based)
+
+  // Statistics
+  uint32_t getRecordCount() const { return records; }
+  uint32_t getDataBytes() const { return dataBytes; }
+  uint32_t getSkippedBytes() const { return skippedBytes; }  // Bootloader section
+  uint16_t getPageCount() const { return pages; }
+
+private:
+  HexPageCallback callback;
+  void* context;
+
+  // Decoder state
+  bool inRecord = false;
+  bool highNibble = true;
+  uint8_t record[4 + HEX_MAX_RECORD_DATA + 1];  // count, addrH, addrL, type, data, checksum
+  uint16_t recordLength = 0;
+  Result result = HEX_OK;
+
+  // Address state
+  uint32_t baseAddress = 0;  // From type 02/04 records
+
+  // Page assembly
+  uint8_t page[HEX_PAGE_SIZE];
+  int32_t pageAddress = -1;  // -1 = no page open
+  uint8_t emitted[HEX_FLASH_END / HEX_PAGE_SIZE / 8];
+
+  // Statistics
+  uint32_t records = 0;
+  uint32_t dataBytes = 0;
+  uint32_t skippedBytes = 0;
+  uint16_t pages = 0;
+
+  Result processRecord();
+  Result storeByte(uint32_t address, uint8_t value);
+  Result flushPage();
+};
+
+#endif // INTEL_HEX_STREAM_H
@@ -3,7 +3,9 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <vector>
+#include <FS.h>
+#include "intel_hex_stream.h"
+#include "ms11_image.h"
 
 // Twiboot bootloader I2C address (slave)
 #define TWIBOOT_I2C_ADDR 0x14
@@ -14,24 +16,91 @@
 // I2C Command to enter bootloader mode
 #define APP_BOOTLOADER_COMMAND 0x42  // ASCII 'B'
 
-// Twiboot commands (from bootloader protocol)
+// Twiboot commands (twiboot.c). Memory is accessed as
+// [0x02] [memtype] [addrH] [addrL] followed by data to write, or by a read.
 enum TwiBootCommand {
-  TWIBOOT_READ_VERSION = 0x01,
-  TWIBOOT_READ_MEMORY = 0x02,
-  TWIBOOT_WRITE_MEMORY = 0x03,
-  TWIBOOT_READ_FLASH = 0x04,
-  TWIBOOT_READ_EEPROM = 0x05,
-  TWIBOOT_WRITE_FLASH = 0x06,
-  TWIBOOT_WRITE_EEPROM = 0x07,
-  TWIBOOT_READ_SIGNATURE = 0x08
+  TWIBOOT_CMD_READ_VERSION = 0x01,   // Alone: version string. With 0x80: start the application
+  TWIBOOT_CMD_ACCESS_MEMORY = 0x02
 };
 
-// Bootloader response status
-enum TwiBootStatus {
-  BOOT_OK = 0x00,
-  BOOT_ERROR = 0xFF
+enum TwiBootMemType {
+  TWIBOOT_MEM_CHIPINFO = 0x00,       // signature(3) pagesize(1) flashsize(2) eepromsize(2)
+  TWIBOOT_MEM_FLASH = 0x01,
+  TWIBOOT_MEM_EEPROM = 0x02
 };
 
+#define TWIBOOT_BOOTTYPE_APPLICATION 0x80
+#define TWIBOOT_VERSION_LENGTH       16
+
+// ============================================================================
+// DIFFERENTIAL FLASHING
+// ============================================================================
+// Each page the HEX decoder completes is compared with the slave's flash
+// before anything is written: first against the CRC-32 recorded for that page
+// by the last verified upload (no bus traffic), otherwise by reading the page
+// back through the twiboot read command (~4 short transfers instead of
+// 8 writes, an erase and the programming delays). Only differing pages are
+// written. Afterwards every page of the image is read back and checked; the
+// per-page CRC table is stored in LittleFS only after that verify succeeds,
+// so reflashing the same build costs one read pass.
+//
+// The cache describes the slave's flash, not the file: if the ATmega was
+// programmed behind our back (ISP, another host) the verify fails, the cache
+// is dropped and the next attempt falls back to read-back comparison.
+// Every board on the slave bus has its own cache (setTarget()); the board at
+// APP_I2C_ADDR keeps the original file name.
+
+#define MD11_FLASH_CACHE_PATH  "/ms11_flash.cache"
+#define MD11_FLASH_CACHE_FMT   "/ms11_flash_%02x.cache"   // Other application addresses
+#define MD11_FLASH_CACHE_MAGIC 0x4631314D  // "M11F"
+#define MD11_FLASH_PAGES       (HEX_BOOTLOADER_START / HEX_PAGE_SIZE)  // Application pages
+
+// ============================================================================
+// TWIBOOT PACING
+// ============================================================================
+// Pages go out in as few transactions as the Wire buffer allows: with the
+// ESP32 default of 128 bytes a page takes two writes, built with
+// -D I2C_BUFFER_LENGTH=132 (or more) it is a single transaction. Instead of
+// sleeping after every chunk, the bootloader is ACK-polled once the page is
+// committed; it does not answer its address while erasing and programming.
+// The same polling replaces the fixed waits for bootloader entry and exit.
+
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 32  // Classic Wire buffer
+#endif
+
+#define TWIBOOT_WRITE_HEADER      4  // 0x02 memtype addrH addrL
+#define TWIBOOT_WRITE_CHUNK       ((I2C_BUFFER_LENGTH - TWIBOOT_WRITE_HEADER) < HEX_PAGE_SIZE ? \
+                                   (I2C_BUFFER_LENGTH - TWIBOOT_WRITE_HEADER) : HEX_PAGE_SIZE)
+#define MD11_READ_CHUNK           (I2C_BUFFER_LENGTH < HEX_PAGE_SIZE ? I2C_BUFFER_LENGTH : HEX_PAGE_SIZE)
+
+// twiboot programs each EEPROM byte as it arrives and stretches the clock
+// while the previous one completes (~3.4 ms), so EEPROM writes stay short
+#define TWIBOOT_EEPROM_WRITE_CHUNK 8
+
+#define TWIBOOT_PAGE_TIMEOUT_MS   50    // Page erase + write is ~4.5 ms on the ATmega328P
+#define TWIBOOT_ENTRY_TIMEOUT_MS  8000  // twiboot answers ~5 s after the boot magic is set
+#define TWIBOOT_EXIT_TIMEOUT_MS   2000  // Application back on SLAVE_I2C_ADDR
+
+// ============================================================================
+// BACKUP / ROLLBACK
+// ============================================================================
+// Before an update SlaveFlasher dumps the application section into a sparse
+// .msimg (erased pages left out) and the EEPROM into a raw file, so the
+// previous firmware can be flashed back like any other image. The dump is
+// written to a temporary file and only replaces the last good backup once
+// complete. Every page read also lands in the page cache, so the update
+// that follows needs no extra read-back. The bootloader section is not
+// dumped: twiboot cannot rewrite it anyway.
+// Leading dots keep the backups out of the boot-time update scan.
+
+#define MD11_BACKUP_IMAGE_PATH   "/.ms11_backup.msimg"
+#define MD11_BACKUP_EEPROM_PATH  "/.ms11_backup.eeprom"
+#define MD11_BACKUP_IMAGE_FMT    "/.ms11_backup_%02x.msimg"    // Other application addresses
+#define MD11_BACKUP_EEPROM_FMT   "/.ms11_backup_%02x.eeprom"
+#define MD11_BACKUP_TEMP_PATH    "/.ms11_backup.tmp"
+#define MD11_BACKUP_TEMP_EEPROM  "/.ms11_backup_eeprom.tmp"
+
 class MD11SlaveUpdate {
 public:
   MD11SlaveUpdate();
@@ -39,23 +108,121 @@ public:
   // Request app to enter bootloader mode
   bool requestBootloaderMode();
   
-  // Query bootloader version
+  // Query bootloader version (e.g. "TWIBOOT v3.2")
   bool queryBootloaderVersion(String& version);
   
+  // Chip info as reported by twiboot; flashSize is the application section
+  struct ChipInfo {
+    uint8_t signature[3];
+    uint8_t pageSize;
+    uint16_t flashSize;
+    uint16_t eepromSize;
+  };
+  bool queryChipInfo(ChipInfo& info);
+  
   // Query chip signature
   bool queryChipSignature(uint8_t& sig0, uint8_t& sig1, uint8_t& sig2);
   
-  // Upload Intel HEX firmware file
+  // Upload Intel HEX firmware held in memory
   bool uploadHexFile(const String& hexContent, void (*progressCallback)(int percent) = nullptr);
   
-  // Write full 128-byte flash page (in 16-byte chunks)
+  // Upload Intel HEX from a stream (e.g. LittleFS file) without buffering it;
+  // totalSize only drives the progress callback
+  bool uploadHexStream(Stream& source, size_t totalSize = 0, void (*progressCallback)(int percent) = nullptr);
+  
+  // Incremental upload (HTTP body chunks): pages are flashed as they complete
+  void beginHexUpload();
+  bool feedHex(const uint8_t* data, size_t length);  // false once an error occurred
+  bool endHexUpload();                                // true if the whole file was flashed
+  
+  // Flash a pre-decoded .msimg image (ms11_image.h); header, digest and
+  // target signature are checked before the first page is sent
+  bool uploadImage(File& image, void (*progressCallback)(int percent) = nullptr);
+  
+  // Page-level flashing (the upload functions above and SlaveFlasher):
+  // beginFlash(), flashPage() for every page, then finishFlash() verifies
+  // the image and persists the page cache
+  void beginFlash();
+  bool flashPage(uint16_t pageAddress, const uint8_t* page, uint16_t size);
+  bool finishFlash();
+  
+  // Resume after a reset: take a page as already programmed (no bus traffic);
+  // finishFlash() still reads it back
+  void assumePage(uint16_t pageAddress, const uint8_t* page, uint16_t size);
+  
+  // Wait until the bootloader answers on TWIBOOT_I2C_ADDR
+  bool waitForBootloader(uint32_t timeoutMs = TWIBOOT_ENTRY_TIMEOUT_MS);
+  
+  // Write full 128-byte flash page (TWIBOOT_WRITE_CHUNK bytes per transaction)
   bool writeFlashPage(uint16_t pageAddress, const uint8_t* pageData, uint16_t pageSize);
   
-  // Write memory via bootloader (for testing)
-  bool writeMemory(uint16_t address, const uint8_t* data, uint16_t length);
+  // Differential mode (default): unchanged pages are not rewritten.
+  // Disabled, every page is written (the image is still verified).
+  void setDifferential(bool enabled) { differential = enabled; }
+  
+  // Board being flashed, by its application address (selects the page cache).
+  // Only one board can be in twiboot at a time: they all share TWIBOOT_I2C_ADDR.
+  void setTarget(uint8_t appAddress);
+  uint8_t getTarget() const { return targetAddress; }
+  bool isDifferential() const { return differential; }
+  
+  // Read flash or EEPROM (MD11_READ_CHUNK bytes per transaction, retried)
+  bool readMemory(TwiBootMemType type, uint16_t address, uint8_t* buffer, uint16_t length);
+  bool readFlash(uint16_t address, uint8_t* buffer, uint16_t length) {
+    return readMemory(TWIBOOT_MEM_FLASH, address, buffer, length);
+  }
+  
+  // Write EEPROM; chunks that already hold the data are skipped, the rest
+  // is read back and compared
+  bool writeEeprom(uint16_t address, const uint8_t* data, uint16_t length);
+  
+  // Backup for rollback (target board selected with setTarget()):
+  // beginBackup(), backupPage() for index 0 .. getBackupPageCount()-1,
+  // then finishBackup() dumps the EEPROM and replaces the previous backup
+  bool beginBackup();
+  bool backupPage(uint16_t index);
+  bool finishBackup();
+  void abortBackup();
+  uint16_t getBackupPageCount() const { return backupPageCount; }
+  static String backupImagePath(uint8_t appAddress);
+  static String backupEepromPath(uint8_t appAddress);
   
-  // Read memory via bootloader (for testing)
-  bool readMemory(uint16_t address, uint8_t* buffer, uint16_t length);
+  // Write a raw EEPROM dump back (at most the chip's EEPROM size)
+  bool restoreEeprom(const String& path);
+  
+  struct BackupStats {
+    uint16_t pagesStored = 0;     // Non-erased pages in the image
+    uint32_t flashBytes = 0;      // Read from flash
+    uint32_t eepromBytes = 0;
+    uint32_t readUs = 0;          // Time spent in the bus reads
+    uint32_t bytesPerSec = 0;     // Dump throughput
+    uint32_t totalMs = 0;
+    bool complete = false;
+  };
+  BackupStats getBackupStats() const { return backupStats; }
+  
+  // Read back every page of the last upload and check it against its CRC
+  bool verifyImage();
+  
+  // Forget the recorded flash contents (next upload reads every page back)
+  void invalidateFlashCache();
+  
+  struct FlashStats {
+    uint16_t pagesWritten = 0;    // Differed (or full mode) and were programmed
+    uint16_t pagesUnchanged = 0;  // Read back identical, not written
+    uint16_t pagesCached = 0;     // Matched the cache, no bus traffic
+    uint16_t pagesResumed = 0;    // Committed before a reset (flash journal)
+    uint16_t pagesVerified = 0;
+    uint32_t imageCrc = 0;        // CRC-32 over the page CRCs in address order
+    uint32_t flashMs = 0;         // First page -> EOF record
+    uint32_t verifyMs = 0;
+    uint32_t bytesWritten = 0;
+    uint32_t writeUs = 0;         // Inside writeFlashPage(), including ACK polling
+    uint32_t programWaitUs = 0;   // Of which the bootloader was busy programming
+    uint32_t writeBytesPerSec = 0;
+    bool verified = false;
+  };
+  FlashStats getFlashStats() const { return flashStats; }
   
   // Get last error message
   String getLastError() { return lastError; }
@@ -63,22 +230,35 @@ public:
 private:
   String lastError;
   
-  // Helper: Send I2C command to bootloader
-  bool sendBootloaderCommand(TwiBootCommand cmd, const uint8_t* data = nullptr, 
-                             uint16_t dataLen = 0, uint8_t* response = nullptr, 
-                             uint16_t* responseLen = nullptr);
+  // Streaming HEX decoder, flashes each completed page
+  IntelHexStream hexStream;
+  static bool onHexPage(uint16_t pageAddress, const uint8_t* page, uint16_t size, void* context);
   
-  // Helper: Parse Intel HEX line
-  struct HexRecord {
-    uint16_t address;
-    uint8_t recordType;  // 0=data, 1=EOF, 2=extended segment, 4=extended linear
-    std::vector<uint8_t> data;
-  };
+  // Differential flashing state
+  bool differential = true;
+  uint8_t targetAddress = APP_I2C_ADDR;
+  uint32_t pageCrc[MD11_FLASH_PAGES];           // Known CRC-32 of each slave page, 0 = unknown
+  uint8_t imagePages[MD11_FLASH_PAGES / 8];     // Pages of the current upload
+  bool cacheLoaded = false;
+  bool cacheOnDisk = false;                     // LittleFS copy still matches the slave
+  uint32_t uploadStartMs = 0;
+  FlashStats flashStats;
   
-  bool parseHexLine(const String& line, HexRecord& record);
+  String cachePath() const;
+  // Backup in progress
+  File backupFile;
+  MsImageWriter* backupWriter = nullptr;
+  ChipInfo backupChip;
+  uint16_t backupPageCount = 0;
+  uint32_t backupStartMs = 0;
+  BackupStats backupStats;
+  static String pathFor(uint8_t appAddress, const char* primary, const char* format);
   
-  // Helper: Calculate checksum for hex record
-  uint8_t calculateHexChecksum(const String& line);
+  void loadFlashCache();
+  bool saveFlashCache();
+  void dropFlashCacheFile();
+  static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+  static uint32_t pageKey(const uint8_t* page, uint16_t size);
 };
 
 #endif // MD11_SLAVE_UPDATE_H
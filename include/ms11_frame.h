@@ -0,0 +1,108 @@
+#ifndef MS11_FRAME_H
+#define MS11_FRAME_H
+
+#include <Arduino.h>
+#include "ms11_registers.h"
+
+// ============================================================================
+// MS11 PROTOCOL v3 - CRC-8 FRAMING
+// ============================================================================
+// v3 wraps every v2 transaction in a sequence byte and an SMBus PEC
+// (CRC-8, polynomial 0x07, init 0x00). The CRC covers the address bytes as
+// they appear on the wire, so a frame misdirected to another device or a
+// flipped R/W bit fails the check as well.
+//
+//   Write:         S addr+W | seq reg data... pec | P
+//                  pec = crc8(addr+W, seq, reg, data...)
+//   Read request:  S addr+W | seq reg pec | P
+//                  pec = crc8(addr+W, seq, reg)
+//   Read response: S addr+R | seq data... pec | P
+//                  pec = crc8(addr+R, seq, data...)
+//
+// Sequence numbers run 0xA0-0xFF and lead the frame: a v2 slave (e.g. one
+// that reset and lost the negotiated mode) sees a write to a register that
+// does not exist instead of a command. The slave NACKs a write whose PEC
+// does not match and ignores a write repeating the sequence number of the
+// last one it applied, so a frame whose ACK was lost can be re-sent as-is.
+// A bare one-byte pointer write still selects an unframed v2 read (register
+// dumps, diagnostics). Framing is switched on by writing PROTOCOL_V3 to
+// FramingCmd and stays on until the slave resets.
+
+namespace ms11 {
+
+constexpr uint8_t PROTOCOL_V2 = 0x02;
+constexpr uint8_t PROTOCOL_V3 = 0x03;
+
+constexpr uint8_t FRAME_SEQ_FIRST = 0xA0;       // Above every v2 register address
+
+constexpr uint8_t FRAME_WRITE_OVERHEAD = 2;     // seq + pec
+constexpr uint8_t FRAME_READ_OVERHEAD = 2;      // seq + pec
+constexpr uint8_t FRAME_READ_REQUEST_LENGTH = 3; // seq reg pec
+
+// Largest payload of one framed write / read (Wire buffer minus framing)
+constexpr uint8_t FRAME_MAX_WRITE_DATA = MS11_MAX_BURST - 1 - FRAME_WRITE_OVERHEAD;
+constexpr uint8_t FRAME_MAX_READ_DATA = MS11_MAX_BURST - FRAME_READ_OVERHEAD;
+
+static_assert(Snapshot::length <= FRAME_MAX_READ_DATA, "snapshot does not fit a framed read");
+
+inline bool isSequence(uint8_t byte) {
+  return byte >= FRAME_SEQ_FIRST;
+}
+
+inline uint8_t nextSequence(uint8_t seq) {
+  return (seq < FRAME_SEQ_FIRST || seq == 0xFF) ? FRAME_SEQ_FIRST : (uint8_t)(seq + 1);
+}
+
+// CRC-8/SMBus, bitwise (frames are at most 32 bytes)
+inline uint8_t crc8Update(uint8_t crc, uint8_t byte) {
+  crc ^= byte;
+  for (uint8_t bit = 0; bit < 8; bit++) {
+    crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+inline uint8_t crc8(const uint8_t* data, size_t length, uint8_t crc = 0) {
+  for (size_t i = 0; i < length; i++) {
+    crc = crc8Update(crc, data[i]);
+  }
+  return crc;
+}
+
+// Build a framed write into `out`; returns the frame length (0 if too long)
+inline uint8_t buildWriteFrame(uint8_t reg, uint8_t seq, const uint8_t* data, uint8_t length,
+                               uint8_t* out, uint8_t address = SLAVE_ADDRESS) {
+  if (length > FRAME_MAX_WRITE_DATA) {
+    return 0;
+  }
+  out[0] = seq;
+  out[1] = reg;
+  memcpy(out + 2, data, length);
+  out[2 + length] = crc8(out, 2 + length, crc8Update(0, address << 1));
+  return 2 + length + 1;
+}
+
+// Build a framed read request (register pointer + sequence)
+inline uint8_t buildReadRequest(uint8_t reg, uint8_t seq, uint8_t* out,
+                                uint8_t address = SLAVE_ADDRESS) {
+  out[0] = seq;
+  out[1] = reg;
+  out[2] = crc8(out, 2, crc8Update(0, address << 1));
+  return FRAME_READ_REQUEST_LENGTH;
+}
+
+// Verify a read response of `length` payload bytes (buffer holds length + 2)
+enum class FrameCheck : uint8_t { Ok, BadSequence, BadCrc };
+
+inline FrameCheck checkReadResponse(const uint8_t* response, uint8_t length, uint8_t seq,
+                                    uint8_t address = SLAVE_ADDRESS) {
+  uint8_t crc = crc8(response, 1 + length, crc8Update(0, (address << 1) | 1));
+  if (crc != response[1 + length]) {
+    return FrameCheck::BadCrc;
+  }
+  return (response[0] == seq) ? FrameCheck::Ok : FrameCheck::BadSequence;
+}
+
+}  // namespace ms11
+
+#endif // MS11_FRAME_H
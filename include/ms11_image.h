@@ -0,0 +1,99 @@
+#ifndef MS11_IMAGE_H
+#define MS11_IMAGE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <mbedtls/sha256.h>
+#include "intel_hex_stream.h"
+
+// ============================================================================
+// MS11-CONTROL FIRMWARE IMAGE (.msimg)
+// ============================================================================
+// Pre-decoded replacement for shipping the ATmega firmware as Intel HEX:
+// a 64-byte header followed by sparse page records in ascending address
+// order. All fields are little-endian.
+//
+//   Header   magic "MSIM", format version, header size, page size,
+//            target signature (3 bytes), firmware version (BCD, as
+//            ms11::FwVersion), page count, SHA-256 over all page records
+//   Record   uint16 page address + pageSize bytes
+//
+// Images are produced on the host by tools/hex2msimg.py, or on the device
+// by convertHexToImage() when a .hex file is uploaded. The flasher checks
+// the digest over the whole file before the first page is sent, so a
+// truncated or corrupted image never reaches the ATmega.
+
+#define MSIMG_MAGIC           "MSIM"
+#define MSIMG_FORMAT_VERSION  1
+#define MSIMG_HEADER_SIZE     64
+#define MSIMG_EXTENSION       ".msimg"
+
+// ATmega328P, the only target twiboot is built for here
+#define MSIMG_SIG_ATMEGA328P  {0x1E, 0x95, 0x0F}
+
+struct __attribute__((packed)) MsImageHeader {
+  char magic[4];
+  uint8_t formatVersion;
+  uint8_t headerSize;
+  uint16_t pageSize;
+  uint8_t signature[3];
+  uint8_t fwVersion;       // BCD, 0 = unknown (converted from .hex)
+  uint16_t pageCount;
+  uint8_t reserved0[6];
+  uint8_t sha256[32];      // Over every page record, in file order
+  uint8_t reserved1[12];
+};
+
+static_assert(sizeof(MsImageHeader) == MSIMG_HEADER_SIZE, "MsImageHeader layout changed");
+
+#define MSIMG_RECORD_SIZE(pageSize) (2 + (pageSize))
+
+// ============================================================================
+// Writer (on-device .hex conversion)
+// ============================================================================
+
+class MsImageWriter {
+public:
+  MsImageWriter() { mbedtls_sha256_init(&sha); }
+  ~MsImageWriter() { mbedtls_sha256_free(&sha); }
+
+  // Reserve the header; `out` must stay open until finish()
+  bool begin(File& out, const uint8_t signature[3], uint8_t fwVersion = 0,
+             uint16_t pageSize = HEX_PAGE_SIZE);
+
+  // Append one page record (pages must be added in ascending order)
+  bool addPage(uint16_t pageAddress, const uint8_t* page);
+
+  // Seal the digest and rewrite the header
+  bool finish();
+
+  uint16_t getPageCount() const { return header.pageCount; }
+
+private:
+  File* file = nullptr;
+  MsImageHeader header;
+  mbedtls_sha256_context sha;
+  int32_t lastAddress = -1;
+};
+
+// ============================================================================
+// Reader helpers
+// ============================================================================
+
+// Read and sanity-check the header at the start of `file`
+bool readImageHeader(File& file, MsImageHeader& header, String& error);
+
+// Hash every record and compare with the header digest; leaves the file
+// positioned at the first record
+bool verifyImageDigest(File& file, const MsImageHeader& header, String& error);
+
+// Decode `hexPath` into `imagePath` (ATmega328P target). `fwVersion` is the
+// BCD version the HEX was built as, 0 if unknown.
+bool convertHexToImage(const String& hexPath, const String& imagePath, String& error,
+                       uint8_t fwVersion = 0);
+
+// BCD firmware version from user input ("0x61" or "61" = v0.6.1); false
+// unless both digits are decimal and the version is not 0
+bool parseFirmwareVersion(const String& text, uint8_t& version);
+
+#endif // MS11_IMAGE_H
@@ -0,0 +1,205 @@
+#ifndef MS11_REGISTERS_H
+#define MS11_REGISTERS_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+// ============================================================================
+// MS11 PROTOCOL v2 - TYPED REGISTER MAP
+// ============================================================================
+// Every register is a compile-time descriptor: address, value type, byte
+// order and access. Decoding/encoding is generated per descriptor (no
+// runtime tables), and the static_asserts at the bottom reject overlapping
+// registers before anything reaches the bus.
+//
+// The slave has two independent address spaces: a register READ at 0x10 and
+// a register WRITE to 0x10 are different registers (oven limit vs LED).
+// Overlaps are therefore checked per direction.
+
+namespace ms11 {
+
+enum class Endian : uint8_t {
+  Big,     // MSB at the lower address (temperatures, limits)
+  Little   // LSB at the lower address (full version)
+};
+
+enum class Access : uint8_t {
+  ReadOnly,   // Part of the linear read map (burst-readable)
+  WriteOnly,  // Command register in write space
+  ReadWrite,  // Same address in both spaces
+  ReadBlock   // Selects a dedicated response buffer, not the linear map
+};
+
+template <uint8_t Address, typename T, Endian E = Endian::Big, Access A = Access::ReadOnly>
+struct Reg {
+  static_assert(std::is_integral<T>::value, "register value must be an integral type");
+  static_assert(Address + sizeof(T) <= 0x100, "register runs past 0xFF");
+
+  using value_type = T;
+  static constexpr uint8_t address = Address;
+  static constexpr uint8_t size = sizeof(T);
+  static constexpr uint8_t last = Address + sizeof(T) - 1;
+  static constexpr Endian endian = E;
+  static constexpr Access access = A;
+  static constexpr bool readable = (A != Access::WriteOnly);
+  static constexpr bool writable = (A == Access::WriteOnly || A == Access::ReadWrite);
+  static constexpr bool inReadMap = (A == Access::ReadOnly || A == Access::ReadWrite);
+  static constexpr bool inWriteMap = writable;
+
+  // Decode from a buffer whose first byte is register `base`
+  static T decode(const uint8_t* buffer, uint8_t base = Address) {
+    using U = typename std::make_unsigned<T>::type;
+    const uint8_t* p = buffer + (Address - base);
+    U raw = 0;
+    for (uint8_t i = 0; i < size; i++) {
+      uint8_t shift = (E == Endian::Big) ? (size - 1 - i) * 8 : i * 8;
+      raw |= (U)((U)p[i] << shift);
+    }
+    return (T)raw;
+  }
+
+  // Encode into `size` bytes in wire order
+  static void encode(T value, uint8_t* out) {
+    using U = typename std::make_unsigned<T>::type;
+    U raw = (U)value;
+    for (uint8_t i = 0; i < size; i++) {
+      uint8_t shift = (E == Endian::Big) ? (size - 1 - i) * 8 : i * 8;
+      out[i] = (uint8_t)(raw >> shift);
+    }
+  }
+};
+
+// ============================================================================
+// Burst: smallest contiguous span covering a set of readable registers
+// ============================================================================
+
+#define MS11_MAX_BURST 32  // Wire buffer size
+
+template <typename... Regs>
+struct Burst {
+  static constexpr uint8_t first = [] {
+    uint8_t lo = 0xFF;
+    for (uint8_t a : {Regs::address...}) lo = (a < lo) ? a : lo;
+    return lo;
+  }();
+  static constexpr uint8_t last = [] {
+    uint8_t hi = 0;
+    for (uint8_t a : {Regs::last...}) hi = (a > hi) ? a : hi;
+    return hi;
+  }();
+  static constexpr uint8_t length = last - first + 1;
+
+  static_assert(sizeof...(Regs) > 0, "empty burst");
+  static_assert((Regs::inReadMap && ...), "burst may only contain linear read-map registers");
+  static_assert(length <= MS11_MAX_BURST, "burst exceeds the Wire buffer");
+
+  // Typed access into a buffer filled by one read of `length` bytes at `first`
+  template <typename R>
+  static typename R::value_type get(const uint8_t* buffer) {
+    static_assert(R::address >= first && R::last <= last, "register not covered by this burst");
+    return R::decode(buffer, first);
+  }
+};
+
+// ============================================================================
+// Compile-time overlap check
+// ============================================================================
+
+struct Span {
+  uint8_t first;
+  uint8_t last;
+};
+
+template <size_t N>
+constexpr bool spansDisjoint(const Span (&spans)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = i + 1; j < N; j++) {
+      if (spans[i].first <= spans[j].last && spans[j].first <= spans[i].last) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename... Regs>
+constexpr bool disjoint() {
+  constexpr Span spans[] = {{Regs::address, Regs::last}...};
+  return spansDisjoint(spans);
+}
+
+// ============================================================================
+// Register map
+// ============================================================================
+
+constexpr uint8_t SLAVE_ADDRESS = 0x30;
+
+// Read space (linear, burst-readable)
+using OvenTemp          = Reg<0x00, int16_t>;    // °C
+using SysTemp           = Reg<0x02, int16_t>;    // DS18B20 Q8.8
+using FanSpeed          = Reg<0x06, uint8_t>;    // PWM 0-39
+using Status            = Reg<0x07, uint8_t>;    // bit0 igniter, bit1 auger, bits4-7 error
+using FwVersion         = Reg<0x08, uint8_t>;    // BCD (0x61 = v0.6.1)
+using ProtocolVersion   = Reg<0x09, uint8_t>;    // 0x02, 0x03 = v3 framing capable
+using DebugMode         = Reg<0x0A, uint8_t>;    // 0/1
+using FanPercent        = Reg<0x0B, uint8_t>;    // 0-100
+using MinMasterVersion  = Reg<0x0D, uint8_t>;    // 0x10 = v1.0
+using DisplayEnabled    = Reg<0x0E, uint8_t>;    // 0/1
+using OvenTempLimitLow  = Reg<0x0F, uint16_t>;   // °C
+using OvenTempLimitHigh = Reg<0x11, uint16_t>;   // °C
+using IgniterMaxTime    = Reg<0x13, uint16_t>;   // seconds
+using SysTempAlarm      = Reg<0x15, uint8_t>;    // °C
+using EventFlags        = Reg<0x16, uint8_t>;    // EVENT_* bits, cleared on read (not in Snapshot)
+
+// Read space (block): major(16, LE) minor(8) patch<<4|build
+using VersionFull       = Reg<0x0C, uint32_t, Endian::Little, Access::ReadBlock>;
+
+// Write space
+using LedOnOff          = Reg<0x10, uint8_t, Endian::Big, Access::WriteOnly>;   // 0=off, 1=on
+using LedBlink          = Reg<0x11, uint8_t, Endian::Big, Access::WriteOnly>;   // 0=off, 1=1Hz, 2=4Hz
+using FanCmd            = Reg<0x20, uint8_t, Endian::Big, Access::WriteOnly>;   // 0-100 percent
+using IgniterCmd        = Reg<0x21, uint8_t, Endian::Big, Access::WriteOnly>;   // 0/1
+using AugerCmd          = Reg<0x22, uint8_t, Endian::Big, Access::WriteOnly>;   // 0/1
+using DebugCmd          = Reg<0x23, uint8_t, Endian::Big, Access::WriteOnly>;   // toggle
+using SelfTestCmd       = Reg<0x24, uint8_t, Endian::Big, Access::WriteOnly>;   // trigger
+using OvenTempLimitCmd  = Reg<0x25, uint16_t, Endian::Big, Access::WriteOnly>;
+using IgniterTimeCmd    = Reg<0x27, uint16_t, Endian::Big, Access::WriteOnly>;
+using SysTempAlarmCmd   = Reg<0x29, uint8_t, Endian::Big, Access::WriteOnly>;
+using FramingCmd        = Reg<0x2A, uint8_t, Endian::Big, Access::WriteOnly>;   // 0x03 = v3 framing (ms11_frame.h)
+using EnterBootloader   = Reg<0x99, uint8_t, Endian::Big, Access::WriteOnly>;   // BOOTLOADER_MAGIC
+
+constexpr uint8_t BOOTLOADER_MAGIC = 0xB0;
+
+// EventFlags bits - the slave holds its ATTN line low while any are set
+constexpr uint8_t EVENT_STATUS = 0x01;  // Igniter/auger changed without a master command
+constexpr uint8_t EVENT_FAULT  = 0x02;  // Error code in Status changed (overtemp, flame-out, ...)
+constexpr uint8_t EVENT_TEMP   = 0x04;  // Oven/system temperature moved by >= 1 °C
+constexpr uint8_t EVENT_RESET  = 0x80;  // Slave rebooted: outputs and v3 framing are gone
+
+// Whole linear read map in one transaction
+using Snapshot = Burst<OvenTemp, SysTemp, FanSpeed, Status, FwVersion, ProtocolVersion,
+                       DebugMode, FanPercent, MinMasterVersion, DisplayEnabled,
+                       OvenTempLimitLow, OvenTempLimitHigh, IgniterMaxTime, SysTempAlarm>;
+
+// Output readback after a control write (status bits + fan percent)
+using OutputReadback = Burst<Status, FanPercent>;
+
+// Fleet inventory: status and versions of one board (0x07-0x09)
+using Health = Burst<Status, FwVersion, ProtocolVersion>;
+
+static_assert(disjoint<OvenTemp, SysTemp, FanSpeed, Status, FwVersion, ProtocolVersion,
+                       DebugMode, FanPercent, MinMasterVersion, DisplayEnabled,
+                       OvenTempLimitLow, OvenTempLimitHigh, IgniterMaxTime, SysTempAlarm,
+                       EventFlags>(),
+              "MS11 read map has overlapping registers");
+
+static_assert(disjoint<LedOnOff, LedBlink, FanCmd, IgniterCmd, AugerCmd, DebugCmd, SelfTestCmd,
+                       OvenTempLimitCmd, IgniterTimeCmd, SysTempAlarmCmd, FramingCmd,
+                       EnterBootloader>(),
+              "MS11 write map has overlapping registers");
+
+static_assert(Snapshot::first == 0x00 && Snapshot::length == 22, "snapshot must cover 0x00-0x15");
+
+}  // namespace ms11
+
+#endif // MS11_REGISTERS_H
@@ -0,0 +1,182 @@
+#ifndef OVEN_CONTROLLER_H
+#define OVEN_CONTROLLER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "pid_controller.h"
+#include "pid_autotune.h"
+#include "cook_program.h"
+
+// ============================================================================
+// OVEN CONTROLLER (closed-loop oven temperature)
+// ============================================================================
+// Runs OvenControlLaw (pid_controller.h) on its own task every
+// OVEN_CTRL_PERIOD_MS, woken with vTaskDelayUntil so the period does not
+// drift. Each wake-up is timed against the ideal grid (jitter statistics).
+//
+// Input: REG_OVEN_TEMP from the MS11-control - the cached value when the
+// attention line is active (the slave reports changes) and it is at most
+// OVEN_CTRL_CACHE_MAX_AGE_MS old, otherwise a read. The status byte (slave
+// error code) is re-read on the same age limit.
+// Outputs: setAuger()/setFanPercent() on SlaveController. They only update
+// shadow registers; the loop's flushOutputs() sends them.
+//
+// Safety: the oven temperature missing for OVEN_CTRL_MAX_READ_FAILURES
+// ticks, a slave error code, or a reading above OVEN_MAX_TEMP_C puts the
+// controller in FAULT: auger off, fan at OVEN_SHUTDOWN_FAN_PERCENT. Stop
+// does the same. While OFF the controller does not touch the outputs, so
+// manual control from the I2C page keeps working.
+//
+// Autotune: a relay experiment (pid_autotune.h) at the requested setpoint
+// replaces the PID for a few oscillation cycles. Ku/Pu become gains by the
+// chosen rule, are saved, and the loop continues in AUTO at that setpoint
+// from the demand the relay found. If the cycles never agree the old gains
+// stay and the loop continues the same way. Overshooting the setpoint by
+// OVEN_AUTOTUNE_MAX_DEVIATION_C is a fault.
+//
+// Cook programs (cook_program.h) run on this task too: each AUTO tick
+// first evaluates the current stage's triggers, then applies the stage
+// actions (target, fan override, notification) before the PID step. A
+// finished program stops the oven; start(), stop() or a fault end it.
+//
+// Slave updates: the oven cannot start (start, startAutotune, startProgram)
+// while SlaveFlasher is busy, and a flash job for the MS11-control is
+// refused unless the oven is OFF or in FAULT - the board being flashed is
+// the one driving the auger and igniter.
+//
+// Gains and feed-forward persist in NVS ("oven_pid"), with the Ku/Pu of the
+// last autotune; defaults in config.h.
+
+#define OVEN_CTRL_PERIOD_MS            1000
+#define OVEN_CTRL_MAX_READ_FAILURES    5
+#define OVEN_CTRL_CACHE_MAX_AGE_MS     (3 * OVEN_CTRL_PERIOD_MS)  // Older slave readings are read again
+#define OVEN_CTRL_NAMESPACE            "oven_pid"
+#define OVEN_CTRL_TASK_STACK           4096
+#define OVEN_CTRL_TASK_PRIORITY        2      // Above loopTask and the probe task, below the I2C workers
+#define OVEN_CTRL_TASK_CORE            1
+#define OVEN_CTRL_ERROR_LENGTH         64
+#define OVEN_COOK_PROBE_STALE_MS       10000  // Older probe readings do not fire program triggers
+
+class OvenController {
+public:
+  enum Mode : uint8_t {
+    OVEN_OFF = 0,
+    OVEN_AUTO,        // Closed loop on the (ramped) setpoint
+    OVEN_FAULT,       // Stopped by a safety check; start() clears it
+    OVEN_AUTOTUNE     // Relay experiment, then AUTO
+  };
+
+  struct Timing {
+    uint32_t ticks = 0;
+    int32_t lastJitterUs = 0;     // Wake-up minus ideal grid time
+    uint32_t maxJitterUs = 0;     // Largest |jitter|
+    uint32_t meanJitterUs = 0;    // Running mean of |jitter|
+    uint32_t overruns = 0;        // Ticks late by more than a period (grid resynced)
+    uint32_t lastTickUs = 0;      // Time spent in the last tick
+  };
+
+  struct Status {
+    Mode mode = OVEN_OFF;
+    float target = 0.0f;
+    float setpoint = 0.0f;        // Ramped
+    float temperature = 0.0f;     // Last oven reading
+    float demand = 0.0f;          // %
+    bool augerOn = false;
+    uint8_t fanPercent = 0;
+    PidController::Terms terms;
+    uint16_t readFailures = 0;    // Consecutive
+    char error[OVEN_CTRL_ERROR_LENGTH] = "";
+    Timing timing;
+
+    // Last (or running) autotune
+    RelayAutotuner::State tuneState = RelayAutotuner::TUNE_IDLE;
+    AutotuneRule tuneRule = TUNE_TYREUS_LUYBEN;
+    uint8_t tuneCycles = 0;
+    AutotuneResult tuneResult;    // Ku/Pu also restored from NVS
+
+    // Cook program
+    bool programActive = false;
+    char programName[COOK_NAME_LENGTH] = "";
+    uint8_t programStage = 0;
+    uint8_t programStages = 0;
+    char stageName[COOK_STAGE_NAME_LENGTH + 1] = "";
+    uint32_t stageElapsedS = 0;
+    int8_t lastTrigger = -1;      // Trigger that ended the previous stage, -1 = by hand
+    uint8_t fanOverride = COOK_FAN_AUTO;
+    uint16_t notifySeq = 0;       // Bumped by every notification
+    char notifyText[COOK_STAGE_NAME_LENGTH + 1] = "";
+  };
+
+  // Singleton
+  static OvenController& getInstance() {
+    static OvenController instance;
+    return instance;
+  }
+
+  // Load settings and start the control task (mode OFF)
+  bool begin();
+
+  // Close the loop on `target` °C; the ramp starts at the current oven temperature
+  bool start(float target);
+  void stop();
+  bool setTarget(float target);
+  void setRampRate(float degreesPerMinute);
+
+  // Relay autotune at `setpoint`; the derived gains are saved when it completes
+  bool startAutotune(float setpoint, AutotuneRule rule);
+  // Abandon a running autotune and continue in AUTO with the current gains
+  void cancelAutotune();
+
+  // Run a cook program from its first stage (starts the oven if needed).
+  // false while autotuning.
+  bool startProgram(const CookProfile& profile);
+  // End the program; the oven keeps holding the current target
+  void stopProgram();
+  // Skip to the next stage (finishing the program after the last)
+  bool advanceProgram();
+
+  // Gains and feed-forward (°C-based units, see PidGains); `persist` saves to NVS
+  void setGains(const PidGains& gains, float ffPerDegree, bool persist);
+  OvenControlConfig getConfig();
+
+  Status getStatus();
+  static const char* modeName(Mode mode);
+
+private:
+  OvenController() = default;
+  ~OvenController() = default;
+  OvenController(const OvenController&) = delete;
+  OvenController& operator=(const OvenController&) = delete;
+
+  TaskHandle_t task = nullptr;
+  SemaphoreHandle_t lock = nullptr;   // Guards status, law and the requests below
+  OvenControlLaw law;
+  RelayAutotuner tuner;
+  CookEngine cook;
+  Status status;
+  bool startRequested = false;        // Reset the law on the next tick
+  bool saveRequested = false;         // Autotune finished: persist outside the lock
+
+  void loadSettings();
+  void saveSettings();
+  void tick(float dtSeconds);
+  bool readOvenTemperature(float& temperature);
+  bool readSlaveErrorCode(uint8_t& errorCode);
+  void shutdownOutputs();
+  void applyOutputs(const OvenControlLaw::Output& out);
+  void fault(const char* message);
+  void stepAutotune(float temperature, uint32_t nowMs);
+  void resumeAuto(float temperature, uint32_t nowMs, float demand);
+  bool stepProgram(float temperature, uint32_t nowMs);
+  bool handleCookEvent(CookEngine::Event event);
+  void enterCookStage();
+  void endProgram();
+  void notify(const char* text);
+
+  static void controlTask(void* param);
+  static const char* flashGuard(uint8_t target, void* context);
+};
+
+#endif // OVEN_CONTROLLER_H
@@ -0,0 +1,114 @@
+#ifndef PID_AUTOTUNE_H
+#define PID_AUTOTUNE_H
+
+#include <stdint.h>
+#include "pid_controller.h"
+
+// ============================================================================
+// RELAY AUTOTUNE (portable)
+// ============================================================================
+// Relay feedback experiment (Astrom-Hagglund). The demand switches between
+// bias + amplitude and bias - amplitude whenever the oven crosses
+// setpoint -/+ hysteresis, which makes the loop oscillate at its ultimate
+// period Pu. With the oscillation's half peak-to-peak a:
+//
+//   Ku = 4 * amplitude / (pi * sqrt(a^2 - hysteresis^2))
+//
+// A cycle runs from one switch to high to the next. After each one the
+// bias moves to that cycle's mean demand, which evens out the high and low
+// halves (an asymmetric oscillation skews Ku) and ends up as the demand
+// that holds the setpoint. The first `discardCycles` (heat-up, bias still
+// settling) are ignored; the result averages the last `cycles` once their
+// periods and amplitudes agree within `tolerance`.
+//
+// Like pid_controller.h this has no Arduino dependencies, so
+// tools/plant_sim.cpp --autotune runs it against the simulated smoker.
+
+#define AUTOTUNE_MAX_CYCLES_AVERAGED 8
+
+enum AutotuneRule : uint8_t {
+  TUNE_ZIEGLER_NICHOLS = 0,   // Classic PID: fast, overshoots
+  TUNE_TYREUS_LUYBEN          // Detuned for lag-dominant plants: slower, little overshoot
+};
+
+struct AutotuneConfig {
+  float amplitude = 20.0f;        // Relay step either side of the bias, % demand
+  float hysteresis = 1.0f;        // °C, at least the sensor resolution
+  float tolerance = 0.2f;         // Allowed spread of period/amplitude over the averaged cycles
+  uint8_t discardCycles = 1;
+  uint8_t cycles = 3;             // Averaged for the result
+  uint8_t maxCycles = 12;         // Fail if the cycles have not agreed by then
+  uint32_t timeoutMs = 14400000;  // 4 h
+};
+
+struct AutotuneResult {
+  float ku = 0.0f;                // Ultimate gain, % per °C
+  float pu = 0.0f;                // Ultimate period, s
+  float amplitude = 0.0f;         // Oscillation, half peak-to-peak °C
+  float bias = 0.0f;              // Mean demand over the averaged cycles, %
+  uint8_t cycles = 0;
+};
+
+class RelayAutotuner {
+public:
+  enum State : uint8_t {
+    TUNE_IDLE = 0,
+    TUNE_RUNNING,
+    TUNE_DONE,
+    TUNE_FAILED
+  };
+
+  void configure(const AutotuneConfig& config);
+  const AutotuneConfig& getConfig() const { return config; }
+
+  // Start relaying around `setpoint`; `bias` is the first guess of the holding demand
+  void start(float setpoint, float bias, uint32_t nowMs);
+  void cancel() { state = TUNE_IDLE; }
+
+  // Demand (%) for this measurement. Leaves RUNNING for DONE or FAILED by itself.
+  float update(float measurement, uint32_t nowMs);
+
+  State getState() const { return state; }
+  const char* getError() const { return error; }
+  const AutotuneResult& getResult() const { return result; }
+  float getSetpoint() const { return setpoint; }
+  uint8_t getCycleCount() const { return cycleCount; }   // Completed, discarded ones included
+
+  static PidGains gainsFor(const AutotuneResult& result, AutotuneRule rule);
+  static const char* stateName(State state);
+  static const char* ruleName(AutotuneRule rule);
+
+private:
+  struct Cycle {
+    float period;                 // s
+    float peak;
+    float trough;
+    float meanDemand;
+  };
+
+  AutotuneConfig config;
+  State state = TUNE_IDLE;
+  const char* error = "";
+  AutotuneResult result;
+
+  float setpoint = 0.0f;
+  float bias = 0.0f;
+  bool high = true;
+  uint32_t startMs = 0;
+  bool inCycle = false;
+  uint32_t cycleStartMs = 0;
+  uint32_t highMs = 0;            // Time spent high in the current cycle
+  float peak = 0.0f;
+  float trough = 0.0f;
+  uint8_t cycleCount = 0;
+
+  Cycle history[AUTOTUNE_MAX_CYCLES_AVERAGED];
+  uint8_t historyCount = 0;       // Valid entries, newest at historyCount - 1
+
+  float level() const { return high ? bias + config.amplitude : bias - config.amplitude; }
+  void finishCycle(uint32_t nowMs);
+  bool evaluate();
+  void fail(const char* message);
+};
+
+#endif // PID_AUTOTUNE_H
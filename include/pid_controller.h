@@ -0,0 +1,145 @@
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+#include <stdint.h>
+
+// ============================================================================
+// OVEN CONTROL LAW (portable)
+// ============================================================================
+// The arithmetic behind OvenController, kept free of Arduino and FreeRTOS
+// so tools/plant_sim.cpp can run the exact same code against a simulated
+// smoker on the host:
+//
+//   target --SetpointRamp--> setpoint --PidController--> demand 0-100 %
+//          demand --TimeProportioner--> auger on/off   (duty = demand)
+//          demand --linear map--------> fan percent    (fanMin..fanMax)
+//
+// PidController: parallel PID plus feed-forward (bias + gain * setpoint).
+// Derivative acts on the measurement (no kick on setpoint changes) through
+// a first-order filter. Anti-windup by conditional integration: the
+// integral is frozen while the output is held at a limit (clamp or slew)
+// in the direction the error pushes.
+
+struct PidGains {
+  float kp = 0.0f;   // % per °C
+  float ki = 0.0f;   // % per °C·s
+  float kd = 0.0f;   // % per °C/s
+};
+
+class PidController {
+public:
+  struct Terms {
+    float p = 0.0f;
+    float i = 0.0f;
+    float d = 0.0f;
+    float ff = 0.0f;
+    float output = 0.0f;
+    bool limited = false;   // Output held by the clamp or slew limit
+  };
+
+  void setGains(const PidGains& gains) { this->gains = gains; }
+  const PidGains& getGains() const { return gains; }
+  void setFeedForward(float bias, float perDegree) { ffBias = bias; ffPerDegree = perDegree; }
+  void setOutputLimits(float minimum, float maximum) { outMin = minimum; outMax = maximum; }
+  void setSlewRate(float perSecond) { slewPerSecond = perSecond; }        // 0 = off
+  void setDerivativeFilter(float tauSeconds) { derivativeTau = tauSeconds; }
+
+  // Bumpless start: the next update() continues from `output`
+  void reset(float setpoint, float measurement, float output);
+
+  float update(float setpoint, float measurement, float dtSeconds);
+  const Terms& getTerms() const { return terms; }
+
+private:
+  PidGains gains;
+  float ffBias = 0.0f;
+  float ffPerDegree = 0.0f;
+  float outMin = 0.0f;
+  float outMax = 100.0f;
+  float slewPerSecond = 0.0f;
+  float derivativeTau = 0.0f;
+
+  float integral = 0.0f;
+  float lastMeasurement = 0.0f;
+  float derivative = 0.0f;
+  float lastOutput = 0.0f;
+  Terms terms;
+
+  float feedForward(float setpoint) const { return ffBias + ffPerDegree * setpoint; }
+};
+
+// Moves the working setpoint towards the target at a fixed rate
+class SetpointRamp {
+public:
+  void setRate(float degreesPerMinute) { rate = degreesPerMinute; }   // 0 = step
+  void setTarget(float target) { this->target = target; }
+  void reset(float current) { this->current = current; }
+  float update(float dtSeconds);
+  float getCurrent() const { return current; }
+  float getTarget() const { return target; }
+
+private:
+  float rate = 0.0f;
+  float target = 0.0f;
+  float current = 0.0f;
+};
+
+// Slow PWM for the auger: on for duty * window of every window. Pulses
+// shorter than minPulseMs are dropped (or merged into a full window).
+class TimeProportioner {
+public:
+  void configure(uint32_t windowMs, uint32_t minPulseMs);
+  void reset(uint32_t nowMs) { windowStart = nowMs; }
+  bool update(float duty, uint32_t nowMs);
+
+private:
+  uint32_t windowMs = 20000;
+  uint32_t minPulseMs = 1000;
+  uint32_t windowStart = 0;
+};
+
+struct OvenControlConfig {
+  PidGains gains;
+  float ffBias = 0.0f;            // %
+  float ffPerDegree = 0.0f;       // % per °C of setpoint
+  float slewPerSecond = 0.0f;     // Demand change limit, % per second
+  float derivativeTau = 0.0f;     // s
+  float rampPerMinute = 0.0f;     // °C per minute, 0 = step
+  uint32_t augerWindowMs = 20000;
+  uint32_t augerMinPulseMs = 1000;
+  uint8_t fanMin = 0;             // Fan % at zero demand
+  uint8_t fanMax = 100;           // Fan % at full demand
+};
+
+class OvenControlLaw {
+public:
+  struct Output {
+    float setpoint = 0.0f;        // Ramped
+    float demand = 0.0f;          // 0-100 %
+    bool augerOn = false;
+    uint8_t fanPercent = 0;
+    PidController::Terms terms;
+  };
+
+  void configure(const OvenControlConfig& config);
+  const OvenControlConfig& getConfig() const { return config; }
+
+  // Start from the current oven temperature (ramp begins there); `demand`
+  // makes the hand-over bumpless when something else drove the outputs
+  void reset(float measurement, uint32_t nowMs, float demand = 0.0f);
+  void setTarget(float target) { ramp.setTarget(target); }
+  float getTarget() const { return ramp.getTarget(); }
+
+  Output step(float measurement, float dtSeconds, uint32_t nowMs);
+
+  // Map a demand to auger/fan without the PID (relay autotune)
+  Output drive(float demand, uint32_t nowMs);
+
+private:
+  OvenControlConfig config;
+  PidController pid;
+  SetpointRamp ramp;
+  TimeProportioner auger;
+};
+
+#endif // PID_CONTROLLER_H
@@ -0,0 +1,59 @@
+#ifndef PROBE_FILTER_H
+#define PROBE_FILTER_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// PROBE FILTER (per-probe smoothing chain)
+// ============================================================================
+// Applied to every successful, calibrated reading in ProbeManager::readProbe:
+//
+//   median of 5  ->  first-order IIR (EMA)  ->  rate-of-change clamp
+//
+// Each stage can be switched off. All arithmetic is integer: samples are
+// centi-degrees, the EMA state carries 8 extra fraction bits and alpha is
+// Q15 (PROBE_FILTER_ALPHA_ONE = pass-through). The clamp limits the output
+// to maxRate centi-degrees per second of elapsed time.
+//
+// After a gap longer than PROBE_FILTER_GAP_MS (probe unplugged, bus fault)
+// the chain restarts from the next reading instead of slewing towards it.
+
+#define PROBE_FILTER_MEDIAN_WINDOW  5
+#define PROBE_FILTER_ALPHA_ONE      32768
+#define PROBE_FILTER_GAP_MS         10000
+
+struct ProbeFilterConfig {
+  bool median = true;
+  uint16_t alpha = PROBE_FILTER_ALPHA_ONE;  // Q15 EMA weight of the new sample
+  uint16_t maxRate = 0;                     // Centi-degrees per second, 0 = off
+
+  // Conversions for the NVS / probe_cal.txt representation
+  static uint16_t alphaFromFloat(float alpha);
+  static float alphaToFloat(uint16_t alpha) { return alpha / (float)PROBE_FILTER_ALPHA_ONE; }
+};
+
+class ProbeFilter {
+public:
+  void configure(const ProbeFilterConfig& config);
+  const ProbeFilterConfig& getConfig() const { return config; }
+  void reset() { primed = false; }
+
+  // Feed one reading (centi-degrees) taken at nowMs; returns the filtered value
+  int32_t apply(int32_t centi, uint32_t nowMs);
+
+  // Float convenience for ProbeData::temperature
+  float apply(float temperature, uint32_t nowMs);
+
+private:
+  ProbeFilterConfig config;
+  bool primed = false;
+  uint32_t lastMs = 0;
+  int32_t window[PROBE_FILTER_MEDIAN_WINDOW];
+  uint8_t windowPos = 0;
+  int32_t emaQ8 = 0;       // EMA state, centi-degrees << 8
+  int32_t output = 0;      // Last output (clamp reference)
+
+  int32_t median() const;
+};
+
+#endif // PROBE_FILTER_H
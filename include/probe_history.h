@@ -0,0 +1,187 @@
+#ifndef PROBE_HISTORY_H
+#define PROBE_HISTORY_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// ============================================================================
+// PROBE HISTORY (per-probe time series)
+// ============================================================================
+// Three fixed rings per probe, fed once per second by the probe task:
+//
+//   raw   1 s    one value              PROBE_HISTORY_RAW_DEPTH  (10 min)
+//   10s   10 s   min / max / mean       PROBE_HISTORY_10S_DEPTH  (1 h)
+//   1m    60 s   min / max / mean       PROBE_HISTORY_1M_DEPTH   (18 h)
+//
+// Values are centi-degrees (int16). PROBE_HISTORY_NO_DATA marks a second
+// without a healthy, fresh reading, and a rollup period without any.
+//
+// One writer, lock-free readers: the entry is stored first and its sequence
+// number published afterwards with a release store. Sequence numbers keep
+// counting across wraps, so clients page with `since` = the previous `next`.
+// Readers never touch the PROBE_HISTORY_GUARD oldest slots (the writer may
+// be reusing them) and re-check an entry after copying it.
+
+#define PROBE_HISTORY_RAW_DEPTH    600
+#define PROBE_HISTORY_10S_DEPTH    360
+#define PROBE_HISTORY_1M_DEPTH     1080
+#define PROBE_HISTORY_GUARD        4
+#define PROBE_HISTORY_PERIOD_MS    1000
+#define PROBE_HISTORY_STALE_MS     5000     // Older readings are recorded as no data
+#define PROBE_HISTORY_NO_DATA      INT16_MIN
+
+// Binary stream (format=bin): header, then `count` entries, little-endian.
+// Raw entries are one int16, rollups three (min, max, mean).
+#define PROBE_HISTORY_MAGIC        "PHIS"
+#define PROBE_HISTORY_VERSION      1
+
+enum ProbeHistoryTier : uint8_t {
+  HISTORY_TIER_RAW = 0,
+  HISTORY_TIER_10S,
+  HISTORY_TIER_1M,
+  HISTORY_TIER_COUNT
+};
+
+struct __attribute__((packed)) HistoryRollup {
+  int16_t min;
+  int16_t max;
+  int16_t mean;
+};
+
+struct __attribute__((packed)) ProbeHistoryHeader {
+  char magic[4];
+  uint8_t version;
+  uint8_t probe;
+  uint8_t tier;
+  uint8_t entrySize;
+  uint32_t periodMs;
+  uint32_t first;      // Sequence number of the first entry
+  uint32_t count;
+  uint32_t lastMs;     // millis() when the newest entry of the tier was written
+};
+
+static_assert(sizeof(ProbeHistoryHeader) == 24, "ProbeHistoryHeader layout changed");
+
+// Single-producer ring addressed by a free-running sequence number
+template <typename T, uint16_t N>
+class HistoryRing {
+public:
+  void clear() {
+    head.store(0, std::memory_order_release);
+    lastMs.store(0, std::memory_order_relaxed);
+  }
+
+  void push(const T& value, uint32_t nowMs) {
+    uint32_t seq = head.load(std::memory_order_relaxed);
+    slots[seq % N] = value;
+    lastMs.store(nowMs, std::memory_order_relaxed);
+    head.store(seq + 1, std::memory_order_release);
+  }
+
+  // Sequence number the next entry will get
+  uint32_t next() const { return head.load(std::memory_order_acquire); }
+
+  // Oldest sequence number that is safe to read
+  uint32_t oldest() const {
+    uint32_t n = next();
+    return n > N - PROBE_HISTORY_GUARD ? n - (N - PROBE_HISTORY_GUARD) : 0;
+  }
+
+  uint32_t lastSampleMs() const { return lastMs.load(std::memory_order_relaxed); }
+
+  // False if the entry does not exist yet or was overwritten while copying
+  bool read(uint32_t seq, T& out) const {
+    if (seq >= next()) {
+      return false;
+    }
+    out = slots[seq % N];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq >= oldest();
+  }
+
+private:
+  T slots[N];
+  std::atomic<uint32_t> head{0};
+  std::atomic<uint32_t> lastMs{0};
+};
+
+class ProbeHistory {
+public:
+  struct Window {
+    uint32_t first = 0;   // First sequence number to return
+    uint32_t next = 0;    // One past the newest entry (the next `since`)
+    uint32_t lastMs = 0;
+  };
+
+  // Writer (probe task only)
+  void record(bool valid, float temperature, uint32_t nowMs);
+  void reset();
+
+  // Readers (any task)
+  Window window(ProbeHistoryTier tier, uint32_t since) const;
+  bool readRaw(uint32_t seq, int16_t& value) const { return raw.read(seq, value); }
+  bool readRollup(ProbeHistoryTier tier, uint32_t seq, HistoryRollup& rollup) const;
+
+  static uint32_t periodMs(ProbeHistoryTier tier);
+  static const char* tierName(ProbeHistoryTier tier);
+  static bool parseTier(const String& name, ProbeHistoryTier& tier);
+
+private:
+  // Rollup of the raw seconds since the last emit (writer only)
+  struct Accumulator {
+    int16_t min = 0;
+    int16_t max = 0;
+    int32_t sum = 0;
+    uint16_t count = 0;    // Seconds with data
+    uint16_t seconds = 0;
+
+    void add(int16_t value);
+    HistoryRollup take();
+  };
+
+  HistoryRing<int16_t, PROBE_HISTORY_RAW_DEPTH> raw;
+  HistoryRing<HistoryRollup, PROBE_HISTORY_10S_DEPTH> tenSeconds;
+  HistoryRing<HistoryRollup, PROBE_HISTORY_1M_DEPTH> minutes;
+  Accumulator tenSecondAcc;
+  Accumulator minuteAcc;
+};
+
+// ============================================================================
+// Streaming reader (/api/probes/history)
+// ============================================================================
+// Copies one window of a tier straight from the ring into the response
+// buffer, one entry at a time, as JSON or the binary layout above. The
+// window is fixed when the stream is created; an entry overwritten before
+// the client got to it is sent as no data.
+
+class ProbeHistoryStream {
+public:
+  ProbeHistoryStream(const ProbeHistory& history, uint8_t probe, ProbeHistoryTier tier,
+                     uint32_t since, bool binary);
+
+  // Fill `buffer` with up to `maxLen` bytes; 0 once everything was sent
+  size_t fill(uint8_t* buffer, size_t maxLen);
+
+  // Total size of a binary stream (known up front)
+  size_t binaryLength() const;
+
+private:
+  enum Phase : uint8_t { PHASE_HEADER, PHASE_ENTRIES, PHASE_FOOTER, PHASE_DONE };
+
+  const ProbeHistory& history;
+  uint8_t probe;
+  ProbeHistoryTier tier;
+  bool binary;
+  ProbeHistory::Window window;
+  uint32_t seq;
+  Phase phase = PHASE_HEADER;
+
+  char pending[160];      // Current piece (header, one entry or footer)
+  size_t pendingLen = 0;
+  size_t pendingPos = 0;
+
+  bool produce();
+  size_t entrySize() const;
+};
+
+#endif // PROBE_HISTORY_H
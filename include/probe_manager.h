@@ -2,8 +2,13 @@
 #define PROBE_MANAGER_H
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 #include "config.h"
 #include "i2c_manager.h"
+#include "probe_history.h"
+#include "probe_filter.h"
 
 /**
  * Probe Manager - Consolidated Temperature Measurement System
@@ -21,11 +26,55 @@
  * Features:
  * - Non-blocking temperature reads from all available sources
  * - Per-probe calibration support (offset/scale factors)
+ * - Per-probe filter chain (median / EMA / rate clamp, see probe_filter.h)
  * - Error handling and sensor health checks
  * - Last valid value caching for failed reads
  * - Timestamp tracking for data freshness
  */
 
+// ============================================================================
+// ADS1110 ACQUISITION
+// ============================================================================
+// Each ADS1110 runs in continuous-conversion mode; the "probe_task" task
+// visits one converter per PROBE_ADS1110_SLOT_MS (round robin) and reads
+// the 3-byte burst: output code (big-endian) followed by the config
+// register. ST/DRDY = 0 marks a conversion not read before, so a stale
+// result is never consumed twice. A config byte that no longer matches
+// (brown-out, hot-plug) makes the task rewrite the configuration.
+//
+// Codes are normalised to 16 bits and linearised through a thermistor
+// table built once in begin() (PROBE_NTC_* in config.h); each sample is
+// a table lookup plus linear interpolation.
+//
+// The same task records every probe into its ProbeHistory once per
+// PROBE_HISTORY_PERIOD_MS (see probe_history.h).
+
+// Config register (write: SC, DR, PGA; ST starts a single-shot conversion)
+#define ADS1110_CFG_ST_DRDY       0x80
+#define ADS1110_CFG_SC_SINGLE     0x10   // 0 = continuous conversion
+#define ADS1110_CFG_DR_MASK       0x0C
+#define ADS1110_CFG_DR_240SPS     0x00   // 12-bit
+#define ADS1110_CFG_DR_60SPS      0x04   // 14-bit
+#define ADS1110_CFG_DR_30SPS      0x08   // 15-bit
+#define ADS1110_CFG_DR_15SPS      0x0C   // 16-bit
+#define ADS1110_CFG_PGA_MASK      0x03
+#define ADS1110_CFG_PGA_1         0x00
+#define ADS1110_CFG_WRITE_MASK    (ADS1110_CFG_SC_SINGLE | ADS1110_CFG_DR_MASK | ADS1110_CFG_PGA_MASK)
+
+#define PROBE_ADS1110_DATA_RATE   ADS1110_CFG_DR_240SPS
+#define PROBE_ADS1110_CONFIG      (PROBE_ADS1110_DATA_RATE | ADS1110_CFG_PGA_1)
+#define PROBE_ADS1110_MAX         4      // 0x48-0x4B
+#define PROBE_ADS1110_SLOT_MS     25     // One converter per slot: 4 probes -> 10 Hz each
+#define PROBE_ADS1110_STALE_MS    2000   // No fresh conversion for this long -> unhealthy
+#define PROBE_ADS1110_OPEN_CODE   64     // Normalised code below this: probe unplugged
+#define PROBE_ADS1110_SHORT_CODE  32704  // Normalised code above this: input clipped/shorted
+
+#define PROBE_NTC_LUT_SIZE        129    // Entries over the 16-bit code range (step 256)
+
+#define PROBE_TASK_STACK          3072
+#define PROBE_TASK_PRIORITY       1
+#define PROBE_TASK_CORE           1
+
 // Probe type enumeration
 enum class ProbeType {
   UNKNOWN = 0,
@@ -39,7 +88,8 @@ struct ProbeData {
   ProbeType type;
   uint8_t i2c_address;
   uint8_t bus_number;
-  float temperature;        // Last read temperature (°C)
+  float temperature;        // Last read temperature (°C), calibrated and filtered
+  float raw_temperature;    // Same reading before the filter chain
   float humidity;           // Humidity (if sensor supports, else 0)
   uint32_t last_read_ms;    // Last successful read timestamp
   bool initialized;
@@ -84,6 +134,10 @@ public:
   bool setProbeCalibration(uint8_t index, float offset, float scale);
   bool getProbeCalibration(uint8_t index, float& offset, float& scale);
 
+  // Per-probe filter chain (persisted with the calibration)
+  bool setProbeFilter(uint8_t index, const ProbeFilterConfig& config);
+  bool getProbeFilter(uint8_t index, ProbeFilterConfig& config);
+
   // Calibration persistence (NVS + LittleFS)
   bool initializeCalibrationFromNVS();    // Load calibration from NVS; if empty, save defaults
   bool syncCalibrationFromLittleFS();     // Load probe_cal.txt and sync NVS if update_nvs=1
@@ -99,6 +153,24 @@ public:
   // Debug/monitoring
   void printProbeStatus();                 // Serial output of all probes and readings
 
+  // ADS1110 sampler counters (per converter)
+  struct AdcStats {
+    uint8_t address = 0;
+    int16_t code = 0;          // Last fresh output code (raw, data-rate resolution)
+    uint32_t samples = 0;      // Fresh conversions consumed
+    uint32_t notReady = 0;     // Bursts with ST/DRDY still set
+    uint32_t errors = 0;       // Failed bus transfers
+    uint32_t reconfigured = 0; // Config rewrites after a mismatch
+    uint32_t lastSampleMs = 0;
+  };
+  uint8_t getAdcStats(AdcStats* out, uint8_t max);
+
+  // Time series of a probe (nullptr if out of range or not allocated)
+  const ProbeHistory* getHistory(uint8_t index) const;
+
+  // Thermistor table lookup: 16-bit normalised code -> °C (uncalibrated)
+  float linearize(int32_t code) const;
+
 private:
   ProbeManager();  // Private constructor
   ~ProbeManager();
@@ -113,6 +185,13 @@ private:
   bool initializeMS11ControlTemp();
 
   bool readADS1110(ProbeData& probe);
+  bool configureADS1110(uint8_t address);
+  void sampleADS1110(uint8_t channel);
+  void buildThermistorTable();
+  void recordHistory();
+  bool startProbeTask();
+  void stopProbeTask();
+  static void probeTask(void* param);
   bool readAHT10(ProbeData& probe);
   bool readMS11ControlTemp(ProbeData& probe);
 
@@ -125,6 +204,25 @@ private:
   ProbeData probes[MAX_PROBES];
   uint8_t probe_count = 0;
 
+  ProbeFilter filters[MAX_PROBES];
+
+  // History rings, allocated once per detected probe and kept across rescans
+  ProbeHistory* history[MAX_PROBES] = {};
+
+  // ADS1110 sampler state (written by the probe task, guarded by adc_lock)
+  struct AdcChannel {
+    uint8_t address = 0;
+    bool configured = false;
+    float temperature = 0.0f;  // Linearised, before calibration
+    AdcStats stats;
+  };
+  AdcChannel adc[PROBE_ADS1110_MAX];
+  uint8_t adc_count = 0;
+  TaskHandle_t probe_task = nullptr;
+  SemaphoreHandle_t adc_lock = nullptr;
+  volatile bool probe_task_stop = false;
+  float ntc_table[PROBE_NTC_LUT_SIZE];
+
   // I2C addresses and buses
   static constexpr uint8_t ADC_ADDRESS_BASE = 0x48;  // 0x48-0x4B possible
   static constexpr uint8_t TEMP_SENSOR_ADDRESS = 0x38;
@@ -3,53 +3,68 @@
 
 #include <Arduino.h>
 #include "i2c_manager.h"
+#include "ms11_registers.h"
+#include "ms11_frame.h"
 
 // ============================================================================
 // MS11 SLAVE CONTROLLER (ATmega328P @ 0x30)
-// I2C Protocol v2 - Register Map
+// I2C Protocol v2 - Register Map (typed descriptors in ms11_registers.h)
+// I2C Protocol v3 - v2 + CRC-8 / sequence framing (ms11_frame.h), negotiated
 // ============================================================================
 
-#define SLAVE_I2C_ADDR 0x30
-
-// Read Registers (Master → Slave)
-#define REG_OVEN_TEMP_H      0x00  // int16_t high byte
-#define REG_OVEN_TEMP_L      0x01  // int16_t low byte
-#define REG_SYS_TEMP_H       0x02  // int16_t high byte
-#define REG_SYS_TEMP_L       0x03  // int16_t low byte
-#define REG_FAN_SPEED        0x06  // uint8_t PWM (0-39)
-#define REG_STATUS           0x07  // uint8_t status byte
-#define REG_FW_VERSION       0x08  // uint8_t BCD (0x61 = v0.6.1)
-#define REG_PROTOCOL_VER     0x09  // uint8_t (0x02 = v2)
-#define REG_DEBUG_MODE       0x0A  // uint8_t (0/1)
-#define REG_FAN_PERCENT      0x0B  // uint8_t (0-100)
-#define REG_GET_VERSION_FULL 0x0C  // 4 bytes: major(16) minor(8) patch+build(8)
-#define REG_MIN_MASTER_VER   0x0D  // uint8_t (0x10 = v1.0)
-#define REG_DISPLAY_ENABLED  0x0E  // uint8_t (0/1)
-
-// Configuration Registers
-#define REG_OVEN_TEMP_LIMIT_L_H  0x0F  // uint16_t low byte
-#define REG_OVEN_TEMP_LIMIT_L_L  0x10  // uint16_t low byte
-#define REG_OVEN_TEMP_LIMIT_H_H  0x11  // uint16_t high byte
-#define REG_OVEN_TEMP_LIMIT_H_L  0x12  // uint16_t low byte
-#define REG_IGNITER_MAX_TIME_H   0x13  // uint16_t high byte
-#define REG_IGNITER_MAX_TIME_L   0x14  // uint16_t low byte
-#define REG_SYS_TEMP_ALARM       0x15  // uint8_t threshold (°C)
-
-// Write Registers (Master ← Slave)
-#define REG_FAN_CMD          0x20  // uint8_t (0-100 percent)
-#define REG_IGNITER_CMD      0x21  // uint8_t (0=off, 1=on)
-#define REG_AUGER_CMD        0x22  // uint8_t (0=off, 1=on)
-#define REG_DEBUG_CMD        0x23  // uint8_t toggle
-#define REG_SELFTEST_CMD     0x24  // uint8_t trigger
-#define REG_OVEN_TEMP_CMD_H  0x25  // Config write
-#define REG_OVEN_TEMP_CMD_L  0x26
-#define REG_IGNITER_CMD_H    0x27
-#define REG_IGNITER_CMD_L    0x28
-#define REG_SYS_TEMP_ALARM_CMD 0x29
-
-// LED control registers (I2C test mode)
-#define SLAVE_REG_LED_ONOFF  0x10  // 0=off, 1=on
-#define SLAVE_REG_LED_BLINK  0x11  // 0=off, 1=1Hz, 2=4Hz
+#define SLAVE_I2C_ADDR ms11::SLAVE_ADDRESS
+
+// Byte addresses derived from the descriptors (legacy names)
+// Read space
+#define REG_OVEN_TEMP_H      ms11::OvenTemp::address
+#define REG_OVEN_TEMP_L      ms11::OvenTemp::last
+#define REG_SYS_TEMP_H       ms11::SysTemp::address
+#define REG_SYS_TEMP_L       ms11::SysTemp::last
+#define REG_FAN_SPEED        ms11::FanSpeed::address
+#define REG_STATUS           ms11::Status::address
+#define REG_FW_VERSION       ms11::FwVersion::address
+#define REG_PROTOCOL_VER     ms11::ProtocolVersion::address
+#define REG_DEBUG_MODE       ms11::DebugMode::address
+#define REG_FAN_PERCENT      ms11::FanPercent::address
+#define REG_GET_VERSION_FULL ms11::VersionFull::address
+#define REG_MIN_MASTER_VER   ms11::MinMasterVersion::address
+#define REG_DISPLAY_ENABLED  ms11::DisplayEnabled::address
+#define REG_OVEN_TEMP_LIMIT_L_H  ms11::OvenTempLimitLow::address
+#define REG_OVEN_TEMP_LIMIT_L_L  ms11::OvenTempLimitLow::last
+#define REG_OVEN_TEMP_LIMIT_H_H  ms11::OvenTempLimitHigh::address
+#define REG_OVEN_TEMP_LIMIT_H_L  ms11::OvenTempLimitHigh::last
+#define REG_IGNITER_MAX_TIME_H   ms11::IgniterMaxTime::address
+#define REG_IGNITER_MAX_TIME_L   ms11::IgniterMaxTime::last
+#define REG_SYS_TEMP_ALARM       ms11::SysTempAlarm::address
+
+// Snapshot burst: whole read map 0x00-0x15 in one transaction
+#define SLAVE_SNAPSHOT_FIRST_REG ms11::Snapshot::first
+#define SLAVE_SNAPSHOT_LENGTH    ms11::Snapshot::length  // 22 bytes
+
+// Write space
+#define REG_FAN_CMD          ms11::FanCmd::address
+#define REG_IGNITER_CMD      ms11::IgniterCmd::address
+#define REG_AUGER_CMD        ms11::AugerCmd::address
+#define REG_DEBUG_CMD        ms11::DebugCmd::address
+#define REG_SELFTEST_CMD     ms11::SelfTestCmd::address
+#define REG_OVEN_TEMP_CMD_H  ms11::OvenTempLimitCmd::address
+#define REG_OVEN_TEMP_CMD_L  ms11::OvenTempLimitCmd::last
+#define REG_IGNITER_CMD_H    ms11::IgniterTimeCmd::address
+#define REG_IGNITER_CMD_L    ms11::IgniterTimeCmd::last
+#define REG_SYS_TEMP_ALARM_CMD ms11::SysTempAlarmCmd::address
+
+// LED control registers (write space, I2C test mode)
+#define SLAVE_REG_LED_ONOFF  ms11::LedOnOff::address
+#define SLAVE_REG_LED_BLINK  ms11::LedBlink::address
+
+// Control output shadowing
+#define SLAVE_OUTPUT_MAX_RESENDS  3    // Mark an output rejected after this many failed readbacks
+#define SLAVE_OUTPUT_RETRY_MS     250  // Back-off after a failed flush
+#define SLAVE_OUTPUT_REJECT_BACKOFF_MS      5000   // First retry of a rejected output
+#define SLAVE_OUTPUT_REJECT_BACKOFF_MAX_MS  60000  // Doubles per rejection up to this
+
+// Protocol v3 framing
+#define SLAVE_FRAME_RETRIES       3    // Re-sends after a CRC/sequence error or NACK
 
 // Status byte bits
 #define STATUS_IGNITER_BIT   0x01
@@ -71,6 +86,28 @@ struct SlaveVersion {
   }
 };
 
+// Register snapshot (0x00-0x15) decoded from a single burst read.
+// All fields come from the same I2C transaction, so multi-byte values
+// can never mix bytes from different ADC conversions.
+struct SlaveSnapshot {
+  uint32_t sequence;         // Incremented on every successful snapshot (0 = never read)
+  uint32_t timestamp_ms;     // millis() when the burst completed
+  int16_t ovenTemp;          // REG_OVEN_TEMP_H/L (big-endian)
+  int16_t sysTemp;           // REG_SYS_TEMP_H/L (big-endian, DS18B20 Q8.8)
+  uint8_t fanPwm;            // REG_FAN_SPEED (0-39)
+  uint8_t status;            // REG_STATUS
+  uint8_t fwVersion;         // REG_FW_VERSION (BCD)
+  uint8_t protocolVersion;   // REG_PROTOCOL_VER
+  uint8_t debugMode;         // REG_DEBUG_MODE
+  uint8_t fanPercent;        // REG_FAN_PERCENT (0-100)
+  uint8_t minMasterVersion;  // REG_MIN_MASTER_VER
+  uint8_t displayEnabled;    // REG_DISPLAY_ENABLED
+  uint16_t ovenTempLimitLow; // REG_OVEN_TEMP_LIMIT_L_H/L
+  uint16_t ovenTempLimitHigh;// REG_OVEN_TEMP_LIMIT_H_H/L
+  uint16_t igniterMaxTime;   // REG_IGNITER_MAX_TIME_H/L
+  uint8_t sysTempAlarm;      // REG_SYS_TEMP_ALARM (°C)
+};
+
 class SlaveController {
 public:
   // Singleton
@@ -81,6 +118,16 @@ public:
 
   // Initialize I2C communication
   bool begin();
+  
+  // Read the protocol version and switch to v3 framing if the slave has it
+  // (falls back to v2). Also invalidates outputs - call after a slave reset.
+  bool negotiateProtocol();
+  
+  // True while v3 framing is active
+  bool isFramed() const { return framed; }
+  
+  // Renegotiate before the next output flush, on the slave bus worker (safe from any task)
+  void requestRenegotiation() { renegotiatePending = true; }
 
   // ========================================================================
   // Temperature Reading (Critical)
@@ -92,9 +139,76 @@ public:
   // Read system temperature (°C) - cached reading
   bool readSystemTemp(int16_t& temp_c);
   
-  // Force immediate refresh from slave
+  // Last system temperature read from the slave, no bus access (false if none yet)
+  bool getCachedSystemTemp(int16_t& temp_c);
+  
+  // Last oven temperature read from the slave, no bus access (false if none
+  // yet or older than maxAgeMs)
+  bool getCachedOvenTemp(int16_t& temp_c, uint32_t maxAgeMs);
+  
+  // Force immediate refresh from slave (one snapshot burst)
   bool refreshTemperatures();
 
+  // Read the full register map (0x00-0x15) in a single burst
+  bool readSnapshot(SlaveSnapshot& snapshot);
+  
+  // Last successful snapshot (sequence == 0 if none yet)
+  SlaveSnapshot getSnapshot();
+
+  // ========================================================================
+  // Typed Register Access (ms11_registers.h)
+  // ========================================================================
+  
+  // Read one register, decoded with its declared width and byte order
+  template <typename R>
+  bool readReg(typename R::value_type& value);
+  
+  // Read-to-clear EventFlags in exactly one transaction: a retry would read
+  // 0 and lose the events. frameError is set when the slave answered but the
+  // frame did not verify (the flags may already be cleared).
+  bool readEventFlags(uint8_t& flags, bool& frameError);
+  
+  // Write one register (multi-byte values go out in a single transaction)
+  template <typename R>
+  bool writeReg(typename R::value_type value);
+  
+  // Read a burst span; decode fields with B::template get<R>(buffer)
+  template <typename B>
+  bool readBurst(uint8_t (&buffer)[B::length]);
+
+  // ========================================================================
+  // Control Outputs (shadow registers)
+  // ========================================================================
+  // setFanPercent/setIgniter/setAuger/setLed only record the desired value.
+  // flushOutputs() sends whatever differs from the slave-confirmed value:
+  // fan/igniter/auger (0x20-0x22) as one multi-byte write, LED on its own,
+  // followed by a status/fan readback that confirms the outputs. Writes are
+  // queued on the slave bus worker, so the caller never blocks on Wire1.
+  
+  // Send dirty outputs (call once per control tick)
+  bool flushOutputs();
+  
+  // Forget confirmed state so the next flush re-sends every commanded output
+  // (after a reconnect the slave may have reset its outputs)
+  void invalidateOutputs();
+  
+  // Re-send and read back every commanded output on the next flush, keeping
+  // the back-off of rejected ones (heartbeat: catches outputs the slave
+  // changed on its own)
+  void reconfirmOutputs();
+  
+  // Outputs the slave kept rejecting (bit 0 fan, 1 igniter, 2 auger). They
+  // are retried with back-off; a bit clears once a readback confirms it.
+  uint8_t getRejectedOutputs() const { return rejectedOutputs; }
+  
+  struct OutputStats {
+    uint32_t flushes = 0;      // Flushes that queued at least one write
+    uint32_t suppressed = 0;   // Set calls that matched the confirmed value
+    uint32_t mismatches = 0;   // Readback differed from the written value
+    uint32_t rejections = 0;   // Outputs marked rejected after SLAVE_OUTPUT_MAX_RESENDS
+  };
+  OutputStats getOutputStats();
+
   // ========================================================================
   // Fan Control
   // ========================================================================
@@ -128,13 +242,17 @@ public:
   // Read status byte (bit 0=igniter, bit 1=auger, bits 4-7=error code)
   bool readStatus(uint8_t& statusByte);
   
+  // Last status byte read from the slave, no bus access (false if none yet
+  // or older than maxAgeMs)
+  bool getCachedStatus(uint8_t& statusByte, uint32_t maxAgeMs);
+
   // Get error code from status (bits 4-7)
   uint8_t getErrorCode();
   
   // Get firmware version (BCD format)
   uint8_t getFirmwareVersion();
   
-  // Get protocol version (should be 0x02)
+  // Get protocol version (0x02, or 0x03 when framing capable)
   uint8_t getProtocolVersion();
   
   // Read full firmware version (4-byte format: YYYY.M.m.pp)
@@ -143,6 +261,9 @@ public:
   // Get cached full version string
   String getFullVersionString();
   
+  // Decode the REG_GET_VERSION_FULL block
+  static SlaveVersion decodeVersion(uint32_t raw);
+  
   // Quick ping (connection test)
   bool ping();
   
@@ -157,11 +278,11 @@ public:
   bool runSelfTest();
   
   // Direct LED control via I2C
-  bool setLed(bool on);  // Turn LED on/off
+  bool setLed(bool on);  // Turn LED on/off (shadowed, sent by flushOutputs)
   bool pulseLed(uint16_t durationMs);  // Start a non-blocking pulse
   
   // Get last error message
-  String getLastError() { return lastError; }
+  String getLastError();
   
   // Get connection statistics
   struct Stats {
@@ -171,8 +292,17 @@ public:
     uint32_t failedWrites = 0;
   };
   
-  Stats getStats() { return stats; }
+  Stats getStats();
   void resetStats();
+  
+  // Protocol v3 frame errors
+  struct FrameStats {
+    uint32_t crcErrors = 0;        // Response PEC mismatch
+    uint32_t sequenceErrors = 0;   // Response echoed the wrong sequence number
+    uint32_t retries = 0;          // Frames re-sent after an error
+    uint32_t renegotiations = 0;   // Framing lost (slave reset) and renegotiated
+  };
+  FrameStats getFrameStats();
 
 private:
   SlaveController() = default;
@@ -182,6 +312,24 @@ private:
   SlaveController(const SlaveController&) = delete;
   SlaveController& operator=(const SlaveController&) = delete;
 
+  // Synchronous transfers run from the loop, the oven task and the event
+  // task. transferLock (recursive) serialises them together with lastError,
+  // the read caches and the framing state. Bus worker callbacks never take
+  // it; they and the counters use shadowMux.
+  SemaphoreHandle_t transferLock = nullptr;
+  
+  class TransferGuard {
+  public:
+    explicit TransferGuard(SemaphoreHandle_t lock) : lock(lock) {
+      if (lock) xSemaphoreTakeRecursive(lock, portMAX_DELAY);  // nullptr before begin()
+    }
+    ~TransferGuard() {
+      if (lock) xSemaphoreGiveRecursive(lock);
+    }
+  private:
+    SemaphoreHandle_t lock;
+  };
+  
   // State
   String lastError;
   uint8_t lastStatus = 0;
@@ -195,14 +343,97 @@ private:
   // Cached temperature readings
   int16_t cachedOvenTemp = 0;
   int16_t cachedSystemTemp = 0;
+  bool systemTempValid = false;
   unsigned long lastTempReadTime = 0;
+  unsigned long lastStatusReadTime = 0;
+  
+  // Last burst snapshot
+  SlaveSnapshot lastSnapshot = {};
+  
+  // Shadow registers for control outputs
+  enum OutputIndex : uint8_t { OUT_FAN = 0, OUT_IGNITER, OUT_AUGER, OUT_LED, OUT_COUNT };
+  struct ShadowRegister {
+    uint8_t desired = 0;
+    uint8_t confirmed = 0;
+    bool desiredValid = false;    // Master has commanded this output
+    bool confirmedValid = false;  // Slave acknowledged `confirmed`
+    uint8_t resends = 0;          // Consecutive readback mismatches
+    uint32_t rejectedAt = 0;      // When resends reached SLAVE_OUTPUT_MAX_RESENDS
+    uint32_t backoffMs = 0;       // Wait before retrying a rejected output (0 = none)
+  };
+  ShadowRegister shadow[OUT_COUNT];
+  portMUX_TYPE shadowMux = portMUX_INITIALIZER_UNLOCKED;
+  uint8_t sentValues[OUT_COUNT] = {0};
+  uint8_t sentFirst = 0;             // Control span in flight (OUT_FAN..OUT_AUGER)
+  uint8_t sentLast = 0;
+  volatile uint8_t flushPending = 0; // Queued transactions of the current flush
+  volatile uint8_t rejectedOutputs = 0;
+  volatile bool controlWriteOk = false;
+  uint32_t flushRetryAt = 0;
+  bool readbackFramed = false;
+  uint8_t readbackSequence = 0;
+  uint8_t readbackFrameErrors = 0;   // Consecutive bad framed readbacks
+  uint8_t readbackBuffer[ms11::OutputReadback::length + ms11::FRAME_READ_OVERHEAD];
+  OutputStats outputStats;
+  
+  // Protocol v3 framing
+  volatile bool framed = false;
+  volatile bool renegotiatePending = false;  // Set on persistent frame errors
+  uint8_t sequence = 0;                      // Last sequence number handed out
+  FrameStats frameStats;
   
   // Statistics
   Stats stats;
   
   // Helpers
-  bool readRegisterInt16(uint8_t regHigh, uint8_t regLow, int16_t& value);
-  bool writeRegisterInt16(uint8_t regHigh, uint8_t regLow, int16_t value);
+  uint8_t takeSequence();
+  void count(uint32_t& counter);
+  bool transferRead(uint8_t reg, uint8_t* buffer, uint8_t length);
+  bool transferWrite(uint8_t reg, const uint8_t* data, uint8_t length);
+  uint8_t encodeWrite(uint8_t reg, const uint8_t* data, uint8_t length, uint8_t* out);
+  void setOutput(OutputIndex index, uint8_t value);
+  bool isDirty(const ShadowRegister& reg) const;
+  void countResend(OutputIndex index, uint32_t now);
+  bool submitTracked(const I2CTransaction& txn);
+  void onFlushFailed();
+  static void onControlWriteComplete(const I2CTransaction& txn, I2CErrorCode result, void* context);
+  static void onReadbackComplete(const I2CTransaction& txn, I2CErrorCode result, void* context);
+  static void onLedWriteComplete(const I2CTransaction& txn, I2CErrorCode result, void* context);
+  static void onRenegotiateProbe(const I2CTransaction& txn, I2CErrorCode result, void* context);
 };
 
+// ============================================================================
+// Typed register access (templates)
+// ============================================================================
+
+template <typename R>
+bool SlaveController::readReg(typename R::value_type& value) {
+  static_assert(R::readable, "register is write-only");
+  uint8_t buffer[R::size];
+  if (!transferRead(R::address, buffer, R::size)) {
+    return false;
+  }
+  value = R::decode(buffer);
+  return true;
+}
+
+template <typename R>
+bool SlaveController::writeReg(typename R::value_type value) {
+  static_assert(R::writable, "register is read-only");
+  uint8_t data[R::size];
+  R::encode(value, data);
+
+  if (!transferWrite(R::address, data, R::size)) {
+    count(stats.failedWrites);
+    return false;
+  }
+  count(stats.successfulWrites);
+  return true;
+}
+
+template <typename B>
+bool SlaveController::readBurst(uint8_t (&buffer)[B::length]) {
+  return transferRead(B::first, buffer, B::length);
+}
+
 #endif // SLAVE_CONTROLLER_H
@@ -0,0 +1,78 @@
+#ifndef SLAVE_EVENTS_H
+#define SLAVE_EVENTS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "config.h"
+
+// ============================================================================
+// SLAVE EVENT MONITOR (ATmega ATTN line)
+// ============================================================================
+// The ATmega pulls SLAVE_ATTN_PIN low while ms11::EventFlags is non-zero.
+// A falling edge wakes the service task from the ISR; the task reads the
+// (read-to-clear) flags and then only the registers they name: Status for
+// STATUS/FAULT, the two temperatures for TEMP. A RESET flag schedules a
+// protocol renegotiation. No I2C traffic is generated while the line is idle.
+//
+// With SLAVE_ATTN_PIN = -1 begin() returns false and the main loop keeps its
+// 2 s heartbeat polling. Under -D I2C_SIM_BUS the simulated ATmega drives a
+// virtual line instead of a GPIO.
+
+#define SLAVE_EVENT_TASK_STACK      3072
+#define SLAVE_EVENT_TASK_PRIORITY   4      // Above the I2C workers (3): fault latency first
+#define SLAVE_EVENT_TASK_CORE       1
+#define SLAVE_EVENT_LEVEL_CHECK_MS  100    // Re-check the line level (covers a missed edge)
+#define SLAVE_EVENT_HEARTBEAT_MS    30000  // Heartbeat ping interval while the line is in use
+
+class SlaveEventMonitor {
+public:
+  // Singleton
+  static SlaveEventMonitor& getInstance() {
+    static SlaveEventMonitor instance;
+    return instance;
+  }
+
+  // Attach the ISR and start the service task (false = no line, keep polling)
+  bool begin();
+  void end();
+
+  // True when slave events arrive via the attention line
+  bool isActive() const { return task != nullptr; }
+
+  // Wake the service task from task context (simulated line, manual trigger)
+  void notify();
+
+  struct Stats {
+    uint32_t events = 0;         // EventFlags reads with at least one bit set
+    uint32_t spurious = 0;       // Line asserted but no flag set
+    uint32_t readErrors = 0;     // EventFlags read failed
+    uint32_t resyncs = 0;        // Flags lost to a frame error, state read from a snapshot
+    uint32_t faults = 0;
+    uint32_t resets = 0;
+    uint32_t lastLatencyUs = 0;  // Line asserted -> registers read
+    uint32_t maxLatencyUs = 0;
+    uint8_t lastFlags = 0;
+  };
+  Stats getStats() { return stats; }
+
+private:
+  SlaveEventMonitor() = default;
+  ~SlaveEventMonitor() = default;
+  SlaveEventMonitor(const SlaveEventMonitor&) = delete;
+  SlaveEventMonitor& operator=(const SlaveEventMonitor&) = delete;
+
+  TaskHandle_t task = nullptr;
+  volatile bool pending = false;        // Assertion seen, not yet serviced
+  volatile uint32_t assertedAtUs = 0;   // micros() of the first unserviced assertion
+  Stats stats;
+
+  bool lineAsserted();
+  bool service();
+  void completed();
+
+  static void IRAM_ATTR onAttentionIsr(void* arg);
+  static void serviceTask(void* param);
+};
+
+#endif // SLAVE_EVENTS_H
@@ -0,0 +1,172 @@
+#ifndef SLAVE_FLASHER_H
+#define SLAVE_FLASHER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "md11_slave_update.h"
+#include "ms11_image.h"
+#include "flash_journal.h"
+#include "slave_controller.h"
+
+// ============================================================================
+// SLAVE FLASHER (background MS11-control update jobs)
+// ============================================================================
+// Flashes an image file from LittleFS on its own task so HTTP handlers only
+// stage the file and return a job id. The job is a state machine advanced
+// one bounded step at a time (one page, or one 250 ms slice of a wait):
+//
+//   PREPARE -> ENTER_BOOTLOADER -> CHECK_SIGNATURE [-> BACKUP] -> WRITE_PAGES
+//           -> VERIFY [-> RESTORE_EEPROM] -> EXIT_BOOTLOADER -> DONE
+//
+// BACKUP dumps the board's current firmware and EEPROM (one page per step)
+// so rollback() can flash it back; it is skipped when resuming and for the
+// rollback itself. RESTORE_EEPROM only runs for a rollback that asks for it.
+//
+// Cancellation is checked between steps. Before the first page is written
+// a cancelled job returns the ATmega to its application; once pages have
+// been written it stays in the bootloader so a new job can finish the image.
+// Every state change and page is published to the progress listener (the
+// /api/twi/events SSE stream), rate-limited to SLAVE_FLASH_EVENT_INTERVAL_MS.
+//
+// Jobs are journalled in NVS (FlashJournal). A job for the image named in
+// an active journal with the same digest resumes at its checkpoint: pages
+// below it are taken as written and only checked by the final verify.
+//
+// A job targets one board by its application address. All boards share the
+// twiboot address, so the others keep running while it is flashed, and a
+// job refuses to start while a different board is sitting in the bootloader.
+
+#define SLAVE_FLASH_TASK_STACK        6144
+#define SLAVE_FLASH_TASK_PRIORITY     2      // Below the I2C workers and slave events
+#define SLAVE_FLASH_TASK_CORE         1
+#define SLAVE_FLASH_WAIT_SLICE_MS     250    // Bootloader entry is polled in slices (cancellable)
+#define SLAVE_FLASH_EVENT_INTERVAL_MS 100    // Page progress events at most this often
+#define SLAVE_FLASH_ERROR_LENGTH      96
+
+// Staging files for web uploads; the leading dot keeps them out of the boot-time update scan
+#define SLAVE_FLASH_STAGING_HEX       "/.ms11_upload.hex"
+#define SLAVE_FLASH_STAGING_IMAGE     "/.ms11_upload.msimg"
+
+class SlaveFlasher {
+public:
+  enum State : uint8_t {
+    FLASH_IDLE = 0,
+    FLASH_PREPARE,           // Convert .hex, check header and SHA-256
+    FLASH_ENTER_BOOTLOADER,
+    FLASH_CHECK_SIGNATURE,
+    FLASH_BACKUP,            // Dump the current firmware and EEPROM
+    FLASH_WRITE_PAGES,
+    FLASH_VERIFY,
+    FLASH_RESTORE_EEPROM,    // Rollback only
+    FLASH_EXIT_BOOTLOADER,
+    FLASH_DONE,
+    FLASH_FAILED,
+    FLASH_CANCELLED
+  };
+
+  struct Progress {
+    uint32_t jobId = 0;
+    uint8_t target = 0;       // Application address of the board being flashed
+    State state = FLASH_IDLE;
+    uint16_t page = 0;        // Pages processed (written, skipped, cached or resumed)
+    uint16_t pageCount = 0;
+    uint16_t resumePage = 0;  // First page written by this job (journal checkpoint)
+    uint8_t percent = 0;
+    uint16_t backupPage = 0;  // Pages dumped so far
+    bool rollback = false;
+    bool inBootloader = false;
+    char error[SLAVE_FLASH_ERROR_LENGTH] = "";
+    MD11SlaveUpdate::FlashStats stats;
+    MD11SlaveUpdate::BackupStats backup;
+  };
+
+  typedef void (*ProgressListener)(const Progress& progress, void* context);
+
+  // Why a job for `target` must not start now, or nullptr to allow it
+  typedef const char* (*StartGuard)(uint8_t target, void* context);
+
+  // Singleton
+  static SlaveFlasher& getInstance() {
+    static SlaveFlasher instance;
+    return instance;
+  }
+
+  // Start the flasher task
+  bool begin();
+
+  // Queue a job for a .msimg or .hex file in LittleFS. Returns the job id,
+  // 0 if a job is already running or the flasher is not started.
+  // A temporary file is removed when the job ends, whatever the outcome.
+  // With `backup` the board's current firmware is saved for rollback first.
+  // `hexVersion` is written into the image converted from a .hex (BCD, 0 = unknown).
+  uint32_t start(const String& path, bool differential = true, bool temporary = false,
+                 uint8_t target = SLAVE_I2C_ADDR, bool backup = true, uint8_t hexVersion = 0);
+
+  // Flash the last backup of `target` back, optionally with its EEPROM
+  uint32_t rollback(uint8_t target = SLAVE_I2C_ADDR, bool restoreEeprom = false);
+
+  // Request cancellation (takes effect between steps)
+  bool cancel(uint32_t jobId);
+
+  bool isBusy();
+  Progress getProgress();
+
+  // Called from the flasher task after every published change
+  void setListener(ProgressListener listener, void* context);
+
+  // Asked by start()/rollback() once the job slot is reserved; a reason
+  // refuses the job (start returns 0)
+  void setStartGuard(StartGuard guard, void* context);
+
+  static const char* stateName(State state);
+
+private:
+  SlaveFlasher() = default;
+  ~SlaveFlasher() = default;
+  SlaveFlasher(const SlaveFlasher&) = delete;
+  SlaveFlasher& operator=(const SlaveFlasher&) = delete;
+
+  TaskHandle_t task = nullptr;
+  SemaphoreHandle_t lock = nullptr;   // Guards progress and the job request
+  Progress progress;
+  uint32_t nextJobId = 1;
+  volatile bool cancelRequested = false;
+
+  ProgressListener listener = nullptr;
+  void* listenerContext = nullptr;
+  StartGuard startGuard = nullptr;
+  void* startGuardContext = nullptr;
+  uint32_t lastEventMs = 0;
+
+  // Current job (flasher task only)
+  String path;
+  bool differential = true;
+  bool temporary = false;
+  uint8_t hexVersion = 0;             // Image version for a .hex job
+  uint8_t target = SLAVE_I2C_ADDR;
+  bool backup = true;
+  bool restoreEeprom = false;
+  String eepromPath;                  // Rollback: EEPROM dump to restore
+  File image;
+  MsImageHeader header;
+  bool enteredBootloader = false;     // We sent the entry command (undo on early cancel)
+  uint32_t enterDeadlineMs = 0;
+  uint16_t resumePage = 0;            // Pages below this were committed before a reset
+
+  uint32_t queue(const String& path, bool differential, bool temporary, uint8_t target,
+                 bool backup, const String& eepromPath, uint8_t hexVersion);
+  void runJob();
+  State step(State state);
+  State startWriting();
+  void leaveBootloader();
+  State fail(const String& message);
+  void setState(State state);
+  void publish(bool force);
+
+  static void flasherTask(void* param);
+};
+
+#endif // SLAVE_FLASHER_H
@@ -0,0 +1,126 @@
+#ifndef SLAVE_FLEET_H
+#define SLAVE_FLEET_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "slave_controller.h"
+
+// ============================================================================
+// SLAVE FLEET (several MS11-control boards on the slave bus)
+// ============================================================================
+// Extra smoker zones are MS11-control boards at their own application
+// addresses on Wire1. The address list is kept in NVS; the board at
+// SLAVE_I2C_ADDR stays the one SlaveController drives.
+//
+// Inventory: every SLAVE_FLEET_SCAN_INTERVAL_MS each board is pinged and its
+// REG_GET_VERSION_FULL block and status/version burst (ms11::Health) are
+// read. The main board is read through SlaveController (framing-aware);
+// the others speak plain protocol v2.
+//
+// Fleet update: boards whose firmware version differs from the image (or
+// all of them with `force`) are flashed one at a time through SlaveFlasher.
+// An image without a version (0) is only flashed with `force`. Only the board being flashed
+// leaves its application; the others keep running.
+
+#define SLAVE_FLEET_MAX_BOARDS       8
+#define SLAVE_FLEET_NAMESPACE        "ms11_fleet"
+#define SLAVE_FLEET_SCAN_INTERVAL_MS 10000
+#define SLAVE_FLEET_JOB_POLL_MS      200
+#define SLAVE_FLEET_TASK_STACK       4096
+#define SLAVE_FLEET_TASK_PRIORITY    1
+#define SLAVE_FLEET_TASK_CORE        1
+
+class SlaveFleet {
+public:
+  enum BoardState : uint8_t {
+    BOARD_UNKNOWN = 0,   // Not scanned yet
+    BOARD_ABSENT,        // No ACK
+    BOARD_RUNNING,       // Application answering, no error code
+    BOARD_FAULT,         // Application reports an error code
+    BOARD_QUEUED,        // Waiting for its turn in a fleet update
+    BOARD_UPDATING,      // In the bootloader (SlaveFlasher job)
+    BOARD_UPDATE_FAILED
+  };
+
+  struct Board {
+    uint8_t address = 0;
+    BoardState state = BOARD_UNKNOWN;
+    SlaveVersion version = {0, 0, 0, 0, false};
+    uint8_t fwVersion = 0;          // BCD
+    uint8_t protocolVersion = 0;
+    uint8_t status = 0;
+    uint32_t lastSeenMs = 0;        // 0 = never answered
+    uint16_t failures = 0;          // Consecutive failed scans
+    uint32_t updates = 0;           // Successful fleet updates since boot
+  };
+
+  struct UpdateStatus {
+    bool running = false;
+    String path;
+    uint8_t imageVersion = 0;       // BCD from the image header, 0 = unknown
+    uint8_t current = 0;            // Address being flashed, 0 = none
+    uint8_t total = 0;              // Boards selected for this update
+    uint8_t done = 0;
+    uint8_t failed = 0;
+  };
+
+  // Singleton
+  static SlaveFleet& getInstance() {
+    static SlaveFleet instance;
+    return instance;
+  }
+
+  // Load the address list and start the inventory task
+  bool begin();
+
+  // Replace the address list (persisted). Rejects reserved and duplicate
+  // addresses and the twiboot address.
+  bool setAddresses(const uint8_t* addresses, uint8_t count);
+
+  // Copy the board table; returns the number of boards
+  uint8_t getBoards(Board* out, uint8_t max);
+
+  // Scan on the next task cycle instead of waiting for the interval
+  void requestScan();
+
+  // Flash every outdated board with the .msimg at `path`, one at a time
+  bool startUpdate(const String& path, bool force = false);
+  bool cancelUpdate();
+  UpdateStatus getUpdateStatus();
+
+  static const char* stateName(BoardState state);
+
+  String getLastError() { return lastError; }
+
+private:
+  SlaveFleet() = default;
+  ~SlaveFleet() = default;
+  SlaveFleet(const SlaveFleet&) = delete;
+  SlaveFleet& operator=(const SlaveFleet&) = delete;
+
+  TaskHandle_t task = nullptr;
+  SemaphoreHandle_t lock = nullptr;   // Guards boards, boardCount and update
+  Board boards[SLAVE_FLEET_MAX_BOARDS];
+  uint8_t boardCount = 0;
+  UpdateStatus update;
+  bool updateRequested = false;
+  bool force = false;
+  volatile bool cancelRequested = false;
+  String lastError;
+
+  void loadAddresses();
+  static void routeBoard(uint8_t address);
+  void scanAll();
+  void scanBoard(uint8_t address);
+  bool readBoard(uint8_t address, Board& board);
+  void runUpdate();
+  bool flashBoard(uint8_t address);
+  void setBoardState(uint8_t address, BoardState state);
+  static bool validAddress(uint8_t address);
+
+  static void fleetTask(void* param);
+};
+
+#endif // SLAVE_FLEET_H
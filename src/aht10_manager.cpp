@@ -1,11 +1,6 @@
 #include "aht10_manager.h"
-#include "Adafruit_AHTX0.h"
 #include "i2c_manager.h"
 
-// Global AHT10 sensor instance
-Adafruit_AHTX0 gAHT10;
-bool gAHT10Ready = false;
-
 AHT10Manager::AHT10Manager() {
   // Constructor - initialization handled in begin()
 }
@@ -37,18 +32,30 @@ bool AHT10Manager::begin() {
     return false;
   }
 
-  // Initialize AHT10 using default Wire (which is Bus 1 for display devices)
-  if (!gAHT10.begin()) {
-    lastError = "AHT10 initialization failed";
+  // Load the calibration coefficients if the sensor has not done so itself
+  uint8_t status = 0;
+  if (!I2CManager::getInstance().displayRead(AHT10_I2C_ADDRESS, &status, 1)) {
+    lastError = "AHT10 status read failed";
     Serial.println("[AHT10] WARNING: " + lastError);
     return false;
   }
+  if (!(status & AHT10_STATUS_CALIBRATED)) {
+    const uint8_t calibrate[] = {AHT10_CMD_CALIBRATE, 0x08, 0x00};
+    if (!I2CManager::getInstance().displayWrite(AHT10_I2C_ADDRESS, calibrate, sizeof(calibrate))) {
+      lastError = "AHT10 initialization failed";
+      Serial.println("[AHT10] WARNING: " + lastError);
+      return false;
+    }
+    delay(10);
+  }
 
   initialized = true;
-  gAHT10Ready = true;
   
-  // Read sensor immediately on startup to have valid data
-  readSensor();
+  // Take the first measurement right away (blocking, setup only) to have valid data
+  if (trigger()) {
+    delay(AHT10_CONVERSION_MS);
+    collect();
+  }
   
   Serial.println("[AHT10] ✓ Temperature & Humidity Sensor initialized (I2C Bus 1: 0x" + 
                  String(AHT10_I2C_ADDRESS, HEX) + ")");
@@ -60,33 +67,91 @@ bool AHT10Manager::begin() {
 
 void AHT10Manager::end() {
   if (initialized) {
-    gAHT10Ready = false;
     initialized = false;
+    phase = PHASE_IDLE;
     Serial.println("[AHT10] Sensor shutdown");
   }
 }
 
-bool AHT10Manager::readSensor() {
-  if (!initialized || !gAHT10Ready) {
-    return false;  // Silently return if not ready
+// ============================================================================
+// Trigger / collect state machine
+// ============================================================================
+
+void AHT10Manager::update() {
+  if (!initialized) {
+    return;
   }
 
-  // Get sensor data
-  sensors_event_t humidityEvent, tempEvent;
-  
-  if (!gAHT10.getEvent(&humidityEvent, &tempEvent)) {
+  uint32_t now = millis();
+  if (phase == PHASE_IDLE) {
+    if (lastTriggerTime == 0 || now - lastTriggerTime >= AHT10_MEASURE_INTERVAL_MS) {
+      trigger();
+    }
+    return;
+  }
+
+  // Converting: leave the bus alone until the result can be ready
+  if (now - triggeredAt >= AHT10_CONVERSION_MS) {
+    collect();
+  }
+}
+
+bool AHT10Manager::trigger() {
+  const uint8_t command[] = {AHT10_CMD_TRIGGER, 0x33, 0x00};
+  lastTriggerTime = millis();
+
+  if (!I2CManager::getInstance().displayWrite(AHT10_I2C_ADDRESS, command, sizeof(command))) {
+    lastError = "Failed to trigger measurement";
+    failures++;
+    return false;
+  }
+  triggeredAt = lastTriggerTime;
+  phase = PHASE_CONVERTING;
+  return true;
+}
+
+bool AHT10Manager::collect() {
+  uint8_t data[6];
+  if (!I2CManager::getInstance().displayRead(AHT10_I2C_ADDRESS, data, sizeof(data))) {
     lastError = "Failed to read sensor data";
+    failures++;
+    phase = PHASE_IDLE;
     return false;  // Keep last valid values
   }
 
+  if (data[0] & AHT10_STATUS_BUSY) {
+    // Still converting: try again on a later tick, up to the timeout
+    if (millis() - triggeredAt > AHT10_CONVERSION_TIMEOUT_MS) {
+      lastError = "Conversion timed out";
+      failures++;
+      phase = PHASE_IDLE;
+    }
+    return false;
+  }
+
+  // 20-bit humidity, then 20-bit temperature (shared middle byte)
+  uint32_t rawHumidity = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
+  uint32_t rawTemperature = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
+
   // Update readings and timestamp
-  temperature = tempEvent.temperature;
-  humidity = humidityEvent.relative_humidity;
+  humidity = rawHumidity * 100.0f / 1048576.0f;
+  temperature = rawTemperature * 200.0f / 1048576.0f - 50.0f;
   lastReadTime = millis();
+  failures = 0;
+  phase = PHASE_IDLE;
 
   return true;
 }
 
+bool AHT10Manager::readSensor() {
+  if (!initialized) {
+    return false;  // Silently return if not ready
+  }
+
+  // Cache only: the loop's update() owns the bus and the state machine
+  return lastReadTime != 0 && millis() - lastReadTime <= AHT10_STALE_MS;
+}
+
 float AHT10Manager::getTemperature() {
   return temperature;
 }
@@ -104,7 +169,6 @@ bool AHT10Manager::isHealthy() {
     return false;
   }
 
-  // Try a test read
-  sensors_event_t humidityEvent, tempEvent;
-  return gAHT10.getEvent(&humidityEvent, &tempEvent);
+  // Judged from the cached measurement; no test read on the shared bus
+  return failures < 3 && lastReadTime != 0 && millis() - lastReadTime <= AHT10_STALE_MS;
 }
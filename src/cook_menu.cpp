@@ -0,0 +1,160 @@
+#include "cook_menu.h"
+#include "lcd_manager.h"
+#include "seesaw_rotary.h"
+#include "oven_controller.h"
+#include <new>
+
+bool CookMenu::update(uint32_t nowMs, bool available) {
+  if (nowMs - lastStatusMs >= COOK_MENU_STATUS_MS) {
+    lastStatusMs = nowMs;
+    refreshStatus(nowMs);
+  }
+  if (!available || !LCDManager::getInstance().isInitialized()) {
+    if (view == VIEW_MENU) {
+      view = VIEW_CLOSED;   // A pending notice waits for the LCD
+    }
+    pressPending = false;
+    return false;
+  }
+
+  int32_t delta = 0;
+  if (nowMs - lastPollMs >= COOK_MENU_POLL_MS) {
+    lastPollMs = nowMs;
+    delta = SeesawRotary::getInstance().getDelta();
+  }
+  bool press = pressPending;
+  pressPending = false;
+
+  switch (view) {
+    case VIEW_CLOSED:
+      if (delta != 0) {
+        open(nowMs);
+      }
+      break;
+
+    case VIEW_MENU:
+      if (delta != 0 || press) {
+        viewSinceMs = nowMs;
+      }
+      if (delta != 0) {
+        // Wrap around; the encoder counts one step per detent
+        int32_t count = itemCount();
+        selected = (uint8_t)(((selected + delta) % count + count) % count);
+        dirty = true;
+      }
+      if (press) {
+        select();
+      } else if (nowMs - viewSinceMs >= COOK_MENU_TIMEOUT_MS) {
+        close();
+      }
+      break;
+
+    case VIEW_NOTICE:
+      if (press || nowMs - viewSinceMs >= COOK_NOTICE_SHOW_MS) {
+        close();
+      }
+      break;
+  }
+
+  if (dirty) {
+    dirty = false;
+    render();
+  }
+  return view != VIEW_CLOSED;
+}
+
+void CookMenu::refreshStatus(uint32_t nowMs) {
+  OvenController::Status status = OvenController::getInstance().getStatus();
+  programRunning = status.programActive;
+
+  if (programRunning) {
+    uint32_t minutes = status.stageElapsedS / 60;
+    snprintf(line, sizeof(line), "%u/%u %uC %02u:%02u", status.programStage + 1, status.programStages,
+             (unsigned)(status.target + 0.5f), (unsigned)(minutes / 60 % 100), (unsigned)(minutes % 60));
+  } else {
+    line[0] = '\0';
+  }
+
+  // New notification: show it over whatever is on the LCD
+  if (notifySeqKnown && status.notifySeq != seenNotifySeq) {
+    strlcpy(notice, status.notifyText, sizeof(notice));
+    view = VIEW_NOTICE;
+    viewSinceMs = nowMs;
+    dirty = true;
+  }
+  seenNotifySeq = status.notifySeq;
+  notifySeqKnown = true;
+}
+
+void CookMenu::open(uint32_t nowMs) {
+  profileCount = programRunning ? 0 : CookProfileStore::getInstance().list(profiles, COOK_PROFILE_MAX_FILES);
+  selected = 0;
+  view = VIEW_MENU;
+  viewSinceMs = nowMs;
+  dirty = true;
+}
+
+void CookMenu::close() {
+  view = VIEW_CLOSED;
+  LCDManager::getInstance().clear();   // The Ready screen redraws itself
+}
+
+uint8_t CookMenu::itemCount() const {
+  return programRunning ? 3 : profileCount + 1;
+}
+
+CookMenu::Action CookMenu::itemAction(uint8_t index) const {
+  if (programRunning) {
+    return index == 0 ? ITEM_NEXT : (index == 1 ? ITEM_STOP : ITEM_BACK);
+  }
+  return index < profileCount ? ITEM_PROFILE : ITEM_BACK;
+}
+
+void CookMenu::select() {
+  OvenController& oven = OvenController::getInstance();
+  switch (itemAction(selected)) {
+    case ITEM_PROFILE: {
+      CookProfile* profile = new (std::nothrow) CookProfile();
+      bool started = profile && CookProfileStore::getInstance().load(profiles[selected].name, *profile) &&
+                     oven.startProgram(*profile);
+      delete profile;
+      if (!started) {
+        strlcpy(notice, "Start failed", sizeof(notice));
+        view = VIEW_NOTICE;
+        viewSinceMs = millis();
+        dirty = true;
+        return;
+      }
+      break;
+    }
+    case ITEM_NEXT:
+      oven.advanceProgram();
+      break;
+    case ITEM_STOP:
+      oven.stopProgram();
+      break;
+    case ITEM_BACK:
+      break;
+  }
+  lastStatusMs = 0;   // Show the new program state right away
+  close();
+}
+
+void CookMenu::render() {
+  LCDManager& lcd = LCDManager::getInstance();
+  if (view == VIEW_NOTICE) {
+    lcd.printLine(0, "Cook program:");
+    lcd.printLine(1, notice);
+    return;
+  }
+
+  lcd.printLine(0, programRunning ? line : "Start program");
+  String item = ">";
+  switch (itemAction(selected)) {
+    case ITEM_PROFILE: item += profiles[selected].name; break;
+    case ITEM_NEXT:    item += "Next stage"; break;
+    case ITEM_STOP:    item += "Stop program"; break;
+    case ITEM_BACK:    item += "Back"; break;
+  }
+  lcd.printLine(1, item);
+}
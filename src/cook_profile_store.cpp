@@ -0,0 +1,250 @@
+#include "cook_profile_store.h"
+#include <LittleFS.h>
+#include <math.h>
+
+// ============================================================================
+// Files
+// ============================================================================
+
+// "Pork Shoulder #2" -> "/cook/pork_shoulder__2.ckpf"
+String CookProfileStore::pathFor(const char* name) {
+  String path = COOK_PROFILE_DIR "/";
+  for (const char* c = name; *c; c++) {
+    path += isalnum((unsigned char)*c) || *c == '-' ? (char)tolower((unsigned char)*c) : '_';
+  }
+  return path + COOK_PROFILE_EXTENSION;
+}
+
+bool CookProfileStore::save(const CookProfile& profile) {
+  const char* invalid = profile.validate();
+  if (invalid) {
+    lastError = invalid;
+    return false;
+  }
+
+  String path = pathFor(profile.name);
+  if (!LittleFS.exists(path)) {
+    Entry existing[COOK_PROFILE_MAX_FILES];
+    if (list(existing, COOK_PROFILE_MAX_FILES) >= COOK_PROFILE_MAX_FILES) {
+      lastError = "Too many profiles";
+      return false;
+    }
+  }
+
+  uint8_t buffer[COOK_PROFILE_MAX_SIZE];
+  size_t size = profile.encode(buffer, sizeof(buffer));
+
+  LittleFS.mkdir(COOK_PROFILE_DIR);
+  String temp = path + ".tmp";
+  File file = LittleFS.open(temp, "w");
+  if (!file) {
+    lastError = "Could not create " + temp;
+    return false;
+  }
+  bool written = file.write(buffer, size) == size;
+  file.close();
+
+  if (!written || (LittleFS.exists(path) && !LittleFS.remove(path)) || !LittleFS.rename(temp, path)) {
+    LittleFS.remove(temp);
+    lastError = "Could not write " + path;
+    return false;
+  }
+
+  Serial.printf("[CookProfiles] Saved '%s' (%u stages, %u bytes)\n", profile.name,
+                profile.stageCount, (unsigned)size);
+  return true;
+}
+
+bool CookProfileStore::load(const char* name, CookProfile& profile) {
+  String path = pathFor(name);
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    lastError = "No profile named " + String(name);
+    return false;
+  }
+
+  uint8_t buffer[COOK_PROFILE_MAX_SIZE];
+  size_t size = file.size();
+  bool read = size <= sizeof(buffer) && file.read(buffer, size) == size;
+  file.close();
+  if (!read) {
+    lastError = "Could not read " + path;
+    return false;
+  }
+
+  const char* error = profile.decode(buffer, size);
+  if (error) {
+    lastError = path + ": " + error;
+    return false;
+  }
+  return true;
+}
+
+bool CookProfileStore::remove(const char* name) {
+  String path = pathFor(name);
+  if (!LittleFS.exists(path) || !LittleFS.remove(path)) {
+    lastError = "No profile named " + String(name);
+    return false;
+  }
+  return true;
+}
+
+uint8_t CookProfileStore::list(Entry* out, uint8_t max) {
+  File dir = LittleFS.open(COOK_PROFILE_DIR);
+  if (!dir || !dir.isDirectory()) {
+    return 0;
+  }
+
+  uint8_t count = 0;
+  File file = dir.openNextFile();
+  while (file && count < max) {
+    String fileName = String(file.name());
+    CookProfileHeader header;
+    if (fileName.endsWith(COOK_PROFILE_EXTENSION) &&
+        file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+        memcmp(header.magic, COOK_PROFILE_MAGIC, sizeof(header.magic)) == 0) {
+      // Insertion sort: a handful of entries
+      header.name[sizeof(header.name) - 1] = '\0';
+      uint8_t i = count++;
+      while (i > 0 && strcasecmp(out[i - 1].name, header.name) > 0) {
+        out[i] = out[i - 1];
+        i--;
+      }
+      memcpy(out[i].name, header.name, sizeof(out[i].name));
+      out[i].stageCount = header.stageCount;
+    }
+    file.close();
+    file = dir.openNextFile();
+  }
+  dir.close();
+  return count;
+}
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+bool CookProfileStore::fromJson(JsonObject json, CookProfile& profile, String& error) {
+  profile = CookProfile();
+  String name = json["name"].as<String>();
+  if (name.isEmpty() || name.length() >= COOK_NAME_LENGTH) {
+    error = "name must be 1-23 characters";
+    return false;
+  }
+  strlcpy(profile.name, name.c_str(), sizeof(profile.name));
+
+  JsonArray stages = json["stages"].as<JsonArray>();
+  if (stages.size() == 0 || stages.size() > COOK_MAX_STAGES) {
+    error = "stages must have 1-16 entries";
+    return false;
+  }
+
+  for (JsonObject s : stages) {
+    CookStage& stage = profile.stages[profile.stageCount++];
+    memset(&stage, 0, sizeof(stage));
+    String stageName = s["name"].as<String>();
+    strncpy(stage.record.name, stageName.c_str(), sizeof(stage.record.name));
+    // Range-check before narrowing: the casts would wrap 400 °C or fan 300
+    float setpoint = s["setpoint"].as<float>();
+    if (!(setpoint >= 0.0f && setpoint * 100.0f < COOK_MAX_SETPOINT)) {
+      error = "setpoint must be 0 (keep) or below " + String(COOK_MAX_SETPOINT / 100) + " °C";
+      return false;
+    }
+    stage.record.setpoint = (int16_t)lroundf(setpoint * 100.0f);
+    if (s["fan"].isNull()) {
+      stage.record.fanPercent = COOK_FAN_AUTO;
+    } else {
+      int fan = s["fan"].as<int>();
+      if (!s["fan"].is<int>() || fan < 0 || fan > 100) {
+        error = "fan must be 0-100 or null";
+        return false;
+      }
+      stage.record.fanPercent = (uint8_t)fan;
+    }
+    stage.record.flags = s["notify"].as<bool>() ? COOK_STAGE_NOTIFY : 0;
+
+    JsonArray triggers = s["triggers"].as<JsonArray>();
+    if (triggers.size() > COOK_MAX_TRIGGERS) {
+      error = "at most 4 triggers per stage";
+      return false;
+    }
+    for (JsonObject t : triggers) {
+      CookTrigger& trigger = stage.triggers[stage.record.triggerCount++];
+      String type = t["type"].as<String>();
+      if (!CookEngine::parseTriggerType(type.c_str(), trigger.type)) {
+        error = "unknown trigger type '" + type + "'";
+        return false;
+      }
+      if (trigger.type != TRIGGER_ELAPSED) {
+        int probe = t["probe"].as<int>();
+        if (t["probe"].as<String>() == "oven") {
+          trigger.probe = COOK_PROBE_OVEN;
+        } else if (t["probe"].is<int>() && probe >= 0 && probe < COOK_PROBE_COUNT) {
+          trigger.probe = (uint8_t)probe;
+        } else {
+          error = "probe must be \"oven\" or 0-" + String(COOK_PROBE_COUNT - 1);
+          return false;
+        }
+      }
+      float value = t["value"].as<float>();
+      if (!(fabsf(value) < COOK_TRIGGER_MAX_VALUE)) {
+        error = "trigger value out of range";
+        return false;
+      }
+      if (trigger.type == TRIGGER_ELAPSED) {
+        trigger.value = (int32_t)lroundf(value);
+      } else {
+        trigger.value = (int32_t)lroundf(value * 100.0f);
+        bool rate = trigger.type == TRIGGER_RATE_BELOW || trigger.type == TRIGGER_RATE_ABOVE;
+        trigger.param = t[rate ? "window" : "hold"].as<uint16_t>();
+      }
+    }
+  }
+
+  const char* invalid = profile.validate();
+  if (invalid) {
+    error = invalid;
+    return false;
+  }
+  return true;
+}
+
+void CookProfileStore::toJson(const CookProfile& profile, JsonObject json) {
+  json["name"] = profile.name;
+  JsonArray stages = json["stages"].to<JsonArray>();
+
+  for (uint8_t i = 0; i < profile.stageCount; i++) {
+    const CookStage& stage = profile.stages[i];
+    char stageName[COOK_STAGE_NAME_LENGTH + 1];
+    CookProfile::stageName(stage, stageName);
+
+    JsonObject s = stages.add<JsonObject>();
+    s["name"] = stageName;
+    s["setpoint"] = stage.record.setpoint / 100.0f;
+    if (stage.record.fanPercent == COOK_FAN_AUTO) {
+      s["fan"] = nullptr;
+    } else {
+      s["fan"] = stage.record.fanPercent;
+    }
+    s["notify"] = (stage.record.flags & COOK_STAGE_NOTIFY) != 0;
+
+    JsonArray triggers = s["triggers"].to<JsonArray>();
+    for (uint8_t j = 0; j < stage.record.triggerCount; j++) {
+      const CookTrigger& trigger = stage.triggers[j];
+      JsonObject t = triggers.add<JsonObject>();
+      t["type"] = CookEngine::triggerName(trigger.type);
+      if (trigger.type == TRIGGER_ELAPSED) {
+        t["value"] = trigger.value;
+        continue;
+      }
+      if (trigger.probe == COOK_PROBE_OVEN) {
+        t["probe"] = "oven";
+      } else {
+        t["probe"] = trigger.probe;
+      }
+      t["value"] = trigger.value / 100.0f;
+      bool rate = trigger.type == TRIGGER_RATE_BELOW || trigger.type == TRIGGER_RATE_ABOVE;
+      t[rate ? "window" : "hold"] = trigger.param;
+    }
+  }
+}
@@ -0,0 +1,238 @@
+#include "cook_program.h"
+#include <string.h>
+
+static const char* const kTriggerNames[TRIGGER_TYPE_COUNT] = {
+  "elapsed", "probe_above", "probe_below", "rate_below", "rate_above"
+};
+
+// ============================================================================
+// CookProfile
+// ============================================================================
+
+const char* CookProfile::validate() const {
+  if (name[0] == '\0' || memchr(name, '\0', sizeof(name)) == nullptr) {
+    return "Profile needs a name";
+  }
+  if (stageCount == 0 || stageCount > COOK_MAX_STAGES) {
+    return "Profile needs 1-16 stages";
+  }
+  if (stages[0].record.setpoint <= 0) {
+    return "First stage needs a setpoint";
+  }
+
+  for (uint8_t s = 0; s < stageCount; s++) {
+    const CookStage& stage = stages[s];
+    if (stage.record.setpoint < 0 || stage.record.setpoint >= COOK_MAX_SETPOINT) {
+      return "Setpoint out of range";
+    }
+    if (stage.record.triggerCount > COOK_MAX_TRIGGERS ||
+        (stage.record.fanPercent > 100 && stage.record.fanPercent != COOK_FAN_AUTO)) {
+      return "Invalid stage";
+    }
+    for (uint8_t t = 0; t < stage.record.triggerCount; t++) {
+      const CookTrigger& trigger = stage.triggers[t];
+      if (trigger.type >= TRIGGER_TYPE_COUNT) {
+        return "Unknown trigger type";
+      }
+      if (trigger.type == TRIGGER_ELAPSED && trigger.value <= 0) {
+        return "Elapsed trigger needs a time";
+      }
+      if (trigger.type == TRIGGER_ELAPSED && (uint32_t)trigger.value > COOK_MAX_ELAPSED_S) {
+        return "Elapsed trigger too long";
+      }
+      if (trigger.type != TRIGGER_ELAPSED && trigger.probe != COOK_PROBE_OVEN &&
+          trigger.probe >= COOK_PROBE_COUNT) {
+        return "Unknown trigger probe";
+      }
+    }
+  }
+  return nullptr;
+}
+
+size_t CookProfile::encode(uint8_t* out, size_t max) const {
+  if (validate()) {
+    return 0;
+  }
+
+  size_t size = sizeof(CookProfileHeader);
+  for (uint8_t s = 0; s < stageCount; s++) {
+    size += sizeof(CookStageRecord) + stages[s].record.triggerCount * sizeof(CookTrigger);
+  }
+  if (size > max) {
+    return 0;
+  }
+
+  CookProfileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, COOK_PROFILE_MAGIC, sizeof(header.magic));
+  header.formatVersion = COOK_PROFILE_FORMAT_VERSION;
+  header.stageCount = stageCount;
+  header.size = (uint16_t)size;
+  strncpy(header.name, name, sizeof(header.name) - 1);
+  memcpy(out, &header, sizeof(header));
+
+  size_t pos = sizeof(header);
+  for (uint8_t s = 0; s < stageCount; s++) {
+    const CookStage& stage = stages[s];
+    memcpy(out + pos, &stage.record, sizeof(stage.record));
+    pos += sizeof(stage.record);
+    memcpy(out + pos, stage.triggers, stage.record.triggerCount * sizeof(CookTrigger));
+    pos += stage.record.triggerCount * sizeof(CookTrigger);
+  }
+  return pos;
+}
+
+const char* CookProfile::decode(const uint8_t* data, size_t length) {
+  CookProfileHeader header;
+  if (length < sizeof(header)) {
+    return "Truncated profile";
+  }
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, COOK_PROFILE_MAGIC, sizeof(header.magic)) != 0) {
+    return "Not a cook profile";
+  }
+  if (header.formatVersion != COOK_PROFILE_FORMAT_VERSION) {
+    return "Unsupported profile version";
+  }
+  if (header.size != length || header.stageCount == 0 || header.stageCount > COOK_MAX_STAGES) {
+    return "Corrupt profile";
+  }
+
+  memset(stages, 0, sizeof(stages));
+  memcpy(name, header.name, sizeof(name));
+  name[sizeof(name) - 1] = '\0';
+  stageCount = header.stageCount;
+
+  size_t pos = sizeof(header);
+  for (uint8_t s = 0; s < stageCount; s++) {
+    CookStage& stage = stages[s];
+    if (pos + sizeof(stage.record) > length) {
+      return "Truncated profile";
+    }
+    memcpy(&stage.record, data + pos, sizeof(stage.record));
+    pos += sizeof(stage.record);
+
+    size_t triggerBytes = stage.record.triggerCount * sizeof(CookTrigger);
+    if (stage.record.triggerCount > COOK_MAX_TRIGGERS || pos + triggerBytes > length) {
+      return "Corrupt profile";
+    }
+    memcpy(stage.triggers, data + pos, triggerBytes);
+    pos += triggerBytes;
+  }
+  if (pos != length) {
+    return "Corrupt profile";
+  }
+  return validate();
+}
+
+void CookProfile::stageName(const CookStage& stage, char out[COOK_STAGE_NAME_LENGTH + 1]) {
+  memcpy(out, stage.record.name, COOK_STAGE_NAME_LENGTH);
+  out[COOK_STAGE_NAME_LENGTH] = '\0';
+}
+
+// ============================================================================
+// CookEngine
+// ============================================================================
+
+void CookEngine::start(const CookProfile& newProfile, uint32_t nowMs) {
+  profile = newProfile;
+  running = true;
+  lastTrigger = -1;
+  enterStage(0, nowMs);
+}
+
+void CookEngine::enterStage(uint8_t index, uint32_t nowMs) {
+  stage = index;
+  stageStartMs = nowMs;
+  memset(state, 0, sizeof(state));
+}
+
+CookEngine::Event CookEngine::tick(CookInputReader reader, void* context, uint32_t nowMs) {
+  if (!running) {
+    return COOK_NONE;
+  }
+
+  const CookStage& current = profile.stages[stage];
+  for (uint8_t t = 0; t < current.record.triggerCount; t++) {
+    if (evaluate(current.triggers[t], state[t], reader, context, nowMs)) {
+      Event event = advance(nowMs);
+      lastTrigger = t;
+      return event;
+    }
+  }
+  return COOK_NONE;
+}
+
+CookEngine::Event CookEngine::advance(uint32_t nowMs) {
+  if (!running) {
+    return COOK_NONE;
+  }
+
+  lastTrigger = -1;
+  if (stage + 1 >= profile.stageCount) {
+    running = false;
+    return COOK_FINISHED;
+  }
+  enterStage(stage + 1, nowMs);
+  return COOK_STAGE_CHANGED;
+}
+
+bool CookEngine::evaluate(const CookTrigger& trigger, TriggerState& ts, CookInputReader reader,
+                          void* context, uint32_t nowMs) {
+  if (trigger.type == TRIGGER_ELAPSED) {
+    return nowMs - stageStartMs >= (uint32_t)trigger.value * 1000UL;
+  }
+
+  float value;
+  if (!reader(trigger.probe, value, context)) {
+    // No reading: thresholds must hold again, rates restart their window
+    ts.holding = false;
+    ts.hasReference = false;
+    return false;
+  }
+  float threshold = trigger.value / 100.0f;
+
+  if (trigger.type == TRIGGER_PROBE_ABOVE || trigger.type == TRIGGER_PROBE_BELOW) {
+    bool met = trigger.type == TRIGGER_PROBE_ABOVE ? value >= threshold : value <= threshold;
+    if (!met) {
+      ts.holding = false;
+      return false;
+    }
+    if (!ts.holding) {
+      ts.holding = true;
+      ts.holdSinceMs = nowMs;
+    }
+    return nowMs - ts.holdSinceMs >= trigger.param * 1000UL;
+  }
+
+  // Rate triggers: one comparison per completed window
+  uint32_t windowMs = (trigger.param ? trigger.param : COOK_RATE_DEFAULT_WINDOW_S) * 1000UL;
+  if (!ts.hasReference) {
+    ts.hasReference = true;
+    ts.reference = value;
+    ts.referenceMs = nowMs;
+    return false;
+  }
+  uint32_t elapsed = nowMs - ts.referenceMs;
+  if (elapsed < windowMs) {
+    return false;
+  }
+  float perMinute = (value - ts.reference) * 60000.0f / elapsed;
+  ts.reference = value;
+  ts.referenceMs = nowMs;
+  return trigger.type == TRIGGER_RATE_BELOW ? perMinute < threshold : perMinute > threshold;
+}
+
+const char* CookEngine::triggerName(uint8_t type) {
+  return type < TRIGGER_TYPE_COUNT ? kTriggerNames[type] : "unknown";
+}
+
+bool CookEngine::parseTriggerType(const char* name, uint8_t& type) {
+  for (uint8_t i = 0; i < TRIGGER_TYPE_COUNT; i++) {
+    if (strcmp(name, kTriggerNames[i]) == 0) {
+      type = i;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,73 @@
+#include "flash_journal.h"
+#include <Preferences.h>
+
+bool FlashJournal::load(Entry& entry) {
+  Preferences prefs;
+  prefs.begin(FLASH_JOURNAL_NAMESPACE, true);  // true = read-only mode
+  entry.phase = (Phase)prefs.getUChar("phase", JOURNAL_IDLE);
+  entry.page = prefs.getUShort("page", 0);
+  entry.address = prefs.getUChar("addr", ms11::SLAVE_ADDRESS);
+  entry.path = prefs.getString("path", "");
+  bool digest = prefs.getBytes("sha", entry.sha256, sizeof(entry.sha256)) == sizeof(entry.sha256);
+  prefs.end();
+
+  if (entry.phase == JOURNAL_IDLE) {
+    return false;
+  }
+  if (!digest || entry.path.isEmpty() || entry.phase > JOURNAL_EXITING) {
+    Serial.println("[FlashJournal] Discarding incomplete journal");
+    clear();
+    return false;
+  }
+  return true;
+}
+
+void FlashJournal::begin(const String& path, const uint8_t sha256[32], uint8_t address, uint16_t page) {
+  Preferences prefs;
+  prefs.begin(FLASH_JOURNAL_NAMESPACE, false);  // false = read/write mode
+  // Invalidate first, phase last: a journal is only valid once path and digest are in place
+  prefs.putUChar("phase", JOURNAL_IDLE);
+  prefs.putString("path", path);
+  prefs.putBytes("sha", sha256, 32);
+  prefs.putUShort("page", page);
+  prefs.putUChar("addr", address);
+  prefs.putUChar("phase", JOURNAL_WRITING);
+  prefs.end();
+  lastCheckpoint = page;
+}
+
+void FlashJournal::checkpoint(uint16_t pages) {
+  if (pages < lastCheckpoint + FLASH_JOURNAL_PAGE_INTERVAL) {
+    return;
+  }
+  Preferences prefs;
+  prefs.begin(FLASH_JOURNAL_NAMESPACE, false);
+  prefs.putUShort("page", pages);
+  prefs.end();
+  lastCheckpoint = pages;
+}
+
+void FlashJournal::setPhase(Phase phase) {
+  Preferences prefs;
+  prefs.begin(FLASH_JOURNAL_NAMESPACE, false);
+  prefs.putUChar("phase", phase);
+  prefs.end();
+}
+
+void FlashJournal::clear() {
+  Preferences prefs;
+  prefs.begin(FLASH_JOURNAL_NAMESPACE, false);
+  prefs.clear();
+  prefs.end();
+  lastCheckpoint = 0;
+}
+
+const char* FlashJournal::phaseName(Phase phase) {
+  switch (phase) {
+    case JOURNAL_IDLE:      return "idle";
+    case JOURNAL_WRITING:   return "writing";
+    case JOURNAL_VERIFYING: return "verifying";
+    case JOURNAL_EXITING:   return "exiting";
+  }
+  return "unknown";
+}
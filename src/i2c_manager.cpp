@@ -1,13 +1,37 @@
 #include "i2c_manager.h"
+#include "i2c_metrics.h"
+#include "config.h"
 #include <Arduino.h>
+#ifdef I2C_SIM_BUS
+#include "i2c_sim_bus.h"
+#endif
 
 // Private constructor
 I2CManager::I2CManager() {
-  // Initialize pointers
+#ifdef I2C_SIM_BUS
+  // Simulated buses with virtual devices (no hardware required)
+  I2CBusBackend& slaveRaw = SimBus::slaveInstance();
+  I2CBusBackend& displayRaw = SimBus::displayInstance();
+#else
+  // Initialize backends
   // CRITICAL: Slave bus on Wire1 (I2C1), Display bus on Wire (I2C0)
   // This maps to enum: I2C_BUS_SLAVE=1 (Wire1), I2C_BUS_DISPLAY=0 (Wire)
-  slaveBus = &Wire1;    // I2C1 (GPIO5/6 @ 100kHz - ATmega slave)
-  displayBus = &Wire;   // I2C0 (GPIO8/9 @ 100kHz - Display devices)
+  static TwoWireBackend slaveRaw(Wire1, "Wire1");    // I2C1 (GPIO5/6 @ 100kHz - ATmega slave)
+  static TwoWireBackend displayRaw(Wire, "Wire");    // I2C0 (GPIO8/9 @ 100kHz - Display devices)
+#endif
+
+  // Every transaction is timed and counted (see I2CMetrics)
+  static MeteredBusBackend slaveMetered(slaveRaw, I2C_BUS_SLAVE);
+  static MeteredBusBackend displayMetered(displayRaw, I2C_BUS_DISPLAY);
+  slaveBus = &slaveMetered;
+  displayBus = &displayMetered;
+
+  // Declared device routes
+  static const I2CRoute declaredRoutes[] = I2C_ROUTE_TABLE;
+  memset(routes, I2C_ROUTE_UNKNOWN, sizeof(routes));
+  for (const I2CRoute& route : declaredRoutes) {
+    setRoute(route.address, (I2CBus)route.bus);
+  }
 }
 
 I2CManager::~I2CManager() {
@@ -32,7 +56,7 @@ bool I2CManager::begin() {
   // Initialize Slave Bus (GPIO5/6 @ 100kHz - Wire1/I2C1 - CRITICAL)
   // ATmega328P slave controller at 0x30
   // Conservative speed for reliability
-  if (!slaveBus->begin(5, 6, 100000)) {
+  if (!slaveBus->begin(5, 6, I2C_SLAVE_CLOCK_HZ)) {
     setError(I2C_ERROR_NOT_INIT);
     Serial.println("[I2CManager] ERROR: Failed to initialize Slave Bus (GPIO5/6)");
     vSemaphoreDelete(slaveMutex);
@@ -41,12 +65,12 @@ bool I2CManager::begin() {
   }
   
   slaveBus->setTimeout(100);  // 100ms timeout for critical slave
-  Serial.println("[I2CManager] ✓ Slave Bus initialized (Wire1, GPIO5/6 @ 100kHz - ATmega328P @ 0x30)");
+  Serial.printf("[I2CManager] ✓ Slave Bus initialized (%s, GPIO5/6 @ 100kHz - ATmega328P @ 0x30)\n", slaveBus->name());
 
   // Initialize Display Bus (GPIO8/9 @ 100kHz - Wire/I2C0 - NON-CRITICAL)
   // LCD (0x27), OLED (0x3C), Seesaw (0x36), and other display devices
   // Conservative speed for reliability
-  if (!displayBus->begin(8, 9, 100000)) {
+  if (!displayBus->begin(8, 9, I2C_DISPLAY_CLOCK_HZ)) {
     setError(I2C_ERROR_NOT_INIT);
     Serial.println("[I2CManager] ERROR: Failed to initialize Display Bus (GPIO8/9)");
     slaveBus->end();
@@ -56,9 +80,26 @@ bool I2CManager::begin() {
   }
   
   displayBus->setTimeout(50);  // 50ms timeout for display (non-critical)
-  Serial.println("[I2CManager] ✓ Display Bus initialized (Wire, GPIO8/9 @ 100kHz - LCD/OLED/Seesaw)");
+  Serial.printf("[I2CManager] ✓ Display Bus initialized (%s, GPIO8/9 @ 100kHz - LCD/OLED/Seesaw)\n", displayBus->name());
+
+  slaveState = BusState();
+  slaveState.health.clockHz = I2C_SLAVE_CLOCK_HZ;
+  slaveState.health.maxClockHz = I2C_SLAVE_MAX_CLOCK_HZ;
+  slaveState.lastChangeMs = millis();
+  displayState = BusState();
+  displayState.health.clockHz = I2C_DISPLAY_CLOCK_HZ;
+  displayState.health.maxClockHz = I2C_DISPLAY_MAX_CLOCK_HZ;
+  displayState.lastChangeMs = millis();
 
   initialized = true;
+
+  // Start async workers (sync API keeps working if this fails)
+  slaveWorker.bus = I2C_BUS_SLAVE;
+  displayWorker.bus = I2C_BUS_DISPLAY;
+  if (!startWorker(slaveWorker, "i2c_slave") || !startWorker(displayWorker, "i2c_display")) {
+    Serial.println("[I2CManager] WARNING: Failed to start async bus workers");
+  }
+
   setError(I2C_OK);
   return true;
 }
@@ -68,6 +109,10 @@ void I2CManager::end() {
     return;
   }
 
+  // Stop async workers before the buses go away
+  stopWorker(slaveWorker);
+  stopWorker(displayWorker);
+
   // Stop both buses
   if (slaveBus) {
     slaveBus->end();
@@ -97,7 +142,11 @@ bool I2CManager::acquireLock(SemaphoreHandle_t mutex, uint32_t timeout_ms) {
   }
   
   TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
-  return xSemaphoreTake(mutex, ticks) == pdTRUE;
+  uint32_t start = micros();
+  bool acquired = (xSemaphoreTake(mutex, ticks) == pdTRUE);
+  I2CMetrics::getInstance().recordLockWait(mutex == slaveMutex ? I2C_BUS_SLAVE : I2C_BUS_DISPLAY,
+                                           micros() - start, acquired);
+  return acquired;
 }
 
 // Helper: Release mutex
@@ -109,34 +158,28 @@ void I2CManager::releaseLock(SemaphoreHandle_t mutex) {
 
 // Helper: Set error with detail
 void I2CManager::setError(I2CErrorCode code, uint8_t wireError) {
-  lastErrorCode = code;
-  
+  lastError.store((uint16_t)code | ((uint16_t)wireError << 8), std::memory_order_relaxed);
+}
+
+const char* I2CManager::errorMessage(I2CErrorCode code) {
   switch (code) {
-    case I2C_OK:
-      lastErrorMsg = "OK";
-      break;
-    case I2C_ERROR_TIMEOUT:
-      lastErrorMsg = "Timeout";
-      break;
-    case I2C_ERROR_NACK:
-      lastErrorMsg = "NACK (device not responding)";
-      break;
-    case I2C_ERROR_BUS_BUSY:
-      lastErrorMsg = "Bus busy";
-      break;
-    case I2C_ERROR_NOT_INIT:
-      lastErrorMsg = "Not initialized";
-      break;
-    case I2C_ERROR_INVALID_PARAM:
-      lastErrorMsg = "Invalid parameter";
-      break;
-    default:
-      lastErrorMsg = "Unknown error";
+    case I2C_OK:                  return "OK";
+    case I2C_ERROR_TIMEOUT:       return "Timeout";
+    case I2C_ERROR_NACK:          return "NACK (device not responding)";
+    case I2C_ERROR_BUS_BUSY:      return "Bus busy";
+    case I2C_ERROR_NOT_INIT:      return "Not initialized";
+    case I2C_ERROR_INVALID_PARAM: return "Invalid parameter";
+    default:                      return "Unknown error";
   }
-  
-  if (wireError) {
-    lastErrorMsg += " (Wire error: " + String(wireError) + ")";
+}
+
+String I2CManager::getLastError() {
+  uint16_t error = lastError.load(std::memory_order_relaxed);
+  String message = errorMessage((I2CErrorCode)(error & 0xFF));
+  if (error >> 8) {
+    message += " (Wire error: " + String(error >> 8) + ")";
   }
+  return message;
 }
 
 // ============================================================================
@@ -162,9 +205,7 @@ bool I2CManager::writeRegister(uint8_t address, uint8_t reg, uint8_t value,
   while (attempt <= retries) {
     uint8_t error = 0;
     
-    slaveBus->beginTransmission(address);
-    slaveBus->write(data, 2);
-    error = slaveBus->endTransmission();
+    error = busWrite(I2C_BUS_SLAVE, address, data, 2);
 
     if (error == 0) {
       success = true;
@@ -182,6 +223,7 @@ bool I2CManager::writeRegister(uint8_t address, uint8_t reg, uint8_t value,
 
     attempt++;
     if (attempt <= retries) {
+      I2CMetrics::getInstance().recordRetry(I2C_BUS_SLAVE, address);
       delay(10);  // Small delay before retry
     }
   }
@@ -209,14 +251,11 @@ bool I2CManager::readRegister(uint8_t address, uint8_t reg, uint8_t& value,
     uint8_t error = 0;
 
     // Write register address
-    slaveBus->beginTransmission(address);
-    slaveBus->write(reg);
-    error = slaveBus->endTransmission();
+    error = busWrite(I2C_BUS_SLAVE, address, &reg, 1);
 
     if (error == 0) {
       // Read value
-      if (slaveBus->requestFrom(address, (uint8_t)1) == 1) {
-        value = slaveBus->read();
+      if (busRead(I2C_BUS_SLAVE, address, &value, 1)) {
         success = true;
         setError(I2C_OK);
         break;
@@ -229,6 +268,7 @@ bool I2CManager::readRegister(uint8_t address, uint8_t reg, uint8_t& value,
 
     attempt++;
     if (attempt <= retries) {
+      I2CMetrics::getInstance().recordRetry(I2C_BUS_SLAVE, address);
       delay(10);
     }
   }
@@ -238,7 +278,7 @@ bool I2CManager::readRegister(uint8_t address, uint8_t reg, uint8_t& value,
 }
 
 bool I2CManager::readRegisterMulti(uint8_t address, uint8_t reg, uint8_t* buffer,
-                                    uint16_t length, uint16_t timeout_ms) {
+                                    uint16_t length, uint16_t timeout_ms, uint8_t retries) {
   if (!initialized || !buffer || length == 0) {
     setError(I2C_ERROR_INVALID_PARAM);
     return false;
@@ -250,23 +290,26 @@ bool I2CManager::readRegisterMulti(uint8_t address, uint8_t reg, uint8_t* buffer
   }
 
   bool success = false;
+  uint8_t attempt = 0;
 
-  // Write register address
-  slaveBus->beginTransmission(address);
-  slaveBus->write(reg);
-  if (slaveBus->endTransmission() == 0) {
-    // Read bytes
-    if (slaveBus->requestFrom(address, (uint8_t)length) == length) {
-      for (uint16_t i = 0; i < length; i++) {
-        buffer[i] = slaveBus->read();
+  while (attempt <= retries) {
+    // Write register address
+    if (busWrite(I2C_BUS_SLAVE, address, &reg, 1) == 0) {
+      // Read bytes
+      if (busRead(I2C_BUS_SLAVE, address, buffer, length)) {
+        success = true;
+        setError(I2C_OK);
+        break;
       }
-      success = true;
-      setError(I2C_OK);
     }
-  }
 
-  if (!success) {
     setError(I2C_ERROR_NACK);
+
+    attempt++;
+    if (attempt <= retries) {
+      I2CMetrics::getInstance().recordRetry(I2C_BUS_SLAVE, address);
+      delay(10);
+    }
   }
 
   releaseLock(slaveMutex);
@@ -280,62 +323,27 @@ bool I2CManager::write(uint8_t address, const uint8_t* data, uint16_t length,
     return false;
   }
 
-  Serial.printf("[I2CManager] WRITE attempt: 0x%02X, %d bytes, timeout=%dms\n", address, length, timeout_ms);
-
-  // First try slave bus (GPIO5/6)
-  Serial.println("[I2CManager] Trying slave bus (GPIO5/6)...");
-  if (!acquireLock(slaveMutex, timeout_ms)) {
-    Serial.println("[I2CManager] Slave bus MUTEX LOCKED");
-    setError(I2C_ERROR_BUS_BUSY);
-    return false;
-  }
-
-  slaveBus->beginTransmission(address);
-  size_t written = slaveBus->write(data, length);
-  uint8_t error = slaveBus->endTransmission();
-  
-  Serial.printf("[I2CManager] Slave bus: wrote=%d bytes, error=%d\n", written, error);
+  I2CBus bus = routeFor(address);
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
 
-  bool success = (error == 0);
-  releaseLock(slaveMutex);
-  
-  if (success) {
-    Serial.printf("[I2CManager] ✓ WRITE to 0x%02X SUCCEEDED on slave bus\n", address);
-    setError(I2C_OK);
-    return true;
-  }
-  
-  // If slave bus failed, try display bus as fallback
-  Serial.println("[I2CManager] Slave bus failed, trying display bus (GPIO8/9)...");
-  
-  if (!acquireLock(displayMutex, timeout_ms)) {
-    Serial.println("[I2CManager] Display bus MUTEX LOCKED");
+  if (!acquireLock(mutex, timeout_ms)) {
+    I2C_TRACE("write 0x%02X bus %d: mutex busy", address, bus);
     setError(I2C_ERROR_BUS_BUSY);
     return false;
   }
 
-  displayBus->beginTransmission(address);
-  written = displayBus->write(data, length);
-  error = displayBus->endTransmission();
+  uint8_t error = busWrite(bus, address, data, length);
+  releaseLock(mutex);
 
-  Serial.printf("[I2CManager] Display bus: wrote=%d bytes, error=%d\n", written, error);
+  I2C_TRACE("write 0x%02X bus %d: %u bytes, error=%u", address, bus, length, error);
 
-  success = (error == 0);
-  releaseLock(displayMutex);
-  
-  if (success) {
-    Serial.printf("[I2CManager] ✓ WRITE to 0x%02X SUCCEEDED on display bus!\n", address);
-  } else {
-    Serial.printf("[I2CManager] ✗ WRITE to 0x%02X FAILED on both buses\n", address);
-  }
-  
-  if (success) {
-    setError(I2C_OK);
-  } else {
+  if (error != 0) {
     setError(I2C_ERROR_NACK, error);
+    return false;
   }
 
-  return success;
+  setError(I2C_OK);
+  return true;
 }
 
 bool I2CManager::read(uint8_t address, uint8_t* buffer, uint16_t length,
@@ -345,51 +353,116 @@ bool I2CManager::read(uint8_t address, uint8_t* buffer, uint16_t length,
     return false;
   }
 
-  // TEMPORARY DEBUG: Try both buses for read
-  // First try slave bus (GPIO5/6)
-  if (!acquireLock(slaveMutex, timeout_ms)) {
+  I2CBus bus = routeFor(address);
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
+
+  if (!acquireLock(mutex, timeout_ms)) {
+    I2C_TRACE("read 0x%02X bus %d: mutex busy", address, bus);
     setError(I2C_ERROR_BUS_BUSY);
     return false;
   }
 
-  bool success = false;
-  if (slaveBus->requestFrom(address, (uint8_t)length) == length) {
-    for (uint16_t i = 0; i < length; i++) {
-      buffer[i] = slaveBus->read();
-    }
-    success = true;
-    setError(I2C_OK);
+  bool success = busRead(bus, address, buffer, length);
+  releaseLock(mutex);
+
+  I2C_TRACE("read 0x%02X bus %d: %u bytes, %s", address, bus, length, success ? "ok" : "failed");
+
+  setError(success ? I2C_OK : I2C_ERROR_NACK);
+  return success;
+}
+
+bool I2CManager::writeRead(uint8_t address, const uint8_t* txData, uint16_t txLength,
+                           uint8_t* rxBuffer, uint16_t rxLength, uint16_t timeout_ms) {
+  if (!initialized || !txData || txLength == 0 || !rxBuffer || rxLength == 0) {
+    setError(I2C_ERROR_INVALID_PARAM);
+    return false;
   }
-  releaseLock(slaveMutex);
-  
-  // If slave bus failed, try display bus as fallback
+
+  I2CBus bus = routeFor(address);
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
+
+  if (!acquireLock(mutex, timeout_ms)) {
+    I2C_TRACE("writeRead 0x%02X bus %d: mutex busy", address, bus);
+    setError(I2C_ERROR_BUS_BUSY);
+    return false;
+  }
+
+  uint8_t error = busWrite(bus, address, txData, txLength);
+  bool success = (error == 0) && busRead(bus, address, rxBuffer, rxLength);
+  releaseLock(mutex);
+
+  I2C_TRACE("writeRead 0x%02X bus %d: %u/%u bytes, %s", address, bus, txLength, rxLength,
+            success ? "ok" : "failed");
+
   if (!success) {
-    Serial.printf("[I2CManager] Read from 0x%02X failed on slave bus, trying display bus...\n", address);
-    
-    if (!acquireLock(displayMutex, timeout_ms)) {
-      setError(I2C_ERROR_BUS_BUSY);
-      return false;
-    }
+    setError(I2C_ERROR_NACK, error);
+    return false;
+  }
 
-    if (displayBus->requestFrom(address, (uint8_t)length) == length) {
-      for (uint16_t i = 0; i < length; i++) {
-        buffer[i] = displayBus->read();
-      }
-      success = true;
-      setError(I2C_OK);
+  setError(I2C_OK);
+  return true;
+}
+
+// ============================================================================
+// Device Routing
+// ============================================================================
+
+I2CBus I2CManager::routeFor(uint8_t address) {
+  if (address >= 0x80) {
+    return I2C_BUS_SLAVE;
+  }
+  uint32_t now = millis();
+  portENTER_CRITICAL(&routeMux);
+  uint8_t route = routes[address];
+  uint32_t missAt = routeMissAt[address];
+  portEXIT_CRITICAL(&routeMux);
+  if (route == I2C_ROUTE_ABSENT) {
+    if (now - missAt < I2C_ROUTE_MISS_HOLD_MS) {
+      return I2C_BUS_SLAVE;   // Recently absent from both buses: no new probe yet
     }
-    releaseLock(displayMutex);
-    
-    if (success) {
-      Serial.printf("[I2CManager] Read from 0x%02X succeeded on display bus!\n", address);
+  } else if (route != I2C_ROUTE_UNKNOWN) {
+    return (I2CBus)route;
+  }
+
+  // Discovery: the first bus that ACKs owns the address. A miss is only
+  // held for a while, the device may simply not be up yet.
+  I2CBus bus;
+  if (ping(address, I2C_BUS_SLAVE)) {
+    bus = I2C_BUS_SLAVE;
+  } else if (ping(address, I2C_BUS_DISPLAY)) {
+    bus = I2C_BUS_DISPLAY;
+  } else {
+    portENTER_CRITICAL(&routeMux);
+    if (routes[address] == I2C_ROUTE_UNKNOWN || routes[address] == I2C_ROUTE_ABSENT) {
+      routes[address] = I2C_ROUTE_ABSENT;
+      routeMissAt[address] = now;
     }
+    portEXIT_CRITICAL(&routeMux);
+    return I2C_BUS_SLAVE;
   }
-  
-  if (!success) {
-    setError(I2C_ERROR_NACK);
+
+  setRoute(address, bus);
+  Serial.printf("[I2CManager] Learned route 0x%02X -> %s\n", address,
+                bus == I2C_BUS_SLAVE ? slaveBus->name() : displayBus->name());
+  return bus;
+}
+
+void I2CManager::setRoute(uint8_t address, I2CBus bus) {
+  if (address < 0x80) {
+    portENTER_CRITICAL(&routeMux);
+    routes[address] = bus;
+    portEXIT_CRITICAL(&routeMux);
   }
+}
 
-  return success;
+bool I2CManager::hasRoute(uint8_t address) {
+  if (address >= 0x80) {
+    return false;
+  }
+  portENTER_CRITICAL(&routeMux);
+  bool known = routes[address] != I2C_ROUTE_UNKNOWN && routes[address] != I2C_ROUTE_ABSENT;
+  portEXIT_CRITICAL(&routeMux);
+  return known;
 }
 
 // ============================================================================
@@ -406,9 +479,7 @@ bool I2CManager::displayWrite(uint8_t address, const uint8_t* data,
     return false;  // Fail silently for display
   }
 
-  displayBus->beginTransmission(address);
-  displayBus->write(data, length);
-  uint8_t error = displayBus->endTransmission();
+  uint8_t error = busWrite(I2C_BUS_DISPLAY, address, data, length);
 
   bool success = (error == 0);
   releaseLock(displayMutex);
@@ -426,10 +497,7 @@ bool I2CManager::displayRead(uint8_t address, uint8_t* buffer,
   }
 
   bool success = false;
-  if (displayBus->requestFrom(address, (uint8_t)length) == length) {
-    for (uint16_t i = 0; i < length; i++) {
-      buffer[i] = displayBus->read();
-    }
+  if (busRead(I2C_BUS_DISPLAY, address, buffer, length)) {
     success = true;
   }
 
@@ -437,29 +505,422 @@ bool I2CManager::displayRead(uint8_t address, uint8_t* buffer,
   return success;
 }
 
+// ============================================================================
+// Async Transaction Queue
+// ============================================================================
+
+bool I2CManager::startWorker(BusWorker& worker, const char* name) {
+  worker.highQueue = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(I2CTransaction));
+  worker.normalQueue = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(I2CTransaction));
+  worker.pending = xSemaphoreCreateCounting(I2C_QUEUE_DEPTH * 2, 0);
+
+  if (!worker.highQueue || !worker.normalQueue || !worker.pending) {
+    stopWorker(worker);
+    return false;
+  }
+
+  if (xTaskCreatePinnedToCore(workerTask, name, I2C_WORKER_STACK, &worker,
+                              I2C_WORKER_PRIORITY, &worker.task, I2C_WORKER_CORE) != pdPASS) {
+    worker.task = nullptr;
+    stopWorker(worker);
+    return false;
+  }
+
+  return true;
+}
+
+void I2CManager::stopWorker(BusWorker& worker) {
+  if (worker.task) {
+    vTaskDelete(worker.task);
+    worker.task = nullptr;
+  }
+  if (worker.highQueue) {
+    vQueueDelete(worker.highQueue);
+    worker.highQueue = nullptr;
+  }
+  if (worker.normalQueue) {
+    vQueueDelete(worker.normalQueue);
+    worker.normalQueue = nullptr;
+  }
+  if (worker.pending) {
+    vSemaphoreDelete(worker.pending);
+    worker.pending = nullptr;
+  }
+}
+
+void I2CManager::workerTask(void* param) {
+  BusWorker& worker = *static_cast<BusWorker*>(param);
+  I2CManager& manager = I2CManager::getInstance();
+  I2CTransaction txn;
+
+  for (;;) {
+    // One semaphore count per queued transaction
+    if (xSemaphoreTake(worker.pending, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    // High priority queue always drains first
+    if (xQueueReceive(worker.highQueue, &txn, 0) != pdTRUE &&
+        xQueueReceive(worker.normalQueue, &txn, 0) != pdTRUE) {
+      continue;
+    }
+
+    I2CErrorCode result;
+    if (txn.deadline_ms != 0 && (int32_t)(millis() - txn.deadline_ms) > 0) {
+      // Stale (e.g. an old display frame) - drop without touching the bus
+      result = I2C_ERROR_TIMEOUT;
+      worker.stats.dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      result = manager.executeTransaction(txn);
+      if (result == I2C_OK) {
+        worker.stats.completed.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        worker.stats.failed.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    if (txn.callback) {
+      txn.callback(txn, result, txn.context);
+    }
+  }
+}
+
+I2CErrorCode I2CManager::executeTransaction(const I2CTransaction& txn) {
+  bool isSlave = (txn.bus == I2C_BUS_SLAVE);
+  SemaphoreHandle_t mutex = isSlave ? slaveMutex : displayMutex;
+
+  if (!acquireLock(mutex, isSlave ? 100 : 50)) {
+    return I2C_ERROR_BUS_BUSY;
+  }
+
+  I2CErrorCode result = I2C_ERROR_NACK;
+
+  for (uint8_t attempt = 0; attempt <= txn.retries; attempt++) {
+    if (attempt > 0) {
+      I2CMetrics::getInstance().recordRetry(txn.bus, txn.address);
+      delay(10);
+    }
+
+    if (txn.type != I2C_TXN_READ) {
+      if (busWrite(txn.bus, txn.address, txn.txData, txn.txLength) != 0) {
+        continue;
+      }
+      if (txn.type == I2C_TXN_WRITE) {
+        result = I2C_OK;
+        break;
+      }
+    }
+
+    if (busRead(txn.bus, txn.address, txn.rxBuffer, txn.rxLength)) {
+      result = I2C_OK;
+      break;
+    }
+  }
+
+  releaseLock(mutex);
+  return result;
+}
+
+bool I2CManager::submit(const I2CTransaction& txn, uint32_t queueTimeout_ms) {
+  BusWorker& worker = (txn.bus == I2C_BUS_SLAVE) ? slaveWorker : displayWorker;
+
+  if (!initialized || !worker.task) {
+    return false;
+  }
+  if (txn.txLength > I2C_TXN_MAX_DATA ||
+      (txn.type != I2C_TXN_READ && txn.txLength == 0) ||
+      (txn.type != I2C_TXN_WRITE && (!txn.rxBuffer || txn.rxLength == 0))) {
+    return false;
+  }
+
+  QueueHandle_t queue = (txn.priority == I2C_PRIORITY_HIGH) ? worker.highQueue : worker.normalQueue;
+  if (xQueueSend(queue, &txn, pdMS_TO_TICKS(queueTimeout_ms)) != pdTRUE) {
+    worker.stats.rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  worker.stats.submitted.fetch_add(1, std::memory_order_relaxed);
+  xSemaphoreGive(worker.pending);
+  return true;
+}
+
+bool I2CManager::submitWriteRegister(uint8_t address, uint8_t reg, uint8_t value,
+                                     I2CTransactionPriority priority,
+                                     I2CCompletionCallback callback, void* context) {
+  I2CTransaction txn;
+  txn.type = I2C_TXN_WRITE;
+  txn.priority = priority;
+  txn.bus = I2C_BUS_SLAVE;
+  txn.address = address;
+  txn.txData[0] = reg;
+  txn.txData[1] = value;
+  txn.txLength = 2;
+  txn.retries = 2;
+  txn.callback = callback;
+  txn.context = context;
+  return submit(txn);
+}
+
+I2CManager::QueueStats I2CManager::getQueueStats(I2CBus bus) {
+  return ((bus == I2C_BUS_SLAVE) ? slaveWorker.stats : displayWorker.stats).snapshot();
+}
+
+I2CManager::QueueStats I2CManager::AtomicQueueStats::snapshot() const {
+  QueueStats copy;
+  copy.submitted = submitted.load(std::memory_order_relaxed);
+  copy.completed = completed.load(std::memory_order_relaxed);
+  copy.failed = failed.load(std::memory_order_relaxed);
+  copy.dropped = dropped.load(std::memory_order_relaxed);
+  copy.rejected = rejected.load(std::memory_order_relaxed);
+  return copy;
+}
+
+// ============================================================================
+// Bus Recovery & Clock Negotiation
+// ============================================================================
+
+// Devices that must keep ACKing before a faster clock is accepted
+static const uint8_t SLAVE_PROBE_ADDRESSES[] = {0x30};                     // ATmega328P
+static const uint8_t DISPLAY_PROBE_ADDRESSES[] = {0x3C, LCD_I2C_ADDRESS, 0x36, 0x38}; // OLED, LCD, Seesaw, AHT10
+
+// Fastest clock a device handles (bus ceiling if it is Fast-mode)
+static uint32_t deviceMaxClock(uint8_t address, uint32_t busMax) {
+  if (address == LCD_I2C_ADDRESS) {
+    return min<uint32_t>(busMax, I2C_PCF8574_MAX_CLOCK_HZ);  // Drops bits above 100 kHz but still ACKs
+  }
+  return busMax;
+}
+
+uint8_t I2CManager::busWrite(I2CBus bus, uint8_t address, const uint8_t* data, size_t length) {
+  I2CBusBackend* backend = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
+  uint8_t error = backend->write(address, data, length);
+  if (error == 0) {
+    ((bus == I2C_BUS_SLAVE) ? slaveState : displayState).consecutiveFaults = 0;
+  } else {
+    onBusFault(bus, error);
+  }
+  return error;
+}
+
+bool I2CManager::busRead(I2CBus bus, uint8_t address, uint8_t* buffer, size_t length) {
+  I2CBusBackend* backend = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
+  if (backend->read(address, buffer, length) == length) {
+    ((bus == I2C_BUS_SLAVE) ? slaveState : displayState).consecutiveFaults = 0;
+    return true;
+  }
+  onBusFault(bus, 2);  // requestFrom() gives no error code, treat as NACK
+  return false;
+}
+
+void I2CManager::onBusFault(I2CBus bus, uint8_t wireError) {
+  I2CBusBackend* backend = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
+  BusState& state = (bus == I2C_BUS_SLAVE) ? slaveState : displayState;
+
+  // A NACK from an absent device is normal (scan, ping) unless a line is held low
+  bool lineStuck = backend->isLineStuck();
+  if ((wireError == 2 || wireError == 3) && !lineStuck) {
+    return;
+  }
+
+  state.health.faults++;
+  state.consecutiveFaults++;
+
+  if (lineStuck || state.consecutiveFaults >= I2C_RECOVERY_FAULT_THRESHOLD) {
+    recoverBus(bus, lineStuck);
+  }
+}
+
+void I2CManager::recoverBus(I2CBus bus, bool lineStuck) {
+  I2CBusBackend* backend = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
+  BusState& state = (bus == I2C_BUS_SLAVE) ? slaveState : displayState;
+
+  bool released = backend->recover();
+  state.health.recoveries++;
+  state.health.lastRecoveryMs = millis();
+  state.consecutiveFaults = 0;
+
+  // Back off one step and wait longer before probing upward again
+  uint32_t slower = state.health.clockHz / 2;
+  if (slower < I2C_MIN_CLOCK_HZ) {
+    slower = I2C_MIN_CLOCK_HZ;
+  }
+  applyClock(bus, slower);
+  state.probeHoldoffMs = min<uint32_t>(state.probeHoldoffMs * 2, I2C_CLOCK_PROBE_MAX_HOLDOFF_MS);
+
+  Serial.printf("[I2CManager] Bus recovery on %s (%s, SDA %s), clock now %lu Hz\n",
+                backend->name(), lineStuck ? "line held low" : "repeated faults",
+                released ? "released" : "STILL LOW", (unsigned long)state.health.clockHz);
+}
+
+bool I2CManager::applyClock(I2CBus bus, uint32_t frequency) {
+  I2CBusBackend* backend = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
+  BusState& state = (bus == I2C_BUS_SLAVE) ? slaveState : displayState;
+
+  state.lastChangeMs = millis();
+  state.faultsAtLastChange = state.health.faults;
+
+  if (frequency == state.health.clockHz) {
+    return true;
+  }
+  if (!backend->setClock(frequency)) {
+    return false;
+  }
+  state.health.clockHz = frequency;
+  state.health.clockChanges++;
+  return true;
+}
+
+void I2CManager::probeClockUp(I2CBus bus) {
+  I2CBusBackend* backend = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
+  BusState& state = (bus == I2C_BUS_SLAVE) ? slaveState : displayState;
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
+  const uint8_t* candidates = (bus == I2C_BUS_SLAVE) ? SLAVE_PROBE_ADDRESSES : DISPLAY_PROBE_ADDRESSES;
+  uint8_t candidateCount = (bus == I2C_BUS_SLAVE) ? sizeof(SLAVE_PROBE_ADDRESSES) : sizeof(DISPLAY_PROBE_ADDRESSES);
+
+  if (!acquireLock(mutex, 10)) {
+    return;  // Busy, try again next maintain()
+  }
+
+  // Only devices that ACK at the current rate count as evidence; the
+  // slowest of them caps the step
+  uint8_t present[sizeof(DISPLAY_PROBE_ADDRESSES)];
+  uint8_t presentCount = 0;
+  uint32_t ceiling = state.health.maxClockHz;
+  for (uint8_t i = 0; i < candidateCount; i++) {
+    if (backend->write(candidates[i], nullptr, 0) == 0) {
+      present[presentCount++] = candidates[i];
+      ceiling = deviceMaxClock(candidates[i], ceiling);
+    }
+  }
+
+  uint32_t previous = state.health.clockHz;
+  if (ceiling < previous) {
+    // A slow device appeared after a step-up
+    applyClock(bus, ceiling);
+    Serial.printf("[I2CManager] %s clock lowered to %lu Hz for a Standard-mode device\n",
+                  backend->name(), (unsigned long)ceiling);
+    releaseLock(mutex);
+    return;
+  }
+  if (presentCount == 0 || ceiling == previous) {
+    applyClock(bus, previous);  // Nothing to validate against or already capped, restart holdoff
+    releaseLock(mutex);
+    return;
+  }
+
+  uint32_t faster = min<uint32_t>(previous * 2, ceiling);
+  applyClock(bus, faster);
+
+  bool ok = true;
+  for (uint8_t n = 0; n < I2C_CLOCK_PROBE_PINGS && ok; n++) {
+    for (uint8_t i = 0; i < presentCount && ok; i++) {
+      ok = (backend->write(present[i], nullptr, 0) == 0);
+    }
+  }
+  if (ok && backend->isLineStuck()) {
+    ok = false;
+  }
+
+  if (ok) {
+    state.probeHoldoffMs = I2C_CLOCK_PROBE_INTERVAL_MS;
+    Serial.printf("[I2CManager] %s clock raised to %lu Hz\n", backend->name(), (unsigned long)faster);
+  } else {
+    if (backend->isLineStuck()) {
+      backend->recover();
+      state.health.recoveries++;
+      state.health.lastRecoveryMs = millis();
+    }
+    applyClock(bus, previous);
+    state.probeHoldoffMs = min<uint32_t>(state.probeHoldoffMs * 2, I2C_CLOCK_PROBE_MAX_HOLDOFF_MS);
+    Serial.printf("[I2CManager] %s failed at %lu Hz, staying at %lu Hz\n",
+                  backend->name(), (unsigned long)faster, (unsigned long)previous);
+  }
+
+  releaseLock(mutex);
+}
+
+void I2CManager::maintain() {
+  if (!initialized) {
+    return;
+  }
+
+  uint32_t now = millis();
+  if (now - lastMaintainMs < 1000) {
+    return;
+  }
+  lastMaintainMs = now;
+
+  const I2CBus buses[] = {I2C_BUS_SLAVE, I2C_BUS_DISPLAY};
+  for (I2CBus bus : buses) {
+    BusState& state = (bus == I2C_BUS_SLAVE) ? slaveState : displayState;
+
+    if (state.health.faults != state.faultsAtLastChange) {
+      // Faults since the last change restart the fault-free window
+      state.lastChangeMs = now;
+      state.faultsAtLastChange = state.health.faults;
+      continue;
+    }
+    if (state.health.clockHz >= state.health.maxClockHz ||
+        now - state.lastChangeMs < state.probeHoldoffMs) {
+      continue;
+    }
+
+    probeClockUp(bus);
+  }
+}
+
+I2CManager::BusHealth I2CManager::getBusHealth(I2CBus bus) {
+  return (bus == I2C_BUS_SLAVE) ? slaveState.health : displayState.health;
+}
+
+bool I2CManager::setMaxClock(I2CBus bus, uint32_t frequency) {
+  BusState& state = (bus == I2C_BUS_SLAVE) ? slaveState : displayState;
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
+
+  if (!initialized || frequency < I2C_MIN_CLOCK_HZ || !acquireLock(mutex, 100)) {
+    return false;
+  }
+
+  bool ok = true;
+  state.health.maxClockHz = frequency;
+  if (state.health.clockHz > frequency) {
+    ok = applyClock(bus, frequency);
+  }
+  releaseLock(mutex);
+
+  Serial.printf("[I2CManager] %s clock ceiling %lu Hz\n",
+                (bus == I2C_BUS_SLAVE) ? slaveBus->name() : displayBus->name(),
+                (unsigned long)frequency);
+  return ok;
+}
+
 // ============================================================================
 // Diagnostics & Health
 // ============================================================================
 
-bool I2CManager::scanBus(uint8_t* foundAddresses, uint8_t maxDevices, uint8_t& count) {
+bool I2CManager::scanBus(uint8_t* foundAddresses, uint8_t maxDevices, uint8_t& count,
+                         I2CBus bus) {
   if (!initialized || !foundAddresses) {
     setError(I2C_ERROR_INVALID_PARAM);
     return false;
   }
 
-  if (!acquireLock(slaveMutex, 1000)) {
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
+  if (!acquireLock(mutex, 1000)) {
     setError(I2C_ERROR_BUS_BUSY);
     return false;
   }
 
   count = 0;
-  Serial.println("[I2CManager] Scanning bus...");
+  Serial.printf("[I2CManager] Scanning %s...\n", (bus == I2C_BUS_SLAVE) ? slaveBus->name() : displayBus->name());
 
   for (uint8_t addr = 0x03; addr <= 0x77; addr++) {
-    slaveBus->beginTransmission(addr);
-    uint8_t error = slaveBus->endTransmission();
+    uint8_t error = busWrite(bus, addr, nullptr, 0);
 
     if (error == 0) {
+      if (!hasRoute(addr)) {
+        setRoute(addr, bus);
+      }
       if (count < maxDevices) {
         foundAddresses[count] = addr;
         Serial.printf("[I2CManager] Found device at 0x%02X\n", addr);
@@ -468,7 +929,7 @@ bool I2CManager::scanBus(uint8_t* foundAddresses, uint8_t maxDevices, uint8_t& c
     }
   }
 
-  releaseLock(slaveMutex);
+  releaseLock(mutex);
   setError(I2C_OK);
   return true;
 }
@@ -478,20 +939,58 @@ bool I2CManager::ping(uint8_t address, I2CBus bus) {
     return false;
   }
 
-  TwoWire* wire = (bus == I2C_BUS_SLAVE) ? slaveBus : displayBus;
   SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
 
   if (!acquireLock(mutex, 100)) {
     return false;
   }
 
-  wire->beginTransmission(address);
-  uint8_t error = wire->endTransmission();
+  uint8_t error = busWrite(bus, address, nullptr, 0);
 
   releaseLock(mutex);
   return (error == 0);
 }
 
+bool I2CManager::waitForAck(uint8_t address, uint32_t timeout_ms, uint32_t* waitedUs) {
+  if (!initialized) {
+    setError(I2C_ERROR_NOT_INIT);
+    return false;
+  }
+
+  I2CBus bus = routeFor(address);
+  SemaphoreHandle_t mutex = (bus == I2C_BUS_SLAVE) ? slaveMutex : displayMutex;
+  uint32_t start = micros();
+
+  for (;;) {
+    // Lock per probe so other users of the bus are not starved by a long wait
+    if (acquireLock(mutex, 100)) {
+      uint8_t error = busWrite(bus, address, nullptr, 0);
+      releaseLock(mutex);
+      if (error == 0) {
+        if (waitedUs) {
+          *waitedUs = micros() - start;
+        }
+        setError(I2C_OK);
+        return true;
+      }
+    }
+
+    uint32_t elapsed = micros() - start;
+    if (elapsed >= timeout_ms * 1000UL) {
+      break;
+    }
+    if (elapsed < I2C_ACK_POLL_SPIN_US) {
+      delayMicroseconds(I2C_ACK_POLL_INTERVAL_US);
+    } else {
+      delay(I2C_ACK_POLL_SLOW_MS);
+    }
+  }
+
+  I2C_TRACE("waitForAck 0x%02X: no ACK within %lu ms", address, (unsigned long)timeout_ms);
+  setError(I2C_ERROR_TIMEOUT);
+  return false;
+}
+
 bool I2CManager::isSlaveBusHealthy() {
   return ping(0x30, I2C_BUS_SLAVE);  // Ping slave controller
 }
@@ -0,0 +1,187 @@
+#include "i2c_metrics.h"
+
+// ============================================================================
+// Latency histogram
+// ============================================================================
+
+uint16_t I2CLatencyHistogram::bucketFor(uint32_t valueUs) {
+  if (valueUs < SUB_BUCKETS) {
+    return valueUs;
+  }
+
+  uint8_t exponent = 31 - __builtin_clz(valueUs);  // Position of highest set bit (>= 3)
+  if (exponent > I2C_HIST_MAX_EXPONENT) {
+    return BUCKET_COUNT - 1;
+  }
+
+  uint8_t sub = (valueUs >> (exponent - I2C_HIST_SUB_BITS)) & (SUB_BUCKETS - 1);
+  return (exponent - I2C_HIST_SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint32_t I2CLatencyHistogram::bucketLowerBound(uint16_t bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+
+  uint8_t exponent = bucket / SUB_BUCKETS + I2C_HIST_SUB_BITS - 1;
+  uint8_t sub = bucket % SUB_BUCKETS;
+  return (uint32_t)(SUB_BUCKETS + sub) << (exponent - I2C_HIST_SUB_BITS);
+}
+
+void I2CLatencyHistogram::record(uint32_t valueUs) {
+  buckets[bucketFor(valueUs)].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+
+  uint32_t current = maxValue.load(std::memory_order_relaxed);
+  while (valueUs > current &&
+         !maxValue.compare_exchange_weak(current, valueUs, std::memory_order_relaxed)) {
+  }
+}
+
+void I2CLatencyHistogram::reset() {
+  for (uint16_t i = 0; i < BUCKET_COUNT; i++) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+  count.store(0, std::memory_order_relaxed);
+  maxValue.store(0, std::memory_order_relaxed);
+}
+
+uint32_t I2CLatencyHistogram::percentile(float pct) const {
+  uint32_t total = getCount();
+  if (total == 0) {
+    return 0;
+  }
+
+  uint32_t target = (uint32_t)((pct / 100.0f) * total + 0.5f);
+  if (target == 0) {
+    target = 1;
+  }
+
+  uint32_t seen = 0;
+  for (uint16_t i = 0; i < BUCKET_COUNT; i++) {
+    seen += buckets[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      // Report the bucket's upper edge, but never more than the observed max
+      uint32_t upper = (i + 1 < BUCKET_COUNT) ? bucketLowerBound(i + 1) - 1 : getMax();
+      uint32_t maxSeen = getMax();
+      return (upper < maxSeen) ? upper : maxSeen;
+    }
+  }
+  return getMax();
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+I2CAddressMetrics* I2CMetrics::slotFor(uint8_t bus, uint8_t address) {
+  if (bus >= I2C_METRICS_BUS_COUNT || address == 0) {
+    return nullptr;
+  }
+
+  I2CAddressMetrics* slots = buses[bus].addresses;
+  for (uint8_t i = 0; i < I2C_METRICS_ADDR_SLOTS; i++) {
+    uint8_t current = slots[i].address.load(std::memory_order_relaxed);
+    if (current == address) {
+      return &slots[i];
+    }
+    if (current == 0) {
+      // Claim free slot; if another task won the race, check what it stored
+      uint8_t expected = 0;
+      if (slots[i].address.compare_exchange_strong(expected, address, std::memory_order_relaxed) ||
+          expected == address) {
+        return &slots[i];
+      }
+    }
+  }
+  return nullptr;
+}
+
+void I2CMetrics::recordWrite(uint8_t bus, uint8_t address, size_t length,
+                             uint8_t wireError, uint32_t elapsedUs) {
+  if (bus >= I2C_METRICS_BUS_COUNT) {
+    return;
+  }
+  buses[bus].writeLatency.record(elapsedUs);
+
+  I2CAddressMetrics* slot = slotFor(bus, address);
+  if (!slot) {
+    buses[bus].untracked.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  slot->transactions.fetch_add(1, std::memory_order_relaxed);
+  switch (wireError) {
+    case 0:
+      slot->bytes.fetch_add(length, std::memory_order_relaxed);
+      break;
+    case 2:
+    case 3:
+      slot->nacks.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case 5:
+      slot->timeouts.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:
+      slot->errors.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void I2CMetrics::recordRead(uint8_t bus, uint8_t address, size_t requested,
+                            size_t received, uint32_t elapsedUs) {
+  if (bus >= I2C_METRICS_BUS_COUNT) {
+    return;
+  }
+  buses[bus].readLatency.record(elapsedUs);
+
+  I2CAddressMetrics* slot = slotFor(bus, address);
+  if (!slot) {
+    buses[bus].untracked.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  slot->transactions.fetch_add(1, std::memory_order_relaxed);
+  slot->bytes.fetch_add(received, std::memory_order_relaxed);
+  if (received < requested) {
+    // requestFrom() does not distinguish NACK from timeout
+    slot->nacks.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void I2CMetrics::recordRetry(uint8_t bus, uint8_t address) {
+  I2CAddressMetrics* slot = slotFor(bus, address);
+  if (slot) {
+    slot->retries.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void I2CMetrics::recordLockWait(uint8_t bus, uint32_t waitUs, bool acquired) {
+  if (bus >= I2C_METRICS_BUS_COUNT) {
+    return;
+  }
+  if (acquired) {
+    buses[bus].lockWait.record(waitUs);
+  } else {
+    buses[bus].lockTimeouts.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void I2CMetrics::reset() {
+  for (uint8_t b = 0; b < I2C_METRICS_BUS_COUNT; b++) {
+    I2CBusMetrics& m = buses[b];
+    for (uint8_t i = 0; i < I2C_METRICS_ADDR_SLOTS; i++) {
+      I2CAddressMetrics& a = m.addresses[i];
+      a.transactions.store(0, std::memory_order_relaxed);
+      a.bytes.store(0, std::memory_order_relaxed);
+      a.nacks.store(0, std::memory_order_relaxed);
+      a.timeouts.store(0, std::memory_order_relaxed);
+      a.errors.store(0, std::memory_order_relaxed);
+      a.retries.store(0, std::memory_order_relaxed);
+    }
+    m.untracked.store(0, std::memory_order_relaxed);
+    m.writeLatency.reset();
+    m.readLatency.reset();
+    m.lockWait.reset();
+    m.lockTimeouts.store(0, std::memory_order_relaxed);
+  }
+}
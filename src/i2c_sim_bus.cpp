@@ -0,0 +1,618 @@
+#include "i2c_sim_bus.h"
+
+#ifdef I2C_SIM_BUS
+
+#include "config.h"
+#include "slave_controller.h"
+#include "md11_slave_update.h"
+#include "ms11_frame.h"
+
+// ============================================================================
+// SimBus
+// ============================================================================
+
+SimBus& SimBus::slaveInstance() {
+  static SimBus bus("SimBus-slave");
+  static bool populated = false;
+  if (!populated) {
+    bus.attach(&slaveDevice());
+    populated = true;
+  }
+  return bus;
+}
+
+SimAtmega328& SimBus::slaveDevice() {
+  static SimAtmega328 atmega;
+  return atmega;
+}
+
+SimBus& SimBus::displayInstance() {
+  static SimBus bus("SimBus-display");
+  static SimPCF8574 lcd;
+  static SimSSD1306 oled;
+  static SimAHT10 aht10;
+  static SimSeesaw seesaw;
+  static SimADS1110 probe(0x48);
+  static bool populated = false;
+  if (!populated) {
+    bus.attach(&lcd);
+    bus.attach(&oled);
+    bus.attach(&aht10);
+    bus.attach(&seesaw);
+    bus.attach(&probe);
+    populated = true;
+  }
+  return bus;
+}
+
+bool SimBus::attach(SimDevice* device) {
+  if (!device || deviceCount >= MAX_DEVICES) {
+    return false;
+  }
+  devices[deviceCount++] = device;
+  return true;
+}
+
+bool SimBus::begin(int sda, int scl, uint32_t frequency) {
+  clockHz = frequency ? frequency : 100000;
+  running = true;
+  return true;
+}
+
+bool SimBus::setClock(uint32_t frequency) {
+  if (frequency == 0) {
+    return false;
+  }
+  clockHz = frequency;
+  return true;
+}
+
+SimDevice* SimBus::find(uint8_t address) {
+  for (uint8_t i = 0; i < deviceCount; i++) {
+    if (devices[i]->respondsTo(address)) {
+      return devices[i];
+    }
+  }
+  return nullptr;
+}
+
+void SimBus::charge(size_t bytes) {
+  // START + address byte + payload (9 bits each incl. ACK) + STOP
+  uint32_t bits = (uint32_t)(bytes + 1) * 9 + 2;
+  stats.transactions++;
+  stats.bytes += bytes;
+  stats.busTimeUs += ((uint64_t)bits * 1000000ULL) / clockHz;
+}
+
+bool SimBus::recover() {
+  stuck = false;
+  stats.recoveries++;
+  return true;
+}
+
+uint8_t SimBus::write(uint8_t address, const uint8_t* data, size_t length, bool sendStop) {
+  if (!running) {
+    return 4;
+  }
+  if (stuck) {
+    return 5;  // SDA held low - peripheral times out
+  }
+
+  SimDevice* device = find(address);
+  if (!device) {
+    charge(0);
+    stats.nacks++;
+    return 2;  // NACK on address
+  }
+
+  charge(length);
+  if (!device->onWrite(address, data, length)) {
+    stats.nacks++;
+    return 3;  // NACK on data
+  }
+  return 0;
+}
+
+size_t SimBus::read(uint8_t address, uint8_t* buffer, size_t length, bool sendStop) {
+  if (!running || stuck) {
+    return 0;
+  }
+
+  SimDevice* device = find(address);
+  if (!device) {
+    charge(0);
+    stats.nacks++;
+    return 0;
+  }
+
+  size_t count = device->onRead(address, buffer, length);
+  charge(count);
+  return count;
+}
+
+void SimBus::printStats() const {
+  Serial.printf("[SimBus] %s: %lu transactions, %lu bytes, %lu NACKs, %lu recoveries, %.2f ms bus time @ %lu Hz\n",
+                label, (unsigned long)stats.transactions, (unsigned long)stats.bytes,
+                (unsigned long)stats.nacks, (unsigned long)stats.recoveries,
+                stats.busTimeUs / 1000.0, (unsigned long)clockHz);
+}
+
+// ============================================================================
+// SimAtmega328 - MS11-control app (0x30) + twiboot (0x14)
+// ============================================================================
+
+SimAtmega328::SimAtmega328() {
+  memset(regs, 0, sizeof(regs));
+  memset(flash, 0xFF, sizeof(flash));
+  memset(eeprom, 0xFF, sizeof(eeprom));
+
+  regs[REG_FW_VERSION] = 0x61;
+  regs[REG_PROTOCOL_VER] = ms11::PROTOCOL_V3;
+  regs[REG_MIN_MASTER_VER] = 0x10;
+  regs[REG_DISPLAY_ENABLED] = 1;
+  regs[REG_SYS_TEMP_ALARM] = 70;
+  regs[ms11::EventFlags::address] = ms11::EVENT_RESET;  // Power-on
+
+  // 2026.2.14.05 (major little-endian, patch/build nibbles)
+  version[0] = 2026 & 0xFF;
+  version[1] = 2026 >> 8;
+  version[2] = 2;
+  version[3] = (1 << 4) | 5;
+
+  setOvenTemp(21);
+  setSystemTemp(22 * 256);
+}
+
+bool SimAtmega328::respondsTo(uint8_t address) const {
+  if (!connected) {
+    return false;
+  }
+  if (bootloader && programming && (int32_t)(micros() - busyUntilUs) < 0) {
+    return false;  // CPU halted by the page erase/write
+  }
+  return bootloader ? (address == TWIBOOT_I2C_ADDR) : (address == SLAVE_I2C_ADDR);
+}
+
+void SimAtmega328::setOvenTemp(int16_t value) {
+  int16_t previous = ms11::OvenTemp::decode(regs);
+  regs[REG_OVEN_TEMP_H] = (uint16_t)value >> 8;
+  regs[REG_OVEN_TEMP_L] = value & 0xFF;
+  if (value != previous) {
+    raiseEvent(ms11::EVENT_TEMP);
+  }
+}
+
+void SimAtmega328::setSystemTemp(int16_t q8_8) {
+  int16_t previous = ms11::SysTemp::decode(regs);
+  regs[REG_SYS_TEMP_H] = (uint16_t)q8_8 >> 8;
+  regs[REG_SYS_TEMP_L] = q8_8 & 0xFF;
+  if (abs(q8_8 - previous) >= 256) {
+    raiseEvent(ms11::EVENT_TEMP);  // Same 1 °C threshold as the firmware
+  }
+}
+
+void SimAtmega328::setProtocolVersion(uint8_t version) {
+  regs[REG_PROTOCOL_VER] = version;
+  framed = false;
+}
+
+void SimAtmega328::setErrorCode(uint8_t code) {
+  uint8_t previous = regs[REG_STATUS];
+  regs[REG_STATUS] = (regs[REG_STATUS] & ~STATUS_ERROR_MASK) | ((code & 0x0F) << STATUS_ERROR_SHIFT);
+  if (code != 0) {
+    // Safety shutdown, as the firmware does for overtemp/flame-out
+    regs[REG_STATUS] &= ~(STATUS_IGNITER_BIT | STATUS_AUGER_BIT);
+  }
+  if (regs[REG_STATUS] != previous) {
+    raiseEvent(ms11::EVENT_FAULT | ms11::EVENT_STATUS);
+  }
+}
+
+void SimAtmega328::raiseEvent(uint8_t flags) {
+  regs[ms11::EventFlags::address] |= flags;
+  if (attentionHandler && isAttentionAsserted()) {
+    attentionHandler(attentionContext);
+  }
+}
+
+void SimAtmega328::simulateReset() {
+  regs[REG_STATUS] &= STATUS_ERROR_MASK;
+  regs[REG_FAN_PERCENT] = 0;
+  regs[REG_FAN_SPEED] = 0;
+  ledOn = false;
+  framed = false;
+  framedRead = false;
+  regPointer = 0;
+  raiseEvent(ms11::EVENT_RESET);
+}
+
+void SimAtmega328::loadFlash(uint16_t address, const uint8_t* data, size_t length) {
+  size_t count = (address < BOOTLOADER_START) ? min(length, (size_t)(BOOTLOADER_START - address)) : 0;
+  memcpy(flash + address, data, count);
+}
+
+void SimAtmega328::powerFailAfterPages(uint32_t pages) {
+  powerFailAt = pages ? pageWrites + pages : 0;
+}
+
+bool SimAtmega328::onWrite(uint8_t address, const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return true;  // Address probe
+  }
+  return bootloader ? bootWrite(data, length) : appWrite(data, length);
+}
+
+size_t SimAtmega328::onRead(uint8_t address, uint8_t* buffer, size_t length) {
+  if (bootloader) {
+    return bootRead(buffer, length);
+  }
+
+  // Framed response: seq payload pec
+  uint8_t* payload = buffer;
+  size_t payloadLength = length;
+  bool frame = framed && framedRead && length >= ms11::FRAME_READ_OVERHEAD;
+  if (frame) {
+    buffer[0] = responseSeq;
+    payload = buffer + 1;
+    payloadLength = length - ms11::FRAME_READ_OVERHEAD;
+  }
+
+  if (regPointer == REG_GET_VERSION_FULL) {
+    // Full version is a 4-byte value behind a single register
+    payloadLength = min(payloadLength, sizeof(version));
+    memcpy(payload, version, payloadLength);
+  } else {
+    // Sequential read with auto-increment; EventFlags clears once read
+    for (size_t i = 0; i < payloadLength; i++) {
+      uint8_t reg = regPointer++;
+      payload[i] = regs[reg];
+      if (reg == ms11::EventFlags::address) {
+        regs[reg] = 0;
+      }
+    }
+  }
+
+  if (!frame) {
+    return payloadLength;
+  }
+  buffer[1 + payloadLength] = ms11::crc8(buffer, 1 + payloadLength,
+                                         ms11::crc8Update(0, (SLAVE_I2C_ADDR << 1) | 1));
+  if (corruptResponses > 0) {
+    corruptResponses--;
+    buffer[1] ^= 0x01;  // Line glitch
+  }
+  return payloadLength + ms11::FRAME_READ_OVERHEAD;
+}
+
+bool SimAtmega328::appWrite(const uint8_t* data, size_t length) {
+  if (framed && ms11::isSequence(data[0])) {
+    return framedWrite(data, length);
+  }
+
+  regPointer = data[0];
+  framedRead = false;
+
+  // Bootloader entry: 0x99 + magic 0xB0 (accepted unframed in every mode)
+  if (regPointer == 0x99) {
+    if (length >= 2 && data[1] == 0xB0) {
+      bootloader = true;
+      framed = false;
+      bootCmd = 0;
+      return true;
+    }
+    return false;
+  }
+
+  // v3: a bare pointer write still selects an unframed read, commands must be framed
+  if (framed && length > 1) {
+    return false;
+  }
+  return applyRegisters(data, length);
+}
+
+bool SimAtmega328::framedWrite(const uint8_t* data, size_t length) {
+  if (length < ms11::FRAME_READ_REQUEST_LENGTH) {
+    return false;
+  }
+  uint8_t pec = ms11::crc8(data, length - 1, ms11::crc8Update(0, SLAVE_I2C_ADDR << 1));
+  if (pec != data[length - 1]) {
+    return false;  // NACK, master re-sends
+  }
+
+  regPointer = data[1];
+
+  // seq reg pec: read request
+  if (length == ms11::FRAME_READ_REQUEST_LENGTH) {
+    framedRead = true;
+    responseSeq = data[0];
+    return true;
+  }
+
+  framedRead = false;
+  if (data[0] == lastWriteSeq) {
+    return true;  // Repeat of a frame already applied (lost ACK)
+  }
+  lastWriteSeq = data[0];
+  return applyRegisters(data + 1, length - 2);
+}
+
+bool SimAtmega328::applyRegisters(const uint8_t* data, size_t length) {
+  regPointer = data[0];
+
+  for (size_t i = 1; i < length; i++) {
+    uint8_t reg = regPointer++;
+    uint8_t value = data[i];
+
+    switch (reg) {
+      case REG_FAN_CMD:
+        if (value > 100) return false;
+        regs[REG_FAN_PERCENT] = value;
+        regs[REG_FAN_SPEED] = (value * 39 + 50) / 100;
+        break;
+      case REG_IGNITER_CMD:
+        regs[REG_STATUS] = value ? (regs[REG_STATUS] | STATUS_IGNITER_BIT)
+                                 : (regs[REG_STATUS] & ~STATUS_IGNITER_BIT);
+        break;
+      case REG_AUGER_CMD:
+        regs[REG_STATUS] = value ? (regs[REG_STATUS] | STATUS_AUGER_BIT)
+                                 : (regs[REG_STATUS] & ~STATUS_AUGER_BIT);
+        break;
+      case SLAVE_REG_LED_ONOFF:
+        ledOn = (value != 0);
+        break;
+      case ms11::FramingCmd::address:
+        if (value == ms11::PROTOCOL_V3 && regs[REG_PROTOCOL_VER] >= ms11::PROTOCOL_V3) {
+          framed = true;
+          lastWriteSeq = 0;
+        } else if (value == ms11::PROTOCOL_V2) {
+          framed = false;
+        } else {
+          return false;
+        }
+        break;
+      default:
+        // Read-only map (0x00-0x0E) is not writable
+        if (reg <= REG_DISPLAY_ENABLED) return false;
+        regs[reg] = value;
+        break;
+    }
+  }
+  return true;
+}
+
+bool SimAtmega328::bootWrite(const uint8_t* data, size_t length) {
+  bootCmd = data[0];
+
+  // 0x01: read version (1 byte) or switch to application (0x01 0x80)
+  if (bootCmd == 0x01) {
+    if (length >= 2 && data[1] == 0x80) {
+      bootloader = false;
+      regPointer = 0;
+      raiseEvent(ms11::EVENT_RESET);  // Application starts from reset
+    }
+    return true;
+  }
+
+  // 0x02 memtype addrH addrL [data...]: set pointer / write memory
+  if (bootCmd == 0x02) {
+    if (length < 2) return false;
+    memType = data[1];
+    if (length < 4) return true;
+    memAddress = ((uint16_t)data[2] << 8) | data[3];
+
+    for (size_t i = 4; i < length; i++) {
+      if (memType == 0x01) {
+        if (memAddress >= BOOTLOADER_START) return false;  // Bootloader is protected
+        flash[memAddress++] = data[i];
+        if ((memAddress % PAGE_SIZE) == 0) {
+          pageWrites++;  // Page committed on boundary
+          programming = true;
+          busyUntilUs = micros() + PAGE_PROGRAM_US;
+          if (pageWrites == powerFailAt) {
+            connected = false;  // Brown-out right after the commit; setConnected(true) powers up again
+            powerFailAt = 0;
+          }
+        }
+      } else if (memType == 0x02) {
+        if (memAddress >= EEPROM_SIZE) return false;
+        eeprom[memAddress++] = data[i];
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+size_t SimAtmega328::bootRead(uint8_t* buffer, size_t length) {
+  if (bootCmd == 0x01) {
+    static const char versionString[] = "TWIBOOT v3.2 SIM";
+    size_t count = min(length, sizeof(versionString) - 1);
+    memcpy(buffer, versionString, count);
+    return count;
+  }
+
+  if (bootCmd == 0x02) {
+    if (memType == 0x00) {
+      // Chip info: signature(3) pagesize(1) flashsize(2) eepromsize(2)
+      const uint8_t info[8] = {0x1E, 0x95, 0x0F, PAGE_SIZE,
+                               BOOTLOADER_START >> 8, BOOTLOADER_START & 0xFF,
+                               EEPROM_SIZE >> 8, EEPROM_SIZE & 0xFF};
+      size_t count = min(length, sizeof(info));
+      memcpy(buffer, info, count);
+      return count;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+      if (memType == 0x01) {
+        buffer[i] = (memAddress < FLASH_SIZE) ? flash[memAddress] : 0xFF;
+      } else {
+        buffer[i] = (memAddress < EEPROM_SIZE) ? eeprom[memAddress] : 0xFF;
+      }
+      memAddress++;
+    }
+    return length;
+  }
+
+  return 0;
+}
+
+// ============================================================================
+// SimPCF8574
+// ============================================================================
+
+bool SimPCF8574::onWrite(uint8_t address, const uint8_t* data, size_t length) {
+  if (length > 0) {
+    port = data[length - 1];
+    writes += length;
+  }
+  return true;
+}
+
+size_t SimPCF8574::onRead(uint8_t address, uint8_t* buffer, size_t length) {
+  memset(buffer, port, length);
+  return length;
+}
+
+// ============================================================================
+// SimSSD1306
+// ============================================================================
+
+bool SimSSD1306::onWrite(uint8_t address, const uint8_t* data, size_t length) {
+  if (length < 2) {
+    return true;
+  }
+  // Control byte: 0x00 = command stream, 0x40 = display data
+  if (data[0] & 0x40) {
+    dataBytes += length - 1;
+  } else {
+    commandBytes += length - 1;
+  }
+  return true;
+}
+
+size_t SimSSD1306::onRead(uint8_t address, uint8_t* buffer, size_t length) {
+  memset(buffer, 0x00, length);  // Status: display on, not busy
+  return length;
+}
+
+// ============================================================================
+// SimAHT10
+// ============================================================================
+
+bool SimAHT10::onWrite(uint8_t address, const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return true;
+  }
+  switch (data[0]) {
+    case 0xE1:  // Calibrate / init
+      calibrated = true;
+      break;
+    case 0xAC:  // Trigger measurement
+      measuring = true;
+      triggerTime = millis();
+      break;
+    case 0xBA:  // Soft reset
+      calibrated = false;
+      measuring = false;
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+size_t SimAHT10::onRead(uint8_t address, uint8_t* buffer, size_t length) {
+  bool busy = measuring && (millis() - triggerTime < CONVERSION_MS);
+  uint8_t status = (busy ? 0x80 : 0x00) | (calibrated ? 0x08 : 0x00);
+
+  uint32_t hum = (uint32_t)(humidity / 100.0f * 1048576.0f);
+  uint32_t temp = (uint32_t)((temperature + 50.0f) / 200.0f * 1048576.0f);
+  const uint8_t frame[6] = {
+    status,
+    (uint8_t)(hum >> 12), (uint8_t)(hum >> 4),
+    (uint8_t)(((hum & 0x0F) << 4) | ((temp >> 16) & 0x0F)),
+    (uint8_t)(temp >> 8), (uint8_t)temp
+  };
+
+  size_t count = min(length, sizeof(frame));
+  memcpy(buffer, frame, count);
+  if (!busy) {
+    measuring = false;
+  }
+  return count;
+}
+
+// ============================================================================
+// SimADS1110
+// ============================================================================
+
+bool SimADS1110::onWrite(uint8_t addr, const uint8_t* data, size_t length) {
+  if (length > 0) {
+    config = data[0] & 0x1F;
+    lastReadMs = millis();  // Conversion restarts with the new settings
+  }
+  return true;
+}
+
+int16_t SimADS1110::outputCode() {
+  // Inverse of the divider in config.h: NTC high side, series resistor low side
+  static const int32_t fullScale[] = {2048, 8192, 16384, 32768};
+  uint8_t dr = (config >> 2) & 0x03;
+
+  float kelvin = temperature + 273.15f;
+  float ohms = PROBE_NTC_R25_OHMS * expf(PROBE_NTC_BETA * (1.0f / kelvin - 1.0f / 298.15f));
+  float mv = unplugged ? 0.0f
+           : PROBE_NTC_EXCITATION_MV * PROBE_NTC_SERIES_OHMS / (PROBE_NTC_SERIES_OHMS + ohms);
+  int32_t code = (int32_t)(mv / 2048.0f * fullScale[dr]);
+  return (int16_t)min(code, fullScale[dr] - 1);
+}
+
+size_t SimADS1110::onRead(uint8_t addr, uint8_t* buffer, size_t length) {
+  static const uint16_t periodMs[] = {5, 17, 34, 67};  // 240/60/30/15 SPS
+  uint8_t dr = (config >> 2) & 0x03;
+  bool fresh = millis() - lastReadMs >= periodMs[dr];
+
+  int16_t code = outputCode();
+  const uint8_t burst[3] = {
+    (uint8_t)(code >> 8), (uint8_t)code,
+    (uint8_t)((fresh ? 0x00 : 0x80) | (config & 0x1F))
+  };
+  size_t count = min(length, sizeof(burst));
+  memcpy(buffer, burst, count);
+  if (fresh) {
+    lastReadMs = millis();
+  }
+  return count;
+}
+
+// ============================================================================
+// SimSeesaw
+// ============================================================================
+
+bool SimSeesaw::onWrite(uint8_t address, const uint8_t* data, size_t length) {
+  if (length >= 2) {
+    module = data[0];
+    function = data[1];
+  }
+  return true;
+}
+
+size_t SimSeesaw::onRead(uint8_t address, uint8_t* buffer, size_t length) {
+  memset(buffer, 0, length);
+
+  if (module == 0x00 && function == 0x01 && length >= 1) {
+    buffer[0] = 0x87;  // STATUS_HW_ID: ATtiny8x7
+  } else if (module == 0x11 && function == 0x30 && length >= 4) {
+    uint32_t pos = (uint32_t)encoderPosition;
+    buffer[0] = pos >> 24;
+    buffer[1] = pos >> 16;
+    buffer[2] = pos >> 8;
+    buffer[3] = pos;
+  }
+  return length;
+}
+
+#endif // I2C_SIM_BUS
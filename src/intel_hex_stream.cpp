@@ -0,0 +1,192 @@
+#include "intel_hex_stream.h"
+
+IntelHexStream::IntelHexStream(HexPageCallback callback, void* context)
+    : callback(callback), context(context) {
+  reset();
+}
+
+void IntelHexStream::reset() {
+  inRecord = false;
+  highNibble = true;
+  recordLength = 0;
+  result = HEX_OK;
+  baseAddress = 0;
+  pageAddress = -1;
+  memset(emitted, 0, sizeof(emitted));
+  records = 0;
+  dataBytes = 0;
+  skippedBytes = 0;
+  pages = 0;
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+static inline int8_t hexValue(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+IntelHexStream::Result IntelHexStream::feed(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length && result == HEX_OK; i++) {
+    uint8_t c = data[i];
+
+    if (!inRecord) {
+      // Anything between records is ignored (line endings, wrappers)
+      if (c == ':') {
+        inRecord = true;
+        highNibble = true;
+        recordLength = 0;
+      }
+      continue;
+    }
+
+    int8_t nibble = hexValue(c);
+    if (nibble < 0) {
+      if (recordLength == 0 && highNibble) {
+        inRecord = false;  // A ':' not followed by hex digits is not a record
+        continue;
+      }
+      result = HEX_ERROR_SYNTAX;
+      break;
+    }
+
+    if (highNibble) {
+      record[recordLength] = nibble << 4;
+      highNibble = false;
+      continue;
+    }
+    record[recordLength++] |= nibble;
+    highNibble = true;
+
+    // Complete once count(1) addr(2) type(1) data(count) checksum(1) arrived
+    if (recordLength >= 5 && recordLength == 5 + record[0]) {
+      inRecord = false;
+      result = processRecord();
+    }
+  }
+  return result;
+}
+
+IntelHexStream::Result IntelHexStream::finish() {
+  if (result == HEX_OK) {
+    result = HEX_ERROR_TRUNCATED;
+  }
+  return result;
+}
+
+IntelHexStream::Result IntelHexStream::processRecord() {
+  uint8_t sum = 0;
+  for (uint16_t i = 0; i < recordLength; i++) {
+    sum += record[i];
+  }
+  if (sum != 0) {
+    return HEX_ERROR_CHECKSUM;
+  }
+
+  uint8_t count = record[0];
+  uint16_t offset = ((uint16_t)record[1] << 8) | record[2];
+  uint8_t type = record[3];
+  const uint8_t* payload = record + 4;
+  records++;
+
+  switch (type) {
+    case 0x00: {  // Data
+      for (uint8_t i = 0; i < count; i++) {
+        Result r = storeByte(baseAddress + offset + i, payload[i]);
+        if (r != HEX_OK) {
+          return r;
+        }
+      }
+      return HEX_OK;
+    }
+
+    case 0x01: {  // End of file
+      Result r = flushPage();
+      return (r == HEX_OK) ? HEX_DONE : r;
+    }
+
+    case 0x02:  // Extended segment address (<< 4)
+      if (count != 2) return HEX_ERROR_RECORD;
+      baseAddress = (((uint32_t)payload[0] << 8) | payload[1]) << 4;
+      return HEX_OK;
+
+    case 0x04:  // Extended linear address (<< 16)
+      if (count != 2) return HEX_ERROR_RECORD;
+      baseAddress = (((uint32_t)payload[0] << 8) | payload[1]) << 16;
+      return HEX_OK;
+
+    case 0x03:  // Start segment address (irrelevant for AVR)
+    case 0x05:  // Start linear address
+      return HEX_OK;
+
+    default:
+      return HEX_ERROR_RECORD;
+  }
+}
+
+// ============================================================================
+// Page assembly
+// ============================================================================
+
+IntelHexStream::Result IntelHexStream::storeByte(uint32_t address, uint8_t value) {
+  if (address >= HEX_BOOTLOADER_START && address < HEX_FLASH_END) {
+    skippedBytes++;  // Never overwrite the bootloader
+    return HEX_OK;
+  }
+  if (address >= HEX_FLASH_END) {
+    return HEX_ERROR_ADDRESS;
+  }
+
+  int32_t base = address & ~(uint32_t)(HEX_PAGE_SIZE - 1);
+  if (base != pageAddress) {
+    Result r = flushPage();
+    if (r != HEX_OK) {
+      return r;
+    }
+    uint16_t index = base / HEX_PAGE_SIZE;
+    if (emitted[index / 8] & (1 << (index % 8))) {
+      return HEX_ERROR_ADDRESS;  // Would erase a page already written
+    }
+    pageAddress = base;
+    memset(page, 0xFF, sizeof(page));
+  }
+
+  page[address - base] = value;
+  dataBytes++;
+  return HEX_OK;
+}
+
+IntelHexStream::Result IntelHexStream::flushPage() {
+  if (pageAddress < 0) {
+    return HEX_OK;
+  }
+
+  uint16_t index = pageAddress / HEX_PAGE_SIZE;
+  emitted[index / 8] |= (1 << (index % 8));
+  uint16_t address = pageAddress;
+  pageAddress = -1;
+  pages++;
+
+  if (callback && !callback(address, page, HEX_PAGE_SIZE, context)) {
+    return HEX_ERROR_WRITE;
+  }
+  return HEX_OK;
+}
+
+const char* IntelHexStream::getErrorString() const {
+  switch (result) {
+    case HEX_OK:              return "OK";
+    case HEX_DONE:            return "Done";
+    case HEX_ERROR_SYNTAX:    return "Invalid character in hex record";
+    case HEX_ERROR_CHECKSUM:  return "Hex record checksum mismatch";
+    case HEX_ERROR_RECORD:    return "Unsupported or malformed hex record";
+    case HEX_ERROR_ADDRESS:   return "Address outside flash or page out of order";
+    case HEX_ERROR_WRITE:     return "Flash page write failed";
+    case HEX_ERROR_TRUNCATED: return "Hex file ended without EOF record";
+  }
+  return "Unknown";
+}
@@ -19,9 +19,16 @@
 #include "probe_manager.h"
 #include "gpio_manager.h"
 #include "slave_controller.h"
+#include "slave_events.h"
 #include "github_updater.h"
 #include "wifi_manager.h"
 #include "md11_slave_update.h"
+#include "ms11_image.h"
+#include "slave_flasher.h"
+#include "flash_journal.h"
+#include "slave_fleet.h"
+#include "oven_controller.h"
+#include "cook_menu.h"
 #include "images.h"
 
 // Extracted modules
@@ -156,31 +163,67 @@ void delayWithBlink(unsigned long ms) {
   }
 }
 
-// Check for .hex file in LittleFS root and perform MS11-control update if found
+// Check for a firmware image (.msimg, or .hex converted once) in LittleFS root
+// and perform MS11-control update if found. An update interrupted by a reset
+// (flash journal in NVS) is resumed first.
 bool checkAndUpdateMS11Firmware() {
-  // Scan root directory for .hex files
-  File root = LittleFS.open("/");
-  if (!root || !root.isDirectory()) {
-    return false;
+  String imagePath = "";
+  bool temporary = false;
+  uint8_t target = SLAVE_I2C_ADDR;
+  
+  FlashJournal::Entry journal;
+  if (FlashJournal::getInstance().load(journal)) {
+    if (LittleFS.exists(journal.path)) {
+      Serial.printf("[FlashJournal] Interrupted update of %s on 0x%02X (%s, page %u)\n",
+                    journal.path.c_str(), journal.address, FlashJournal::phaseName(journal.phase), journal.page);
+      imagePath = journal.path;
+      target = journal.address;
+      temporary = imagePath.startsWith("/.");  // Web upload staging file
+    } else {
+      Serial.printf("[FlashJournal] WARNING: %s is gone, cannot resume the update\n", journal.path.c_str());
+      FlashJournal::getInstance().clear();
+    }
   }
   
-  String hexFilePath = "";
-  File file = root.openNextFile();
-  
-  while (file) {
-    String fileName = String(file.name());
-    if (fileName.endsWith(".hex") && !fileName.startsWith(".")) {
-      hexFilePath = "/" + fileName;
+  // Scan root directory for firmware files
+  if (imagePath.isEmpty()) {
+    File root = LittleFS.open("/");
+    if (!root || !root.isDirectory()) {
+      return false;
+    }
+    
+    String hexFilePath = "";
+    File file = root.openNextFile();
+    
+    while (file && imagePath.isEmpty()) {
+      String fileName = String(file.name());
+      if (!fileName.startsWith(".")) {
+        if (fileName.endsWith(MSIMG_EXTENSION)) {
+          imagePath = "/" + fileName;
+        } else if (fileName.endsWith(".hex") && hexFilePath.isEmpty()) {
+          hexFilePath = "/" + fileName;
+        }
+      }
       file.close();
-      break;
+      file = root.openNextFile();
+    }
+    
+    root.close();
+    
+    // A .hex is decoded once into an image; flashing always uses the image
+    if (imagePath.isEmpty() && !hexFilePath.isEmpty()) {
+      imagePath = hexFilePath.substring(0, hexFilePath.length() - 4) + MSIMG_EXTENSION;
+      String error;
+      if (!convertHexToImage(hexFilePath, imagePath, error)) {
+        Serial.println("[MS11Image] ERROR: " + error);
+        LittleFS.rename(hexFilePath, hexFilePath + ".bad");  // Do not retry on every boot
+        return false;
+      }
+      LittleFS.remove(hexFilePath);
     }
-    file.close();
-    file = root.openNextFile();
   }
   
-  root.close();
-  
-  if (hexFilePath.isEmpty()) {
+  if (imagePath.isEmpty()) {
     return false;
   }
   
@@ -192,55 +235,36 @@ bool checkAndUpdateMS11Firmware() {
     startupBlinkDone = true;
   }
   
-  // Enter bootloader mode
-  I2CManager& manager = I2CManager::getInstance();
-  if (!manager.writeRegister(0x30, 0x99, 0xB0)) {
+  // Same job as a web upload: bootloader entry, signature check, journalled
+  // page writes, verify and exit
+  SlaveFlasher& flasher = SlaveFlasher::getInstance();
+  if (!flasher.begin() || flasher.start(imagePath, true, temporary, target) == 0) {
     LCDManager::getInstance().printLine(1, "Update failed!");
     delay(3000);
     return false;
   }
   
-  // Wait for bootloader to start
-  delay(6000);
-  
-  // Check if bootloader is active
-  if (!manager.ping(0x14, I2C_BUS_SLAVE)) {
-    LCDManager::getInstance().printLine(1, "Bootloader fail!");
-    delay(3000);
-    return false;
-  }
-  
-  // Upload hex file
-  File hexFile = LittleFS.open(hexFilePath, "r");
-  if (!hexFile) {
-    LCDManager::getInstance().printLine(1, "File open fail!");
-    delay(3000);
-    return false;
-  }
-  
-  String hexContent = hexFile.readString();
-  hexFile.close();
-  
-  if (!md11SlaveUpdater) {
-    md11SlaveUpdater = new MD11SlaveUpdate();
+  uint8_t lastPercent = 0;
+  while (flasher.isBusy()) {
+    uint8_t percent = flasher.getProgress().percent;
+    if (percent != lastPercent && LCDManager::getInstance().isInitialized()) {
+      lastPercent = percent;
+      LCDManager::getInstance().printLine(1, "Updating " + String(percent) + "%");
+    }
+    delay(50);
   }
   
-  if (!md11SlaveUpdater->uploadHexFile(hexContent)) {
+  SlaveFlasher::Progress result = flasher.getProgress();
+  if (result.state != SlaveFlasher::FLASH_DONE) {
     LCDManager::getInstance().printLine(1, "Upload failed!");
     delay(3000);
     return false;
   }
   
-  // Exit bootloader
-  uint8_t exitCmd[2] = {0x01, 0x80};
-  manager.write(0x14, exitCmd, 2);
-  delay(1000);
-  
-  // Delete hex file
-  delay(100);
-  if (!LittleFS.remove(hexFilePath)) {
+  // Delete image file (the job already removed a staging file)
+  if (LittleFS.exists(imagePath) && !LittleFS.remove(imagePath)) {
     // Fallback: rename to mark as processed
-    LittleFS.rename(hexFilePath, hexFilePath + ".done");
+    LittleFS.rename(imagePath, imagePath + ".done");
   }
   
   // Show success message
@@ -313,6 +337,9 @@ void setup() {
   if (!SlaveController::getInstance().begin()) {
     Serial.println("WARNING: Slave controller not responding - check I2C wiring");
   }
+  
+  // Slave attention line: faults arrive by interrupt, heartbeat polling slows down
+  SlaveEventMonitor::getInstance().begin();
 
   // Initialize Probe Manager (aggregated temperature from multiple sources)
   ProbeManager::getInstance().begin();
@@ -325,10 +352,15 @@ void setup() {
   ms11Present = SlaveController::getInstance().ping();
   Serial.printf("[Main] MS11-control detection: %s\n", ms11Present ? "PRESENT" : "ABSENT");
   
-  // Check for firmware update hex file and perform update if found
-  if (ms11Present) {
+  // Check for firmware update hex file and perform update if found.
+  // An interrupted update is resumed even when the half-written application
+  // does not answer.
+  FlashJournal::Entry journal;
+  if (ms11Present || FlashJournal::getInstance().load(journal)) {
     checkAndUpdateMS11Firmware();  // Will reboot if update performed
-    
+  }
+  
+  if (ms11Present) {
     // Trigger 500ms LED pulse on MS11-control (normal startup)
     if (SlaveController::getInstance().pulseLed(500)) {
       ledPulseStartTime = millis();
@@ -380,8 +412,13 @@ void setup() {
   githubUpdater = new GitHubUpdater(preferences);
   githubUpdater->loadUpdateInfo();
   
-  // Initialize MD11 Slave updater
-  md11SlaveUpdater = new MD11SlaveUpdate();
+  // Initialize MD11 Slave updater (may exist from the boot-time update check)
+  if (!md11SlaveUpdater) {
+    md11SlaveUpdater = new MD11SlaveUpdate();
+  }
+  SlaveFlasher::getInstance().begin();
+  SlaveFleet::getInstance().begin();
+  OvenController::getInstance().begin();
   
   Serial.println("OTA Update System Initialized");
   Serial.println("Firmware Version: " + currentFirmwareVersion);
@@ -532,12 +569,9 @@ void handleDisplayTasks() {
   static unsigned long lastDisplayUpdate = 0;
   unsigned long now = millis();
   
-  // Read AHT10 sensor periodically (every 30 seconds to save power)
-  static unsigned long lastSensorRead = 0;
-  if ((now - lastSensorRead >= 30000) && AHT10Manager::getInstance().isInitialized()) {
-    AHT10Manager::getInstance().readSensor();
-    lastSensorRead = now;
-  }
+  // Advance the AHT10 measurement (trigger, later collect); never waits for
+  // the conversion. The OLED and ProbeManager read the cached result.
+  AHT10Manager::getInstance().update();
 
   // Update display every 1 second with temperature and humidity (only after startup complete)
   // Only redraw OLED when sensor data actually changed to avoid unnecessary I2C traffic
@@ -611,28 +645,45 @@ void handleDisplayTasks() {
     }
   }
 
-  // ---- Ready display with blinking period ----
-  if (lcdStatusShown && ipDisplayCleared && !ms11ConnectionLost && !ms11Restored && LCDManager::getInstance().isInitialized()) {
+  // ---- Cook program menu and notices (encoder); they borrow the Ready screen ----
+  bool readyScreen = lcdStatusShown && ipDisplayCleared && !ms11ConnectionLost && !ms11Restored;
+  static bool lastCookMenuShown = false;
+  bool cookMenuShown = CookMenu::getInstance().update(now, readyScreen);
+  bool lcdReclaimed = lastCookMenuShown && !cookMenuShown;  // Menu cleared the LCD: redraw
+  lastCookMenuShown = cookMenuShown;
+
+  // ---- Ready display with blinking period (program progress while one runs) ----
+  if (readyScreen && !cookMenuShown && LCDManager::getInstance().isInitialized()) {
     // Blinking period after Ready: visible first 600ms of each second
     bool periodVisible = blinkState(now, 600, 400);
-    static bool lastPeriodVisible = true;
-    static bool readyLineInitialized = false;
-    if (!readyLineInitialized || periodVisible != lastPeriodVisible) {
-      readyLineInitialized = true;
-      lastPeriodVisible = periodVisible;
-      LCDManager::getInstance().printLine(0, periodVisible ? "Ready." : "Ready ");
+    const char* programLine = CookMenu::getInstance().programLine();
+    char readyText[17];
+    strlcpy(readyText, programLine[0] ? programLine : (periodVisible ? "Ready." : "Ready "), sizeof(readyText));
+    static char lastReadyText[17] = "";
+    if (lcdReclaimed || strcmp(readyText, lastReadyText) != 0) {
+      strlcpy(lastReadyText, readyText, sizeof(lastReadyText));
+      LCDManager::getInstance().printLine(0, readyText);
     }
   }
   
   // ---- Heartbeat / reconnect: ping MS11-control every 2 seconds ----
-  // Skip heartbeat during bootloader operations to avoid I2C interference
-  if (ipDisplayCleared && (now - lastHeartbeatTime >= 2000)) {
+  // With the attention line faults arrive by interrupt; the heartbeat only
+  // has to catch a dead slave or a broken line, and reconnect stays at 2 s
+  // Skip heartbeat during bootloader operations to avoid I2C interference;
+  // the interval restarts when the flash ends so the slave can boot first
+  unsigned long heartbeatInterval = (ms11Present && SlaveEventMonitor::getInstance().isActive())
+                                        ? SLAVE_EVENT_HEARTBEAT_MS : 2000;
+  if (SlaveFlasher::getInstance().isBusy()) {
+    lastHeartbeatTime = now;
+  } else if (ipDisplayCleared && (now - lastHeartbeatTime >= heartbeatInterval)) {
     lastHeartbeatTime = now;
     if (ms11Present) {
       // Heartbeat: verify MS11-control is still alive with 2ms LED pulse
       if (!SlaveController::getInstance().ping()) {
         // Lost contact — start blinking "Connection lost!"
         Serial.println("[Main] Lost contact with MS11-control!");
+        // Confirmed outputs are stale now: re-send and read back once it answers
+        SlaveController::getInstance().invalidateOutputs();
         ms11Present = false;
         ms11ConnectionLost = true;
         ms11Restored = false;
@@ -643,6 +694,8 @@ void handleDisplayTasks() {
           LCDManager::getInstance().printLine(1, "Connection lost!");
         }
       } else {
+        // Re-confirm the control outputs in case the slave changed one on its own
+        SlaveController::getInstance().reconfirmOutputs();
         // MS11-control present: send 2ms heartbeat pulse (safe with I2CManager mutex)
         if (SlaveController::getInstance().pulseLed(2)) {
           ledPulseStartTime = millis();
@@ -654,6 +707,8 @@ void handleDisplayTasks() {
       // Reconnect: try to re-establish contact with MS11-control
       if (SlaveController::getInstance().ping()) {
         Serial.println("[Main] MS11-control reconnected!");
+        // Slave may have reset: renegotiate framing, re-send every commanded output
+        SlaveController::getInstance().negotiateProtocol();
         ms11Present = true;
         ms11ConnectionLost = false;
         ms11Restored = true;
@@ -696,7 +751,7 @@ void handleDisplayTasks() {
   
   // ---- LCD time display: colon always visible, blinking period in Ready instead ----
   // Only show clock when MS11-control is connected (ms11Present) and not during "Restored" message
-  if (ipDisplayCleared && lcdStatusShown && ms11Present && !ms11Restored && LCDManager::getInstance().isInitialized() && Settings::stringToBool(ntpEnabled)) {
+  if (ipDisplayCleared && lcdStatusShown && ms11Present && !ms11Restored && !cookMenuShown && LCDManager::getInstance().isInitialized() && Settings::stringToBool(ntpEnabled)) {
     time_t rawTime = time(nullptr);
     if (rawTime >= NTP_VALID_TIME) {
       int timezoneOffsetHours = parseTimezoneOffset(timezone);
@@ -713,7 +768,7 @@ void handleDisplayTasks() {
       
       // Only update LCD when string actually changed
       static char lastTimeStr[17] = "";
-      if (strcmp(timeStr, lastTimeStr) != 0) {
+      if (lcdReclaimed || strcmp(timeStr, lastTimeStr) != 0) {
         strncpy(lastTimeStr, timeStr, sizeof(lastTimeStr));
         LCDManager::getInstance().printLine(1, String(timeStr));
       }
@@ -740,6 +795,9 @@ void handleSystemTasks() {
   if (rebootScheduled && (millis() - rebootTime > REBOOT_DELAY)) {
     performReboot();
   }
+
+  // I2C clock negotiation (rate-limited internally)
+  I2CManager::getInstance().maintain();
 }
 
 // Handle NeoPixel status indicator and button feedback
@@ -808,6 +866,7 @@ void handleNeopixelTasks() {
     lastButtonCheck = now;
     if (SeesawRotary::getInstance().getButtonPress()) {
       startBlink(0xFFFFFF, statusColor, 6, 100);
+      CookMenu::getInstance().onButton();
     }
   }
 
@@ -861,6 +920,7 @@ void loop() {
   if (ledPulseActive) {
     unsigned long elapsed = millis() - ledPulseStartTime;
     if (elapsed >= ledPulseDurationMs) {
+      // Shadowed; sent by flushOutputs() below without blocking on Wire1
       SlaveController::getInstance().setLed(false);
       ledPulseActive = false;
     }
@@ -870,6 +930,13 @@ void loop() {
   GPIOManager::getInstance().update();
   
   handleDisplayTasks();
+  
+  // Control tick: send changed slave outputs (fan/igniter/auger/LED) in one go.
+  // Not while the slave is absent (the reconnect re-sends them) or being flashed
+  if (ms11Present && !SlaveFlasher::getInstance().isBusy()) {
+    SlaveController::getInstance().flushOutputs();
+  }
+  
   handleSystemTasks();
   handleNetworkTasks();
   handleNeopixelTasks();  // Update NeoPixel status indicator
@@ -1,8 +1,19 @@
 #include "md11_slave_update.h"
 #include "i2c_manager.h"
+#include "ms11_image.h"
+#include <LittleFS.h>
 
-MD11SlaveUpdate::MD11SlaveUpdate() {
+// Layout of the cache file: header followed by pageCrc[MD11_FLASH_PAGES]
+struct FlashCacheHeader {
+  uint32_t magic;
+  uint16_t pageSize;
+  uint16_t pageCount;
+};
+
+MD11SlaveUpdate::MD11SlaveUpdate() : hexStream(onHexPage, this) {
   lastError = "";
+  memset(pageCrc, 0, sizeof(pageCrc));
+  memset(imagePages, 0, sizeof(imagePages));
 }
 
 bool MD11SlaveUpdate::requestBootloaderMode() {
@@ -24,7 +35,11 @@ bool MD11SlaveUpdate::requestBootloaderMode() {
   Serial.println("[MD11SlaveUpdate] Bootloader command sent. Waiting for app to reboot...");
   
   // Wait for app to reboot and bootloader to start
-  delay(2000);
+  if (!waitForBootloader()) {
+    lastError = "Bootloader did not appear at 0x" + String(TWIBOOT_I2C_ADDR, HEX);
+    Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+    return false;
+  }
   
   // Verify bootloader is active by querying version
   String version;
@@ -38,48 +53,62 @@ bool MD11SlaveUpdate::requestBootloaderMode() {
   return true;
 }
 
+bool MD11SlaveUpdate::waitForBootloader(uint32_t timeoutMs) {
+  uint32_t waitedUs = 0;
+  if (!I2CManager::getInstance().waitForAck(TWIBOOT_I2C_ADDR, timeoutMs, &waitedUs)) {
+    return false;
+  }
+  Serial.printf("[MD11SlaveUpdate] Bootloader answered after %lu ms\n", (unsigned long)(waitedUs / 1000));
+  return true;
+}
+
 bool MD11SlaveUpdate::queryBootloaderVersion(String& version) {
   Serial.println("[MD11SlaveUpdate] Querying bootloader version...");
   
-  uint8_t response[16];
-  uint16_t responseLen = sizeof(response);
-  
-  if (!sendBootloaderCommand(TWIBOOT_READ_VERSION, nullptr, 0, response, &responseLen)) {
+  // A lone 0x01 selects the version string; only 0x01 0x80 starts the application
+  const uint8_t cmd[1] = {TWIBOOT_CMD_READ_VERSION};
+  char response[TWIBOOT_VERSION_LENGTH + 1];
+  if (!I2CManager::getInstance().writeRead(TWIBOOT_I2C_ADDR, cmd, sizeof(cmd),
+                                           (uint8_t*)response, TWIBOOT_VERSION_LENGTH)) {
     lastError = "Failed to query bootloader version";
     return false;
   }
+  response[TWIBOOT_VERSION_LENGTH] = '\0';
   
-  if (responseLen < 4) {
-    lastError = "Invalid version response length";
+  version = response;  // NUL- or space-padded
+  version.trim();
+  Serial.println("[MD11SlaveUpdate] Bootloader version: " + version);
+  
+  return true;
+}
+
+bool MD11SlaveUpdate::queryChipInfo(ChipInfo& info) {
+  const uint8_t cmd[4] = {TWIBOOT_CMD_ACCESS_MEMORY, TWIBOOT_MEM_CHIPINFO, 0x00, 0x00};
+  uint8_t raw[8];
+  if (!I2CManager::getInstance().writeRead(TWIBOOT_I2C_ADDR, cmd, sizeof(cmd), raw, sizeof(raw))) {
+    lastError = "Failed to query chip info";
     return false;
   }
   
-  // Response format: major, minor, features_low, features_high
-  version = String(response[0]) + "." + String(response[1]);
-  Serial.println("[MD11SlaveUpdate] Bootloader version: " + version);
-  
+  memcpy(info.signature, raw, sizeof(info.signature));
+  info.pageSize = raw[3];
+  info.flashSize = ((uint16_t)raw[4] << 8) | raw[5];
+  info.eepromSize = ((uint16_t)raw[6] << 8) | raw[7];
   return true;
 }
 
 bool MD11SlaveUpdate::queryChipSignature(uint8_t& sig0, uint8_t& sig1, uint8_t& sig2) {
   Serial.println("[MD11SlaveUpdate] Querying chip signature...");
   
-  uint8_t response[16];
-  uint16_t responseLen = sizeof(response);
-  
-  if (!sendBootloaderCommand(TWIBOOT_READ_SIGNATURE, nullptr, 0, response, &responseLen)) {
+  ChipInfo info;
+  if (!queryChipInfo(info)) {
     lastError = "Failed to query chip signature";
     return false;
   }
   
-  if (responseLen < 3) {
-    lastError = "Invalid signature response length";
-    return false;
-  }
-  
-  sig0 = response[0];
-  sig1 = response[1];
-  sig2 = response[2];
+  sig0 = info.signature[0];
+  sig1 = info.signature[1];
+  sig2 = info.signature[2];
   
   Serial.printf("[MD11SlaveUpdate] Chip signature: %02X %02X %02X\n", sig0, sig1, sig2);
   
@@ -87,328 +116,691 @@ bool MD11SlaveUpdate::queryChipSignature(uint8_t& sig0, uint8_t& sig1, uint8_t&
 }
 
 bool MD11SlaveUpdate::uploadHexFile(const String& hexContent, void (*progressCallback)(int percent)) {
-  Serial.println("[MD11SlaveUpdate] Starting hex file upload (page-based mode)...");
-  
-  // Page buffer (128 bytes for ATmega328P)
-  const uint16_t PAGE_SIZE = 128;
-  uint8_t pageBuffer[PAGE_SIZE];
-  uint16_t currentPageBase = 0xFFFF;  // Current page start address
-  bool pagePending = false;  // Page has data waiting to be flushed
-  
-  // Parse hex file line by line
-  int lineCount = 0;
-  int errorCount = 0;
-  uint32_t totalBytes = 0;
-  uint16_t baseAddress = 0x0000;  // Extended linear address
-  
-  // Split hex content into lines
-  int startIdx = 0;
-  String currentLine;
-  
-  while (startIdx < hexContent.length()) {
-    int endIdx = hexContent.indexOf('\n', startIdx);
-    if (endIdx == -1) endIdx = hexContent.length();
-    
-    currentLine = hexContent.substring(startIdx, endIdx);
-    currentLine.trim();
-    startIdx = endIdx + 1;
-    
-    if (currentLine.length() == 0) continue;
-    if (currentLine[0] != ':') continue;  // Skip non-hex lines
-    
-    lineCount++;
-    
-    HexRecord record;
-    if (!parseHexLine(currentLine, record)) {
-      Serial.println("[MD11SlaveUpdate] ERROR: Invalid hex line " + String(lineCount));
-      errorCount++;
-      continue;
+  Serial.println("[MD11SlaveUpdate] Starting hex upload from memory...");
+
+  beginHexUpload();
+  const uint8_t* data = (const uint8_t*)hexContent.c_str();
+  size_t total = hexContent.length();
+  const size_t SLICE = 512;  // Progress granularity only
+
+  for (size_t offset = 0; offset < total; offset += SLICE) {
+    if (!feedHex(data + offset, min(SLICE, total - offset))) {
+      break;
     }
-    
-    // Handle record types
-    if (record.recordType == 0x00) {
-      // Data record
-      uint16_t fullAddress = (baseAddress << 16) | record.address;
-      
-      // Check if address is in bootloader section (0x7C00 for ATmega328P)
-      if (fullAddress >= 0x7C00 && fullAddress < 0x8000) {
-        Serial.println("[MD11SlaveUpdate] Skipping bootloader section at 0x" + String(fullAddress, HEX));
-        continue;
-      }
-      
-      // Process each byte in the record
-      for (size_t i = 0; i < record.data.size(); i++) {
-        uint16_t byteAddr = fullAddress + i;
-        uint16_t pageBase = byteAddr & ~(PAGE_SIZE - 1);  // Round down to page boundary
-        uint16_t offsetInPage = byteAddr & (PAGE_SIZE - 1);
-        
-        // Check if we crossed into a new page
-        if (pageBase != currentPageBase) {
-          // Flush previous page if it has data
-          if (pagePending && currentPageBase != 0xFFFF) {
-            Serial.println("[MD11SlaveUpdate] Page boundary crossed, flushing page at 0x" + String(currentPageBase, HEX));
-            if (!writeFlashPage(currentPageBase, pageBuffer, PAGE_SIZE)) {
-              Serial.println("[MD11SlaveUpdate] ERROR: Failed to write page at 0x" + String(currentPageBase, HEX));
-              errorCount++;
-              break;
-            }
-          }
-          
-          // Start new page
-          currentPageBase = pageBase;
-          memset(pageBuffer, 0xFF, PAGE_SIZE);  // Initialize with 0xFF (erased flash)
-          pagePending = false;
-          Serial.println("[MD11SlaveUpdate] Starting new page at 0x" + String(currentPageBase, HEX));
-        }
-        
-        // Add byte to page buffer
-        pageBuffer[offsetInPage] = record.data[i];
-        pagePending = true;
-        totalBytes++;
-        
-        // Progress callback every 256 bytes
-        if (progressCallback && (totalBytes % 256 == 0)) {
-          progressCallback((totalBytes * 100) / 32768);  // Estimate 32KB typical sketch size
-        }
-      }
-      
-    } else if (record.recordType == 0x04) {
-      // Extended linear address record
-      if (record.data.size() >= 2) {
-        baseAddress = (record.data[0] << 8) | record.data[1];
-        Serial.println("[MD11SlaveUpdate] Extended address: 0x" + String(baseAddress, HEX));
-      }
-      
-    } else if (record.recordType == 0x01) {
-      // End of file
-      Serial.println("[MD11SlaveUpdate] EOF reached at line " + String(lineCount));
+    if (progressCallback) {
+      progressCallback(((offset + SLICE < total ? offset + SLICE : total) * 100) / total);
+    }
+  }
+  return endHexUpload();
+}
+
+bool MD11SlaveUpdate::uploadHexStream(Stream& source, size_t totalSize, void (*progressCallback)(int percent)) {
+  Serial.println("[MD11SlaveUpdate] Starting streamed hex upload...");
+
+  beginHexUpload();
+  uint8_t buffer[256];
+  size_t consumed = 0;
+
+  while (source.available() > 0) {
+    size_t n = source.readBytes(buffer, sizeof(buffer));
+    if (n == 0) {
+      break;
+    }
+    consumed += n;
+    if (!feedHex(buffer, n)) {
       break;
     }
+    if (progressCallback && totalSize > 0) {
+      progressCallback((min(consumed, totalSize) * 100) / totalSize);
+    }
   }
-  
-  // Flush last page if pending
-  if (pagePending && currentPageBase != 0xFFFF) {
-    Serial.println("[MD11SlaveUpdate] Flushing last page at 0x" + String(currentPageBase, HEX));
-    if (!writeFlashPage(currentPageBase, pageBuffer, PAGE_SIZE)) {
-      Serial.println("[MD11SlaveUpdate] ERROR: Failed to write last page");
-      errorCount++;
+  return endHexUpload();
+}
+
+void MD11SlaveUpdate::beginHexUpload() {
+  hexStream.reset();
+  beginFlash();
+}
+
+bool MD11SlaveUpdate::feedHex(const uint8_t* data, size_t length) {
+  IntelHexStream::Result result = hexStream.feed(data, length);
+  return result == IntelHexStream::HEX_OK || result == IntelHexStream::HEX_DONE;
+}
+
+bool MD11SlaveUpdate::endHexUpload() {
+  if (hexStream.finish() != IntelHexStream::HEX_DONE) {
+    if (lastError.isEmpty()) {
+      lastError = String(hexStream.getErrorString()) + " (record " + String(hexStream.getLine()) + ")";
     }
+    Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+    return false;
   }
-  
-  if (errorCount > 0) {
-    lastError = "Upload failed with " + String(errorCount) + " errors";
+  if (!finishFlash()) {
     return false;
   }
-  
-  Serial.println("[MD11SlaveUpdate] Upload complete! Wrote " + String(totalBytes) + " bytes");
+
+  Serial.printf("[MD11SlaveUpdate] Upload complete! %lu records, %lu bytes in %u pages (%lu bootloader bytes skipped)\n",
+                (unsigned long)hexStream.getRecordCount(), (unsigned long)hexStream.getDataBytes(),
+                hexStream.getPageCount(), (unsigned long)hexStream.getSkippedBytes());
   return true;
 }
 
+bool MD11SlaveUpdate::uploadImage(File& image, void (*progressCallback)(int percent)) {
+  Serial.println("[MD11SlaveUpdate] Starting image upload...");
+  lastError = "";
+
+  // Check the whole file before the first page goes out
+  MsImageHeader header;
+  if (!readImageHeader(image, header, lastError) || !verifyImageDigest(image, header, lastError)) {
+    Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+    return false;
+  }
+
+  uint8_t sig[3];
+  if (!queryChipSignature(sig[0], sig[1], sig[2])) {
+    Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+    return false;
+  }
+  if (memcmp(sig, header.signature, sizeof(sig)) != 0) {
+    char message[80];
+    snprintf(message, sizeof(message), "Image is for %02X %02X %02X, target is %02X %02X %02X",
+             header.signature[0], header.signature[1], header.signature[2], sig[0], sig[1], sig[2]);
+    lastError = message;
+    Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+    return false;
+  }
+
+  beginFlash();
+  uint8_t record[MSIMG_RECORD_SIZE(HEX_PAGE_SIZE)];
+  for (uint16_t i = 0; i < header.pageCount; i++) {
+    if (image.read(record, sizeof(record)) != sizeof(record)) {
+      lastError = "Image read failed at page " + String(i);
+      Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+      return false;
+    }
+    uint16_t pageAddress = record[0] | ((uint16_t)record[1] << 8);
+    if ((pageAddress % HEX_PAGE_SIZE) != 0 || pageAddress >= HEX_BOOTLOADER_START) {
+      lastError = "Image page address 0x" + String(pageAddress, HEX) + " outside the application section";
+      Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+      return false;
+    }
+    if (!flashPage(pageAddress, record + 2, HEX_PAGE_SIZE)) {
+      Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+      return false;
+    }
+    if (progressCallback) {
+      progressCallback(((i + 1) * 100) / header.pageCount);
+    }
+  }
+  if (!finishFlash()) {
+    return false;
+  }
+
+  Serial.printf("[MD11SlaveUpdate] Image upload complete! %u pages, firmware version %X.%X\n",
+                header.pageCount, header.fwVersion >> 4, header.fwVersion & 0x0F);
+  return true;
+}
+
+void MD11SlaveUpdate::beginFlash() {
+  lastError = "";
+  if (!cacheLoaded) {
+    loadFlashCache();
+  }
+  memset(imagePages, 0, sizeof(imagePages));
+  flashStats = FlashStats();
+  uploadStartMs = millis();
+}
+
+bool MD11SlaveUpdate::finishFlash() {
+  flashStats.flashMs = millis() - uploadStartMs;
+  if (flashStats.writeUs > 0) {
+    flashStats.writeBytesPerSec = (uint64_t)flashStats.bytesWritten * 1000000ULL / flashStats.writeUs;
+  }
+
+  if (!verifyImage()) {
+    Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
+    return false;
+  }
+
+  // A pure cache hit changed nothing worth rewriting to LittleFS
+  if (!cacheOnDisk || flashStats.pagesCached != flashStats.pagesVerified) {
+    saveFlashCache();
+  }
+
+  Serial.printf("[MD11SlaveUpdate] Pages: %u written, %u unchanged, %u cached, %u resumed; flash %lu ms, verify %lu ms, image CRC %08lX\n",
+                flashStats.pagesWritten, flashStats.pagesUnchanged, flashStats.pagesCached, flashStats.pagesResumed,
+                (unsigned long)flashStats.flashMs, (unsigned long)flashStats.verifyMs,
+                (unsigned long)flashStats.imageCrc);
+  if (flashStats.pagesWritten > 0) {
+    Serial.printf("[MD11SlaveUpdate] Write throughput: %lu B/s (%lu bytes, %lu ms programming wait)\n",
+                  (unsigned long)flashStats.writeBytesPerSec, (unsigned long)flashStats.bytesWritten,
+                  (unsigned long)(flashStats.programWaitUs / 1000));
+  }
+  return true;
+}
+
+bool MD11SlaveUpdate::onHexPage(uint16_t pageAddress, const uint8_t* page, uint16_t size, void* context) {
+  // flashPage() sets lastError on failure, which endHexUpload() keeps
+  return static_cast<MD11SlaveUpdate*>(context)->flashPage(pageAddress, page, size);
+}
+
+// ============================================================================
+// Differential flashing
+// ============================================================================
+
+bool MD11SlaveUpdate::flashPage(uint16_t pageAddress, const uint8_t* page, uint16_t size) {
+  // The decoder never emits bootloader pages, so the index is in range
+  uint16_t index = pageAddress / HEX_PAGE_SIZE;
+  imagePages[index / 8] |= (1 << (index % 8));
+  uint32_t key = pageKey(page, size);
+
+  if (differential) {
+    if (pageCrc[index] == key) {
+      flashStats.pagesCached++;
+      return true;
+    }
+
+    uint8_t current[HEX_PAGE_SIZE];
+    if (readFlash(pageAddress, current, size)) {
+      if (memcmp(current, page, size) == 0) {
+        pageCrc[index] = key;
+        flashStats.pagesUnchanged++;
+        return true;
+      }
+    } else {
+      // Not fatal: the page is simply written
+      Serial.println("[MD11SlaveUpdate] WARNING: " + lastError + ", writing page");
+      lastError = "";
+    }
+  }
+
+  // From the first write on, the stored table no longer describes the slave
+  dropFlashCacheFile();
+  pageCrc[index] = 0;
+  if (!writeFlashPage(pageAddress, page, size)) {
+    return false;
+  }
+  pageCrc[index] = key;
+  flashStats.pagesWritten++;
+  return true;
+}
+
+void MD11SlaveUpdate::assumePage(uint16_t pageAddress, const uint8_t* page, uint16_t size) {
+  uint16_t index = pageAddress / HEX_PAGE_SIZE;
+  imagePages[index / 8] |= (1 << (index % 8));
+  pageCrc[index] = pageKey(page, size);
+  flashStats.pagesResumed++;
+}
+
+bool MD11SlaveUpdate::readMemory(TwiBootMemType type, uint16_t address, uint8_t* buffer, uint16_t length) {
+  const int MAX_RETRIES = 2;
+  I2CManager& manager = I2CManager::getInstance();
+
+  // Twiboot read: [CMD_ACCESS_MEMORY(0x02)] [memtype] [addrH] [addrL], then read.
+  // The address is sent with every chunk so a retried chunk starts at the right byte.
+  for (uint16_t offset = 0; offset < length; offset += MD11_READ_CHUNK) {
+    uint16_t chunkAddr = address + offset;
+    uint16_t bytesThisChunk = min((uint16_t)MD11_READ_CHUNK, (uint16_t)(length - offset));
+    uint8_t cmd[4] = {TWIBOOT_CMD_ACCESS_MEMORY, (uint8_t)type,
+                      (uint8_t)(chunkAddr >> 8), (uint8_t)(chunkAddr & 0xFF)};
+
+    bool chunkRead = false;
+    for (int attempt = 1; attempt <= MAX_RETRIES && !chunkRead; attempt++) {
+      chunkRead = manager.writeRead(TWIBOOT_I2C_ADDR, cmd, sizeof(cmd), buffer + offset, bytesThisChunk);
+    }
+    if (!chunkRead) {
+      lastError = String(type == TWIBOOT_MEM_EEPROM ? "Failed to read EEPROM" : "Failed to read flash") +
+                  " at address 0x" + String(chunkAddr, HEX);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MD11SlaveUpdate::writeEeprom(uint16_t address, const uint8_t* data, uint16_t length) {
+  I2CManager& manager = I2CManager::getInstance();
+  uint8_t current[TWIBOOT_EEPROM_WRITE_CHUNK];
+  uint8_t frame[TWIBOOT_WRITE_HEADER + TWIBOOT_EEPROM_WRITE_CHUNK];
+  uint16_t written = 0;
+
+  for (uint16_t offset = 0; offset < length; offset += TWIBOOT_EEPROM_WRITE_CHUNK) {
+    uint16_t chunkAddr = address + offset;
+    uint16_t bytesThisChunk = min((uint16_t)TWIBOOT_EEPROM_WRITE_CHUNK, (uint16_t)(length - offset));
+
+    // EEPROM cells wear out: leave identical bytes alone
+    if (!readMemory(TWIBOOT_MEM_EEPROM, chunkAddr, current, bytesThisChunk)) {
+      return false;
+    }
+    if (memcmp(current, data + offset, bytesThisChunk) == 0) {
+      continue;
+    }
+
+    frame[0] = TWIBOOT_CMD_ACCESS_MEMORY;
+    frame[1] = TWIBOOT_MEM_EEPROM;
+    frame[2] = chunkAddr >> 8;
+    frame[3] = chunkAddr & 0xFF;
+    memcpy(frame + TWIBOOT_WRITE_HEADER, data + offset, bytesThisChunk);
+    if (!manager.write(TWIBOOT_I2C_ADDR, frame, TWIBOOT_WRITE_HEADER + bytesThisChunk) ||
+        !manager.waitForAck(TWIBOOT_I2C_ADDR, TWIBOOT_PAGE_TIMEOUT_MS)) {
+      lastError = "Failed to write EEPROM at address 0x" + String(chunkAddr, HEX);
+      return false;
+    }
+
+    if (!readMemory(TWIBOOT_MEM_EEPROM, chunkAddr, current, bytesThisChunk) ||
+        memcmp(current, data + offset, bytesThisChunk) != 0) {
+      lastError = "EEPROM verify failed at address 0x" + String(chunkAddr, HEX);
+      return false;
+    }
+    written += bytesThisChunk;
+  }
+
+  Serial.printf("[MD11SlaveUpdate] EEPROM 0x%04X+%u: %u bytes written\n", address, length, written);
+  return true;
+}
+
+bool MD11SlaveUpdate::verifyImage() {
+  uint32_t start = millis();
+  uint8_t page[HEX_PAGE_SIZE];
+  uint32_t imageCrc = 0;
+
+  flashStats.pagesVerified = 0;
+  flashStats.verified = false;
+
+  for (uint16_t index = 0; index < MD11_FLASH_PAGES; index++) {
+    if (!(imagePages[index / 8] & (1 << (index % 8)))) {
+      continue;
+    }
+    uint16_t pageAddress = index * HEX_PAGE_SIZE;
+    if (!readFlash(pageAddress, page, HEX_PAGE_SIZE)) {
+      invalidateFlashCache();
+      return false;
+    }
+
+    uint32_t key = pageKey(page, HEX_PAGE_SIZE);
+    if (key != pageCrc[index]) {
+      // Either the write did not take or a cached page was stale
+      lastError = "Verify failed at page 0x" + String(pageAddress, HEX);
+      invalidateFlashCache();
+      return false;
+    }
+    imageCrc = crc32((const uint8_t*)&key, sizeof(key), imageCrc);
+    flashStats.pagesVerified++;
+  }
+
+  flashStats.imageCrc = imageCrc;
+  flashStats.verifyMs = millis() - start;
+  flashStats.verified = true;
+  return true;
+}
+
+void MD11SlaveUpdate::setTarget(uint8_t appAddress) {
+  if (appAddress != targetAddress) {
+    targetAddress = appAddress;
+    cacheLoaded = false;  // Reloaded for the new board by beginFlash()
+    cacheOnDisk = false;
+  }
+}
+
+String MD11SlaveUpdate::pathFor(uint8_t appAddress, const char* primary, const char* format) {
+  if (appAddress == APP_I2C_ADDR) {
+    return primary;
+  }
+  char path[32];
+  snprintf(path, sizeof(path), format, appAddress);
+  return path;
+}
+
+String MD11SlaveUpdate::cachePath() const {
+  return pathFor(targetAddress, MD11_FLASH_CACHE_PATH, MD11_FLASH_CACHE_FMT);
+}
+
+void MD11SlaveUpdate::loadFlashCache() {
+  cacheLoaded = true;
+  cacheOnDisk = false;
+  memset(pageCrc, 0, sizeof(pageCrc));
+
+  if (!LittleFS.exists(cachePath())) {
+    return;
+  }
+  File file = LittleFS.open(cachePath(), "r");
+  if (!file) {
+    return;
+  }
+
+  FlashCacheHeader header;
+  bool valid = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+               header.magic == MD11_FLASH_CACHE_MAGIC &&
+               header.pageSize == HEX_PAGE_SIZE &&
+               header.pageCount == MD11_FLASH_PAGES &&
+               file.read((uint8_t*)pageCrc, sizeof(pageCrc)) == sizeof(pageCrc);
+  file.close();
+
+  if (!valid) {
+    Serial.println("[MD11SlaveUpdate] Discarding invalid flash cache");
+    memset(pageCrc, 0, sizeof(pageCrc));
+    LittleFS.remove(cachePath());
+    return;
+  }
+
+  cacheOnDisk = true;
+  uint16_t known = 0;
+  for (uint16_t i = 0; i < MD11_FLASH_PAGES; i++) {
+    if (pageCrc[i] != 0) {
+      known++;
+    }
+  }
+  Serial.printf("[MD11SlaveUpdate] Flash cache loaded (%u pages known)\n", known);
+}
+
+bool MD11SlaveUpdate::saveFlashCache() {
+  File file = LittleFS.open(cachePath(), "w");
+  if (!file) {
+    Serial.println("[MD11SlaveUpdate] WARNING: Cannot write flash cache");
+    return false;
+  }
+
+  FlashCacheHeader header = {MD11_FLASH_CACHE_MAGIC, HEX_PAGE_SIZE, MD11_FLASH_PAGES};
+  bool written = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                 file.write((const uint8_t*)pageCrc, sizeof(pageCrc)) == sizeof(pageCrc);
+  file.close();
+
+  if (!written) {
+    LittleFS.remove(cachePath());
+    Serial.println("[MD11SlaveUpdate] WARNING: Flash cache write incomplete, removed");
+    return false;
+  }
+  cacheOnDisk = true;
+  return true;
+}
+
+void MD11SlaveUpdate::dropFlashCacheFile() {
+  if (cacheOnDisk) {
+    LittleFS.remove(cachePath());
+    cacheOnDisk = false;
+  }
+}
+
+void MD11SlaveUpdate::invalidateFlashCache() {
+  memset(pageCrc, 0, sizeof(pageCrc));
+  cacheLoaded = true;
+  cacheOnDisk = false;
+  if (LittleFS.exists(cachePath())) {
+    LittleFS.remove(cachePath());
+  }
+}
+
+// CRC-32 (IEEE, reflected), chainable through the crc argument
+uint32_t MD11SlaveUpdate::crc32(const uint8_t* data, size_t length, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// Page CRC as stored in the cache; 0 is reserved for "unknown"
+uint32_t MD11SlaveUpdate::pageKey(const uint8_t* page, uint16_t size) {
+  uint32_t crc = crc32(page, size);
+  return crc ? crc : 1;
+}
+
 bool MD11SlaveUpdate::writeFlashPage(uint16_t pageAddress, const uint8_t* pageData, uint16_t pageSize) {
-  Serial.printf("[MD11SlaveUpdate] Writing page at 0x%04X (%d bytes)\n", pageAddress, pageSize);
-  
-  const int CHUNK_SIZE = 16;  // 16 bytes per I2C transaction (safe for Wire library 32-byte buffer)
   const int MAX_RETRIES = 3;
   
-  // CRITICAL: Use Wire1 (slave bus, GPIO5/6) - NOT Wire (display bus, GPIO8/9)!
-  // The bootloader at 0x14 is on the slave bus.
-  TwoWire* wire = &Wire1;
+  // The bootloader at 0x14 is on the slave bus - go through I2CManager so the
+  // slave bus mutex is honoured and the bus backend can be swapped.
+  I2CManager& manager = I2CManager::getInstance();
+  uint8_t frame[TWIBOOT_WRITE_HEADER + TWIBOOT_WRITE_CHUNK];
+  uint32_t start = micros();
   
-  // Write page in 16-byte chunks
-  // Each chunk is a separate I2C transaction with STOP condition.
   // Twiboot protocol: [CMD_ACCESS_MEMORY(0x02)] [MEMTYPE_FLASH(0x01)] [addrH] [addrL] [data...]
-  // Page write is triggered internally when page boundary is reached.
-  for (int offset = 0; offset < pageSize; offset += CHUNK_SIZE) {
-    int bytesThisChunk = min(CHUNK_SIZE, pageSize - offset);
+  // One transaction with STOP per chunk; the page is programmed once its
+  // last byte has arrived.
+  for (uint16_t offset = 0; offset < pageSize; offset += TWIBOOT_WRITE_CHUNK) {
+    uint16_t bytesThisChunk = min((uint16_t)TWIBOOT_WRITE_CHUNK, (uint16_t)(pageSize - offset));
     uint16_t chunkAddr = pageAddress + offset;
     
+    frame[0] = 0x02;  // CMD_ACCESS_MEMORY
+    frame[1] = 0x01;  // MEMTYPE_FLASH
+    frame[2] = (chunkAddr >> 8) & 0xFF;
+    frame[3] = chunkAddr & 0xFF;
+    memcpy(frame + TWIBOOT_WRITE_HEADER, pageData + offset, bytesThisChunk);
+    
     bool chunkSent = false;
     for (int attempt = 1; attempt <= MAX_RETRIES && !chunkSent; attempt++) {
-      wire->beginTransmission(TWIBOOT_I2C_ADDR);
-      wire->write(0x02);  // CMD_ACCESS_MEMORY
-      wire->write(0x01);  // MEMTYPE_FLASH
-      wire->write((chunkAddr >> 8) & 0xFF);  // Address high byte
-      wire->write(chunkAddr & 0xFF);         // Address low byte
-      
-      // Write chunk data
-      for (int i = 0; i < bytesThisChunk; i++) {
-        wire->write(pageData[offset + i]);
-      }
-      
-      // Send STOP after every chunk (bootloader expects this)
-      uint8_t err = wire->endTransmission(true);
-      
-      if (err == 0) {
+      if (manager.write(TWIBOOT_I2C_ADDR, frame, TWIBOOT_WRITE_HEADER + bytesThisChunk)) {
         chunkSent = true;
       } else {
-        Serial.printf("[MD11SlaveUpdate] ERROR: Chunk at 0x%04X+%d failed (attempt %d, error %d)\n", 
-                     pageAddress, offset, attempt, err);
-        delay(5 * attempt);  // Increasing delay on retries
+        Serial.printf("[MD11SlaveUpdate] ERROR: Chunk at 0x%04X+%u failed (attempt %d): %s\n", 
+                     pageAddress, offset, attempt, manager.getLastError().c_str());
+        // Retry as soon as the bootloader listens again
+        manager.waitForAck(TWIBOOT_I2C_ADDR, TWIBOOT_PAGE_TIMEOUT_MS);
       }
     }
     
     if (!chunkSent) {
-      lastError = "Failed to send chunk at address 0x" + String(pageAddress + offset, HEX);
+      lastError = "Failed to send chunk at address 0x" + String(chunkAddr, HEX);
       return false;
     }
-    
-    // Wait for bootloader to process chunk
-    // On page boundary crossings, bootloader does erase+write (~4.5ms for ATmega328P)
-    delay(5);
   }
   
-  // Extra delay after full page for potential page flush
-  delay(10);
+  // The bootloader does not answer while erasing and programming the page
+  uint32_t waitedUs = 0;
+  if (!manager.waitForAck(TWIBOOT_I2C_ADDR, TWIBOOT_PAGE_TIMEOUT_MS, &waitedUs)) {
+    lastError = "Bootloader did not return after programming page 0x" + String(pageAddress, HEX);
+    return false;
+  }
+  
+  flashStats.bytesWritten += pageSize;
+  flashStats.programWaitUs += waitedUs;
+  flashStats.writeUs += micros() - start;
   
-  Serial.println("[MD11SlaveUpdate] Page written successfully");
+  Serial.printf("[MD11SlaveUpdate] Page 0x%04X written (%u bytes, ready after %lu us)\n",
+                pageAddress, pageSize, (unsigned long)waitedUs);
   return true;
 }
 
-bool MD11SlaveUpdate::parseHexLine(const String& line, HexRecord& record) {
-  if (line.length() < 11) return false;
-  if (line[0] != ':') return false;
-  
-  // Parse: :LLAAAATTDD...CC
-  // LL = byte count, AAAA = address, TT = record type, DD = data, CC = checksum
-  
-  record.data.clear();
-  
-  // Byte count
-  uint8_t byteCount = strtol(line.substring(1, 3).c_str(), nullptr, 16);
-  
-  // Address
-  record.address = strtol(line.substring(3, 7).c_str(), nullptr, 16);
-  
-  // Record type
-  record.recordType = strtol(line.substring(7, 9).c_str(), nullptr, 16);
-  
-  // Data bytes
-  for (int i = 0; i < byteCount; i++) {
-    int pos = 9 + (i * 2);
-    if (pos + 2 > line.length()) return false;
-    
-    uint8_t byte = strtol(line.substring(pos, pos + 2).c_str(), nullptr, 16);
-    record.data.push_back(byte);
-  }
-  
-  return true;
+// ============================================================================
+// Backup / rollback
+// ============================================================================
+
+String MD11SlaveUpdate::backupImagePath(uint8_t appAddress) {
+  return pathFor(appAddress, MD11_BACKUP_IMAGE_PATH, MD11_BACKUP_IMAGE_FMT);
 }
 
-bool MD11SlaveUpdate::writeMemory(uint16_t address, const uint8_t* data, uint16_t length) {
-  Serial.printf("[MD11SlaveUpdate] Writing %d bytes to 0x%04X\n", length, address);
-  
-  // Twiboot write command: [CMD] [ADDR_HIGH] [ADDR_LOW] [LEN] [DATA...]
-  uint8_t cmdData[20];
-  cmdData[0] = (address >> 8) & 0xFF;
-  cmdData[1] = address & 0xFF;
-  cmdData[2] = length & 0xFF;
-  
-  // Copy data
-  for (int i = 0; i < length && i < 16; i++) {
-    cmdData[3 + i] = data[i];
+String MD11SlaveUpdate::backupEepromPath(uint8_t appAddress) {
+  return pathFor(appAddress, MD11_BACKUP_EEPROM_PATH, MD11_BACKUP_EEPROM_FMT);
+}
+
+bool MD11SlaveUpdate::beginBackup() {
+  abortBackup();
+  backupStats = BackupStats();
+  backupStartMs = millis();
+
+  if (!queryChipInfo(backupChip)) {
+    return false;
   }
-  
-  uint8_t response[1];
-  uint16_t responseLen = 1;
-  
-  if (!sendBootloaderCommand(TWIBOOT_WRITE_FLASH, cmdData, 3 + length, response, &responseLen)) {
-    lastError = "Write memory failed";
+  if (backupChip.pageSize != HEX_PAGE_SIZE || backupChip.flashSize == 0 ||
+      backupChip.flashSize > HEX_BOOTLOADER_START) {
+    lastError = "Unexpected chip geometry (page " + String(backupChip.pageSize) +
+                ", flash " + String(backupChip.flashSize) + ")";
     return false;
   }
-  
-  if (responseLen < 1 || response[0] != BOOT_OK) {
-    lastError = "Bootloader returned error";
+  backupPageCount = backupChip.flashSize / HEX_PAGE_SIZE;
+
+  // The pages read below are what the slave holds: they seed the page cache
+  if (!cacheLoaded) {
+    loadFlashCache();
+  }
+
+  backupFile = LittleFS.open(MD11_BACKUP_TEMP_PATH, "w");
+  if (!backupFile) {
+    lastError = "Cannot create " MD11_BACKUP_TEMP_PATH;
+    return false;
+  }
+  backupWriter = new MsImageWriter();
+  if (!backupWriter->begin(backupFile, backupChip.signature)) {
+    abortBackup();
+    lastError = "Cannot write backup image";
     return false;
   }
-  
   return true;
 }
 
-bool MD11SlaveUpdate::readMemory(uint16_t address, uint8_t* buffer, uint16_t length) {
-  Serial.printf("[MD11SlaveUpdate] Reading %d bytes from 0x%04X\n", length, address);
-  
-  uint8_t cmdData[3];
-  cmdData[0] = (address >> 8) & 0xFF;
-  cmdData[1] = address & 0xFF;
-  cmdData[2] = length & 0xFF;
-  
-  if (!sendBootloaderCommand(TWIBOOT_READ_FLASH, cmdData, 3, buffer, &length)) {
-    lastError = "Read memory failed";
+bool MD11SlaveUpdate::backupPage(uint16_t index) {
+  if (!backupWriter || index >= backupPageCount) {
+    lastError = "No backup in progress";
     return false;
   }
-  
+
+  uint8_t page[HEX_PAGE_SIZE];
+  uint16_t pageAddress = index * HEX_PAGE_SIZE;
+  uint32_t start = micros();
+  if (!readFlash(pageAddress, page, HEX_PAGE_SIZE)) {
+    abortBackup();
+    return false;
+  }
+  backupStats.readUs += micros() - start;
+  backupStats.flashBytes += HEX_PAGE_SIZE;
+
+  uint32_t key = pageKey(page, HEX_PAGE_SIZE);
+  if (pageCrc[index] != 0 && pageCrc[index] != key) {
+    dropFlashCacheFile();  // Stale: the slave was changed behind our back
+  }
+  pageCrc[index] = key;
+
+  bool erased = true;
+  for (uint16_t i = 0; i < HEX_PAGE_SIZE && erased; i++) {
+    erased = (page[i] == 0xFF);
+  }
+  if (erased) {
+    return true;  // Sparse image, like a decoded .hex
+  }
+  if (!backupWriter->addPage(pageAddress, page)) {
+    abortBackup();
+    lastError = "Cannot write backup image";
+    return false;
+  }
+  backupStats.pagesStored++;
   return true;
 }
 
-bool MD11SlaveUpdate::sendBootloaderCommand(TwiBootCommand cmd, const uint8_t* data,
-                                          uint16_t dataLen, uint8_t* response,
-                                          uint16_t* responseLen) {
-  // Send command to bootloader via I2C slave bus (Wire1, GPIO5/6)
-  I2CManager& manager = I2CManager::getInstance();
-  
-  // Build command buffer
-  uint8_t cmdBuffer[256];
-  cmdBuffer[0] = (uint8_t)cmd;
-  
-  if (data && dataLen > 0) {
-    memcpy(cmdBuffer + 1, data, dataLen);
+bool MD11SlaveUpdate::finishBackup() {
+  if (!backupWriter) {
+    lastError = "No backup in progress";
+    return false;
   }
-  
-  // Send via slave bus (Wire1)
-  if (!manager.write(TWIBOOT_I2C_ADDR, cmdBuffer, 1 + dataLen)) {
-    lastError = "I2C transmission failed on slave bus";
-    Serial.println("[MD11SlaveUpdate] ERROR: Write failed - " + lastError);
+  if (backupStats.pagesStored == 0) {
+    // Blank board: keep the previous backup, there is nothing to roll back to
+    abortBackup();
+    Serial.println("[MD11SlaveUpdate] Slave flash is empty, no backup taken");
+    return true;
+  }
+
+  bool sealed = backupWriter->finish();
+  delete backupWriter;
+  backupWriter = nullptr;
+  backupFile.close();
+  if (!sealed) {
+    LittleFS.remove(MD11_BACKUP_TEMP_PATH);
+    lastError = "Cannot write backup image";
     return false;
   }
-  
-  Serial.printf("[MD11SlaveUpdate] Sent command 0x%02X to bootloader, waiting for response...\n", cmd);
-  
-  // Small delay for bootloader to process command
-  delay(10);
-  
-  // Request response from bootloader (flexible length)
-  if (response && responseLen && *responseLen > 0) {
-    uint16_t maxLen = *responseLen;
-    uint16_t bytesRead = 0;
-    unsigned long startTime = millis();
-    unsigned long timeout = 100;  // 100ms timeout
-    
-    // Use Wire1 directly (slave bus, GPIO5/6)
-    TwoWire* wire1 = &Wire1;
-    
-    // Simple requestFrom - no extra beginTransmission needed
-    // The previous write already completed with STOP
-    size_t available = wire1->requestFrom(TWIBOOT_I2C_ADDR, maxLen);
-    Serial.printf("[MD11SlaveUpdate] Requested %d bytes, got %d available\n", maxLen, available);
-    
-    while (wire1->available() && bytesRead < maxLen && (millis() - startTime) < timeout) {
-      response[bytesRead++] = wire1->read();
+
+  // EEPROM: raw dump, streamed in read chunks
+  File eeprom = LittleFS.open(MD11_BACKUP_TEMP_EEPROM, "w");
+  bool ok = (bool)eeprom;
+  uint8_t buffer[MD11_READ_CHUNK];
+  for (uint16_t offset = 0; ok && offset < backupChip.eepromSize; offset += sizeof(buffer)) {
+    uint16_t n = min((uint16_t)sizeof(buffer), (uint16_t)(backupChip.eepromSize - offset));
+    uint32_t start = micros();
+    ok = readMemory(TWIBOOT_MEM_EEPROM, offset, buffer, n);
+    backupStats.readUs += micros() - start;
+    if (ok && eeprom.write(buffer, n) != n) {
+      lastError = "Cannot write EEPROM backup";
+      ok = false;
     }
-    
-    Serial.printf("[MD11SlaveUpdate] Read %d bytes from bootloader\n", bytesRead);
-    
-    if (bytesRead == 0) {
-      lastError = "No response from bootloader";
-      Serial.println("[MD11SlaveUpdate] ERROR: " + lastError);
-      *responseLen = 0;
-      return false;
+    backupStats.eepromBytes += ok ? n : 0;
+  }
+  if (eeprom) {
+    eeprom.close();
+  } else {
+    lastError = "Cannot create " MD11_BACKUP_TEMP_EEPROM;
+  }
+
+  // Only a complete pair replaces the previous good backup
+  String imagePath = backupImagePath(targetAddress);
+  String eepromPath = backupEepromPath(targetAddress);
+  if (ok) {
+    LittleFS.remove(imagePath);
+    LittleFS.remove(eepromPath);
+    ok = LittleFS.rename(MD11_BACKUP_TEMP_PATH, imagePath) &&
+         LittleFS.rename(MD11_BACKUP_TEMP_EEPROM, eepromPath);
+    if (!ok) {
+      lastError = "Cannot store " + imagePath;
+      LittleFS.remove(imagePath);  // Never leave an image without its EEPROM
     }
-    
-    *responseLen = bytesRead;
   }
-  
+  if (!ok) {
+    LittleFS.remove(MD11_BACKUP_TEMP_PATH);
+    LittleFS.remove(MD11_BACKUP_TEMP_EEPROM);
+    return false;
+  }
+
+  backupStats.totalMs = millis() - backupStartMs;
+  if (backupStats.readUs > 0) {
+    backupStats.bytesPerSec = (uint64_t)(backupStats.flashBytes + backupStats.eepromBytes) * 1000000ULL /
+                              backupStats.readUs;
+  }
+  backupStats.complete = true;
+
+  Serial.printf("[MD11SlaveUpdate] Backup: %u of %u pages + %lu bytes EEPROM in %lu ms (%lu B/s read)\n",
+                backupStats.pagesStored, backupPageCount, (unsigned long)backupStats.eepromBytes,
+                (unsigned long)backupStats.totalMs, (unsigned long)backupStats.bytesPerSec);
   return true;
 }
 
-uint8_t MD11SlaveUpdate::calculateHexChecksum(const String& line) {
-  // Calculate checksum for Intel HEX format
-  uint8_t sum = 0;
-  
-  // Skip the ':' at the beginning
-  for (int i = 1; i < line.length() - 2; i += 2) {
-    uint8_t byte = strtol(line.substring(i, i + 2).c_str(), nullptr, 16);
-    sum += byte;
+void MD11SlaveUpdate::abortBackup() {
+  if (backupWriter) {
+    delete backupWriter;
+    backupWriter = nullptr;
   }
-  
-  return (~sum + 1) & 0xFF;
+  if (backupFile) {
+    backupFile.close();
+    LittleFS.remove(MD11_BACKUP_TEMP_PATH);
+  }
+}
+
+bool MD11SlaveUpdate::restoreEeprom(const String& path) {
+  ChipInfo chip;
+  if (!queryChipInfo(chip)) {
+    return false;
+  }
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    lastError = "Cannot open " + path;
+    return false;
+  }
+  if (file.size() == 0 || file.size() > chip.eepromSize) {
+    file.close();
+    lastError = "EEPROM dump does not fit the target (" + String(chip.eepromSize) + " bytes)";
+    return false;
+  }
+
+  uint8_t buffer[64];
+  uint16_t address = 0;
+  bool ok = true;
+  while (ok && file.available() > 0) {
+    size_t n = file.read(buffer, sizeof(buffer));
+    if (n == 0) {
+      break;
+    }
+    ok = writeEeprom(address, buffer, n);
+    address += n;
+  }
+  file.close();
+  return ok;
 }
@@ -0,0 +1,185 @@
+#include "ms11_image.h"
+#include <LittleFS.h>
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+bool MsImageWriter::begin(File& out, const uint8_t signature[3], uint8_t fwVersion,
+                          uint16_t pageSize) {
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MSIMG_MAGIC, sizeof(header.magic));
+  header.formatVersion = MSIMG_FORMAT_VERSION;
+  header.headerSize = MSIMG_HEADER_SIZE;
+  header.pageSize = pageSize;
+  memcpy(header.signature, signature, sizeof(header.signature));
+  header.fwVersion = fwVersion;
+
+  file = &out;
+  lastAddress = -1;
+  mbedtls_sha256_starts(&sha, 0);
+
+  // Placeholder, rewritten by finish()
+  return file->write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+}
+
+bool MsImageWriter::addPage(uint16_t pageAddress, const uint8_t* page) {
+  if (!file || (int32_t)pageAddress <= lastAddress || (pageAddress % header.pageSize) != 0) {
+    return false;
+  }
+
+  uint8_t address[2] = {(uint8_t)(pageAddress & 0xFF), (uint8_t)(pageAddress >> 8)};
+  if (file->write(address, sizeof(address)) != sizeof(address) ||
+      file->write(page, header.pageSize) != header.pageSize) {
+    return false;
+  }
+  mbedtls_sha256_update(&sha, address, sizeof(address));
+  mbedtls_sha256_update(&sha, page, header.pageSize);
+
+  lastAddress = pageAddress;
+  header.pageCount++;
+  return true;
+}
+
+bool MsImageWriter::finish() {
+  if (!file) {
+    return false;
+  }
+  mbedtls_sha256_finish(&sha, header.sha256);
+
+  bool written = file->seek(0) &&
+                 file->write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+  file = nullptr;
+  return written;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+bool readImageHeader(File& file, MsImageHeader& header, String& error) {
+  if (!file.seek(0) || file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+    error = "Image too short";
+    return false;
+  }
+  if (memcmp(header.magic, MSIMG_MAGIC, sizeof(header.magic)) != 0) {
+    error = "Not an .msimg image";
+    return false;
+  }
+  if (header.formatVersion != MSIMG_FORMAT_VERSION || header.headerSize != MSIMG_HEADER_SIZE) {
+    error = "Unsupported image format " + String(header.formatVersion);
+    return false;
+  }
+  if (header.pageSize != HEX_PAGE_SIZE) {
+    error = "Image page size " + String(header.pageSize) + " does not match the target";
+    return false;
+  }
+
+  size_t expected = MSIMG_HEADER_SIZE + (size_t)header.pageCount * MSIMG_RECORD_SIZE(header.pageSize);
+  if (header.pageCount == 0 || file.size() != expected) {
+    error = "Image size " + String(file.size()) + " does not match " + String(header.pageCount) + " pages";
+    return false;
+  }
+  return true;
+}
+
+bool verifyImageDigest(File& file, const MsImageHeader& header, String& error) {
+  if (!file.seek(MSIMG_HEADER_SIZE)) {
+    error = "Image seek failed";
+    return false;
+  }
+
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+
+  uint8_t buffer[256];
+  size_t remaining = (size_t)header.pageCount * MSIMG_RECORD_SIZE(header.pageSize);
+  while (remaining > 0) {
+    size_t n = file.read(buffer, min(remaining, sizeof(buffer)));
+    if (n == 0) {
+      break;
+    }
+    mbedtls_sha256_update(&sha, buffer, n);
+    remaining -= n;
+  }
+
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&sha, digest);
+  mbedtls_sha256_free(&sha);
+
+  if (remaining > 0 || memcmp(digest, header.sha256, sizeof(digest)) != 0) {
+    error = "Image SHA-256 mismatch";
+    return false;
+  }
+  return file.seek(MSIMG_HEADER_SIZE);
+}
+
+// ============================================================================
+// .hex -> .msimg conversion
+// ============================================================================
+
+static bool onConvertPage(uint16_t pageAddress, const uint8_t* page, uint16_t size, void* context) {
+  return static_cast<MsImageWriter*>(context)->addPage(pageAddress, page);
+}
+
+bool parseFirmwareVersion(const String& text, uint8_t& version) {
+  char* end = nullptr;
+  unsigned long value = strtoul(text.c_str(), &end, 16);
+  if (text.isEmpty() || *end != '\0' || value == 0 || value > 0x99 || (value & 0x0F) > 9) {
+    return false;
+  }
+  version = (uint8_t)value;
+  return true;
+}
+
+bool convertHexToImage(const String& hexPath, const String& imagePath, String& error,
+                       uint8_t fwVersion) {
+  File hexFile = LittleFS.open(hexPath, "r");
+  if (!hexFile) {
+    error = "Cannot open " + hexPath;
+    return false;
+  }
+  File imageFile = LittleFS.open(imagePath, "w");
+  if (!imageFile) {
+    hexFile.close();
+    error = "Cannot create " + imagePath;
+    return false;
+  }
+
+  const uint8_t signature[3] = MSIMG_SIG_ATMEGA328P;
+  MsImageWriter writer;
+  IntelHexStream decoder(onConvertPage, &writer);
+  bool ok = writer.begin(imageFile, signature, fwVersion);
+
+  uint8_t buffer[256];
+  while (ok && hexFile.available() > 0) {
+    size_t n = hexFile.readBytes(buffer, sizeof(buffer));
+    if (n == 0) {
+      break;
+    }
+    IntelHexStream::Result result = decoder.feed(buffer, n);
+    ok = (result == IntelHexStream::HEX_OK || result == IntelHexStream::HEX_DONE);
+  }
+  if (ok) {
+    ok = decoder.finish() == IntelHexStream::HEX_DONE && writer.finish();
+  }
+  hexFile.close();
+  imageFile.close();
+
+  if (!ok) {
+    IntelHexStream::Result result = decoder.getResult();
+    if (result == IntelHexStream::HEX_OK || result == IntelHexStream::HEX_DONE) {
+      error = "Cannot write " + imagePath;
+    } else {
+      // HEX_ERROR_WRITE: a page arrived out of order or its record could not be written
+      error = String(decoder.getErrorString()) + " (record " + String(decoder.getLine()) + ")";
+    }
+    LittleFS.remove(imagePath);
+    return false;
+  }
+
+  Serial.printf("[MS11Image] Converted %s -> %s (%u pages)\n",
+                hexPath.c_str(), imagePath.c_str(), writer.getPageCount());
+  return true;
+}
@@ -0,0 +1,634 @@
+#include "oven_controller.h"
+#include "config.h"
+#include "slave_controller.h"
+#include "slave_events.h"
+#include "probe_manager.h"
+#include "slave_flasher.h"
+#include <Preferences.h>
+
+static_assert(COOK_MAX_SETPOINT == OVEN_MAX_TEMP_C * 100, "Cook setpoints must stay below OVEN_MAX_TEMP_C");
+
+bool OvenController::begin() {
+  if (task) {
+    return true;
+  }
+
+  lock = xSemaphoreCreateMutex();
+  if (!lock) {
+    Serial.println("[OvenController] ERROR: Failed to create lock");
+    return false;
+  }
+  loadSettings();
+  SlaveFlasher::getInstance().setStartGuard(flashGuard, this);
+
+  if (xTaskCreatePinnedToCore(controlTask, "oven_ctrl", OVEN_CTRL_TASK_STACK, this,
+                              OVEN_CTRL_TASK_PRIORITY, &task, OVEN_CTRL_TASK_CORE) != pdPASS) {
+    task = nullptr;
+    Serial.println("[OvenController] ERROR: Failed to start control task");
+    return false;
+  }
+
+  const PidGains& gains = law.getConfig().gains;
+  Serial.printf("[OvenController] ✓ Ready (kp=%.3f ki=%.4f kd=%.2f, %u ms period)\n",
+                gains.kp, gains.ki, gains.kd, OVEN_CTRL_PERIOD_MS);
+  return true;
+}
+
+// ============================================================================
+// Settings (NVS)
+// ============================================================================
+
+void OvenController::loadSettings() {
+  OvenControlConfig config;
+  config.ffBias = OVEN_FF_DEFAULT_BIAS;
+  config.derivativeTau = OVEN_DERIVATIVE_TAU_S;
+  config.slewPerSecond = OVEN_DEMAND_SLEW_PER_S;
+  config.augerWindowMs = OVEN_AUGER_WINDOW_MS;
+  config.augerMinPulseMs = OVEN_AUGER_MIN_PULSE_MS;
+  config.fanMin = OVEN_FAN_MIN_PERCENT;
+  config.fanMax = OVEN_FAN_MAX_PERCENT;
+
+  Preferences prefs;
+  prefs.begin(OVEN_CTRL_NAMESPACE, true);  // true = read-only mode
+  config.gains.kp = prefs.getFloat("kp", OVEN_PID_DEFAULT_KP);
+  config.gains.ki = prefs.getFloat("ki", OVEN_PID_DEFAULT_KI);
+  config.gains.kd = prefs.getFloat("kd", OVEN_PID_DEFAULT_KD);
+  config.ffPerDegree = prefs.getFloat("kff", OVEN_FF_DEFAULT_PER_DEGREE);
+  config.rampPerMinute = prefs.getFloat("ramp", OVEN_RAMP_DEFAULT_PER_MIN);
+  status.tuneResult.ku = prefs.getFloat("ku", 0.0f);
+  status.tuneResult.pu = prefs.getFloat("pu", 0.0f);
+  prefs.end();
+
+  law.configure(config);
+
+  AutotuneConfig tuneConfig;
+  tuneConfig.amplitude = OVEN_AUTOTUNE_AMPLITUDE;
+  tuneConfig.hysteresis = OVEN_AUTOTUNE_HYSTERESIS_C;
+  tuneConfig.cycles = OVEN_AUTOTUNE_CYCLES;
+  tuneConfig.maxCycles = OVEN_AUTOTUNE_MAX_CYCLES;
+  tuneConfig.timeoutMs = OVEN_AUTOTUNE_TIMEOUT_MIN * 60000UL;
+  tuner.configure(tuneConfig);
+}
+
+void OvenController::saveSettings() {
+  OvenControlConfig config = getConfig();
+  AutotuneResult tuned = getStatus().tuneResult;
+
+  Preferences prefs;
+  prefs.begin(OVEN_CTRL_NAMESPACE, false);  // false = read/write mode
+  prefs.putFloat("kp", config.gains.kp);
+  prefs.putFloat("ki", config.gains.ki);
+  prefs.putFloat("kd", config.gains.kd);
+  prefs.putFloat("kff", config.ffPerDegree);
+  prefs.putFloat("ramp", config.rampPerMinute);
+  if (tuned.ku > 0.0f) {
+    prefs.putFloat("ku", tuned.ku);
+    prefs.putFloat("pu", tuned.pu);
+  }
+  prefs.end();
+}
+
+// ============================================================================
+// Commands
+// ============================================================================
+
+// SlaveFlasher start guard: the MS11-control is only flashed with the oven
+// stopped. The flasher has reserved its job slot before asking, and the
+// start commands check isBusy() under our lock, so one of the two always
+// sees the other.
+const char* OvenController::flashGuard(uint8_t target, void* context) {
+  if (target != SLAVE_I2C_ADDR) {
+    return nullptr;
+  }
+  Mode mode = static_cast<OvenController*>(context)->getStatus().mode;
+  return (mode == OVEN_OFF || mode == OVEN_FAULT) ? nullptr : "Oven is running";
+}
+
+bool OvenController::start(float target) {
+  if (!lock || !(target > 0.0f) || target >= OVEN_MAX_TEMP_C) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (SlaveFlasher::getInstance().isBusy()) {
+    xSemaphoreGive(lock);
+    return false;   // Slave update in progress
+  }
+  if (status.programActive) {
+    endProgram();   // Manual target takes over
+  }
+  law.setTarget(target);
+  status.target = target;
+  status.mode = OVEN_AUTO;
+  status.readFailures = 0;
+  status.error[0] = '\0';
+  startRequested = true;   // The law restarts from the next oven reading
+  xSemaphoreGive(lock);
+
+  Serial.printf("[OvenController] Auto, target %.1f°C\n", target);
+  return true;
+}
+
+void OvenController::stop() {
+  if (!lock) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (status.mode == OVEN_AUTOTUNE) {
+    tuner.cancel();
+    status.tuneState = RelayAutotuner::TUNE_IDLE;
+  }
+  if (status.programActive) {
+    endProgram();
+  }
+  if (status.mode == OVEN_AUTO || status.mode == OVEN_AUTOTUNE) {
+    shutdownOutputs();
+    Serial.println("[OvenController] Stopped");
+  }
+  status.mode = OVEN_OFF;
+  xSemaphoreGive(lock);
+}
+
+bool OvenController::setTarget(float target) {
+  if (!lock || !(target > 0.0f) || target >= OVEN_MAX_TEMP_C) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool tuning = status.mode == OVEN_AUTOTUNE;   // The relay owns the setpoint
+  if (!tuning) {
+    law.setTarget(target);
+    status.target = target;
+  }
+  xSemaphoreGive(lock);
+  return !tuning;
+}
+
+bool OvenController::startAutotune(float setpoint, AutotuneRule rule) {
+  if (!lock || !(setpoint > 0.0f) || setpoint + OVEN_AUTOTUNE_MAX_DEVIATION_C >= OVEN_MAX_TEMP_C) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (status.programActive || SlaveFlasher::getInstance().isBusy()) {
+    xSemaphoreGive(lock);
+    return false;   // The program owns the setpoint, or a slave update is running
+  }
+  const OvenControlConfig& config = law.getConfig();
+  // Feed-forward at the setpoint is the first guess of the holding demand
+  tuner.start(setpoint, config.ffBias + config.ffPerDegree * setpoint, millis());
+  law.setTarget(setpoint);
+  status.target = setpoint;
+  status.mode = OVEN_AUTOTUNE;
+  status.readFailures = 0;
+  status.error[0] = '\0';
+  status.tuneState = RelayAutotuner::TUNE_RUNNING;
+  status.tuneRule = rule;
+  status.tuneCycles = 0;
+  startRequested = true;
+  xSemaphoreGive(lock);
+
+  Serial.printf("[OvenController] Autotune (%s) at %.1f°C\n", RelayAutotuner::ruleName(rule), setpoint);
+  return true;
+}
+
+void OvenController::cancelAutotune() {
+  if (!lock) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (status.mode == OVEN_AUTOTUNE) {
+    tuner.cancel();
+    status.tuneState = RelayAutotuner::TUNE_IDLE;
+    resumeAuto(status.temperature, millis(), status.demand);
+    Serial.println("[OvenController] Autotune cancelled");
+  }
+  xSemaphoreGive(lock);
+}
+
+void OvenController::setRampRate(float degreesPerMinute) {
+  if (!lock) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  OvenControlConfig config = law.getConfig();
+  config.rampPerMinute = max(degreesPerMinute, 0.0f);
+  law.configure(config);
+  xSemaphoreGive(lock);
+}
+
+void OvenController::setGains(const PidGains& gains, float ffPerDegree, bool persist) {
+  if (!lock) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  OvenControlConfig config = law.getConfig();
+  config.gains = gains;
+  config.ffPerDegree = ffPerDegree;
+  law.configure(config);
+  xSemaphoreGive(lock);
+
+  if (persist) {
+    saveSettings();
+  }
+}
+
+OvenControlConfig OvenController::getConfig() {
+  if (!lock) {
+    return law.getConfig();
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  OvenControlConfig config = law.getConfig();
+  xSemaphoreGive(lock);
+  return config;
+}
+
+OvenController::Status OvenController::getStatus() {
+  if (!lock) {
+    return status;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  Status copy = status;
+  xSemaphoreGive(lock);
+  return copy;
+}
+
+const char* OvenController::modeName(Mode mode) {
+  switch (mode) {
+    case OVEN_OFF:   return "off";
+    case OVEN_AUTO:  return "auto";
+    case OVEN_FAULT: return "fault";
+    case OVEN_AUTOTUNE: return "autotune";
+    default:         return "unknown";
+  }
+}
+
+// ============================================================================
+// Cook programs
+// ============================================================================
+
+bool OvenController::startProgram(const CookProfile& profile) {
+  if (!lock || profile.validate() != nullptr) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (status.mode == OVEN_AUTOTUNE || SlaveFlasher::getInstance().isBusy()) {
+    xSemaphoreGive(lock);
+    return false;
+  }
+
+  cook.start(profile, millis());
+  status.programActive = true;
+  strlcpy(status.programName, profile.name, sizeof(status.programName));
+  status.programStages = profile.stageCount;
+  status.lastTrigger = -1;
+  enterCookStage();
+
+  if (status.mode != OVEN_AUTO) {
+    status.mode = OVEN_AUTO;
+    status.readFailures = 0;
+    status.error[0] = '\0';
+    startRequested = true;
+  }
+  xSemaphoreGive(lock);
+
+  Serial.printf("[OvenController] Program '%s' started (%u stages)\n", profile.name, profile.stageCount);
+  return true;
+}
+
+void OvenController::stopProgram() {
+  if (!lock) {
+    return;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (status.programActive) {
+    endProgram();
+    Serial.printf("[OvenController] Program stopped, holding %.1f°C\n", status.target);
+  }
+  xSemaphoreGive(lock);
+}
+
+bool OvenController::advanceProgram() {
+  if (!lock) {
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool running = cook.isRunning();
+  if (running) {
+    handleCookEvent(cook.advance(millis()));
+  }
+  xSemaphoreGive(lock);
+  return running;
+}
+
+// Trigger input for CookEngine: `context` points at the oven temperature
+static bool readCookInput(uint8_t probe, float& value, void* context) {
+  if (probe == COOK_PROBE_OVEN) {
+    value = *static_cast<const float*>(context);
+    return true;
+  }
+  ProbeData* data = ProbeManager::getInstance().getProbe(probe);
+  if (!data || !data->healthy || millis() - data->last_read_ms > OVEN_COOK_PROBE_STALE_MS) {
+    return false;
+  }
+  value = data->temperature;
+  return true;
+}
+
+// Caller holds the lock. false when the program finished and stopped the oven.
+bool OvenController::stepProgram(float temperature, uint32_t nowMs) {
+  if (!cook.isRunning()) {
+    return true;
+  }
+  CookEngine::Event event = cook.tick(readCookInput, &temperature, nowMs);
+  status.stageElapsedS = cook.getStageElapsedMs(nowMs) / 1000;
+  return handleCookEvent(event);
+}
+
+// Caller holds the lock
+bool OvenController::handleCookEvent(CookEngine::Event event) {
+  if (event == CookEngine::COOK_STAGE_CHANGED) {
+    enterCookStage();
+  } else if (event == CookEngine::COOK_FINISHED) {
+    Serial.printf("[OvenController] Program '%s' finished\n", status.programName);
+    notify("Program done");
+    endProgram();
+    shutdownOutputs();
+    status.mode = OVEN_OFF;
+    return false;
+  }
+  return true;
+}
+
+// Caller holds the lock. Runs the actions of the engine's current stage.
+void OvenController::enterCookStage() {
+  const CookStage& stage = cook.getStage();
+  status.programStage = cook.getStageIndex();
+  status.stageElapsedS = 0;
+  status.lastTrigger = cook.getLastTrigger();
+  CookProfile::stageName(stage, status.stageName);
+
+  // validate() already bounds the setpoint; a bad one still never reaches the law
+  if (stage.record.setpoint >= COOK_MAX_SETPOINT) {
+    Serial.printf("[OvenController] Stage setpoint %d out of range, keeping %.1f°C\n",
+                  stage.record.setpoint, status.target);
+  } else if (stage.record.setpoint > 0) {
+    status.target = stage.record.setpoint / 100.0f;
+    law.setTarget(status.target);
+  }
+  status.fanOverride = stage.record.fanPercent;
+  if (stage.record.flags & COOK_STAGE_NOTIFY) {
+    notify(status.stageName);
+  }
+
+  char fan[8] = "auto";
+  if (status.fanOverride != COOK_FAN_AUTO) {
+    snprintf(fan, sizeof(fan), "%u%%", status.fanOverride);
+  }
+  Serial.printf("[OvenController] Stage %u/%u '%s': target %.1f°C, fan %s (trigger %d)\n",
+                status.programStage + 1, status.programStages, status.stageName, status.target,
+                fan, status.lastTrigger);
+}
+
+// Caller holds the lock
+void OvenController::endProgram() {
+  cook.stop();
+  status.programActive = false;
+  status.fanOverride = COOK_FAN_AUTO;
+}
+
+// Caller holds the lock
+void OvenController::notify(const char* text) {
+  strlcpy(status.notifyText, text, sizeof(status.notifyText));
+  status.notifySeq++;
+  Serial.printf("[OvenController] Notify: %s\n", text);
+}
+
+// ============================================================================
+// Control loop
+// ============================================================================
+
+bool OvenController::readOvenTemperature(float& temperature) {
+  SlaveController& slave = SlaveController::getInstance();
+  int16_t value = 0;
+
+  // With the attention line the slave reports temperature changes itself,
+  // so a recent cached value is current and the bus stays idle. A missed
+  // attention edge only costs a read once the cache has aged out.
+  bool cached = SlaveEventMonitor::getInstance().isActive() &&
+                slave.getCachedOvenTemp(value, OVEN_CTRL_CACHE_MAX_AGE_MS);
+  if (!cached && !slave.readOvenTemp(value)) {
+    return false;
+  }
+  temperature = value;
+  return true;
+}
+
+// Temperature reads do not carry the status byte; refresh it when no
+// snapshot or status read has brought it in recently
+bool OvenController::readSlaveErrorCode(uint8_t& errorCode) {
+  SlaveController& slave = SlaveController::getInstance();
+  uint8_t statusByte = 0;
+  if (!slave.getCachedStatus(statusByte, OVEN_CTRL_CACHE_MAX_AGE_MS) && !slave.readStatus(statusByte)) {
+    return false;
+  }
+  errorCode = slave.getErrorCode();
+  return true;
+}
+
+// Caller holds the lock
+void OvenController::shutdownOutputs() {
+  SlaveController& slave = SlaveController::getInstance();
+  slave.setAuger(false);
+  slave.setFanPercent(OVEN_SHUTDOWN_FAN_PERCENT);
+  status.augerOn = false;
+  status.fanPercent = OVEN_SHUTDOWN_FAN_PERCENT;
+  status.demand = 0.0f;
+}
+
+// Caller holds the lock
+void OvenController::applyOutputs(const OvenControlLaw::Output& out) {
+  SlaveController& slave = SlaveController::getInstance();
+  slave.setAuger(out.augerOn);
+  slave.setFanPercent(out.fanPercent);
+
+  status.setpoint = out.setpoint;
+  status.demand = out.demand;
+  status.augerOn = out.augerOn;
+  status.fanPercent = out.fanPercent;
+  status.terms = out.terms;
+}
+
+// Caller holds the lock
+void OvenController::fault(const char* message) {
+  if (status.mode == OVEN_AUTOTUNE) {
+    tuner.cancel();
+    status.tuneState = RelayAutotuner::TUNE_FAILED;
+  }
+  if (status.programActive) {
+    endProgram();
+  }
+  shutdownOutputs();
+  status.mode = OVEN_FAULT;
+  strlcpy(status.error, message, sizeof(status.error));
+  Serial.printf("[OvenController] FAULT: %s\n", message);
+}
+
+// Caller holds the lock. Closed loop at `demand`, from the current temperature.
+void OvenController::resumeAuto(float temperature, uint32_t nowMs, float demand) {
+  law.setTarget(status.target);
+  law.reset(temperature, nowMs, demand);
+  status.mode = OVEN_AUTO;
+}
+
+// Caller holds the lock
+void OvenController::stepAutotune(float temperature, uint32_t nowMs) {
+  float demand = tuner.update(temperature, nowMs);
+  status.tuneState = tuner.getState();
+  status.tuneCycles = tuner.getCycleCount();
+
+  if (status.tuneState == RelayAutotuner::TUNE_RUNNING) {
+    OvenControlLaw::Output out = law.drive(demand, nowMs);
+    out.setpoint = tuner.getSetpoint();
+    applyOutputs(out);
+    return;
+  }
+
+  if (status.tuneState == RelayAutotuner::TUNE_DONE) {
+    const AutotuneResult& result = tuner.getResult();
+    OvenControlConfig config = law.getConfig();
+    config.gains = RelayAutotuner::gainsFor(result, status.tuneRule);
+    law.configure(config);
+    status.tuneResult = result;
+    saveRequested = true;
+    Serial.printf("[OvenController] Autotune done: Ku=%.2f Pu=%.0fs -> kp=%.3f ki=%.4f kd=%.1f\n",
+                  result.ku, result.pu, config.gains.kp, config.gains.ki, config.gains.kd);
+    resumeAuto(temperature, nowMs, result.bias);
+  } else {
+    // Keep cooking on the old gains; the reason stays visible in the status
+    snprintf(status.error, sizeof(status.error), "Autotune: %s", tuner.getError());
+    Serial.printf("[OvenController] %s, keeping the current gains\n", status.error);
+    resumeAuto(temperature, nowMs, status.demand);
+  }
+}
+
+void OvenController::tick(float dtSeconds) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool active = status.mode == OVEN_AUTO || status.mode == OVEN_AUTOTUNE;
+  xSemaphoreGive(lock);
+  if (!active) {
+    return;
+  }
+
+  // Bus access outside the lock so status readers never wait on I2C
+  float temperature = 0.0f;
+  uint8_t errorCode = 0;
+  bool valid = readOvenTemperature(temperature) && readSlaveErrorCode(errorCode);
+  uint8_t rejected = SlaveController::getInstance().getRejectedOutputs();
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (status.mode != OVEN_AUTO && status.mode != OVEN_AUTOTUNE) {
+    xSemaphoreGive(lock);  // Stopped while we were reading
+    return;
+  }
+
+  if (!valid) {
+    // Hold the last outputs through a few missed readings (temperature or status)
+    if (++status.readFailures >= OVEN_CTRL_MAX_READ_FAILURES) {
+      fault("Oven temperature unavailable");
+    }
+    xSemaphoreGive(lock);
+    return;
+  }
+  status.readFailures = 0;
+  status.temperature = temperature;
+
+  if (errorCode != 0) {
+    char message[OVEN_CTRL_ERROR_LENGTH];
+    snprintf(message, sizeof(message), "Slave error code %u", errorCode);
+    fault(message);
+  } else if (rejected != 0) {
+    char message[OVEN_CTRL_ERROR_LENGTH];
+    snprintf(message, sizeof(message), "Slave rejects %s command",
+             (rejected & 0x01) ? "fan" : ((rejected & 0x02) ? "igniter" : "auger"));
+    fault(message);
+  } else if (temperature > OVEN_MAX_TEMP_C) {
+    fault("Over temperature");
+  } else if (status.mode == OVEN_AUTOTUNE &&
+             temperature > tuner.getSetpoint() + OVEN_AUTOTUNE_MAX_DEVIATION_C) {
+    fault("Autotune overshoot");
+  } else {
+    uint32_t now = millis();
+    if (startRequested) {
+      law.reset(temperature, now);
+      startRequested = false;
+    }
+
+    if (status.mode == OVEN_AUTOTUNE) {
+      stepAutotune(temperature, now);
+    } else if (stepProgram(temperature, now)) {
+      OvenControlLaw::Output out = law.step(temperature, dtSeconds, now);
+      if (status.fanOverride != COOK_FAN_AUTO) {
+        out.fanPercent = status.fanOverride;
+      }
+      applyOutputs(out);
+    }
+  }
+  bool save = saveRequested;
+  saveRequested = false;
+  xSemaphoreGive(lock);
+
+  if (save) {
+    saveSettings();   // NVS write outside the lock
+  }
+}
+
+void OvenController::controlTask(void* param) {
+  OvenController* self = static_cast<OvenController*>(param);
+  const uint32_t periodUs = OVEN_CTRL_PERIOD_MS * 1000UL;
+  TickType_t wake = xTaskGetTickCount();
+  uint32_t idealUs = micros() + periodUs;
+  uint32_t lastUs = micros();
+  uint64_t jitterSumUs = 0;
+
+  for (;;) {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(OVEN_CTRL_PERIOD_MS));
+
+    uint32_t nowUs = micros();
+    int32_t jitter = (int32_t)(nowUs - idealUs);
+    idealUs += periodUs;
+    bool overrun = jitter > (int32_t)periodUs;
+    if (overrun) {
+      // Start a new grid instead of firing the missed ticks back to back
+      wake = xTaskGetTickCount();
+      idealUs = nowUs + periodUs;
+    }
+
+    // Real elapsed time, so a late tick integrates the right interval
+    float dt = constrain((nowUs - lastUs) / 1000000.0f, 0.001f, 5.0f);
+    lastUs = nowUs;
+
+    self->tick(dt);
+
+    xSemaphoreTake(self->lock, portMAX_DELAY);
+    Timing& timing = self->status.timing;
+    uint32_t magnitude = (uint32_t)abs(jitter);
+    timing.ticks++;
+    timing.lastJitterUs = jitter;
+    timing.maxJitterUs = max(timing.maxJitterUs, magnitude);
+    jitterSumUs += magnitude;
+    timing.meanJitterUs = (uint32_t)(jitterSumUs / timing.ticks);
+    timing.overruns += overrun ? 1 : 0;
+    timing.lastTickUs = micros() - nowUs;
+    xSemaphoreGive(self->lock);
+  }
+}
@@ -0,0 +1,164 @@
+#include "pid_autotune.h"
+#include <math.h>
+
+static float clampf(float value, float low, float high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+void RelayAutotuner::configure(const AutotuneConfig& newConfig) {
+  config = newConfig;
+  // Both relay levels must fit in 0-100 % around some bias
+  config.amplitude = clampf(config.amplitude, 1.0f, 50.0f);
+  if (config.cycles < 1) {
+    config.cycles = 1;
+  } else if (config.cycles > AUTOTUNE_MAX_CYCLES_AVERAGED) {
+    config.cycles = AUTOTUNE_MAX_CYCLES_AVERAGED;
+  }
+  if (config.maxCycles < config.discardCycles + config.cycles) {
+    config.maxCycles = config.discardCycles + config.cycles;
+  }
+}
+
+void RelayAutotuner::start(float newSetpoint, float initialBias, uint32_t nowMs) {
+  setpoint = newSetpoint;
+  bias = clampf(initialBias, config.amplitude, 100.0f - config.amplitude);
+  high = true;
+  startMs = nowMs;
+  inCycle = false;
+  cycleCount = 0;
+  historyCount = 0;
+  result = AutotuneResult();
+  error = "";
+  state = TUNE_RUNNING;
+}
+
+float RelayAutotuner::update(float measurement, uint32_t nowMs) {
+  if (state != TUNE_RUNNING) {
+    return bias;
+  }
+  if (nowMs - startMs > config.timeoutMs) {
+    fail("Timed out");
+    return bias;
+  }
+
+  peak = fmaxf(peak, measurement);
+  trough = fminf(trough, measurement);
+
+  if (high && measurement > setpoint + config.hysteresis) {
+    high = false;
+    if (inCycle) {
+      highMs = nowMs - cycleStartMs;
+    }
+  } else if (!high && measurement < setpoint - config.hysteresis) {
+    high = true;
+    if (inCycle) {
+      finishCycle(nowMs);
+    }
+    inCycle = true;
+    cycleStartMs = nowMs;
+    peak = trough = measurement;
+  }
+  return state == TUNE_RUNNING ? level() : bias;
+}
+
+void RelayAutotuner::finishCycle(uint32_t nowMs) {
+  uint32_t periodMs = nowMs - cycleStartMs;
+  float highFraction = periodMs > 0 ? (float)highMs / periodMs : 0.5f;
+  float meanDemand = bias + config.amplitude * (2.0f * highFraction - 1.0f);
+  cycleCount++;
+
+  if (cycleCount > config.discardCycles) {
+    if (historyCount == AUTOTUNE_MAX_CYCLES_AVERAGED) {
+      for (uint8_t i = 1; i < historyCount; i++) {
+        history[i - 1] = history[i];
+      }
+      historyCount--;
+    }
+    history[historyCount++] = {periodMs / 1000.0f, peak, trough, meanDemand};
+  }
+
+  // Centre the relay on the demand that actually held the oven
+  bias = clampf(meanDemand, config.amplitude, 100.0f - config.amplitude);
+
+  if (!evaluate() && cycleCount >= config.maxCycles) {
+    fail("Oscillation did not settle");
+  }
+}
+
+bool RelayAutotuner::evaluate() {
+  if (historyCount < config.cycles) {
+    return false;
+  }
+
+  const Cycle* last = &history[historyCount - config.cycles];
+  float period = 0.0f, amplitude = 0.0f, demand = 0.0f;
+  for (uint8_t i = 0; i < config.cycles; i++) {
+    period += last[i].period;
+    amplitude += (last[i].peak - last[i].trough) / 2.0f;
+    demand += last[i].meanDemand;
+  }
+  period /= config.cycles;
+  amplitude /= config.cycles;
+  demand /= config.cycles;
+
+  for (uint8_t i = 0; i < config.cycles; i++) {
+    float a = (last[i].peak - last[i].trough) / 2.0f;
+    if (fabsf(last[i].period - period) > config.tolerance * period ||
+        fabsf(a - amplitude) > config.tolerance * amplitude) {
+      return false;
+    }
+  }
+
+  if (amplitude <= config.hysteresis) {
+    fail("Oscillation within the hysteresis");
+    return true;
+  }
+
+  result.ku = 4.0f * config.amplitude /
+              ((float)M_PI * sqrtf(amplitude * amplitude - config.hysteresis * config.hysteresis));
+  result.pu = period;
+  result.amplitude = amplitude;
+  result.bias = demand;
+  result.cycles = config.cycles;
+  state = TUNE_DONE;
+  return true;
+}
+
+void RelayAutotuner::fail(const char* message) {
+  error = message;
+  state = TUNE_FAILED;
+}
+
+PidGains RelayAutotuner::gainsFor(const AutotuneResult& result, AutotuneRule rule) {
+  // Standard form (Kp, Ti, Td) converted to the parallel gains PidController uses
+  float kp, ti, td;
+  if (rule == TUNE_ZIEGLER_NICHOLS) {
+    kp = 0.6f * result.ku;
+    ti = 0.5f * result.pu;
+    td = 0.125f * result.pu;
+  } else {
+    kp = result.ku / 2.2f;
+    ti = 2.2f * result.pu;
+    td = result.pu / 6.3f;
+  }
+
+  PidGains gains;
+  gains.kp = kp;
+  gains.ki = ti > 0.0f ? kp / ti : 0.0f;
+  gains.kd = kp * td;
+  return gains;
+}
+
+const char* RelayAutotuner::stateName(State state) {
+  switch (state) {
+    case TUNE_IDLE:    return "idle";
+    case TUNE_RUNNING: return "running";
+    case TUNE_DONE:    return "done";
+    case TUNE_FAILED:  return "failed";
+    default:           return "unknown";
+  }
+}
+
+const char* RelayAutotuner::ruleName(AutotuneRule rule) {
+  return rule == TUNE_ZIEGLER_NICHOLS ? "zn" : "tl";
+}
@@ -0,0 +1,135 @@
+#include "pid_controller.h"
+#include <math.h>
+
+static float clampf(float value, float low, float high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+// ============================================================================
+// PidController
+// ============================================================================
+
+void PidController::reset(float setpoint, float measurement, float output) {
+  lastMeasurement = measurement;
+  derivative = 0.0f;
+  lastOutput = clampf(output, outMin, outMax);
+  integral = lastOutput - gains.kp * (setpoint - measurement) - feedForward(setpoint);
+  terms = Terms();
+  terms.output = lastOutput;
+}
+
+float PidController::update(float setpoint, float measurement, float dtSeconds) {
+  if (dtSeconds <= 0.0f) {
+    return lastOutput;
+  }
+  float error = setpoint - measurement;
+
+  // Derivative on measurement, low-pass filtered (sensor steps are whole degrees)
+  float raw = -(measurement - lastMeasurement) / dtSeconds;
+  lastMeasurement = measurement;
+  float alpha = derivativeTau > 0.0f ? dtSeconds / (derivativeTau + dtSeconds) : 1.0f;
+  derivative += alpha * (raw - derivative);
+
+  terms.p = gains.kp * error;
+  terms.d = gains.kd * derivative;
+  terms.ff = feedForward(setpoint);
+
+  float candidate = integral + gains.ki * error * dtSeconds;
+  float unlimited = terms.p + candidate + terms.d + terms.ff;
+  float output = clampf(unlimited, outMin, outMax);
+  if (slewPerSecond > 0.0f) {
+    float step = slewPerSecond * dtSeconds;
+    output = clampf(output, lastOutput - step, lastOutput + step);
+  }
+
+  // Integrate only while the output can still follow in the error's direction
+  terms.limited = fabsf(output - unlimited) > 1e-4f;
+  bool pushingLimit = terms.limited && ((unlimited > output && error > 0.0f) ||
+                                        (unlimited < output && error < 0.0f));
+  if (!pushingLimit) {
+    integral = candidate;
+  }
+
+  terms.i = integral;
+  terms.output = output;
+  lastOutput = output;
+  return output;
+}
+
+// ============================================================================
+// SetpointRamp
+// ============================================================================
+
+float SetpointRamp::update(float dtSeconds) {
+  if (rate <= 0.0f) {
+    current = target;
+    return current;
+  }
+  float step = rate * dtSeconds / 60.0f;
+  if (current < target) {
+    current = fminf(current + step, target);
+  } else if (current > target) {
+    current = fmaxf(current - step, target);
+  }
+  return current;
+}
+
+// ============================================================================
+// TimeProportioner
+// ============================================================================
+
+void TimeProportioner::configure(uint32_t window, uint32_t minPulse) {
+  windowMs = window > 0 ? window : 1;
+  minPulseMs = minPulse < windowMs / 2 ? minPulse : windowMs / 2;
+}
+
+bool TimeProportioner::update(float duty, uint32_t nowMs) {
+  while (nowMs - windowStart >= windowMs) {
+    windowStart += windowMs;
+  }
+
+  uint32_t onTime = (uint32_t)(clampf(duty, 0.0f, 1.0f) * windowMs + 0.5f);
+  if (onTime < minPulseMs) {
+    onTime = 0;
+  } else if (windowMs - onTime < minPulseMs) {
+    onTime = windowMs;
+  }
+  return nowMs - windowStart < onTime;
+}
+
+// ============================================================================
+// OvenControlLaw
+// ============================================================================
+
+void OvenControlLaw::configure(const OvenControlConfig& newConfig) {
+  config = newConfig;
+  pid.setGains(config.gains);
+  pid.setFeedForward(config.ffBias, config.ffPerDegree);
+  pid.setOutputLimits(0.0f, 100.0f);
+  pid.setSlewRate(config.slewPerSecond);
+  pid.setDerivativeFilter(config.derivativeTau);
+  ramp.setRate(config.rampPerMinute);
+  auger.configure(config.augerWindowMs, config.augerMinPulseMs);
+}
+
+void OvenControlLaw::reset(float measurement, uint32_t nowMs, float demand) {
+  ramp.reset(measurement);
+  pid.reset(measurement, measurement, demand);
+  auger.reset(nowMs);
+}
+
+OvenControlLaw::Output OvenControlLaw::step(float measurement, float dtSeconds, uint32_t nowMs) {
+  float setpoint = ramp.update(dtSeconds);
+  Output out = drive(pid.update(setpoint, measurement, dtSeconds), nowMs);
+  out.terms = pid.getTerms();
+  return out;
+}
+
+OvenControlLaw::Output OvenControlLaw::drive(float demand, uint32_t nowMs) {
+  Output out;
+  out.setpoint = ramp.getCurrent();
+  out.demand = clampf(demand, 0.0f, 100.0f);
+  out.augerOn = auger.update(out.demand / 100.0f, nowMs);
+  out.fanPercent = (uint8_t)lroundf(config.fanMin + (config.fanMax - config.fanMin) * out.demand / 100.0f);
+  return out;
+}
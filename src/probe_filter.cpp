@@ -0,0 +1,79 @@
+#include "probe_filter.h"
+
+uint16_t ProbeFilterConfig::alphaFromFloat(float alpha) {
+  if (!(alpha > 0.0f) || alpha >= 1.0f) {
+    return PROBE_FILTER_ALPHA_ONE;  // Out of range or NaN: EMA off
+  }
+  return max((uint16_t)1, (uint16_t)lroundf(alpha * PROBE_FILTER_ALPHA_ONE));
+}
+
+void ProbeFilter::configure(const ProbeFilterConfig& newConfig) {
+  config = newConfig;
+  if (config.alpha == 0 || config.alpha > PROBE_FILTER_ALPHA_ONE) {
+    config.alpha = PROBE_FILTER_ALPHA_ONE;
+  }
+  primed = false;
+}
+
+int32_t ProbeFilter::median() const {
+  // Insertion sort of a copy; five elements, at most ten compares
+  int32_t sorted[PROBE_FILTER_MEDIAN_WINDOW];
+  for (uint8_t i = 0; i < PROBE_FILTER_MEDIAN_WINDOW; i++) {
+    int32_t value = window[i];
+    int8_t j = i - 1;
+    while (j >= 0 && sorted[j] > value) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = value;
+  }
+  return sorted[PROBE_FILTER_MEDIAN_WINDOW / 2];
+}
+
+int32_t ProbeFilter::apply(int32_t centi, uint32_t nowMs) {
+  if (!primed || nowMs - lastMs > PROBE_FILTER_GAP_MS) {
+    // (Re)start: every stage settles on the first reading
+    for (uint8_t i = 0; i < PROBE_FILTER_MEDIAN_WINDOW; i++) {
+      window[i] = centi;
+    }
+    windowPos = 0;
+    emaQ8 = centi * 256;
+    output = centi;
+    lastMs = nowMs;
+    primed = true;
+    return centi;
+  }
+
+  uint32_t elapsedMs = nowMs - lastMs;
+  lastMs = nowMs;
+  int32_t value = centi;
+
+  // Spike rejection
+  if (config.median) {
+    window[windowPos] = value;
+    windowPos = (windowPos + 1) % PROBE_FILTER_MEDIAN_WINDOW;
+    value = median();
+  }
+
+  // First-order IIR: ema += alpha * (x - ema)
+  if (config.alpha < PROBE_FILTER_ALPHA_ONE) {
+    int64_t delta = (int64_t)(value * 256 - emaQ8) * config.alpha;
+    emaQ8 += (int32_t)(delta >> 15);
+    value = (emaQ8 + 128) >> 8;
+  } else {
+    emaQ8 = value * 256;
+  }
+
+  // Rate-of-change clamp
+  if (config.maxRate > 0) {
+    int32_t limit = max((int32_t)1, (int32_t)((uint32_t)config.maxRate * elapsedMs / 1000));
+    value = constrain(value, output - limit, output + limit);
+  }
+
+  output = value;
+  return value;
+}
+
+float ProbeFilter::apply(float temperature, uint32_t nowMs) {
+  return apply((int32_t)lroundf(temperature * 100.0f), nowMs) / 100.0f;
+}
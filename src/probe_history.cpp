@@ -0,0 +1,251 @@
+#include "probe_history.h"
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+void ProbeHistory::Accumulator::add(int16_t value) {
+  seconds++;
+  if (value == PROBE_HISTORY_NO_DATA) {
+    return;
+  }
+  if (count == 0 || value < min) {
+    min = value;
+  }
+  if (count == 0 || value > max) {
+    max = value;
+  }
+  sum += value;
+  count++;
+}
+
+HistoryRollup ProbeHistory::Accumulator::take() {
+  HistoryRollup rollup = {PROBE_HISTORY_NO_DATA, PROBE_HISTORY_NO_DATA, PROBE_HISTORY_NO_DATA};
+  if (count > 0) {
+    rollup.min = min;
+    rollup.max = max;
+    rollup.mean = (int16_t)lroundf((float)sum / count);
+  }
+  *this = Accumulator();
+  return rollup;
+}
+
+void ProbeHistory::reset() {
+  raw.clear();
+  tenSeconds.clear();
+  minutes.clear();
+  tenSecondAcc = Accumulator();
+  minuteAcc = Accumulator();
+}
+
+void ProbeHistory::record(bool valid, float temperature, uint32_t nowMs) {
+  int16_t value = PROBE_HISTORY_NO_DATA;
+  if (valid) {
+    // Centi-degrees; the lowest code is reserved for "no data"
+    float centi = roundf(temperature * 100.0f);
+    value = (int16_t)constrain(centi, -32767.0f, 32767.0f);
+  }
+
+  raw.push(value, nowMs);
+  tenSecondAcc.add(value);
+  minuteAcc.add(value);
+
+  if (tenSecondAcc.seconds >= periodMs(HISTORY_TIER_10S) / PROBE_HISTORY_PERIOD_MS) {
+    tenSeconds.push(tenSecondAcc.take(), nowMs);
+  }
+  if (minuteAcc.seconds >= periodMs(HISTORY_TIER_1M) / PROBE_HISTORY_PERIOD_MS) {
+    minutes.push(minuteAcc.take(), nowMs);
+  }
+}
+
+// ============================================================================
+// Readers
+// ============================================================================
+
+ProbeHistory::Window ProbeHistory::window(ProbeHistoryTier tier, uint32_t since) const {
+  Window w;
+  uint32_t oldest = 0;
+  switch (tier) {
+    case HISTORY_TIER_RAW:
+      w.next = raw.next();
+      oldest = raw.oldest();
+      w.lastMs = raw.lastSampleMs();
+      break;
+    case HISTORY_TIER_10S:
+      w.next = tenSeconds.next();
+      oldest = tenSeconds.oldest();
+      w.lastMs = tenSeconds.lastSampleMs();
+      break;
+    default:
+      w.next = minutes.next();
+      oldest = minutes.oldest();
+      w.lastMs = minutes.lastSampleMs();
+      break;
+  }
+  w.first = constrain(since, oldest, w.next);
+  return w;
+}
+
+bool ProbeHistory::readRollup(ProbeHistoryTier tier, uint32_t seq, HistoryRollup& rollup) const {
+  if (tier == HISTORY_TIER_10S) {
+    return tenSeconds.read(seq, rollup);
+  }
+  if (tier == HISTORY_TIER_1M) {
+    return minutes.read(seq, rollup);
+  }
+  return false;
+}
+
+uint32_t ProbeHistory::periodMs(ProbeHistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_10S: return 10000;
+    case HISTORY_TIER_1M:  return 60000;
+    default:               return PROBE_HISTORY_PERIOD_MS;
+  }
+}
+
+const char* ProbeHistory::tierName(ProbeHistoryTier tier) {
+  switch (tier) {
+    case HISTORY_TIER_RAW: return "raw";
+    case HISTORY_TIER_10S: return "10s";
+    case HISTORY_TIER_1M:  return "1m";
+    default:               return "unknown";
+  }
+}
+
+bool ProbeHistory::parseTier(const String& name, ProbeHistoryTier& tier) {
+  for (uint8_t i = 0; i < HISTORY_TIER_COUNT; i++) {
+    if (name == tierName((ProbeHistoryTier)i)) {
+      tier = (ProbeHistoryTier)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// ============================================================================
+// Streaming reader
+// ============================================================================
+
+// Centi-degrees as a JSON number, "null" for no data
+static int formatCenti(char* out, size_t size, int16_t value) {
+  if (value == PROBE_HISTORY_NO_DATA) {
+    return snprintf(out, size, "null");
+  }
+  int32_t v = value;
+  return snprintf(out, size, "%s%ld.%02ld", v < 0 ? "-" : "", (long)(abs(v) / 100), (long)(abs(v) % 100));
+}
+
+ProbeHistoryStream::ProbeHistoryStream(const ProbeHistory& history, uint8_t probe,
+                                       ProbeHistoryTier tier, uint32_t since, bool binary)
+  : history(history), probe(probe), tier(tier), binary(binary) {
+  window = history.window(tier, since);
+  seq = window.first;
+}
+
+size_t ProbeHistoryStream::entrySize() const {
+  return tier == HISTORY_TIER_RAW ? sizeof(int16_t) : sizeof(HistoryRollup);
+}
+
+size_t ProbeHistoryStream::binaryLength() const {
+  return sizeof(ProbeHistoryHeader) + (window.next - window.first) * entrySize();
+}
+
+size_t ProbeHistoryStream::fill(uint8_t* buffer, size_t maxLen) {
+  size_t written = 0;
+  while (written < maxLen) {
+    if (pendingPos == pendingLen) {
+      pendingLen = 0;
+      pendingPos = 0;
+      if (!produce()) {
+        break;
+      }
+    }
+    size_t n = min(maxLen - written, pendingLen - pendingPos);
+    memcpy(buffer + written, pending + pendingPos, n);
+    pendingPos += n;
+    written += n;
+  }
+  return written;
+}
+
+bool ProbeHistoryStream::produce() {
+  switch (phase) {
+    case PHASE_HEADER:
+      if (binary) {
+        ProbeHistoryHeader header;
+        memcpy(header.magic, PROBE_HISTORY_MAGIC, sizeof(header.magic));
+        header.version = PROBE_HISTORY_VERSION;
+        header.probe = probe;
+        header.tier = tier;
+        header.entrySize = entrySize();
+        header.periodMs = ProbeHistory::periodMs(tier);
+        header.first = window.first;
+        header.count = window.next - window.first;
+        header.lastMs = window.lastMs;
+        memcpy(pending, &header, sizeof(header));
+        pendingLen = sizeof(header);
+      } else {
+        pendingLen = snprintf(pending, sizeof(pending),
+                              "{\"probe\":%u,\"tier\":\"%s\",\"periodMs\":%lu,\"first\":%lu,"
+                              "\"next\":%lu,\"lastMs\":%lu,\"samples\":[",
+                              probe, ProbeHistory::tierName(tier),
+                              (unsigned long)ProbeHistory::periodMs(tier),
+                              (unsigned long)window.first, (unsigned long)window.next,
+                              (unsigned long)window.lastMs);
+      }
+      phase = window.first < window.next ? PHASE_ENTRIES : PHASE_FOOTER;
+      return true;
+
+    case PHASE_ENTRIES: {
+      const char* separator = seq > window.first ? "," : "";
+      if (tier == HISTORY_TIER_RAW) {
+        int16_t value;
+        if (!history.readRaw(seq, value)) {
+          value = PROBE_HISTORY_NO_DATA;  // Overwritten while the client was reading
+        }
+        if (binary) {
+          memcpy(pending, &value, sizeof(value));
+          pendingLen = sizeof(value);
+        } else {
+          pendingLen = snprintf(pending, sizeof(pending), "%s", separator);
+          pendingLen += formatCenti(pending + pendingLen, sizeof(pending) - pendingLen, value);
+        }
+      } else {
+        HistoryRollup rollup;
+        if (!history.readRollup(tier, seq, rollup)) {
+          rollup = {PROBE_HISTORY_NO_DATA, PROBE_HISTORY_NO_DATA, PROBE_HISTORY_NO_DATA};
+        }
+        if (binary) {
+          memcpy(pending, &rollup, sizeof(rollup));
+          pendingLen = sizeof(rollup);
+        } else if (rollup.mean == PROBE_HISTORY_NO_DATA) {
+          pendingLen = snprintf(pending, sizeof(pending), "%snull", separator);
+        } else {
+          pendingLen = snprintf(pending, sizeof(pending), "%s[", separator);
+          pendingLen += formatCenti(pending + pendingLen, sizeof(pending) - pendingLen, rollup.min);
+          pending[pendingLen++] = ',';
+          pendingLen += formatCenti(pending + pendingLen, sizeof(pending) - pendingLen, rollup.max);
+          pending[pendingLen++] = ',';
+          pendingLen += formatCenti(pending + pendingLen, sizeof(pending) - pendingLen, rollup.mean);
+          pending[pendingLen++] = ']';
+        }
+      }
+      if (++seq >= window.next) {
+        phase = PHASE_FOOTER;
+      }
+      return true;
+    }
+
+    case PHASE_FOOTER:
+      phase = PHASE_DONE;
+      if (binary) {
+        return false;
+      }
+      pendingLen = snprintf(pending, sizeof(pending), "]}");
+      return true;
+
+    default:
+      return false;
+  }
+}
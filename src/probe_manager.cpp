@@ -1,12 +1,27 @@
 #include "probe_manager.h"
 #include "aht10_manager.h"
 #include "slave_controller.h"
+#include "slave_events.h"
+#include "cook_program.h"
 #include <Preferences.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <new>
+
+// Scale factor that brings an output code of the configured data rate to
+// 16 bits (the ADS1110 sign-extends lower resolutions)
+static int32_t adcCodeScale() {
+  switch (PROBE_ADS1110_DATA_RATE) {
+    case ADS1110_CFG_DR_240SPS: return 16;
+    case ADS1110_CFG_DR_60SPS:  return 4;
+    case ADS1110_CFG_DR_30SPS:  return 2;
+    default:                    return 1;
+  }
+}
 
 ProbeManager::ProbeManager() {
   // Constructor - initialization handled in begin()
+  static_assert(MAX_PROBES == COOK_PROBE_COUNT, "Cook triggers address probes by ProbeManager index");
 }
 
 ProbeManager::~ProbeManager() {
@@ -27,10 +42,29 @@ bool ProbeManager::begin() {
   }
 
   probe_count = 0;
+  adc_count = 0;
+
+  if (!adc_lock) {
+    adc_lock = xSemaphoreCreateMutex();
+    if (!adc_lock) {
+      lastError = "Failed to create ADC lock";
+      return false;
+    }
+  }
+  buildThermistorTable();
 
   // Scan and detect all available temperature probes
   scanAndDetectProbes();
 
+  // Filter defaults; NVS / probe_cal.txt may override them below
+  ProbeFilterConfig filterDefaults;
+  filterDefaults.median = PROBE_FILTER_DEFAULT_MEDIAN;
+  filterDefaults.alpha = ProbeFilterConfig::alphaFromFloat(PROBE_FILTER_DEFAULT_ALPHA);
+  filterDefaults.maxRate = (uint16_t)(PROBE_FILTER_DEFAULT_MAX_RATE * 100.0f);
+  for (uint8_t i = 0; i < probe_count; i++) {
+    filters[i].configure(filterDefaults);
+  }
+
   // Initialize calibration from NVS/LittleFS
   if (probe_count > 0) {
     
@@ -47,12 +81,29 @@ bool ProbeManager::begin() {
     }
   }
 
+  // History rings for every detected probe (allocated once, reused after a rescan)
+  for (uint8_t i = 0; i < probe_count; i++) {
+    if (!history[i]) {
+      history[i] = new (std::nothrow) ProbeHistory();
+      if (!history[i]) {
+        Serial.printf("[Probes] WARNING: No memory for history of probe %u\n", i);
+        continue;
+      }
+    }
+    history[i]->reset();
+  }
+
+  if (probe_count > 0) {
+    startProbeTask();
+  }
+
   initialized = true;
 
   return probe_count > 0;  // Success if at least one probe detected
 }
 
 void ProbeManager::end() {
+  stopProbeTask();
   if (initialized) {
     probe_count = 0;
     initialized = false;
@@ -98,6 +149,7 @@ bool ProbeManager::initializeADS1110(uint8_t address, uint8_t bus) {
   probe.i2c_address = address;
   probe.bus_number = bus;
   probe.temperature = 0.0f;
+  probe.raw_temperature = 0.0f;
   probe.humidity = 0.0f;
   probe.initialized = true;
   probe.healthy = true;
@@ -106,6 +158,15 @@ bool ProbeManager::initializeADS1110(uint8_t address, uint8_t bus) {
   probe.last_read_ms = millis();
   
   probe.name = "ADS1110 ADC (0x" + String(address, HEX) + ")";
+
+  // Hand the converter to the sampler; a failed config write is retried there
+  if (adc_count < PROBE_ADS1110_MAX) {
+    AdcChannel& channel = adc[adc_count++];
+    channel = AdcChannel();
+    channel.address = address;
+    channel.stats.address = address;
+    channel.configured = configureADS1110(address);
+  }
   return true;
 }
 
@@ -119,6 +180,7 @@ bool ProbeManager::initializeAHT10() {
   probe.i2c_address = TEMP_SENSOR_ADDRESS;
   probe.bus_number = I2C_BUS_DISPLAY;
   probe.temperature = AHT10Manager::getInstance().getTemperature();
+  probe.raw_temperature = probe.temperature;
   probe.humidity = AHT10Manager::getInstance().getHumidity();
   probe.initialized = true;
   probe.healthy = AHT10Manager::getInstance().isHealthy();
@@ -138,6 +200,7 @@ bool ProbeManager::initializeMS11ControlTemp() {
   probe.i2c_address = SLAVE_I2C_ADDR;
   probe.bus_number = SLAVE_I2C_BUS;
   probe.temperature = 0.0f;
+  probe.raw_temperature = 0.0f;
   probe.humidity = 0.0f;
   probe.initialized = true;
   probe.healthy = true;  // Will be updately when read attempts start
@@ -192,6 +255,8 @@ bool ProbeManager::readProbe(uint8_t index) {
 
   if (success) {
     probe.last_read_ms = millis();
+    probe.raw_temperature = probe.temperature;
+    probe.temperature = filters[index].apply(probe.temperature, probe.last_read_ms);
     probe.healthy = true;
   } else {
     probe.healthy = false;
@@ -201,22 +266,225 @@ bool ProbeManager::readProbe(uint8_t index) {
 }
 
 bool ProbeManager::readADS1110(ProbeData& probe) {
-  // TODO: Implement ADS1110 ADC reading
-  // - Read raw ADC value from ADS1110 at probe.i2c_address
-  // - Convert to temperature based on sensor calibration
-  // - Store in probe.temperature
-  // - For now: stub implementation
-  
-  // ADS1110 read not yet implemented
-  return false;
+  // Consume the latest conversion published by the sampler task
+  AdcChannel* channel = nullptr;
+  for (uint8_t i = 0; i < adc_count; i++) {
+    if (adc[i].address == probe.i2c_address) {
+      channel = &adc[i];
+      break;
+    }
+  }
+  if (!channel || !adc_lock) {
+    lastError = "ADS1110 not sampled";
+    return false;
+  }
+
+  xSemaphoreTake(adc_lock, portMAX_DELAY);
+  float temperature = channel->temperature;
+  int32_t code = (int32_t)channel->stats.code * adcCodeScale();
+  uint32_t lastSampleMs = channel->stats.lastSampleMs;
+  xSemaphoreGive(adc_lock);
+
+  if (lastSampleMs == 0 || millis() - lastSampleMs > PROBE_ADS1110_STALE_MS) {
+    lastError = "ADS1110 0x" + String(probe.i2c_address, HEX) + ": no fresh conversion";
+    return false;
+  }
+  if (code < PROBE_ADS1110_OPEN_CODE) {
+    lastError = "ADS1110 0x" + String(probe.i2c_address, HEX) + ": probe open";
+    return false;
+  }
+  if (code > PROBE_ADS1110_SHORT_CODE) {
+    lastError = "ADS1110 0x" + String(probe.i2c_address, HEX) + ": input clipped";
+    return false;
+  }
+
+  // Apply calibration
+  probe.temperature = temperature * probe.temp_scale + probe.temp_offset;
+  return true;
+}
+
+// ============================================================================
+// ADS1110 SAMPLER (continuous conversion)
+// ============================================================================
+
+bool ProbeManager::configureADS1110(uint8_t address) {
+  // SC = 0: continuous conversion; the first result is ready one period later
+  uint8_t config = PROBE_ADS1110_CONFIG;
+  return I2CManager::getInstance().displayWrite(address, &config, 1);
+}
+
+void ProbeManager::buildThermistorTable() {
+  // Beta model, evaluated once per table entry. Entry i covers normalised
+  // code i * 256; the input voltage is code / 32768 * 2.048 V (PGA 1).
+  const float t25 = 298.15f;
+  const float step = 32768.0f / (PROBE_NTC_LUT_SIZE - 1);
+
+  for (uint16_t i = 0; i < PROBE_NTC_LUT_SIZE; i++) {
+    float code = max(i * step, 1.0f);  // Code 0 would be an infinite NTC resistance
+    float mv = code / 32768.0f * 2048.0f;
+    float ohms = mv < PROBE_NTC_EXCITATION_MV
+               ? PROBE_NTC_SERIES_OHMS * (PROBE_NTC_EXCITATION_MV - mv) / mv
+               : 1.0f;
+    float kelvin = 1.0f / (1.0f / t25 + logf(ohms / PROBE_NTC_R25_OHMS) / PROBE_NTC_BETA);
+    ntc_table[i] = kelvin - 273.15f;
+  }
+}
+
+float ProbeManager::linearize(int32_t code) const {
+  if (code < 0) {
+    code = 0;
+  } else if (code > 32767) {
+    code = 32767;
+  }
+  uint16_t index = code >> 8;
+  float fraction = (code & 0xFF) / 256.0f;
+  return ntc_table[index] + (ntc_table[index + 1] - ntc_table[index]) * fraction;
+}
+
+void ProbeManager::sampleADS1110(uint8_t index) {
+  AdcChannel& channel = adc[index];
+
+  if (!channel.configured) {
+    bool configured = configureADS1110(channel.address);
+    xSemaphoreTake(adc_lock, portMAX_DELAY);
+    channel.configured = configured;
+    if (!configured) {
+      channel.stats.errors++;
+    }
+    xSemaphoreGive(adc_lock);
+    return;  // First conversion in the new mode is not ready yet
+  }
+
+  // Output register (MSB first) followed by the config register
+  uint8_t burst[3];
+  if (!I2CManager::getInstance().displayRead(channel.address, burst, sizeof(burst))) {
+    xSemaphoreTake(adc_lock, portMAX_DELAY);
+    channel.stats.errors++;
+    xSemaphoreGive(adc_lock);
+    return;
+  }
+
+  uint8_t config = burst[2];
+  if ((config & ADS1110_CFG_WRITE_MASK) != PROBE_ADS1110_CONFIG) {
+    // Power-on defaults (15 SPS) or someone else's settings: the code is
+    // not in our scale, reconfigure on the next visit
+    xSemaphoreTake(adc_lock, portMAX_DELAY);
+    channel.configured = false;
+    channel.stats.reconfigured++;
+    xSemaphoreGive(adc_lock);
+    return;
+  }
+
+  if (config & ADS1110_CFG_ST_DRDY) {
+    // Already consumed this conversion
+    xSemaphoreTake(adc_lock, portMAX_DELAY);
+    channel.stats.notReady++;
+    xSemaphoreGive(adc_lock);
+    return;
+  }
+
+  int16_t code = (int16_t)((burst[0] << 8) | burst[1]);
+  float temperature = linearize((int32_t)code * adcCodeScale());
+
+  xSemaphoreTake(adc_lock, portMAX_DELAY);
+  channel.temperature = temperature;
+  channel.stats.code = code;
+  channel.stats.samples++;
+  channel.stats.lastSampleMs = millis();
+  xSemaphoreGive(adc_lock);
+}
+
+// ============================================================================
+// PROBE TASK (ADS1110 round robin + 1 Hz history)
+// ============================================================================
+
+void ProbeManager::recordHistory() {
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < probe_count; i++) {
+    if (!history[i]) {
+      continue;
+    }
+    // Updated by readAllProbes() in the main loop; 32-bit loads are atomic
+    const ProbeData& probe = probes[i];
+    bool fresh = probe.healthy && now - probe.last_read_ms <= PROBE_HISTORY_STALE_MS;
+    history[i]->record(fresh, probe.temperature, now);
+  }
+}
+
+bool ProbeManager::startProbeTask() {
+  if (probe_task) {
+    return true;
+  }
+  probe_task_stop = false;
+  if (xTaskCreatePinnedToCore(probeTask, "probe_task", PROBE_TASK_STACK, this,
+                              PROBE_TASK_PRIORITY, &probe_task, PROBE_TASK_CORE) != pdPASS) {
+    probe_task = nullptr;
+    Serial.println("[Probes] ERROR: Failed to start probe task");
+    return false;
+  }
+  Serial.printf("[Probes] ✓ Probe task running (%u probe%s, %u ADS1110)\n",
+                probe_count, probe_count == 1 ? "" : "s", adc_count);
+  return true;
+}
+
+void ProbeManager::stopProbeTask() {
+  if (!probe_task) {
+    return;
+  }
+  // Let the task finish its transfer so it never dies holding the bus lock
+  probe_task_stop = true;
+  for (uint8_t i = 0; i < 20 && probe_task; i++) {
+    vTaskDelay(pdMS_TO_TICKS(PROBE_ADS1110_SLOT_MS));
+  }
+}
+
+void ProbeManager::probeTask(void* param) {
+  ProbeManager* self = static_cast<ProbeManager*>(param);
+  TickType_t wake = xTaskGetTickCount();
+  uint32_t nextRecordMs = millis() + PROBE_HISTORY_PERIOD_MS;
+  uint8_t next = 0;
+
+  while (!self->probe_task_stop) {
+    if (next >= self->adc_count) {
+      next = 0;
+    }
+    if (self->adc_count > 0) {
+      self->sampleADS1110(next++);
+    }
+
+    // Fixed 1 Hz grid, independent of how long the slots took
+    if ((int32_t)(millis() - nextRecordMs) >= 0) {
+      nextRecordMs += PROBE_HISTORY_PERIOD_MS;
+      self->recordHistory();
+    }
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(PROBE_ADS1110_SLOT_MS));
+  }
+
+  self->probe_task = nullptr;
+  vTaskDelete(nullptr);
 }
 
+const ProbeHistory* ProbeManager::getHistory(uint8_t index) const {
+  return index < probe_count ? history[index] : nullptr;
+}
 
+uint8_t ProbeManager::getAdcStats(AdcStats* out, uint8_t max) {
+  if (!adc_lock) {
+    return 0;
+  }
+  uint8_t count = 0;
+  xSemaphoreTake(adc_lock, portMAX_DELAY);
+  for (uint8_t i = 0; i < adc_count && count < max; i++) {
+    out[count++] = adc[i].stats;
+  }
+  xSemaphoreGive(adc_lock);
+  return count;
+}
 
 bool ProbeManager::readAHT10(ProbeData& probe) {
-  // Read from AHT10Manager singleton
+  // Shared measurement cached by AHT10Manager (no bus traffic here)
   if (!AHT10Manager::getInstance().readSensor()) {
-    lastError = "AHT10 read failed";
+    lastError = "AHT10 reading stale";
     return false;
   }
 
@@ -234,7 +502,11 @@ bool ProbeManager::readMS11ControlTemp(ProbeData& probe) {
   // Read system temperature from MS11-control slave (DS temperature sensor)
   int16_t temp_raw = 0;
   
-  if (!SlaveController::getInstance().readSystemTemp(temp_raw)) {
+  // With the attention line the slave reports temperature changes itself,
+  // so the cached value is current and the bus stays idle
+  bool cached = SlaveEventMonitor::getInstance().isActive() &&
+                SlaveController::getInstance().getCachedSystemTemp(temp_raw);
+  if (!cached && !SlaveController::getInstance().readSystemTemp(temp_raw)) {
     lastError = "Failed to read MS11-control temperature";
     return false;
   }
@@ -339,6 +611,26 @@ bool ProbeManager::getProbeCalibration(uint8_t index, float& offset, float& scal
   return true;
 }
 
+bool ProbeManager::setProbeFilter(uint8_t index, const ProbeFilterConfig& config) {
+  if (index >= probe_count) {
+    lastError = "Probe index out of range";
+    return false;
+  }
+
+  filters[index].configure(config);
+  return true;
+}
+
+bool ProbeManager::getProbeFilter(uint8_t index, ProbeFilterConfig& config) {
+  if (index >= probe_count) {
+    lastError = "Probe index out of range";
+    return false;
+  }
+
+  config = filters[index].getConfig();
+  return true;
+}
+
 bool ProbeManager::isHealthy() {
   for (uint8_t i = 0; i < probe_count; i++) {
     if (!probes[i].healthy) {
@@ -392,6 +684,19 @@ bool ProbeManager::loadCalibrationFromNVS() {
       probes[i].temp_offset = prefs.getFloat(offset_key.c_str(), 0.0f);
       probes[i].temp_scale = prefs.getFloat(scale_key.c_str(), 1.0f);
     }
+
+    // Filter chain ("probe_N_fmedian", "probe_N_falpha" Q15, "probe_N_frate" centi-°C/s)
+    String median_key = "probe_" + String(i) + "_fmedian";
+    String alpha_key = "probe_" + String(i) + "_falpha";
+    String rate_key = "probe_" + String(i) + "_frate";
+
+    if (prefs.isKey(alpha_key.c_str())) {
+      ProbeFilterConfig filter = filters[i].getConfig();
+      filter.median = prefs.getBool(median_key.c_str(), filter.median);
+      filter.alpha = prefs.getUShort(alpha_key.c_str(), filter.alpha);
+      filter.maxRate = prefs.getUShort(rate_key.c_str(), filter.maxRate);
+      filters[i].configure(filter);
+    }
   }
   
   prefs.end();
@@ -412,6 +717,11 @@ bool ProbeManager::saveCalibrationToNVS() {
     prefs.putFloat(offset_key.c_str(), probes[i].temp_offset);
     prefs.putFloat(scale_key.c_str(), probes[i].temp_scale);
     prefs.putInt(type_key.c_str(), (int)probes[i].type);
+
+    const ProbeFilterConfig& filter = filters[i].getConfig();
+    prefs.putBool(("probe_" + String(i) + "_fmedian").c_str(), filter.median);
+    prefs.putUShort(("probe_" + String(i) + "_falpha").c_str(), filter.alpha);
+    prefs.putUShort(("probe_" + String(i) + "_frate").c_str(), filter.maxRate);
   }
   
   prefs.putBool("initialized", true);
@@ -467,6 +777,22 @@ bool ProbeManager::syncCalibrationFromLittleFS() {
         probes[i].temp_offset = offset;
         probes[i].temp_scale = scale;
       }
+
+      // Optional: "filter": {"median": true, "alpha": 0.3, "max_rate": 5.0}
+      if (probe_obj["filter"].is<JsonObject>()) {
+        JsonObject filter_obj = probe_obj["filter"];
+        ProbeFilterConfig filter = filters[i].getConfig();
+        if (filter_obj.containsKey("median")) {
+          filter.median = filter_obj["median"].as<bool>();
+        }
+        if (filter_obj.containsKey("alpha")) {
+          filter.alpha = ProbeFilterConfig::alphaFromFloat(filter_obj["alpha"].as<float>());
+        }
+        if (filter_obj.containsKey("max_rate")) {
+          filter.maxRate = (uint16_t)constrain(filter_obj["max_rate"].as<float>() * 100.0f, 0.0f, 65535.0f);
+        }
+        filters[i].configure(filter);
+      }
     }
   }
 
@@ -503,6 +829,12 @@ bool ProbeManager::saveCalibrationToLittleFS() {
     probe_obj["type"] = (int)probes[i].type;
     probe_obj["offset"] = serialized(String(probes[i].temp_offset, 3));
     probe_obj["scale"] = serialized(String(probes[i].temp_scale, 3));
+
+    const ProbeFilterConfig& filter = filters[i].getConfig();
+    JsonObject filter_obj = probe_obj.createNestedObject("filter");
+    filter_obj["median"] = filter.median;
+    filter_obj["alpha"] = serialized(String(ProbeFilterConfig::alphaToFloat(filter.alpha), 3));
+    filter_obj["max_rate"] = serialized(String(filter.maxRate / 100.0f, 2));
     probe_obj["temperature"] = serialized(String(probes[i].temperature, 2));
     probe_obj["healthy"] = probes[i].healthy;
   }
@@ -1,6 +1,11 @@
 #include "slave_controller.h"
 
 bool SlaveController::begin() {
+  if (!transferLock) {
+    transferLock = xSemaphoreCreateRecursiveMutex();
+  }
+  TransferGuard guard(transferLock);
+
   // Initialize I2C manager if not already done
   if (!I2CManager::getInstance().isInitialized()) {
     if (!I2CManager::getInstance().begin()) {
@@ -16,20 +21,11 @@ bool SlaveController::begin() {
     return false;
   }
 
-  // Get protocol version (should be 0x02)
-  if (!I2CManager::getInstance().readRegister(SLAVE_I2C_ADDR, REG_PROTOCOL_VER, lastProtoVersion)) {
-    lastError = "Could not read protocol version";
-    Serial.println("[SlaveController] WARNING: " + lastError);
-  } else {
-    if (lastProtoVersion != 0x02) {
-      Serial.printf("[SlaveController] WARNING: Protocol mismatch! Expected 0x02, got 0x%02X\n", lastProtoVersion);
-    } else {
-      Serial.println("[SlaveController] ✓ Protocol v2 confirmed");
-    }
-  }
+  // Protocol v2, or v3 framing if the slave supports it
+  negotiateProtocol();
 
   // Get firmware version
-  if (I2CManager::getInstance().readRegister(SLAVE_I2C_ADDR, REG_FW_VERSION, lastFwVersion)) {
+  if (readReg<ms11::FwVersion>(lastFwVersion)) {
     Serial.printf("[SlaveController] ✓ Slave firmware v%X.%X.%X\n",
                   (lastFwVersion >> 4) & 0xF,
                   (lastFwVersion >> 2) & 0x3,
@@ -40,50 +36,152 @@ bool SlaveController::begin() {
   return true;
 }
 
+bool SlaveController::negotiateProtocol() {
+  TransferGuard guard(transferLock);
+  I2CManager& manager = I2CManager::getInstance();
+
+  // Start from v2: the slave drops framing whenever it resets
+  framed = false;
+  renegotiatePending = false;
+  invalidateOutputs();
+
+  if (!readReg<ms11::ProtocolVersion>(lastProtoVersion)) {
+    lastError = "Could not read protocol version";
+    Serial.println("[SlaveController] WARNING: " + lastError);
+    return false;
+  }
+
+  if (lastProtoVersion < ms11::PROTOCOL_V3) {
+    if (lastProtoVersion != ms11::PROTOCOL_V2) {
+      Serial.printf("[SlaveController] WARNING: Protocol mismatch! Expected 0x02/0x03, got 0x%02X\n", lastProtoVersion);
+    } else {
+      Serial.println("[SlaveController] ✓ Protocol v2 confirmed");
+    }
+    manager.setMaxClock(I2C_BUS_SLAVE, I2C_SLAVE_MAX_CLOCK_HZ);
+    return true;
+  }
+
+  // Enable framing with a plain v2 write, then prove it with a framed read
+  uint8_t echoed = 0;
+  if (writeReg<ms11::FramingCmd>(ms11::PROTOCOL_V3)) {
+    framed = true;
+    if (!readReg<ms11::ProtocolVersion>(echoed) || echoed != lastProtoVersion) {
+      framed = false;
+    }
+  }
+
+  if (!framed) {
+    Serial.println("[SlaveController] WARNING: v3 framing not confirmed, staying on protocol v2");
+    manager.setMaxClock(I2C_BUS_SLAVE, I2C_SLAVE_MAX_CLOCK_HZ);
+    return true;
+  }
+
+  // Corrupted frames are now detected and retried, so the bus may run faster
+  Serial.println("[SlaveController] ✓ Protocol v3 (CRC-8 framing) active");
+  manager.setMaxClock(I2C_BUS_SLAVE, I2C_SLAVE_FRAMED_MAX_CLOCK_HZ);
+  return true;
+}
+
 bool SlaveController::readOvenTemp(int16_t& temp_c) {
-  if (!readRegisterInt16(REG_OVEN_TEMP_H, REG_OVEN_TEMP_L, cachedOvenTemp)) {
-    stats.failedReads++;
+  TransferGuard guard(transferLock);
+  if (!readReg<ms11::OvenTemp>(cachedOvenTemp)) {
+    count(stats.failedReads);
     lastError = "Failed to read oven temperature";
     return false;
   }
 
   temp_c = cachedOvenTemp;
-  stats.successfulReads++;
+  count(stats.successfulReads);
   lastTempReadTime = millis();
   return true;
 }
 
 bool SlaveController::readSystemTemp(int16_t& temp_c) {
-  if (!readRegisterInt16(REG_SYS_TEMP_H, REG_SYS_TEMP_L, cachedSystemTemp)) {
-    stats.failedReads++;
+  TransferGuard guard(transferLock);
+  if (!readReg<ms11::SysTemp>(cachedSystemTemp)) {
+    count(stats.failedReads);
     lastError = "Failed to read system temperature";
     return false;
   }
 
   temp_c = cachedSystemTemp;
-  stats.successfulReads++;
+  systemTempValid = true;
+  count(stats.successfulReads);
   return true;
 }
 
+bool SlaveController::getCachedSystemTemp(int16_t& temp_c) {
+  TransferGuard guard(transferLock);
+  temp_c = cachedSystemTemp;
+  return systemTempValid;
+}
+
+bool SlaveController::getCachedOvenTemp(int16_t& temp_c, uint32_t maxAgeMs) {
+  TransferGuard guard(transferLock);
+  temp_c = cachedOvenTemp;
+  return lastTempReadTime != 0 && millis() - lastTempReadTime <= maxAgeMs;
+}
+
 bool SlaveController::refreshTemperatures() {
-  int16_t dummy;
-  return readOvenTemp(dummy) && readSystemTemp(dummy);
+  SlaveSnapshot snapshot;
+  return readSnapshot(snapshot);
 }
 
-bool SlaveController::setFanPercent(uint8_t percent) {
-  if (percent > 100) {
-    lastError = "Fan percent out of range (0-100)";
+bool SlaveController::readSnapshot(SlaveSnapshot& snapshot) {
+  using ms11::Snapshot;
+  TransferGuard guard(transferLock);
+  uint8_t buffer[Snapshot::length];
+  
+  // One burst for the whole read map instead of one round-trip per byte
+  if (!readBurst<Snapshot>(buffer)) {
+    count(stats.failedReads);
+    lastError = "Failed to read register snapshot";
     return false;
   }
 
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, REG_FAN_CMD, percent)) {
-    stats.failedWrites++;
-    lastError = I2CManager::getInstance().getLastError();
+  snapshot.ovenTemp = Snapshot::get<ms11::OvenTemp>(buffer);
+  snapshot.sysTemp = Snapshot::get<ms11::SysTemp>(buffer);
+  snapshot.fanPwm = Snapshot::get<ms11::FanSpeed>(buffer);
+  snapshot.status = Snapshot::get<ms11::Status>(buffer);
+  snapshot.fwVersion = Snapshot::get<ms11::FwVersion>(buffer);
+  snapshot.protocolVersion = Snapshot::get<ms11::ProtocolVersion>(buffer);
+  snapshot.debugMode = Snapshot::get<ms11::DebugMode>(buffer);
+  snapshot.fanPercent = Snapshot::get<ms11::FanPercent>(buffer);
+  snapshot.minMasterVersion = Snapshot::get<ms11::MinMasterVersion>(buffer);
+  snapshot.displayEnabled = Snapshot::get<ms11::DisplayEnabled>(buffer);
+  snapshot.ovenTempLimitLow = Snapshot::get<ms11::OvenTempLimitLow>(buffer);
+  snapshot.ovenTempLimitHigh = Snapshot::get<ms11::OvenTempLimitHigh>(buffer);
+  snapshot.igniterMaxTime = Snapshot::get<ms11::IgniterMaxTime>(buffer);
+  snapshot.sysTempAlarm = Snapshot::get<ms11::SysTempAlarm>(buffer);
+  snapshot.timestamp_ms = millis();
+  snapshot.sequence = lastSnapshot.sequence + 1;
+  if (snapshot.sequence == 0) {
+    snapshot.sequence = 1;  // 0 is reserved for "never read"
+  }
+
+  // Update cached values derived from the snapshot
+  lastSnapshot = snapshot;
+  cachedOvenTemp = snapshot.ovenTemp;
+  cachedSystemTemp = snapshot.sysTemp;
+  systemTempValid = true;
+  lastTempReadTime = snapshot.timestamp_ms;
+  lastStatusReadTime = snapshot.timestamp_ms;
+  lastStatus = snapshot.status;
+  lastIgniterState = (snapshot.status & STATUS_IGNITER_BIT) != 0;
+  lastAugerState = (snapshot.status & STATUS_AUGER_BIT) != 0;
+  
+  count(stats.successfulReads);
+  return true;
+}
+
+bool SlaveController::setFanPercent(uint8_t percent) {
+  if (percent > 100) {
+    lastError = "Fan percent out of range (0-100)";
     return false;
   }
 
+  setOutput(OUT_FAN, percent);
   lastFanPercent = percent;
-  stats.successfulWrites++;
   return true;
 }
 
@@ -92,24 +190,14 @@ uint8_t SlaveController::getFanPercent() {
 }
 
 bool SlaveController::getFanSpeed(uint8_t& pwm) {
-  if (!I2CManager::getInstance().readRegister(SLAVE_I2C_ADDR, REG_FAN_SPEED, pwm)) {
-    lastError = I2CManager::getInstance().getLastError();
+  if (!readReg<ms11::FanSpeed>(pwm)) {
     return false;
   }
   return (pwm <= 39);  // Valid range check
 }
 
 bool SlaveController::setIgniter(bool on) {
-  uint8_t value = on ? 0x01 : 0x00;
-  
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, REG_IGNITER_CMD, value)) {
-    stats.failedWrites++;
-    lastError = I2CManager::getInstance().getLastError();
-    return false;
-  }
-
-  lastIgniterState = on;
-  stats.successfulWrites++;
+  setOutput(OUT_IGNITER, on ? 0x01 : 0x00);
   return true;
 }
 
@@ -118,16 +206,7 @@ bool SlaveController::isIgniterOn() {
 }
 
 bool SlaveController::setAuger(bool on) {
-  uint8_t value = on ? 0x01 : 0x00;
-  
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, REG_AUGER_CMD, value)) {
-    stats.failedWrites++;
-    lastError = I2CManager::getInstance().getLastError();
-    return false;
-  }
-
-  lastAugerState = on;
-  stats.successfulWrites++;
+  setOutput(OUT_AUGER, on ? 0x01 : 0x00);
   return true;
 }
 
@@ -136,12 +215,13 @@ bool SlaveController::isAugerOn() {
 }
 
 bool SlaveController::readStatus(uint8_t& statusByte) {
-  if (!I2CManager::getInstance().readRegister(SLAVE_I2C_ADDR, REG_STATUS, statusByte)) {
-    lastError = I2CManager::getInstance().getLastError();
+  TransferGuard guard(transferLock);
+  if (!readReg<ms11::Status>(statusByte)) {
     return false;
   }
 
   lastStatus = statusByte;
+  lastStatusReadTime = millis();
   
   // Update cached states from status byte
   lastIgniterState = (statusByte & STATUS_IGNITER_BIT) != 0;
@@ -150,6 +230,12 @@ bool SlaveController::readStatus(uint8_t& statusByte) {
   return true;
 }
 
+bool SlaveController::getCachedStatus(uint8_t& statusByte, uint32_t maxAgeMs) {
+  TransferGuard guard(transferLock);
+  statusByte = lastStatus;
+  return lastStatusReadTime != 0 && millis() - lastStatusReadTime <= maxAgeMs;
+}
+
 uint8_t SlaveController::getErrorCode() {
   return (lastStatus >> STATUS_ERROR_SHIFT) & 0x0F;
 }
@@ -163,32 +249,37 @@ uint8_t SlaveController::getProtocolVersion() {
 }
 
 bool SlaveController::readFullVersion(SlaveVersion& version) {
-  // Read 4 bytes from REG_GET_VERSION_FULL (0x0C)
-  // Byte 0-1: majorVersion (uint16_t, little-endian)
-  // Byte 2:   minorVersion (uint8_t)
-  // Byte 3:   patchAndBuild (high nibble = patch, low nibble = build)
-  uint8_t buffer[4] = {0};
+  TransferGuard guard(transferLock);
+  // 4-byte block at 0x0C, little-endian:
+  // bits 0-15 major, bits 16-23 minor, bits 24-31 patch (high nibble) / build (low nibble)
+  uint32_t raw = 0;
   
-  if (!I2CManager::getInstance().readRegisterMulti(SLAVE_I2C_ADDR, REG_GET_VERSION_FULL, buffer, 4)) {
+  if (!readReg<ms11::VersionFull>(raw)) {
     lastError = "Failed to read full version from slave";
     Serial.println("[SlaveController] ERROR: " + lastError);
     version.valid = false;
     return false;
   }
   
-  version.major = buffer[0] | (buffer[1] << 8);  // Little-endian uint16_t
-  version.minor = buffer[2];
-  version.patch = (buffer[3] >> 4) & 0x0F;
-  version.build = buffer[3] & 0x0F;
-  version.valid = true;
-  
+  version = decodeVersion(raw);
   cachedFullVersion = version;
   
   Serial.printf("[SlaveController] Full version: %s\n", version.toString().c_str());
   return true;
 }
 
+SlaveVersion SlaveController::decodeVersion(uint32_t raw) {
+  SlaveVersion version;
+  version.major = raw & 0xFFFF;
+  version.minor = (raw >> 16) & 0xFF;
+  version.patch = (raw >> 28) & 0x0F;
+  version.build = (raw >> 24) & 0x0F;
+  version.valid = true;
+  return version;
+}
+
 String SlaveController::getFullVersionString() {
+  TransferGuard guard(transferLock);
   if (!cachedFullVersion.valid) {
     SlaveVersion ver;
     if (!readFullVersion(ver)) {
@@ -219,15 +310,19 @@ bool SlaveController::isHealthy() {
 }
 
 bool SlaveController::runSelfTest() {
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, REG_SELFTEST_CMD, 0x01)) {
-    lastError = "Failed to send selftest command";
-    return false;
+  {
+    TransferGuard guard(transferLock);
+    if (!writeReg<ms11::SelfTestCmd>(0x01)) {
+      lastError = "Failed to send selftest command";
+      return false;
+    }
   }
 
-  // Wait for test to complete (~500ms)
+  // Wait for test to complete (~500ms), without blocking other transfers
   delay(500);
 
   // Read status to check result
+  TransferGuard guard(transferLock);
   uint8_t status;
   if (!readStatus(status)) {
     lastError = "Failed to read selftest result";
@@ -244,69 +339,562 @@ bool SlaveController::runSelfTest() {
 }
 
 bool SlaveController::setLed(bool on) {
-  uint8_t value = on ? 1 : 0;
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, SLAVE_REG_LED_ONOFF, value)) {
-    lastError = "Failed to set LED";
-    stats.failedWrites++;
-    Serial.println("[SlaveController] ERROR: LED write failed");
-    return false;
-  }
-  stats.successfulWrites++;
+  setOutput(OUT_LED, on ? 1 : 0);
   return true;
 }
 
 bool SlaveController::pulseLed(uint16_t durationMs) {
-  // Initiate LED pulse - main loop handles the timing
-  if (!setLed(true)) {
-    return false;
-  }
-  return true;
+  // Initiate LED pulse - main loop handles the timing and switches it off again
+  return setLed(true);
 }
 
 void SlaveController::resetStats() {
-  stats.successfulReads = 0;
-  stats.failedReads = 0;
-  stats.successfulWrites = 0;
-  stats.failedWrites = 0;
+  portENTER_CRITICAL(&shadowMux);
+  stats = Stats();
+  portEXIT_CRITICAL(&shadowMux);
+}
+
+String SlaveController::getLastError() {
+  TransferGuard guard(transferLock);
+  return lastError;
+}
+
+SlaveSnapshot SlaveController::getSnapshot() {
+  TransferGuard guard(transferLock);
+  return lastSnapshot;
+}
+
+// Counters are bumped from the bus worker callbacks too, so they share shadowMux
+void SlaveController::count(uint32_t& counter) {
+  portENTER_CRITICAL(&shadowMux);
+  counter++;
+  portEXIT_CRITICAL(&shadowMux);
+}
+
+SlaveController::Stats SlaveController::getStats() {
+  portENTER_CRITICAL(&shadowMux);
+  Stats copy = stats;
+  portEXIT_CRITICAL(&shadowMux);
+  return copy;
+}
+
+SlaveController::FrameStats SlaveController::getFrameStats() {
+  portENTER_CRITICAL(&shadowMux);
+  FrameStats copy = frameStats;
+  portEXIT_CRITICAL(&shadowMux);
+  return copy;
+}
+
+SlaveController::OutputStats SlaveController::getOutputStats() {
+  portENTER_CRITICAL(&shadowMux);
+  OutputStats copy = outputStats;
+  portEXIT_CRITICAL(&shadowMux);
+  return copy;
 }
 
 // ============================================================================
-// Private Helpers
+// Framed Transfers (protocol v2 / v3)
 // ============================================================================
 
-bool SlaveController::readRegisterInt16(uint8_t regHigh, uint8_t regLow, int16_t& value) {
-  uint8_t high = 0, low = 0;
+uint8_t SlaveController::takeSequence() {
+  portENTER_CRITICAL(&shadowMux);
+  sequence = ms11::nextSequence(sequence);
+  uint8_t seq = sequence;
+  portEXIT_CRITICAL(&shadowMux);
+  return seq;
+}
 
-  if (!I2CManager::getInstance().readRegister(SLAVE_I2C_ADDR, regHigh, high, 100, 1)) {
+bool SlaveController::transferRead(uint8_t reg, uint8_t* buffer, uint8_t length) {
+  TransferGuard guard(transferLock);
+  I2CManager& manager = I2CManager::getInstance();
+
+  if (!framed) {
+    if (!manager.readRegisterMulti(SLAVE_I2C_ADDR, reg, buffer, length)) {
+      lastError = manager.getLastError();
+      return false;
+    }
+    return true;
+  }
+
+  if (length > ms11::FRAME_MAX_READ_DATA) {
+    lastError = "Read exceeds frame size";
     return false;
   }
 
-  if (!I2CManager::getInstance().readRegister(SLAVE_I2C_ADDR, regLow, low, 100, 1)) {
+  uint8_t request[ms11::FRAME_READ_REQUEST_LENGTH];
+  uint8_t response[MS11_MAX_BURST];
+  bool frameError = false;
+
+  for (uint8_t attempt = 0; attempt <= SLAVE_FRAME_RETRIES; attempt++) {
+    if (attempt > 0) {
+      count(frameStats.retries);
+      delay(10);
+    }
+
+    // Fresh sequence per attempt: a late response to an earlier request can't match
+    uint8_t seq = takeSequence();
+    ms11::buildReadRequest(reg, seq, request);
+    if (!manager.writeRead(SLAVE_I2C_ADDR, request, sizeof(request),
+                           response, length + ms11::FRAME_READ_OVERHEAD)) {
+      lastError = manager.getLastError();
+      continue;
+    }
+
+    switch (ms11::checkReadResponse(response, length, seq)) {
+      case ms11::FrameCheck::Ok:
+        memcpy(buffer, response + 1, length);
+        return true;
+      case ms11::FrameCheck::BadCrc:
+        count(frameStats.crcErrors);
+        lastError = "Frame CRC mismatch";
+        break;
+      case ms11::FrameCheck::BadSequence:
+        count(frameStats.sequenceErrors);
+        lastError = "Frame sequence mismatch";
+        break;
+    }
+    frameError = true;
+  }
+
+  // Every attempt answered but none verified: the slave has likely lost framing
+  if (frameError) {
+    renegotiatePending = true;
+  }
+  return false;
+}
+
+bool SlaveController::readEventFlags(uint8_t& flags, bool& frameError) {
+  TransferGuard guard(transferLock);
+  I2CManager& manager = I2CManager::getInstance();
+  const uint8_t reg = ms11::EventFlags::address;
+  frameError = false;
+
+  if (!framed) {
+    // writeRead, not readRegisterMulti: the manager must not retry either
+    if (!manager.writeRead(SLAVE_I2C_ADDR, &reg, 1, &flags, 1)) {
+      lastError = manager.getLastError();
+      return false;
+    }
+    return true;
+  }
+
+  uint8_t request[ms11::FRAME_READ_REQUEST_LENGTH];
+  uint8_t response[1 + ms11::FRAME_READ_OVERHEAD];
+  uint8_t seq = takeSequence();
+  ms11::buildReadRequest(reg, seq, request);
+  if (!manager.writeRead(SLAVE_I2C_ADDR, request, sizeof(request), response, sizeof(response))) {
+    lastError = manager.getLastError();
     return false;
   }
 
-  // Combine bytes (big-endian)
-  value = ((int16_t)high << 8) | low;
-  
-  // Handle signed conversion
-  if (value & 0x8000) {
-    value = -(int16_t)(~value + 1);
+  switch (ms11::checkReadResponse(response, 1, seq)) {
+    case ms11::FrameCheck::Ok:
+      flags = response[1];
+      return true;
+    case ms11::FrameCheck::BadCrc:
+      count(frameStats.crcErrors);
+      lastError = "Frame CRC mismatch";
+      break;
+    case ms11::FrameCheck::BadSequence:
+      count(frameStats.sequenceErrors);
+      lastError = "Frame sequence mismatch";
+      break;
   }
-  
-  return true;
+  frameError = true;
+  return false;
 }
 
-bool SlaveController::writeRegisterInt16(uint8_t regHigh, uint8_t regLow, int16_t value) {
-  uint8_t high = (value >> 8) & 0xFF;
-  uint8_t low = value & 0xFF;
+bool SlaveController::transferWrite(uint8_t reg, const uint8_t* data, uint8_t length) {
+  TransferGuard guard(transferLock);
+  I2CManager& manager = I2CManager::getInstance();
+  uint8_t frame[MS11_MAX_BURST];
+
+  if (!framed) {
+    bool ok;
+    if (length == 1) {
+      ok = manager.writeRegister(SLAVE_I2C_ADDR, reg, data[0]);
+    } else if (length < MS11_MAX_BURST) {
+      // Slave auto-increments its register pointer
+      frame[0] = reg;
+      memcpy(frame + 1, data, length);
+      ok = manager.write(SLAVE_I2C_ADDR, frame, 1 + length);
+    } else {
+      lastError = "Write exceeds frame size";
+      return false;
+    }
+    if (!ok) {
+      lastError = manager.getLastError();
+    }
+    return ok;
+  }
 
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, regHigh, high)) {
+  uint8_t frameLength = ms11::buildWriteFrame(reg, takeSequence(), data, length, frame);
+  if (frameLength == 0) {
+    lastError = "Write exceeds frame size";
     return false;
   }
 
-  if (!I2CManager::getInstance().writeRegister(SLAVE_I2C_ADDR, regLow, low)) {
+  // Same frame (same sequence) on every attempt: if only the ACK was lost,
+  // the slave recognises the repeat and does not apply it twice
+  for (uint8_t attempt = 0; attempt <= SLAVE_FRAME_RETRIES; attempt++) {
+    if (attempt > 0) {
+      count(frameStats.retries);
+      delay(10);
+    }
+    if (manager.write(SLAVE_I2C_ADDR, frame, frameLength)) {
+      return true;
+    }
+  }
+
+  lastError = manager.getLastError();
+  return false;
+}
+
+// ============================================================================
+// Control Outputs (shadow registers)
+// ============================================================================
+
+void SlaveController::setOutput(OutputIndex index, uint8_t value) {
+  portENTER_CRITICAL(&shadowMux);
+  ShadowRegister& reg = shadow[index];
+  if (reg.desiredValid && reg.desired == value) {
+    if (reg.confirmedValid && reg.confirmed == value) {
+      outputStats.suppressed++;
+    }
+  } else {
+    reg.desired = value;
+    reg.desiredValid = true;
+    reg.resends = 0;
+  }
+  portEXIT_CRITICAL(&shadowMux);
+}
+
+bool SlaveController::isDirty(const ShadowRegister& reg) const {
+  return reg.desiredValid &&
+         (!reg.confirmedValid || reg.desired != reg.confirmed) &&
+         reg.resends < SLAVE_OUTPUT_MAX_RESENDS;
+}
+
+void SlaveController::invalidateOutputs() {
+  portENTER_CRITICAL(&shadowMux);
+  for (uint8_t i = 0; i < OUT_COUNT; i++) {
+    shadow[i].confirmedValid = false;
+    shadow[i].resends = 0;
+  }
+  portEXIT_CRITICAL(&shadowMux);
+}
+
+void SlaveController::reconfirmOutputs() {
+  portENTER_CRITICAL(&shadowMux);
+  for (uint8_t i = OUT_FAN; i <= OUT_AUGER; i++) {
+    if (shadow[i].resends < SLAVE_OUTPUT_MAX_RESENDS) {
+      shadow[i].confirmedValid = false;
+    }
+  }
+  portEXIT_CRITICAL(&shadowMux);
+}
+
+// Caller holds shadowMux. Readback did not confirm the output: re-send it,
+// and after SLAVE_OUTPUT_MAX_RESENDS mark it rejected until its back-off ends.
+void SlaveController::countResend(OutputIndex index, uint32_t now) {
+  ShadowRegister& reg = shadow[index];
+  reg.confirmedValid = false;
+  if (reg.resends >= SLAVE_OUTPUT_MAX_RESENDS || ++reg.resends < SLAVE_OUTPUT_MAX_RESENDS) {
+    return;  // Already rejected (re-sent inside a span), or still retrying
+  }
+  reg.rejectedAt = now;
+  reg.backoffMs = reg.backoffMs == 0 ? SLAVE_OUTPUT_REJECT_BACKOFF_MS
+                                     : min<uint32_t>(reg.backoffMs * 2, SLAVE_OUTPUT_REJECT_BACKOFF_MAX_MS);
+  rejectedOutputs |= (1 << index);
+  outputStats.rejections++;
+}
+
+bool SlaveController::flushOutputs() {
+  if (flushPending > 0 || (int32_t)(millis() - flushRetryAt) < 0) {
+    return false;  // Previous flush still queued, or backing off
+  }
+
+  if (renegotiatePending) {
+    // negotiateProtocol() blocks on Wire1 for several transfers: run it on the
+    // slave bus worker behind a presence probe, the outputs follow next flush
+    I2CTransaction probe;
+    probe.type = I2C_TXN_READ;
+    probe.priority = I2C_PRIORITY_HIGH;
+    probe.address = SLAVE_I2C_ADDR;
+    probe.rxBuffer = readbackBuffer;
+    probe.rxLength = 1;
+    probe.callback = onRenegotiateProbe;
+    probe.context = this;
+    if (!submitTracked(probe)) {
+      onFlushFailed();
+      return false;
+    }
+    return true;
+  }
+
+  // Snapshot the dirty set: contiguous control span + LED
+  int8_t first = -1;
+  int8_t last = -1;
+  bool ledDirty;
+  uint32_t now = millis();
+  portENTER_CRITICAL(&shadowMux);
+  for (uint8_t i = OUT_FAN; i <= OUT_AUGER; i++) {
+    ShadowRegister& reg = shadow[i];
+    if (reg.resends >= SLAVE_OUTPUT_MAX_RESENDS && now - reg.rejectedAt >= reg.backoffMs) {
+      reg.resends = 0;  // Back-off over: try the rejected output again
+    }
+    if (isDirty(reg)) {
+      if (first < 0) first = i;
+      last = i;
+    }
+  }
+  ledDirty = isDirty(shadow[OUT_LED]);
+  for (uint8_t i = 0; i < OUT_COUNT; i++) {
+    sentValues[i] = shadow[i].desired;
+  }
+  portEXIT_CRITICAL(&shadowMux);
+
+  if (first < 0 && !ledDirty) {
+    return true;  // Nothing to send
+  }
+
+  uint8_t queued = 0;
+
+  if (first >= 0) {
+    sentFirst = first;
+    sentLast = last;
+    controlWriteOk = false;
+
+    // Clean registers inside the span are re-sent with their desired value
+    I2CTransaction write;
+    write.type = I2C_TXN_WRITE;
+    write.priority = I2C_PRIORITY_HIGH;
+    write.address = SLAVE_I2C_ADDR;
+    write.txLength = encodeWrite(ms11::FanCmd::address + first, &sentValues[first],
+                                 last - first + 1, write.txData);
+    write.retries = 1;
+    write.callback = onControlWriteComplete;
+    write.context = this;
+
+    // Readback queued right behind the write (same queue, FIFO)
+    I2CTransaction readback;
+    readback.type = I2C_TXN_WRITE_READ;
+    readback.priority = I2C_PRIORITY_HIGH;
+    readback.address = SLAVE_I2C_ADDR;
+    readback.rxBuffer = readbackBuffer;
+    readback.rxLength = ms11::OutputReadback::length;
+    readbackFramed = framed;
+    if (readbackFramed) {
+      readbackSequence = takeSequence();
+      readback.txLength = ms11::buildReadRequest(ms11::OutputReadback::first, readbackSequence,
+                                                 readback.txData);
+      readback.rxLength += ms11::FRAME_READ_OVERHEAD;
+    } else {
+      readback.txData[0] = ms11::OutputReadback::first;
+      readback.txLength = 1;
+    }
+    readback.retries = 1;
+    readback.callback = onReadbackComplete;
+    readback.context = this;
+
+    if (submitTracked(write)) {
+      queued++;
+      if (submitTracked(readback)) {
+        queued++;
+      }
+    }
+  }
+
+  if (ledDirty) {
+    I2CTransaction led;
+    led.type = I2C_TXN_WRITE;
+    led.priority = I2C_PRIORITY_HIGH;
+    led.address = SLAVE_I2C_ADDR;
+    led.txLength = encodeWrite(ms11::LedOnOff::address, &sentValues[OUT_LED], 1, led.txData);
+    led.retries = 1;
+    led.callback = onLedWriteComplete;
+    led.context = this;
+
+    if (submitTracked(led)) {
+      queued++;
+    }
+  }
+
+  if (queued == 0) {
+    onFlushFailed();
     return false;
   }
 
+  count(outputStats.flushes);
   return true;
 }
+
+void SlaveController::onRenegotiateProbe(const I2CTransaction& txn, I2CErrorCode result, void* context) {
+  // Runs in the slave bus worker task; the flush stays pending until framing is settled
+  SlaveController* self = static_cast<SlaveController*>(context);
+
+  if (result == I2C_OK) {
+    self->count(self->frameStats.renegotiations);
+    Serial.println("[SlaveController] Persistent frame errors, renegotiating protocol");
+    self->negotiateProtocol();
+  } else {
+    self->onFlushFailed();  // Slave not answering: keep the request, retry after the back-off
+  }
+
+  portENTER_CRITICAL(&self->shadowMux);
+  self->flushPending--;
+  portEXIT_CRITICAL(&self->shadowMux);
+}
+
+uint8_t SlaveController::encodeWrite(uint8_t reg, const uint8_t* data, uint8_t length, uint8_t* out) {
+  if (framed) {
+    return ms11::buildWriteFrame(reg, takeSequence(), data, length, out);
+  }
+  out[0] = reg;
+  memcpy(out + 1, data, length);
+  return 1 + length;
+}
+
+bool SlaveController::submitTracked(const I2CTransaction& txn) {
+  // Count as pending before queueing: the worker may complete it before submit() returns
+  portENTER_CRITICAL(&shadowMux);
+  flushPending++;
+  portEXIT_CRITICAL(&shadowMux);
+
+  if (I2CManager::getInstance().submit(txn)) {
+    return true;
+  }
+
+  portENTER_CRITICAL(&shadowMux);
+  flushPending--;
+  portEXIT_CRITICAL(&shadowMux);
+  return false;
+}
+
+void SlaveController::onFlushFailed() {
+  flushRetryAt = millis() + SLAVE_OUTPUT_RETRY_MS;
+}
+
+void SlaveController::onControlWriteComplete(const I2CTransaction& txn, I2CErrorCode result, void* context) {
+  // Runs in the slave bus worker task - keep it short
+  SlaveController* self = static_cast<SlaveController*>(context);
+
+  portENTER_CRITICAL(&self->shadowMux);
+  if (result == I2C_OK) {
+    for (uint8_t i = self->sentFirst; i <= self->sentLast; i++) {
+      self->shadow[i].confirmed = self->sentValues[i];
+      self->shadow[i].confirmedValid = true;
+    }
+  }
+  self->controlWriteOk = (result == I2C_OK);
+  self->flushPending--;
+  portEXIT_CRITICAL(&self->shadowMux);
+
+  if (result == I2C_OK) {
+    self->count(self->stats.successfulWrites);
+  } else {
+    self->count(self->stats.failedWrites);
+    self->onFlushFailed();
+  }
+}
+
+void SlaveController::onReadbackComplete(const I2CTransaction& txn, I2CErrorCode result, void* context) {
+  SlaveController* self = static_cast<SlaveController*>(context);
+  using ms11::OutputReadback;
+
+  if (result != I2C_OK || !self->controlWriteOk) {
+    portENTER_CRITICAL(&self->shadowMux);
+    self->flushPending--;
+    portEXIT_CRITICAL(&self->shadowMux);
+    if (result != I2C_OK) {
+      self->count(self->stats.failedReads);
+    }
+    return;
+  }
+
+  const uint8_t* payload = self->readbackBuffer;
+  if (self->readbackFramed) {
+    ms11::FrameCheck check = ms11::checkReadResponse(self->readbackBuffer, OutputReadback::length,
+                                                     self->readbackSequence);
+    if (check != ms11::FrameCheck::Ok) {
+      // Outputs unverified, not rejected: re-send the span on the next flush
+      // (persistent frame errors renegotiate below)
+      portENTER_CRITICAL(&self->shadowMux);
+      for (uint8_t i = self->sentFirst; i <= self->sentLast; i++) {
+        self->shadow[i].confirmedValid = false;
+      }
+      self->flushPending--;
+      portEXIT_CRITICAL(&self->shadowMux);
+      if (check == ms11::FrameCheck::BadCrc) {
+        self->count(self->frameStats.crcErrors);
+      } else {
+        self->count(self->frameStats.sequenceErrors);
+      }
+      if (++self->readbackFrameErrors >= SLAVE_FRAME_RETRIES) {
+        self->renegotiatePending = true;  // Handled by the next flushOutputs() (on this worker)
+      }
+      self->onFlushFailed();
+      return;
+    }
+    self->readbackFrameErrors = 0;
+    payload++;  // Skip the echoed sequence number
+  }
+
+  uint8_t status = OutputReadback::get<ms11::Status>(payload);
+  uint8_t actual[OUT_AUGER + 1];
+  actual[OUT_FAN] = OutputReadback::get<ms11::FanPercent>(payload);
+  actual[OUT_IGNITER] = (status & STATUS_IGNITER_BIT) ? 1 : 0;
+  actual[OUT_AUGER] = (status & STATUS_AUGER_BIT) ? 1 : 0;
+
+  uint32_t now = millis();
+  portENTER_CRITICAL(&self->shadowMux);
+  uint8_t wasRejected = self->rejectedOutputs;
+  for (uint8_t i = self->sentFirst; i <= self->sentLast; i++) {
+    ShadowRegister& reg = self->shadow[i];
+    if (!reg.confirmedValid || actual[i] == reg.confirmed) {
+      reg.resends = 0;
+      if (reg.confirmedValid) {
+        reg.backoffMs = 0;
+        self->rejectedOutputs &= ~(1 << i);
+      }
+      continue;
+    }
+    // Slave did not apply it: re-send on the next flush (bounded, then backed off)
+    self->countResend((OutputIndex)i, now);
+    self->outputStats.mismatches++;
+  }
+  uint8_t newlyRejected = self->rejectedOutputs & ~wasRejected;
+  self->lastStatus = status;
+  self->lastIgniterState = actual[OUT_IGNITER];
+  self->lastAugerState = actual[OUT_AUGER];
+  self->flushPending--;
+  portEXIT_CRITICAL(&self->shadowMux);
+
+  self->count(self->stats.successfulReads);
+  static const char* names[] = {"fan", "igniter", "auger"};
+  for (uint8_t i = OUT_FAN; i <= OUT_AUGER; i++) {
+    if (newlyRejected & (1 << i)) {
+      Serial.printf("[SlaveController] WARNING: slave keeps rejecting %s command (status 0x%02X), retry in %lus\n",
+                    names[i], status, (unsigned long)(self->shadow[i].backoffMs / 1000));
+    }
+  }
+}
+
+void SlaveController::onLedWriteComplete(const I2CTransaction& txn, I2CErrorCode result, void* context) {
+  SlaveController* self = static_cast<SlaveController*>(context);
+
+  portENTER_CRITICAL(&self->shadowMux);
+  if (result == I2C_OK) {
+    self->shadow[OUT_LED].confirmed = self->sentValues[OUT_LED];
+    self->shadow[OUT_LED].confirmedValid = true;
+  }
+  self->flushPending--;
+  portEXIT_CRITICAL(&self->shadowMux);
+
+  if (result == I2C_OK) {
+    self->count(self->stats.successfulWrites);
+  } else {
+    self->count(self->stats.failedWrites);
+    self->onFlushFailed();
+  }
+}
@@ -0,0 +1,173 @@
+#include "slave_events.h"
+#include "slave_controller.h"
+
+#ifdef I2C_SIM_BUS
+#include "i2c_sim_bus.h"
+#endif
+
+bool SlaveEventMonitor::begin() {
+  if (task) {
+    return true;
+  }
+
+#if !defined(I2C_SIM_BUS)
+  if (SLAVE_ATTN_PIN < 0) {
+    Serial.println("[SlaveEvents] No attention line configured, using heartbeat polling");
+    return false;
+  }
+#endif
+
+  if (xTaskCreatePinnedToCore(serviceTask, "slave_evt", SLAVE_EVENT_TASK_STACK, this,
+                              SLAVE_EVENT_TASK_PRIORITY, &task, SLAVE_EVENT_TASK_CORE) != pdPASS) {
+    task = nullptr;
+    Serial.println("[SlaveEvents] ERROR: Failed to start service task");
+    return false;
+  }
+
+#ifdef I2C_SIM_BUS
+  SimBus::slaveDevice().setAttentionHandler([](void* arg) {
+    static_cast<SlaveEventMonitor*>(arg)->notify();
+  }, this);
+  Serial.println("[SlaveEvents] ✓ Listening on simulated attention line");
+#else
+  pinMode(SLAVE_ATTN_PIN, INPUT_PULLUP);
+  attachInterruptArg(SLAVE_ATTN_PIN, onAttentionIsr, this, FALLING);
+  Serial.printf("[SlaveEvents] ✓ Listening on attention line GPIO%d\n", SLAVE_ATTN_PIN);
+#endif
+
+  // Events raised before the ISR was attached (e.g. the boot RESET flag)
+  notify();
+  return true;
+}
+
+void SlaveEventMonitor::end() {
+  if (!task) {
+    return;
+  }
+#ifdef I2C_SIM_BUS
+  SimBus::slaveDevice().setAttentionHandler(nullptr, nullptr);
+#else
+  detachInterrupt(SLAVE_ATTN_PIN);
+#endif
+  vTaskDelete(task);
+  task = nullptr;
+}
+
+void IRAM_ATTR SlaveEventMonitor::onAttentionIsr(void* arg) {
+  SlaveEventMonitor* self = static_cast<SlaveEventMonitor*>(arg);
+  if (!self->pending) {
+    self->assertedAtUs = micros();
+    self->pending = true;
+  }
+
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->task, &woken);
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void SlaveEventMonitor::notify() {
+  if (!task) {
+    return;
+  }
+  if (!pending) {
+    assertedAtUs = micros();
+    pending = true;
+  }
+  xTaskNotifyGive(task);
+}
+
+bool SlaveEventMonitor::lineAsserted() {
+#ifdef I2C_SIM_BUS
+  return SimBus::slaveDevice().isAttentionAsserted();
+#else
+  return digitalRead(SLAVE_ATTN_PIN) == LOW;
+#endif
+}
+
+void SlaveEventMonitor::serviceTask(void* param) {
+  SlaveEventMonitor* self = static_cast<SlaveEventMonitor*>(param);
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SLAVE_EVENT_LEVEL_CHECK_MS));
+
+    // The line stays low until every flag has been read, so keep servicing
+    // while it is asserted; a failed or empty read waits for the next check
+    while (self->lineAsserted()) {
+      if (!self->pending) {
+        // Level seen without an edge (missed or raised before attach)
+        self->assertedAtUs = micros();
+        self->pending = true;
+      }
+      if (!self->service()) {
+        break;
+      }
+    }
+  }
+}
+
+bool SlaveEventMonitor::service() {
+  SlaveController& slave = SlaveController::getInstance();
+
+  uint8_t flags = 0;
+  bool frameError = false;
+  if (!slave.readEventFlags(flags, frameError)) {
+    stats.readErrors++;
+    if (!frameError) {
+      return false;
+    }
+    // The slave may have cleared the flags with the corrupted answer, so
+    // don't read them again: take the state from a snapshot and resync framing
+    Serial.println("[SlaveEvents] Event flags lost to a frame error, reading snapshot");
+    slave.requestRenegotiation();
+    SlaveSnapshot snapshot;
+    if (!slave.readSnapshot(snapshot)) {
+      return false;
+    }
+    stats.resyncs++;
+    completed();
+    return true;
+  }
+  if (flags == 0) {
+    stats.spurious++;
+    pending = false;
+    return false;
+  }
+  stats.events++;
+  stats.lastFlags = flags;
+
+  if (flags & ms11::EVENT_RESET) {
+    // Outputs and framing were lost; the next flush renegotiates on the slave bus worker
+    stats.resets++;
+    slave.requestRenegotiation();
+    Serial.println("[SlaveEvents] Slave reset reported");
+  }
+
+  if (flags & (ms11::EVENT_STATUS | ms11::EVENT_FAULT)) {
+    uint8_t status;
+    if (slave.readStatus(status) && (flags & ms11::EVENT_FAULT)) {
+      stats.faults++;
+      Serial.printf("[SlaveEvents] Fault: error code %u (status 0x%02X)\n",
+                    slave.getErrorCode(), status);
+    }
+  }
+
+  if (flags & ms11::EVENT_TEMP) {
+    int16_t temp;
+    slave.readOvenTemp(temp);
+    slave.readSystemTemp(temp);
+  }
+
+  completed();
+  return true;
+}
+
+void SlaveEventMonitor::completed() {
+  uint32_t latency = micros() - assertedAtUs;
+  pending = false;
+  stats.lastLatencyUs = latency;
+  if (latency > stats.maxLatencyUs) {
+    stats.maxLatencyUs = latency;
+  }
+}
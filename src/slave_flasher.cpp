@@ -0,0 +1,458 @@
+#include "slave_flasher.h"
+#include "app_state.h"
+#include "i2c_manager.h"
+#include "slave_controller.h"
+#include <LittleFS.h>
+
+bool SlaveFlasher::begin() {
+  if (task) {
+    return true;
+  }
+  if (!md11SlaveUpdater) {
+    md11SlaveUpdater = new MD11SlaveUpdate();
+  }
+
+  lock = xSemaphoreCreateMutex();
+  if (!lock) {
+    Serial.println("[SlaveFlasher] ERROR: Failed to create lock");
+    return false;
+  }
+  if (xTaskCreatePinnedToCore(flasherTask, "slave_flash", SLAVE_FLASH_TASK_STACK, this,
+                              SLAVE_FLASH_TASK_PRIORITY, &task, SLAVE_FLASH_TASK_CORE) != pdPASS) {
+    task = nullptr;
+    Serial.println("[SlaveFlasher] ERROR: Failed to start flasher task");
+    return false;
+  }
+  Serial.println("[SlaveFlasher] ✓ Ready");
+  return true;
+}
+
+// ============================================================================
+// Job control (any task)
+// ============================================================================
+
+uint32_t SlaveFlasher::start(const String& file, bool differentialMode, bool temporaryFile,
+                             uint8_t targetAddress, bool backupFirst, uint8_t version) {
+  return queue(file, differentialMode, temporaryFile, targetAddress, backupFirst, "", version);
+}
+
+uint32_t SlaveFlasher::rollback(uint8_t targetAddress, bool restoreEepromDump) {
+  if (!task) {
+    return 0;
+  }
+  String imagePath = MD11SlaveUpdate::backupImagePath(targetAddress);
+  String dumpPath = restoreEepromDump ? MD11SlaveUpdate::backupEepromPath(targetAddress) : String("");
+  if (!LittleFS.exists(imagePath) || (restoreEepromDump && !LittleFS.exists(dumpPath))) {
+    Serial.printf("[SlaveFlasher] No backup for 0x%02X\n", targetAddress);
+    return 0;
+  }
+  return queue(imagePath, true, false, targetAddress, false, dumpPath, 0);
+}
+
+uint32_t SlaveFlasher::queue(const String& file, bool differentialMode, bool temporaryFile,
+                             uint8_t targetAddress, bool backupFirst, const String& eepromDump,
+                             uint8_t version) {
+  if (!task) {
+    return 0;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  State state = progress.state;
+  bool busy = (state != FLASH_IDLE && state != FLASH_DONE &&
+               state != FLASH_FAILED && state != FLASH_CANCELLED);
+  if (busy) {
+    xSemaphoreGive(lock);
+    return 0;
+  }
+
+  path = file;
+  differential = differentialMode;
+  temporary = temporaryFile;
+  hexVersion = version;
+  target = targetAddress;
+  backup = backupFirst;
+  eepromPath = eepromDump;
+  restoreEeprom = !eepromDump.isEmpty();
+  cancelRequested = false;
+
+  Progress previous = progress;
+  progress = Progress();
+  progress.jobId = nextJobId++;
+  progress.target = targetAddress;
+  progress.rollback = (file == MD11SlaveUpdate::backupImagePath(targetAddress));
+  progress.state = FLASH_PREPARE;
+  progress.inBootloader = previous.inBootloader;
+  uint32_t jobId = progress.jobId;
+  xSemaphoreGive(lock);
+
+  // Asked with the slot already taken (isBusy() is true), so a guard that
+  // checks isBusy() before starting its own work cannot race past us
+  const char* refusal = startGuard ? startGuard(targetAddress, startGuardContext) : nullptr;
+  if (refusal) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    progress = previous;
+    xSemaphoreGive(lock);
+    Serial.printf("[SlaveFlasher] Job for 0x%02X refused: %s\n", targetAddress, refusal);
+    return 0;
+  }
+
+  Serial.printf("[SlaveFlasher] Job %lu queued: %s -> 0x%02X (%s)\n", (unsigned long)jobId, file.c_str(),
+                targetAddress, differentialMode ? "differential" : "full");
+  xTaskNotifyGive(task);
+  return jobId;
+}
+
+bool SlaveFlasher::cancel(uint32_t jobId) {
+  if (!lock) {
+    return false;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  bool running = (progress.jobId == jobId && progress.state >= FLASH_PREPARE &&
+                  progress.state <= FLASH_EXIT_BOOTLOADER);
+  if (running) {
+    cancelRequested = true;
+  }
+  xSemaphoreGive(lock);
+  return running;
+}
+
+bool SlaveFlasher::isBusy() {
+  Progress current = getProgress();
+  return current.state >= FLASH_PREPARE && current.state <= FLASH_EXIT_BOOTLOADER;
+}
+
+SlaveFlasher::Progress SlaveFlasher::getProgress() {
+  if (!lock) {
+    return progress;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  Progress copy = progress;
+  xSemaphoreGive(lock);
+  return copy;
+}
+
+void SlaveFlasher::setListener(ProgressListener callback, void* context) {
+  listener = callback;
+  listenerContext = context;
+}
+
+void SlaveFlasher::setStartGuard(StartGuard guard, void* context) {
+  startGuard = guard;
+  startGuardContext = context;
+}
+
+const char* SlaveFlasher::stateName(State state) {
+  switch (state) {
+    case FLASH_IDLE:             return "idle";
+    case FLASH_PREPARE:          return "prepare";
+    case FLASH_ENTER_BOOTLOADER: return "enter_bootloader";
+    case FLASH_CHECK_SIGNATURE:  return "check_signature";
+    case FLASH_BACKUP:           return "backup";
+    case FLASH_WRITE_PAGES:      return "write_pages";
+    case FLASH_VERIFY:           return "verify";
+    case FLASH_RESTORE_EEPROM:   return "restore_eeprom";
+    case FLASH_EXIT_BOOTLOADER:  return "exit_bootloader";
+    case FLASH_DONE:             return "done";
+    case FLASH_FAILED:           return "failed";
+    case FLASH_CANCELLED:        return "cancelled";
+  }
+  return "unknown";
+}
+
+// ============================================================================
+// Flasher task
+// ============================================================================
+
+void SlaveFlasher::flasherTask(void* param) {
+  SlaveFlasher* self = static_cast<SlaveFlasher*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    self->runJob();
+  }
+}
+
+void SlaveFlasher::runJob() {
+  State state = getProgress().state;
+  enteredBootloader = false;
+  enterDeadlineMs = 0;
+  resumePage = 0;
+  publish(true);
+
+  while (state >= FLASH_PREPARE && state <= FLASH_EXIT_BOOTLOADER) {
+    if (cancelRequested) {
+      // Pages already written (now or before a reset): stay in the bootloader,
+      // a new job completes the image
+      if (state < FLASH_WRITE_PAGES && resumePage == 0) {
+        leaveBootloader();
+      }
+      state = FLASH_CANCELLED;
+      setState(state);
+      break;
+    }
+
+    State next = step(state);
+    if (next != state) {
+      setState(next);
+    }
+    publish(next != state);
+    state = next;
+  }
+
+  if (image) {
+    image.close();
+  }
+  md11SlaveUpdater->abortBackup();  // Cancelled or failed mid-dump
+  if (temporary) {
+    LittleFS.remove(path);
+  }
+  publish(true);
+
+  Progress result = getProgress();
+  Serial.printf("[SlaveFlasher] Job %lu %s%s%s\n", (unsigned long)result.jobId, stateName(result.state),
+                result.error[0] ? ": " : "", result.error);
+}
+
+SlaveFlasher::State SlaveFlasher::step(State state) {
+  I2CManager& manager = I2CManager::getInstance();
+  MD11SlaveUpdate& updater = *md11SlaveUpdater;
+
+  switch (state) {
+    case FLASH_PREPARE: {
+      // A .hex is converted once; the job always flashes the image
+      if (path.endsWith(".hex")) {
+        String imagePath = path.substring(0, path.length() - 4) + MSIMG_EXTENSION;
+        String error;
+        if (!convertHexToImage(path, imagePath, error, hexVersion)) {
+          return fail(error);
+        }
+        if (temporary) {
+          LittleFS.remove(path);
+        }
+        path = imagePath;
+      }
+
+      image = LittleFS.open(path, "r");
+      if (!image) {
+        return fail("Cannot open " + path);
+      }
+      String error;
+      if (!readImageHeader(image, header, error) || !verifyImageDigest(image, header, error)) {
+        return fail(error);
+      }
+
+      // Same image as an interrupted update: continue from its checkpoint
+      resumePage = 0;
+      FlashJournal::Entry entry;
+      if (FlashJournal::getInstance().load(entry) && entry.path == path && entry.address == target &&
+          memcmp(entry.sha256, header.sha256, sizeof(entry.sha256)) == 0) {
+        resumePage = (entry.phase == FlashJournal::JOURNAL_WRITING) ? min(entry.page, header.pageCount)
+                                                                    : header.pageCount;
+        Serial.printf("[SlaveFlasher] Resuming interrupted update (%s) at page %u/%u\n",
+                      FlashJournal::phaseName(entry.phase), resumePage, header.pageCount);
+      }
+
+      xSemaphoreTake(lock, portMAX_DELAY);
+      progress.pageCount = header.pageCount;
+      progress.resumePage = resumePage;
+      xSemaphoreGive(lock);
+      return FLASH_ENTER_BOOTLOADER;
+    }
+
+    case FLASH_ENTER_BOOTLOADER: {
+      if (enterDeadlineMs == 0) {
+        if (manager.ping(TWIBOOT_I2C_ADDR, I2C_BUS_SLAVE)) {
+          // Twiboot is shared: it is ours only if the target's application is gone
+          if (manager.ping(target, I2C_BUS_SLAVE)) {
+            return fail("Another board is in the bootloader");
+          }
+          return FLASH_CHECK_SIGNATURE;  // Already waiting for us
+        }
+        if (manager.writeRegister(target, ms11::EnterBootloader::address, ms11::BOOTLOADER_MAGIC)) {
+          enteredBootloader = true;
+        } else if (resumePage == 0) {
+          return fail("Failed to send bootloader command to 0x" + String(target, HEX));
+        } else {
+          // Half-written application may not answer; twiboot still starts after reset
+          Serial.println("[SlaveFlasher] Application not responding, waiting for the bootloader");
+        }
+        enterDeadlineMs = millis() + TWIBOOT_ENTRY_TIMEOUT_MS;
+      }
+      if (manager.waitForAck(TWIBOOT_I2C_ADDR, SLAVE_FLASH_WAIT_SLICE_MS)) {
+        enterDeadlineMs = 0;
+        return FLASH_CHECK_SIGNATURE;
+      }
+      if ((int32_t)(millis() - enterDeadlineMs) >= 0) {
+        enterDeadlineMs = 0;
+        return fail("Bootloader did not appear at 0x" + String(TWIBOOT_I2C_ADDR, HEX));
+      }
+      return FLASH_ENTER_BOOTLOADER;
+    }
+
+    case FLASH_CHECK_SIGNATURE: {
+      xSemaphoreTake(lock, portMAX_DELAY);
+      progress.inBootloader = true;
+      xSemaphoreGive(lock);
+
+      uint8_t sig[3];
+      if (!updater.queryChipSignature(sig[0], sig[1], sig[2])) {
+        return fail(updater.getLastError());
+      }
+      if (memcmp(sig, header.signature, sizeof(sig)) != 0) {
+        char message[80];
+        snprintf(message, sizeof(message), "Image is for %02X %02X %02X, target is %02X %02X %02X",
+                 header.signature[0], header.signature[1], header.signature[2], sig[0], sig[1], sig[2]);
+        leaveBootloader();
+        return fail(message);
+      }
+
+      updater.setTarget(target);
+      updater.setDifferential(differential);
+
+      // A resumed image is half written: the previous backup stays the good one
+      if (backup && resumePage == 0) {
+        if (!updater.beginBackup()) {
+          leaveBootloader();
+          return fail("Backup failed: " + updater.getLastError());
+        }
+        return FLASH_BACKUP;
+      }
+      return startWriting();
+    }
+
+    case FLASH_BACKUP: {
+      uint16_t index = getProgress().backupPage;
+      bool ok = (index < updater.getBackupPageCount()) ? updater.backupPage(index) : updater.finishBackup();
+      if (!ok) {
+        leaveBootloader();
+        return fail("Backup failed: " + updater.getLastError());
+      }
+      xSemaphoreTake(lock, portMAX_DELAY);
+      if (index < updater.getBackupPageCount()) {
+        progress.backupPage++;
+      }
+      progress.backup = updater.getBackupStats();
+      xSemaphoreGive(lock);
+      return (index < updater.getBackupPageCount()) ? FLASH_BACKUP : startWriting();
+    }
+
+    case FLASH_WRITE_PAGES: {
+      uint8_t record[MSIMG_RECORD_SIZE(HEX_PAGE_SIZE)];
+      if (image.read(record, sizeof(record)) != sizeof(record)) {
+        return fail("Image read failed");
+      }
+      uint16_t pageAddress = record[0] | ((uint16_t)record[1] << 8);
+      if ((pageAddress % HEX_PAGE_SIZE) != 0 || pageAddress >= HEX_BOOTLOADER_START) {
+        return fail("Image page address 0x" + String(pageAddress, HEX) + " outside the application section");
+      }
+      uint16_t index = getProgress().page;
+      if (index < resumePage) {
+        updater.assumePage(pageAddress, record + 2, HEX_PAGE_SIZE);
+      } else if (!updater.flashPage(pageAddress, record + 2, HEX_PAGE_SIZE)) {
+        return fail(updater.getLastError());
+      } else {
+        FlashJournal::getInstance().checkpoint(index + 1);
+      }
+
+      xSemaphoreTake(lock, portMAX_DELAY);
+      progress.page++;
+      // Writing is 0-90 %, the read-back verify the rest
+      progress.percent = (progress.page * 90) / progress.pageCount;
+      progress.stats = updater.getFlashStats();
+      bool last = (progress.page >= progress.pageCount);
+      xSemaphoreGive(lock);
+      if (last) {
+        FlashJournal::getInstance().setPhase(FlashJournal::JOURNAL_VERIFYING);
+      }
+      return last ? FLASH_VERIFY : FLASH_WRITE_PAGES;
+    }
+
+    case FLASH_VERIFY: {
+      if (!updater.finishFlash()) {
+        // Nothing on the slave can be trusted: the next attempt starts over
+        FlashJournal::getInstance().begin(path, header.sha256, target, 0);
+        return fail(updater.getLastError());
+      }
+      FlashJournal::getInstance().setPhase(FlashJournal::JOURNAL_EXITING);
+      xSemaphoreTake(lock, portMAX_DELAY);
+      progress.percent = 99;
+      progress.stats = updater.getFlashStats();
+      xSemaphoreGive(lock);
+      return restoreEeprom ? FLASH_RESTORE_EEPROM : FLASH_EXIT_BOOTLOADER;
+    }
+
+    case FLASH_RESTORE_EEPROM:
+      if (!updater.restoreEeprom(eepromPath)) {
+        // The verified flash stays; only the settings did not make it back
+        leaveBootloader();
+        FlashJournal::getInstance().clear();
+        return fail("EEPROM restore failed: " + updater.getLastError());
+      }
+      return FLASH_EXIT_BOOTLOADER;
+
+    case FLASH_EXIT_BOOTLOADER:
+      leaveBootloader();
+      FlashJournal::getInstance().clear();
+      xSemaphoreTake(lock, portMAX_DELAY);
+      progress.percent = 100;
+      xSemaphoreGive(lock);
+      return FLASH_DONE;
+
+    default:
+      return state;
+  }
+}
+
+SlaveFlasher::State SlaveFlasher::startWriting() {
+  MD11SlaveUpdate& updater = *md11SlaveUpdater;
+  updater.beginFlash();
+  FlashJournal::getInstance().begin(path, header.sha256, target, resumePage);
+  return FLASH_WRITE_PAGES;
+}
+
+void SlaveFlasher::leaveBootloader() {
+  I2CManager& manager = I2CManager::getInstance();
+  if (!enteredBootloader && !manager.ping(TWIBOOT_I2C_ADDR, I2C_BUS_SLAVE)) {
+    return;
+  }
+
+  uint8_t exitCmd[2] = {0x01, 0x80};
+  manager.write(TWIBOOT_I2C_ADDR, exitCmd, 2);
+  manager.waitForAck(target, TWIBOOT_EXIT_TIMEOUT_MS);
+
+  // The application restarted without framing or outputs
+  if (target == SLAVE_I2C_ADDR) {
+    SlaveController::getInstance().requestRenegotiation();
+  }
+  enteredBootloader = false;
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  progress.inBootloader = false;
+  xSemaphoreGive(lock);
+}
+
+SlaveFlasher::State SlaveFlasher::fail(const String& message) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  strlcpy(progress.error, message.c_str(), sizeof(progress.error));
+  xSemaphoreGive(lock);
+  return FLASH_FAILED;
+}
+
+void SlaveFlasher::setState(State state) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  progress.state = state;
+  xSemaphoreGive(lock);
+  Serial.printf("[SlaveFlasher] -> %s\n", stateName(state));
+}
+
+void SlaveFlasher::publish(bool force) {
+  if (!listener) {
+    return;
+  }
+  uint32_t now = millis();
+  if (!force && now - lastEventMs < SLAVE_FLASH_EVENT_INTERVAL_MS) {
+    return;
+  }
+  lastEventMs = now;
+  Progress current = getProgress();
+  listener(current, listenerContext);
+}
@@ -0,0 +1,431 @@
+#include "slave_fleet.h"
+#include "slave_flasher.h"
+#include "ms11_image.h"
+#include "i2c_manager.h"
+#include <LittleFS.h>
+#include <Preferences.h>
+
+bool SlaveFleet::begin() {
+  if (task) {
+    return true;
+  }
+
+  lock = xSemaphoreCreateMutex();
+  if (!lock) {
+    Serial.println("[SlaveFleet] ERROR: Failed to create lock");
+    return false;
+  }
+  loadAddresses();
+
+  if (xTaskCreatePinnedToCore(fleetTask, "slave_fleet", SLAVE_FLEET_TASK_STACK, this,
+                              SLAVE_FLEET_TASK_PRIORITY, &task, SLAVE_FLEET_TASK_CORE) != pdPASS) {
+    task = nullptr;
+    Serial.println("[SlaveFleet] ERROR: Failed to start fleet task");
+    return false;
+  }
+  Serial.printf("[SlaveFleet] ✓ Ready (%u board%s)\n", boardCount, boardCount == 1 ? "" : "s");
+  return true;
+}
+
+// ============================================================================
+// Address list (NVS)
+// ============================================================================
+
+bool SlaveFleet::validAddress(uint8_t address) {
+  // 7-bit, outside the reserved ranges, and never the shared bootloader address
+  return address >= 0x08 && address <= 0x77 && address != TWIBOOT_I2C_ADDR;
+}
+
+void SlaveFleet::loadAddresses() {
+  uint8_t list[SLAVE_FLEET_MAX_BOARDS];
+  Preferences prefs;
+  prefs.begin(SLAVE_FLEET_NAMESPACE, true);  // true = read-only mode
+  size_t count = prefs.getBytes("addrs", list, sizeof(list));
+  prefs.end();
+
+  boardCount = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (validAddress(list[i])) {
+      boards[boardCount] = Board();
+      boards[boardCount++].address = list[i];
+    }
+  }
+  if (boardCount == 0) {
+    boards[0] = Board();
+    boards[0].address = SLAVE_I2C_ADDR;
+    boardCount = 1;
+  }
+  for (uint8_t i = 0; i < boardCount; i++) {
+    routeBoard(boards[i].address);
+  }
+}
+
+// Boards sit on the slave bus: a declared route saves the discovery ping of
+// both buses (and its double timeout) while a board is absent
+void SlaveFleet::routeBoard(uint8_t address) {
+  I2CManager::getInstance().setRoute(address, I2C_BUS_SLAVE);
+}
+
+bool SlaveFleet::setAddresses(const uint8_t* addresses, uint8_t count) {
+  if (count == 0 || count > SLAVE_FLEET_MAX_BOARDS) {
+    lastError = "Between 1 and " + String(SLAVE_FLEET_MAX_BOARDS) + " addresses";
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if (!validAddress(addresses[i])) {
+      lastError = "Invalid address 0x" + String(addresses[i], HEX);
+      return false;
+    }
+    for (uint8_t j = 0; j < i; j++) {
+      if (addresses[j] == addresses[i]) {
+        lastError = "Duplicate address 0x" + String(addresses[i], HEX);
+        return false;
+      }
+    }
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (update.running) {
+    xSemaphoreGive(lock);
+    lastError = "Fleet update running";
+    return false;
+  }
+
+  // Keep what is known about boards that stay in the list
+  Board next[SLAVE_FLEET_MAX_BOARDS];
+  for (uint8_t i = 0; i < count; i++) {
+    next[i].address = addresses[i];
+    for (uint8_t j = 0; j < boardCount; j++) {
+      if (boards[j].address == addresses[i]) {
+        next[i] = boards[j];
+      }
+    }
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    boards[i] = next[i];
+  }
+  boardCount = count;
+  xSemaphoreGive(lock);
+
+  for (uint8_t i = 0; i < count; i++) {
+    routeBoard(addresses[i]);
+  }
+
+  Preferences prefs;
+  prefs.begin(SLAVE_FLEET_NAMESPACE, false);  // false = read/write mode
+  prefs.putBytes("addrs", addresses, count);
+  prefs.end();
+
+  Serial.printf("[SlaveFleet] %u board address%s configured\n", count, count == 1 ? "" : "es");
+  requestScan();
+  return true;
+}
+
+// ============================================================================
+// Inventory
+// ============================================================================
+
+uint8_t SlaveFleet::getBoards(Board* out, uint8_t max) {
+  if (!lock) {
+    return 0;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  uint8_t count = min(boardCount, max);
+  for (uint8_t i = 0; i < count; i++) {
+    out[i] = boards[i];
+  }
+  xSemaphoreGive(lock);
+  return count;
+}
+
+void SlaveFleet::requestScan() {
+  if (task) {
+    xTaskNotifyGive(task);
+  }
+}
+
+void SlaveFleet::scanAll() {
+  uint8_t addresses[SLAVE_FLEET_MAX_BOARDS];
+  xSemaphoreTake(lock, portMAX_DELAY);
+  uint8_t count = boardCount;
+  for (uint8_t i = 0; i < count; i++) {
+    addresses[i] = boards[i].address;
+  }
+  xSemaphoreGive(lock);
+
+  for (uint8_t i = 0; i < count; i++) {
+    scanBoard(addresses[i]);
+  }
+}
+
+void SlaveFleet::scanBoard(uint8_t address) {
+  Board fresh;
+  bool answered = readBoard(address, fresh);
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  for (uint8_t i = 0; i < boardCount; i++) {
+    Board& board = boards[i];
+    if (board.address != address) {
+      continue;
+    }
+    if (answered) {
+      board.version = fresh.version;
+      board.fwVersion = fresh.fwVersion;
+      board.protocolVersion = fresh.protocolVersion;
+      board.status = fresh.status;
+      board.lastSeenMs = millis();
+      board.failures = 0;
+    } else {
+      board.failures++;
+    }
+    // A board in the middle of a fleet update keeps that state
+    if (board.state != BOARD_QUEUED && board.state != BOARD_UPDATING) {
+      if (!answered) {
+        board.state = BOARD_ABSENT;
+      } else {
+        board.state = (board.status & STATUS_ERROR_MASK) ? BOARD_FAULT : BOARD_RUNNING;
+      }
+    }
+  }
+  xSemaphoreGive(lock);
+}
+
+bool SlaveFleet::readBoard(uint8_t address, Board& board) {
+  using ms11::Health;
+  uint8_t health[Health::length];
+  uint32_t raw = 0;
+
+  if (address == SLAVE_I2C_ADDR) {
+    // Framed when protocol v3 is active
+    SlaveController& slave = SlaveController::getInstance();
+    if (!slave.ping() || !slave.readBurst<Health>(health) ||
+        !slave.readReg<ms11::VersionFull>(raw)) {
+      return false;
+    }
+  } else {
+    I2CManager& manager = I2CManager::getInstance();
+    uint8_t block[ms11::VersionFull::size];
+    if (!manager.ping(address, I2C_BUS_SLAVE) ||
+        !manager.readRegisterMulti(address, Health::first, health, Health::length) ||
+        !manager.readRegisterMulti(address, ms11::VersionFull::address, block, sizeof(block))) {
+      return false;
+    }
+    raw = ms11::VersionFull::decode(block);
+  }
+
+  board.status = Health::get<ms11::Status>(health);
+  board.fwVersion = Health::get<ms11::FwVersion>(health);
+  board.protocolVersion = Health::get<ms11::ProtocolVersion>(health);
+  board.version = SlaveController::decodeVersion(raw);
+  return true;
+}
+
+// ============================================================================
+// Fleet update
+// ============================================================================
+
+bool SlaveFleet::startUpdate(const String& path, bool forceAll) {
+  if (!task) {
+    lastError = "Fleet not started";
+    return false;
+  }
+  if (!path.endsWith(MSIMG_EXTENSION) || !LittleFS.exists(path)) {
+    lastError = "Fleet updates need an .msimg image in LittleFS";
+    return false;
+  }
+  if (SlaveFlasher::getInstance().isBusy()) {
+    lastError = "A firmware update is already running";
+    return false;
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  if (update.running) {
+    xSemaphoreGive(lock);
+    lastError = "Fleet update running";
+    return false;
+  }
+  update = UpdateStatus();
+  update.running = true;
+  update.path = path;
+  force = forceAll;
+  updateRequested = true;
+  cancelRequested = false;
+  xSemaphoreGive(lock);
+
+  xTaskNotifyGive(task);
+  return true;
+}
+
+bool SlaveFleet::cancelUpdate() {
+  UpdateStatus status = getUpdateStatus();
+  if (status.running) {
+    cancelRequested = true;
+  }
+  return status.running;
+}
+
+SlaveFleet::UpdateStatus SlaveFleet::getUpdateStatus() {
+  if (!lock) {
+    return update;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  UpdateStatus copy = update;
+  xSemaphoreGive(lock);
+  return copy;
+}
+
+void SlaveFleet::runUpdate() {
+  // Image version decides which boards are outdated
+  MsImageHeader header;
+  String error;
+  File image = LittleFS.open(update.path, "r");
+  bool valid = image && readImageHeader(image, header, error);
+  if (image) {
+    image.close();
+  }
+  if (!valid) {
+    lastError = error.isEmpty() ? "Cannot open " + update.path : error;
+    Serial.println("[SlaveFleet] ERROR: " + lastError);
+    xSemaphoreTake(lock, portMAX_DELAY);
+    update.running = false;
+    xSemaphoreGive(lock);
+    return;
+  }
+
+  // Fresh inventory, then select the boards that answer and differ. An
+  // image without a version (0) cannot be compared: only flashed when forced.
+  scanAll();
+
+  uint8_t targets[SLAVE_FLEET_MAX_BOARDS];
+  uint8_t count = 0;
+  xSemaphoreTake(lock, portMAX_DELAY);
+  update.imageVersion = header.fwVersion;
+  for (uint8_t i = 0; i < boardCount; i++) {
+    Board& board = boards[i];
+    bool reachable = (board.state == BOARD_RUNNING || board.state == BOARD_FAULT);
+    bool outdated = force || (header.fwVersion != 0 && board.fwVersion != header.fwVersion);
+    if (reachable && outdated) {
+      board.state = BOARD_QUEUED;
+      targets[count++] = board.address;
+    }
+  }
+  update.total = count;
+  xSemaphoreGive(lock);
+
+  if (header.fwVersion == 0) {
+    Serial.printf("[SlaveFleet] Updating %u board%s to an image of unknown version%s\n", count,
+                  count == 1 ? "" : "s", force ? "" : " (force=1 to flash it)");
+  } else {
+    Serial.printf("[SlaveFleet] Updating %u board%s to firmware %X.%X\n", count, count == 1 ? "" : "s",
+                  header.fwVersion >> 4, header.fwVersion & 0x0F);
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    if (cancelRequested) {
+      setBoardState(targets[i], BOARD_UNKNOWN);  // Re-evaluated by the next scan
+      continue;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    update.current = targets[i];
+    xSemaphoreGive(lock);
+    setBoardState(targets[i], BOARD_UPDATING);
+
+    bool ok = flashBoard(targets[i]);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (ok) {
+      update.done++;
+    } else {
+      update.failed++;
+    }
+    for (uint8_t j = 0; j < boardCount; j++) {
+      if (boards[j].address == targets[i]) {
+        boards[j].state = ok ? BOARD_UNKNOWN : BOARD_UPDATE_FAILED;
+        if (ok) {
+          boards[j].updates++;
+        }
+      }
+    }
+    xSemaphoreGive(lock);
+
+    if (ok) {
+      scanBoard(targets[i]);  // Report the new version right away
+    }
+  }
+
+  xSemaphoreTake(lock, portMAX_DELAY);
+  update.running = false;
+  update.current = 0;
+  xSemaphoreGive(lock);
+  Serial.printf("[SlaveFleet] Update finished: %u updated, %u failed%s\n", update.done, update.failed,
+                cancelRequested ? " (cancelled)" : "");
+}
+
+bool SlaveFleet::flashBoard(uint8_t address) {
+  SlaveFlasher& flasher = SlaveFlasher::getInstance();
+  uint32_t jobId = flasher.start(update.path, true, false, address);
+  if (jobId == 0) {
+    lastError = "Flasher busy or oven running";
+    return false;
+  }
+
+  bool cancelSent = false;
+  while (flasher.isBusy()) {
+    if (cancelRequested && !cancelSent) {
+      flasher.cancel(jobId);
+      cancelSent = true;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SLAVE_FLEET_JOB_POLL_MS));
+  }
+
+  SlaveFlasher::Progress result = flasher.getProgress();
+  if (result.jobId != jobId || result.state != SlaveFlasher::FLASH_DONE) {
+    lastError = result.error[0] ? String(result.error) : String(SlaveFlasher::stateName(result.state));
+    Serial.printf("[SlaveFleet] Board 0x%02X: %s\n", address, lastError.c_str());
+    return false;
+  }
+  return true;
+}
+
+void SlaveFleet::setBoardState(uint8_t address, BoardState state) {
+  xSemaphoreTake(lock, portMAX_DELAY);
+  for (uint8_t i = 0; i < boardCount; i++) {
+    if (boards[i].address == address) {
+      boards[i].state = state;
+    }
+  }
+  xSemaphoreGive(lock);
+}
+
+const char* SlaveFleet::stateName(BoardState state) {
+  switch (state) {
+    case BOARD_UNKNOWN:       return "unknown";
+    case BOARD_ABSENT:        return "absent";
+    case BOARD_RUNNING:       return "running";
+    case BOARD_FAULT:         return "fault";
+    case BOARD_QUEUED:        return "queued";
+    case BOARD_UPDATING:      return "updating";
+    case BOARD_UPDATE_FAILED: return "update_failed";
+  }
+  return "unknown";
+}
+
+// ============================================================================
+// Fleet task
+// ============================================================================
+
+void SlaveFleet::fleetTask(void* param) {
+  SlaveFleet* self = static_cast<SlaveFleet*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SLAVE_FLEET_SCAN_INTERVAL_MS));
+
+    if (self->updateRequested) {
+      self->updateRequested = false;
+      self->runUpdate();
+    } else if (!SlaveFlasher::getInstance().isBusy()) {
+      // A web upload owns the bootloader; its board would only show as absent
+      self->scanAll();
+    }
+  }
+}
@@ -5,15 +5,24 @@
 #include "utils.h"
 #include "ntp_manager.h"
 #include "i2c_manager.h"
+#include "i2c_metrics.h"
 #include "display_manager.h"
 #include "lcd_manager.h"
 #include "slave_controller.h"
+#include "slave_events.h"
 #include "github_updater.h"
 #include "md11_slave_update.h"
+#include "ms11_image.h"
+#include "slave_flasher.h"
+#include "slave_fleet.h"
+#include "probe_manager.h"
+#include "oven_controller.h"
+#include "cook_profile_store.h"
 #include "LittleFS.h"
 #include <WiFi.h>
 #include <ArduinoJson.h>
 #include <time.h>
+#include <memory>
 
 // ============================================================================
 // FORWARD DECLARATIONS (internal helpers)
@@ -22,6 +31,9 @@
 static void registerPageRoutes(AsyncWebServer& server);
 static void registerSettingsRoutes(AsyncWebServer& server);
 static void registerI2CApiRoutes(AsyncWebServer& server);
+static void registerProbeApiRoutes(AsyncWebServer& server);
+static void registerOvenApiRoutes(AsyncWebServer& server);
+static void registerCookApiRoutes(AsyncWebServer& server);
 static void registerUpdateApiRoutes(AsyncWebServer& server);
 static void registerFileApiRoutes(AsyncWebServer& server);
 
@@ -33,6 +45,9 @@ void registerSTARoutes(AsyncWebServer& server) {
   registerPageRoutes(server);
   registerSettingsRoutes(server);
   registerI2CApiRoutes(server);
+  registerProbeApiRoutes(server);
+  registerOvenApiRoutes(server);
+  registerCookApiRoutes(server);
   registerUpdateApiRoutes(server);
   registerFileApiRoutes(server);
 
@@ -560,12 +575,47 @@ static void registerSettingsRoutes(AsyncWebServer& server) {
 // I2C API ROUTES - Scan, LED control, bootloader, register dump
 // ============================================================================
 
-// I2C slave register addresses (for test_i2c_slave.cpp on Arduino)
-#define SLAVE_REG_LED_ONOFF_WEB    0x10  // 0=off, 1=on
-#define SLAVE_REG_LED_BLINK_WEB    0x11  // 0=off, 1=1Hz, 2=4Hz
-#define SLAVE_REG_LED_STATUS_WEB   0x20  // Read status
-#define SLAVE_REG_ENTER_BOOT_WEB   0x99  // Bootloader with safety code
-#define SLAVE_BOOT_MAGIC_WEB       0xB0
+// Histogram summary for /api/metrics/i2c
+static void addHistogramJson(JsonObject obj, const I2CLatencyHistogram& hist) {
+  obj["count"] = hist.getCount();
+  obj["p50"] = hist.percentile(50);
+  obj["p90"] = hist.percentile(90);
+  obj["p99"] = hist.percentile(99);
+  obj["max"] = hist.getMax();
+}
+
+// Shared by /api/twi/job and the /api/twi/events stream
+static void flashProgressToJson(const SlaveFlasher::Progress& progress, JsonDocument& doc) {
+  doc["jobId"] = progress.jobId;
+  doc["target"] = progress.target;
+  doc["state"] = SlaveFlasher::stateName(progress.state);
+  doc["page"] = progress.page;
+  doc["pageCount"] = progress.pageCount;
+  doc["percent"] = progress.percent;
+  doc["rollback"] = progress.rollback;
+  doc["inBootloader"] = progress.inBootloader;
+  if (progress.error[0]) {
+    doc["error"] = progress.error;
+  }
+  doc["pagesWritten"] = progress.stats.pagesWritten;
+  doc["pagesUnchanged"] = progress.stats.pagesUnchanged;
+  doc["pagesCached"] = progress.stats.pagesCached;
+  doc["pagesResumed"] = progress.stats.pagesResumed;
+  doc["writeBytesPerSec"] = progress.stats.writeBytesPerSec;
+  if (progress.backupPage > 0) {
+    JsonObject backup = doc["backup"].to<JsonObject>();
+    backup["page"] = progress.backupPage;
+    backup["pagesStored"] = progress.backup.pagesStored;
+    backup["complete"] = progress.backup.complete;
+    backup["bytesPerSec"] = progress.backup.bytesPerSec;
+    backup["ms"] = progress.backup.totalMs;
+  }
+  if (progress.stats.verified) {
+    char crc[9];
+    snprintf(crc, sizeof(crc), "%08lX", (unsigned long)progress.stats.imageCrc);
+    doc["imageCrc"] = crc;
+  }
+}
 
 static void registerI2CApiRoutes(AsyncWebServer& server) {
   // API: Get Twiboot bootloader status
@@ -598,83 +648,333 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     request->send(200, "application/json", response);
   });
   
-  // API: Upload hex file to bootloader
+  // API: Upload MS11-control firmware
+  // Body is a .msimg image, raw Intel HEX (text/plain) or the legacy
+  // {"hexContent":"..."} JSON (the HEX decoder skips the wrapper). The body
+  // is only staged in LittleFS here; SlaveFlasher flashes it on its own task
+  // and the response carries the job id. Progress: /api/twi/events (SSE) or
+  // /api/twi/job. Unchanged pages are skipped unless the URL has ?mode=full.
+  // A HEX body is imaged as firmware ?fw_version=0x61 (BCD), unknown without.
   server.on("/api/twi/upload", HTTP_POST, 
     [](AsyncWebServerRequest *request) {}, 
     nullptr, 
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-      // Accumulate data in chunks
-      static String uploadBuffer;
+      static File stagingFile;
+      static String stagingPath;
+      static bool rejected = false;
       
-      // First chunk - reset buffer
       if (index == 0) {
-        uploadBuffer = "";
-        uploadBuffer.reserve(total + 1);
         Serial.println("[Twiboot API] Upload started, total size: " + String(total) + " bytes");
+        if (stagingFile) {
+          stagingFile.close();
+        }
+        rejected = SlaveFlasher::getInstance().isBusy();
+        if (!rejected) {
+          bool image = len >= 4 && memcmp(data, MSIMG_MAGIC, 4) == 0;
+          stagingPath = image ? SLAVE_FLASH_STAGING_IMAGE : SLAVE_FLASH_STAGING_HEX;
+          stagingFile = LittleFS.open(stagingPath, "w");
+        }
       }
       
-      // Append chunk to buffer
-      for (size_t i = 0; i < len; i++) {
-        uploadBuffer += (char)data[i];
+      if (stagingFile && stagingFile.write(data, len) != len) {
+        stagingFile.close();  // LittleFS full; reported below
       }
       
-      Serial.printf("[Twiboot API] Received chunk: %d/%d bytes (%.1f%%)\n", 
-                   index + len, total, ((index + len) * 100.0) / total);
-      
-      // Only process when we have all data
+      // Only respond when we have all data
       if (index + len != total) {
         return;
       }
       
-      Serial.println("[Twiboot API] All data received, processing...");
-      
-      if (!md11SlaveUpdater) {
-        request->send(400, "application/json", "{\"success\":false,\"error\":\"Twiboot not initialized\"}");
-        uploadBuffer = "";
-        return;
-      }
-      
-      // Parse JSON body with hex content
       JsonDocument doc;
-      DeserializationError error = deserializeJson(doc, uploadBuffer);
-      
-      if (error) {
-        Serial.println("[Twiboot API] JSON parse error: " + String(error.c_str()));
-        Serial.println("[Twiboot API] Buffer length: " + String(uploadBuffer.length()));
-        Serial.println("[Twiboot API] First 100 chars: " + uploadBuffer.substring(0, 100));
-        request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
-        uploadBuffer = "";
-        return;
+      int status = 202;
+      uint8_t fwVersion = 0;
+      bool versionOk = !request->hasParam("fw_version") ||
+                       parseFirmwareVersion(request->getParam("fw_version")->value(), fwVersion);
+      if (rejected) {
+        status = 409;
+        doc["success"] = false;
+        doc["error"] = "A firmware update is already running";
+      } else if (!versionOk) {
+        status = 400;
+        doc["success"] = false;
+        doc["error"] = "fw_version must be BCD, e.g. 0x61";
+        stagingFile.close();
+        LittleFS.remove(stagingPath);
+      } else if (!stagingFile) {
+        status = 500;
+        doc["success"] = false;
+        doc["error"] = "Could not store the upload";
+        LittleFS.remove(stagingPath);
+      } else {
+        stagingFile.close();
+        bool full = request->hasParam("mode") && request->getParam("mode")->value() == "full";
+        bool backup = !(request->hasParam("backup") && request->getParam("backup")->value() == "0");
+        uint32_t jobId = SlaveFlasher::getInstance().start(stagingPath, !full, true, SLAVE_I2C_ADDR, backup,
+                                                           fwVersion);
+        if (jobId == 0) {
+          status = 409;
+          doc["success"] = false;
+          doc["error"] = "Flasher busy or oven running";
+          LittleFS.remove(stagingPath);
+        } else {
+          doc["success"] = true;
+          doc["jobId"] = jobId;
+          doc["events"] = "/api/twi/events";
+        }
       }
       
-      String hexContent = doc["hexContent"].as<String>();
-      uploadBuffer = "";  // Free memory
-      
-      if (hexContent.length() == 0) {
-        Serial.println("[Twiboot API] Empty hex content");
-        request->send(400, "application/json", "{\"success\":false,\"error\":\"No hex content\"}");
+      String response;
+      serializeJson(doc, response);
+      request->send(status, "application/json", response);
+    }
+  );
+  
+  // API: Progress of the current (or last) firmware job
+  server.on("/api/twi/job", HTTP_GET, [](AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    flashProgressToJson(SlaveFlasher::getInstance().getProgress(), doc);
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+  
+  // API: Cancel a firmware job (id=<jobId>)
+  server.on("/api/twi/cancel", HTTP_POST, [](AsyncWebServerRequest *request) {
+    uint32_t jobId = 0;
+    if (request->hasParam("id", true)) {
+      jobId = request->getParam("id", true)->value().toInt();
+    } else if (request->hasParam("id")) {
+      jobId = request->getParam("id")->value().toInt();
+    }
+    JsonDocument doc;
+    doc["success"] = SlaveFlasher::getInstance().cancel(jobId);
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+  
+  // API: Backup taken before the last update (target=0x30, download=flash|eeprom)
+  server.on("/api/twi/backup", HTTP_GET, [](AsyncWebServerRequest *request) {
+    uint8_t target = request->hasParam("target") ? strtol(request->getParam("target")->value().c_str(), nullptr, 0)
+                                                 : SLAVE_I2C_ADDR;
+    String imagePath = MD11SlaveUpdate::backupImagePath(target);
+    String eepromPath = MD11SlaveUpdate::backupEepromPath(target);
+
+    if (request->hasParam("download")) {
+      String part = request->getParam("download")->value();
+      String path = (part == "eeprom") ? eepromPath : imagePath;
+      if (!LittleFS.exists(path)) {
+        request->send(404, "application/json", "{\"error\":\"No backup\"}");
         return;
       }
-      
-      Serial.println("[Twiboot API] Hex content size: " + String(hexContent.length()) + " bytes");
-      
-      // NOTE: Do NOT query bootloader version here - it may kick bootloader out of programming mode!
-      // User must click "Enter Bootloader" button first to activate bootloader.
-      Serial.println("[Twiboot API] Starting firmware upload (bootloader must already be active)...");
-      
-      // Upload hex file
-      if (!md11SlaveUpdater->uploadHexFile(hexContent)) {
-        String error = md11SlaveUpdater->getLastError();
-        Serial.println("[Twiboot API] Upload failed: " + error);
-        request->send(500, "application/json", 
-          "{\"success\":false,\"error\":\"" + error + "\"}");
-        return;
+      request->send(LittleFS, path, "application/octet-stream", true);
+      return;
+    }
+
+    JsonDocument doc;
+    doc["target"] = target;
+    doc["available"] = LittleFS.exists(imagePath);
+    File image = LittleFS.open(imagePath, "r");
+    if (image) {
+      MsImageHeader header;
+      String error;
+      if (readImageHeader(image, header, error)) {
+        doc["pages"] = header.pageCount;
+        doc["bytes"] = image.size();
+      } else {
+        doc["error"] = error;
       }
-      
-      Serial.println("[Twiboot API] Upload successful!");
-      request->send(200, "application/json", "{\"success\":true,\"message\":\"Firmware updated\"}");
+      image.close();
     }
-  );
+    File eeprom = LittleFS.open(eepromPath, "r");
+    if (eeprom) {
+      doc["eepromBytes"] = eeprom.size();
+      eeprom.close();
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
+  // API: Flash the backup back (target=0x30, eeprom=1 also restores the EEPROM)
+  server.on("/api/twi/rollback", HTTP_POST, [](AsyncWebServerRequest *request) {
+    uint8_t target = request->hasParam("target", true)
+                         ? strtol(request->getParam("target", true)->value().c_str(), nullptr, 0)
+                         : SLAVE_I2C_ADDR;
+    bool eeprom = request->hasParam("eeprom", true) && request->getParam("eeprom", true)->value() == "1";
+
+    JsonDocument doc;
+    int status = 202;
+    if (SlaveFlasher::getInstance().isBusy()) {
+      status = 409;
+      doc["success"] = false;
+      doc["error"] = "A firmware update is already running";
+    } else {
+      uint32_t jobId = SlaveFlasher::getInstance().rollback(target, eeprom);
+      if (jobId == 0) {
+        status = 404;
+        doc["success"] = false;
+        doc["error"] = "No backup for this board, flasher busy or oven running";
+      } else {
+        doc["success"] = true;
+        doc["jobId"] = jobId;
+        doc["events"] = "/api/twi/events";
+      }
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(status, "application/json", response);
+  });
+
+  // SSE: firmware job progress ("progress" events, JSON as /api/twi/job)
+  static AsyncEventSource flashEvents("/api/twi/events");
+  flashEvents.onConnect([](AsyncEventSourceClient *client) {
+    JsonDocument doc;
+    flashProgressToJson(SlaveFlasher::getInstance().getProgress(), doc);
+    String payload;
+    serializeJson(doc, payload);
+    client->send(payload.c_str(), "progress", millis());
+  });
+  server.addHandler(&flashEvents);
+  SlaveFlasher::getInstance().setListener([](const SlaveFlasher::Progress& progress, void* context) {
+    AsyncEventSource* events = static_cast<AsyncEventSource*>(context);
+    if (events->count() == 0) {
+      return;
+    }
+    JsonDocument doc;
+    flashProgressToJson(progress, doc);
+    String payload;
+    serializeJson(doc, payload);
+    events->send(payload.c_str(), "progress", millis());
+  }, &flashEvents);
+
+  // API: Board inventory and fleet update status
+  server.on("/api/slaves", HTTP_GET, [](AsyncWebServerRequest *request) {
+    SlaveFleet& fleet = SlaveFleet::getInstance();
+    SlaveFleet::Board boards[SLAVE_FLEET_MAX_BOARDS];
+    uint8_t count = fleet.getBoards(boards, SLAVE_FLEET_MAX_BOARDS);
+    uint32_t now = millis();
+
+    JsonDocument doc;
+    JsonArray list = doc["boards"].to<JsonArray>();
+    for (uint8_t i = 0; i < count; i++) {
+      const SlaveFleet::Board& board = boards[i];
+      JsonObject b = list.add<JsonObject>();
+      char address[5];
+      snprintf(address, sizeof(address), "0x%02X", board.address);
+      b["address"] = address;
+      b["primary"] = (board.address == SLAVE_I2C_ADDR);
+      b["state"] = SlaveFleet::stateName(board.state);
+      b["version"] = board.version.toString();
+      b["fwVersion"] = String(board.fwVersion >> 4, HEX) + "." + String(board.fwVersion & 0x0F, HEX);
+      b["protocol"] = board.protocolVersion;
+      b["errorCode"] = (board.status & STATUS_ERROR_MASK) >> STATUS_ERROR_SHIFT;
+      b["failures"] = board.failures;
+      b["updates"] = board.updates;
+      if (board.lastSeenMs != 0) {
+        b["lastSeenMs"] = now - board.lastSeenMs;  // Age of the last answer
+      }
+    }
+
+    SlaveFleet::UpdateStatus update = fleet.getUpdateStatus();
+    JsonObject u = doc["update"].to<JsonObject>();
+    u["running"] = update.running;
+    if (!update.path.isEmpty()) {
+      u["path"] = update.path;
+      u["imageVersion"] = String(update.imageVersion >> 4, HEX) + "." + String(update.imageVersion & 0x0F, HEX);
+      u["total"] = update.total;
+      u["done"] = update.done;
+      u["failed"] = update.failed;
+    }
+    if (update.current != 0) {
+      u["current"] = update.current;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
+  // API: Rescan the fleet now
+  server.on("/api/slaves/scan", HTTP_POST, [](AsyncWebServerRequest *request) {
+    SlaveFleet::getInstance().requestScan();
+    request->send(202, "application/json", "{\"success\":true}");
+  });
+
+  // API: Configure board addresses (list=0x30,0x31,...)
+  server.on("/api/slaves/addresses", HTTP_POST, [](AsyncWebServerRequest *request) {
+    if (!request->hasParam("list", true)) {
+      request->send(400, "application/json", "{\"error\":\"Missing list\"}");
+      return;
+    }
+    String list = request->getParam("list", true)->value();
+    uint8_t addresses[SLAVE_FLEET_MAX_BOARDS];
+    uint8_t count = 0;
+    bool parsed = true;
+    int start = 0;
+    while (parsed && start <= (int)list.length()) {
+      int comma = list.indexOf(',', start);
+      String item = list.substring(start, comma < 0 ? list.length() : comma);
+      item.trim();
+      if (!item.isEmpty()) {
+        long value = strtol(item.c_str(), nullptr, 0);  // Decimal or 0x.. hex
+        parsed = (count < SLAVE_FLEET_MAX_BOARDS && value > 0 && value < 0x80);
+        if (parsed) {
+          addresses[count++] = (uint8_t)value;
+        }
+      }
+      if (comma < 0) {
+        break;
+      }
+      start = comma + 1;
+    }
+
+    SlaveFleet& fleet = SlaveFleet::getInstance();
+    JsonDocument doc;
+    int status = 200;
+    if (!parsed || !fleet.setAddresses(addresses, count)) {
+      status = 400;
+      doc["success"] = false;
+      doc["error"] = parsed ? fleet.getLastError() : "Invalid address list";
+    } else {
+      doc["success"] = true;
+      doc["count"] = count;
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(status, "application/json", response);
+  });
+
+  // API: Flash every outdated board, one at a time (path=/firmware.msimg, force=1)
+  server.on("/api/slaves/update", HTTP_POST, [](AsyncWebServerRequest *request) {
+    String path = request->hasParam("path", true) ? request->getParam("path", true)->value()
+                                                  : String("/firmware.msimg");
+    bool force = request->hasParam("force", true) && request->getParam("force", true)->value() == "1";
+
+    SlaveFleet& fleet = SlaveFleet::getInstance();
+    JsonDocument doc;
+    int status = 202;
+    if (fleet.startUpdate(path, force)) {
+      doc["success"] = true;
+      doc["events"] = "/api/twi/events";  // Per-board progress
+    } else {
+      status = 409;
+      doc["success"] = false;
+      doc["error"] = fleet.getLastError();
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(status, "application/json", response);
+  });
+
+  // API: Stop a fleet update after the current board
+  server.on("/api/slaves/cancel", HTTP_POST, [](AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    doc["success"] = SlaveFleet::getInstance().cancelUpdate();
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
 
   // API: Scan I2C bus
   server.on("/api/i2c/scan", HTTP_GET, [](AsyncWebServerRequest *request) {
@@ -693,30 +993,32 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     doc["bus0"]["speed"] = "100 kHz";
     doc["bus0"]["pins"] = "GPIO8(SDA), GPIO9(SCL)";
     
-    for (uint8_t address = 0x03; address < 0x78; address++) {
-      if (I2CManager::getInstance().ping(address, I2C_BUS_DISPLAY)) {
-        JsonObject device = bus0Devices.add<JsonObject>();
-        
-        char hexAddr[5];
-        sprintf(hexAddr, "0x%02X", address);
-        device["address"] = hexAddr;
-        device["decimal"] = address;
-        device["bus"] = 0;
-        
-        // Add device name if known
-        String deviceName = "Unknown";
-        if (address == 0x3C || address == 0x3D) deviceName = "SSD1306 OLED Display";
-        else if (address == 0x27 || address == 0x3F) deviceName = "PCF8574 LCD 16x2";
-        else if (address == 0x36) deviceName = "Seesaw Rotary Encoder";
-        else if (address == 0x38) deviceName = "AHT10 Temperature & Humidity Sensor";
-        else if (address == 0x76 || address == 0x77) deviceName = "BMP280/BME280 Sensor";
-        else if (address == 0x68) deviceName = "MPU6050/DS3231 RTC";
-        else if (address == 0x48) deviceName = "ADS1110 ADC";
-        else if (address == 0x20) deviceName = "PCF8574 I/O Expander";
-        
-        device["name"] = deviceName;
-      }
-      yield();
+    uint8_t bus0Found[32];
+    uint8_t bus0Count = 0;
+    I2CManager::getInstance().scanBus(bus0Found, sizeof(bus0Found), bus0Count, I2C_BUS_DISPLAY);
+    for (uint8_t i = 0; i < bus0Count && i < sizeof(bus0Found); i++) {
+      uint8_t address = bus0Found[i];
+
+      JsonObject device = bus0Devices.add<JsonObject>();
+      
+      char hexAddr[5];
+      sprintf(hexAddr, "0x%02X", address);
+      device["address"] = hexAddr;
+      device["decimal"] = address;
+      device["bus"] = 0;
+      
+      // Add device name if known
+      String deviceName = "Unknown";
+      if (address == 0x3C || address == 0x3D) deviceName = "SSD1306 OLED Display";
+      else if (address == 0x27 || address == 0x3F) deviceName = "PCF8574 LCD 16x2";
+      else if (address == 0x36) deviceName = "Seesaw Rotary Encoder";
+      else if (address == 0x38) deviceName = "AHT10 Temperature & Humidity Sensor";
+      else if (address == 0x76 || address == 0x77) deviceName = "BMP280/BME280 Sensor";
+      else if (address == 0x68) deviceName = "MPU6050/DS3231 RTC";
+      else if (address == 0x48) deviceName = "ADS1110 ADC";
+      else if (address == 0x20) deviceName = "PCF8574 I/O Expander";
+      
+      device["name"] = deviceName;
     }
     doc["bus0"]["count"] = bus0Devices.size();
     
@@ -726,24 +1028,26 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     doc["bus1"]["speed"] = "100 kHz";
     doc["bus1"]["pins"] = "GPIO5(SDA), GPIO6(SCL)";
     
-    for (uint8_t address = 0x03; address < 0x78; address++) {
-      if (I2CManager::getInstance().ping(address, I2C_BUS_SLAVE)) {
-        JsonObject device = bus1Devices.add<JsonObject>();
-        
-        char hexAddr[5];
-        sprintf(hexAddr, "0x%02X", address);
-        device["address"] = hexAddr;
-        device["decimal"] = address;
-        device["bus"] = 1;
-        
-        // Add device name if known
-        String deviceName = "Unknown";
-        if (address == 0x30) deviceName = "MS11 Slave Controller (ATmega328P)";
-        else if (address == 0x14) deviceName = "Twiboot Bootloader (ATmega328P)";
-        
-        device["name"] = deviceName;
-      }
-      yield();
+    uint8_t bus1Found[32];
+    uint8_t bus1Count = 0;
+    I2CManager::getInstance().scanBus(bus1Found, sizeof(bus1Found), bus1Count, I2C_BUS_SLAVE);
+    for (uint8_t i = 0; i < bus1Count && i < sizeof(bus1Found); i++) {
+      uint8_t address = bus1Found[i];
+
+      JsonObject device = bus1Devices.add<JsonObject>();
+      
+      char hexAddr[5];
+      sprintf(hexAddr, "0x%02X", address);
+      device["address"] = hexAddr;
+      device["decimal"] = address;
+      device["bus"] = 1;
+      
+      // Add device name if known
+      String deviceName = "Unknown";
+      if (address == 0x30) deviceName = "MS11 Slave Controller (ATmega328P)";
+      else if (address == 0x14) deviceName = "Twiboot Bootloader (ATmega328P)";
+      
+      device["name"] = deviceName;
     }
     doc["bus1"]["count"] = bus1Devices.size();
     
@@ -777,24 +1081,24 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     }
     
     // Map action to LED control commands
-    uint8_t reg = SLAVE_REG_LED_ONOFF_WEB;
+    uint8_t reg = ms11::LedOnOff::address;
     uint8_t val = 0;
     String statusText = "";
     
     if (action == "on") {
-      reg = SLAVE_REG_LED_ONOFF_WEB;
+      reg = ms11::LedOnOff::address;
       val = 1;
       statusText = "LED on";
     } else if (action == "blink1") {
-      reg = SLAVE_REG_LED_BLINK_WEB;
+      reg = ms11::LedBlink::address;
       val = 1;
       statusText = "Blinking 1 Hz";
     } else if (action == "blink4") {
-      reg = SLAVE_REG_LED_BLINK_WEB;
+      reg = ms11::LedBlink::address;
       val = 2;
       statusText = "Blinking 4 Hz";
     } else if (action == "blink0") {
-      reg = SLAVE_REG_LED_BLINK_WEB;
+      reg = ms11::LedBlink::address;
       val = 0;
       statusText = "Blink stopped";
     } else {
@@ -802,13 +1106,14 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
       return;
     }
 
-    uint8_t cmdBuffer[2] = {reg, val};
-    
     Serial.printf("[API] LED command: action=%s, REG=0x%02X, VAL=0x%02X\n", 
                   action.c_str(), reg, val);
 
-    I2CManager& manager = I2CManager::getInstance();
-    if (manager.write(0x30, cmdBuffer, 2)) {
+    // Through SlaveController so the write is framed when protocol v3 is active
+    SlaveController& slave = SlaveController::getInstance();
+    bool writeOk = (reg == ms11::LedOnOff::address) ? slave.writeReg<ms11::LedOnOff>(val)
+                                                    : slave.writeReg<ms11::LedBlink>(val);
+    if (writeOk) {
       JsonDocument doc;
       doc["success"] = true;
       doc["action"] = action;
@@ -820,7 +1125,7 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     } else {
       JsonDocument doc;
       doc["success"] = false;
-      doc["error"] = "I2C write failed: " + manager.getLastError();
+      doc["error"] = "I2C write failed: " + slave.getLastError();
       String response;
       serializeJson(doc, response);
       request->send(500, "application/json", response);
@@ -853,7 +1158,7 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     // Step 2: Send bootloader command via I2CManager (with mutex)
     // Protocol: write register 0x99 followed by magic byte 0xB0
     Serial.println("[API-BOOT] Sending {0x99, 0xB0} via I2CManager to 0x30...");
-    bool writeOk = manager.writeRegister(0x30, 0x99, 0xB0);
+    bool writeOk = manager.writeRegister(SLAVE_I2C_ADDR, ms11::EnterBootloader::address, ms11::BOOTLOADER_MAGIC);
     
     Serial.printf("[API-BOOT] writeRegister result = %s\n", writeOk ? "OK" : "FAIL");
     
@@ -890,17 +1195,17 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     }
 
     JsonDocument doc;
+    I2CManager& manager = I2CManager::getInstance();
     
     Serial.println("\n========================================");
     Serial.println("[DIAG] BOOTLOADER RAPID DIAGNOSTIC");
     Serial.println("========================================");
     
     // Step 1: Pre-check
-    Wire1.beginTransmission(0x30);
-    uint8_t pre30 = Wire1.endTransmission();
-    doc["pre_0x30"] = pre30 == 0;
+    bool pre30 = manager.ping(0x30, I2C_BUS_SLAVE);
+    doc["pre_0x30"] = pre30;
     
-    if (pre30 != 0) {
+    if (!pre30) {
       doc["success"] = false;
       doc["error"] = "Arduino not at 0x30";
       String response;
@@ -910,12 +1215,8 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     }
     
     // Step 2: Read firmware version
-    Wire1.beginTransmission(0x30);
-    Wire1.write(0x0C);
-    Wire1.endTransmission(false);
-    uint8_t vBytes = Wire1.requestFrom(0x30, 4);
     uint8_t vBuf[4] = {0};
-    for (int i = 0; i < 4 && Wire1.available(); i++) vBuf[i] = Wire1.read();
+    uint8_t vBytes = manager.readRegisterMulti(0x30, 0x0C, vBuf, 4, 100, 0) ? 4 : 0;
     uint16_t fwMajor = vBuf[0] | (vBuf[1] << 8);
     char vStr[32];
     snprintf(vStr, sizeof(vStr), "%d.%d.%d.%02d", fwMajor, vBuf[2], vBuf[3]>>4, vBuf[3]&0x0F);
@@ -924,14 +1225,11 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     
     // Step 3: Send bootloader command
     Serial.println("[DIAG] Sending {0x99, 0xB0}...");
-    Wire1.beginTransmission(0x30);
-    Wire1.write(0x99);
-    Wire1.write(0xB0);
-    uint8_t wr = Wire1.endTransmission();
-    doc["writeResult"] = wr;
-    Serial.printf("[DIAG] Write: %d (%s)\n", wr, wr==0?"ACK":"FAIL");
-    
-    if (wr != 0) {
+    bool wr = manager.writeRegister(SLAVE_I2C_ADDR, ms11::EnterBootloader::address, ms11::BOOTLOADER_MAGIC, 100, 0);
+    doc["writeResult"] = wr ? 0 : (int)manager.getLastErrorCode();
+    Serial.printf("[DIAG] Write: %s\n", wr ? "ACK" : "FAIL");
+    
+    if (!wr) {
       doc["success"] = false;
       doc["error"] = "Write failed";
       String response;
@@ -952,13 +1250,8 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
       delay(10);
       int t = (i + 1) * 10;
       
-      Wire1.beginTransmission(0x30);
-      uint8_t r30 = Wire1.endTransmission();
-      Wire1.beginTransmission(0x14);
-      uint8_t r14 = Wire1.endTransmission();
-      
-      bool has30 = (r30 == 0);
-      bool has14 = (r14 == 0);
+      bool has30 = manager.ping(0x30, I2C_BUS_SLAVE);
+      bool has14 = manager.ping(0x14, I2C_BUS_SLAVE);
       
       if (!has30 && gapStart == -1) gapStart = t;
       if (has30 && gapStart != -1 && gapEnd == -1) gapEnd = t;
@@ -973,29 +1266,24 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     
     // Step 5: Check at T+2s
     delay(1500);
-    Wire1.beginTransmission(0x30);
-    uint8_t late30 = Wire1.endTransmission();
-    Wire1.beginTransmission(0x14);
-    uint8_t late14 = Wire1.endTransmission();
-    bool lateBoot = (late14 == 0);
+    bool late30 = manager.ping(0x30, I2C_BUS_SLAVE);
+    bool lateBoot = manager.ping(0x14, I2C_BUS_SLAVE);
     Serial.printf("[DIAG] T+2s: 0x30=%s  0x14=%s\n",
-                  late30==0?"YES":" - ", late14==0?"YES":" - ");
+                  late30?"YES":" - ", lateBoot?"YES":" - ");
     if (lateBoot) { found14 = true; found14At = 2000; }
     
     // Step 6: Twiboot has a 5s _delay_ms() after EEPROM match - check at T+6s
     if (!found14) {
       delay(4000);
-      Wire1.beginTransmission(0x30);
-      uint8_t vl30 = Wire1.endTransmission();
-      Wire1.beginTransmission(0x14);
-      uint8_t vl14 = Wire1.endTransmission();
+      bool vl30 = manager.ping(0x30, I2C_BUS_SLAVE);
+      bool vl14 = manager.ping(0x14, I2C_BUS_SLAVE);
       Serial.printf("[DIAG] T+6s: 0x30=%s  0x14=%s\n",
-                    vl30==0?"YES":" - ", vl14==0?"YES":" - ");
-      doc["post6s_0x30"] = vl30 == 0;
-      doc["post6s_0x14"] = vl14 == 0;
-      if (vl14 == 0) { found14 = true; found14At = 6000; }
+                    vl30?"YES":" - ", vl14?"YES":" - ");
+      doc["post6s_0x30"] = vl30;
+      doc["post6s_0x14"] = vl14;
+      if (vl14) { found14 = true; found14At = 6000; }
       // If 0x30 came back, twiboot timed out or isn't present
-      if (vl30 == 0 && vl14 != 0) {
+      if (vl30 && !vl14) {
         doc["note"] = "App restarted at 0x30 - twiboot may have timed out or boot magic not written";
       }
     }
@@ -1007,7 +1295,7 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     doc["gap_end_ms"] = gapEnd;
     doc["bootloader_found"] = found14;
     doc["bootloader_found_at_ms"] = found14At;
-    doc["post2s_0x30"] = late30 == 0;
+    doc["post2s_0x30"] = late30;
     doc["post2s_0x14"] = lateBoot;
     
     if (found14) {
@@ -1168,13 +1456,572 @@ static void registerI2CApiRoutes(AsyncWebServer& server) {
     // Metrics
     doc["scanDuration"] = scanDuration;
     doc["responseTime"] = responseTime;
-    doc["busSpeed"] = 100;
+    doc["busSpeed"] = I2CManager::getInstance().getBusHealth(bus).clockHz / 1000;
     doc["errors"] = errorCount;
     
     String response;
     serializeJson(doc, response);
     request->send(200, "application/json", response);
   });
+
+  // API: Per-bus/per-address I2C counters and latency histograms
+  // GET /api/metrics/i2c[?reset=1]
+  server.on("/api/metrics/i2c", HTTP_GET, [](AsyncWebServerRequest *request) {
+    I2CMetrics& metrics = I2CMetrics::getInstance();
+    JsonDocument doc;
+    doc["uptimeMs"] = millis();
+
+    const I2CBus busIds[] = {I2C_BUS_SLAVE, I2C_BUS_DISPLAY};
+    for (I2CBus bus : busIds) {
+      const I2CBusMetrics& m = metrics.getBus(bus);
+      JsonObject b = doc[bus == I2C_BUS_SLAVE ? "slave" : "display"].to<JsonObject>();
+
+      addHistogramJson(b["writeLatencyUs"].to<JsonObject>(), m.writeLatency);
+      addHistogramJson(b["readLatencyUs"].to<JsonObject>(), m.readLatency);
+      addHistogramJson(b["lockWaitUs"].to<JsonObject>(), m.lockWait);
+      b["lockTimeouts"] = m.lockTimeouts.load();
+      b["untracked"] = m.untracked.load();
+
+      I2CManager::BusHealth health = I2CManager::getInstance().getBusHealth(bus);
+      b["clockHz"] = health.clockHz;
+      b["maxClockHz"] = health.maxClockHz;
+      b["recoveries"] = health.recoveries;
+      b["faults"] = health.faults;
+      b["clockChanges"] = health.clockChanges;
+      b["lastRecoveryMs"] = health.lastRecoveryMs;
+
+      I2CManager::QueueStats q = I2CManager::getInstance().getQueueStats(bus);
+      JsonObject queue = b["queue"].to<JsonObject>();
+      queue["submitted"] = q.submitted;
+      queue["completed"] = q.completed;
+      queue["failed"] = q.failed;
+      queue["dropped"] = q.dropped;
+      queue["rejected"] = q.rejected;
+
+      JsonArray devices = b["devices"].to<JsonArray>();
+      for (uint8_t i = 0; i < I2C_METRICS_ADDR_SLOTS; i++) {
+        const I2CAddressMetrics& a = m.addresses[i];
+        uint8_t address = a.address.load();
+        if (address == 0) {
+          continue;
+        }
+        char addrStr[5];
+        snprintf(addrStr, sizeof(addrStr), "0x%02X", address);
+
+        JsonObject d = devices.add<JsonObject>();
+        d["address"] = addrStr;
+        d["transactions"] = a.transactions.load();
+        d["bytes"] = a.bytes.load();
+        d["nacks"] = a.nacks.load();
+        d["timeouts"] = a.timeouts.load();
+        d["errors"] = a.errors.load();
+        d["retries"] = a.retries.load();
+      }
+    }
+
+    // MS11 protocol framing (v3 CRC-8 / sequence errors)
+    SlaveController& slave = SlaveController::getInstance();
+    SlaveController::FrameStats frames = slave.getFrameStats();
+    JsonObject protocol = doc["slave"]["protocol"].to<JsonObject>();
+    protocol["version"] = slave.getProtocolVersion();
+    protocol["framed"] = slave.isFramed();
+    protocol["crcErrors"] = frames.crcErrors;
+    protocol["sequenceErrors"] = frames.sequenceErrors;
+    protocol["retries"] = frames.retries;
+    protocol["renegotiations"] = frames.renegotiations;
+
+    // Shadowed control outputs (rejected: bit 0 fan, 1 igniter, 2 auger)
+    SlaveController::OutputStats out = slave.getOutputStats();
+    JsonObject outputs = doc["slave"]["outputs"].to<JsonObject>();
+    outputs["flushes"] = out.flushes;
+    outputs["suppressed"] = out.suppressed;
+    outputs["mismatches"] = out.mismatches;
+    outputs["rejections"] = out.rejections;
+    outputs["rejected"] = slave.getRejectedOutputs();
+
+    // Attention-line events (interrupt-driven slave servicing)
+    SlaveEventMonitor& monitor = SlaveEventMonitor::getInstance();
+    SlaveEventMonitor::Stats ev = monitor.getStats();
+    JsonObject events = doc["slave"]["events"].to<JsonObject>();
+    events["active"] = monitor.isActive();
+    events["events"] = ev.events;
+    events["faults"] = ev.faults;
+    events["resets"] = ev.resets;
+    events["spurious"] = ev.spurious;
+    events["readErrors"] = ev.readErrors;
+    events["resyncs"] = ev.resyncs;
+    events["lastLatencyUs"] = ev.lastLatencyUs;
+    events["maxLatencyUs"] = ev.maxLatencyUs;
+
+    if (request->hasParam("reset")) {
+      metrics.reset();
+      doc["reset"] = true;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+}
+
+// ============================================================================
+// PROBE API ROUTES - Temperature probes and ADS1110 sampler
+// ============================================================================
+
+static void registerProbeApiRoutes(AsyncWebServer& server) {
+  // API: One tier of a probe's history, streamed straight from its ring
+  // GET /api/probes/history?probe=0&tier=raw|10s|1m[&since=SEQ][&format=json|bin]
+  // Registered before /api/probes, which would otherwise match this path too
+  server.on("/api/probes/history", HTTP_GET, [](AsyncWebServerRequest *request) {
+    uint8_t index = request->hasParam("probe") ? request->getParam("probe")->value().toInt() : 0;
+    const ProbeHistory* history = ProbeManager::getInstance().getHistory(index);
+    if (!history) {
+      request->send(404, "application/json", "{\"error\":\"Unknown probe\"}");
+      return;
+    }
+
+    ProbeHistoryTier tier = HISTORY_TIER_RAW;
+    if (request->hasParam("tier") && !ProbeHistory::parseTier(request->getParam("tier")->value(), tier)) {
+      request->send(400, "application/json", "{\"error\":\"tier must be raw, 10s or 1m\"}");
+      return;
+    }
+    uint32_t since = request->hasParam("since")
+                   ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+    bool binary = request->hasParam("format") && request->getParam("format")->value() == "bin";
+
+    auto stream = std::make_shared<ProbeHistoryStream>(*history, index, tier, since, binary);
+    AwsResponseFiller filler = [stream](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+      return stream->fill(buffer, maxLen);
+    };
+    AsyncWebServerResponse* response = binary
+      ? request->beginResponse("application/octet-stream", stream->binaryLength(), filler)
+      : request->beginChunkedResponse("application/json", filler);
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+  });
+
+  // API: Probe readings plus ADS1110 sampler counters
+  // GET /api/probes
+  server.on("/api/probes", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ProbeManager& probes = ProbeManager::getInstance();
+    JsonDocument doc;
+    doc["initialized"] = probes.isInitialized();
+
+    JsonArray list = doc["probes"].to<JsonArray>();
+    for (uint8_t i = 0; i < probes.getProbeCount(); i++) {
+      ProbeData* probe = probes.getProbe(i);
+      char addrStr[5];
+      snprintf(addrStr, sizeof(addrStr), "0x%02X", probe->i2c_address);
+
+      JsonObject p = list.add<JsonObject>();
+      p["index"] = i;
+      p["name"] = probe->name;
+      p["type"] = (int)probe->type;
+      p["address"] = addrStr;
+      p["temperature"] = probe->temperature;
+      p["raw"] = probe->raw_temperature;
+      p["healthy"] = probe->healthy;
+      p["lastReadMs"] = probe->last_read_ms;
+
+      ProbeFilterConfig filter;
+      probes.getProbeFilter(i, filter);
+      JsonObject f = p["filter"].to<JsonObject>();
+      f["median"] = filter.median;
+      f["alpha"] = ProbeFilterConfig::alphaToFloat(filter.alpha);
+      f["maxRate"] = filter.maxRate / 100.0f;
+    }
+
+    ProbeManager::AdcStats stats[PROBE_ADS1110_MAX];
+    uint8_t count = probes.getAdcStats(stats, PROBE_ADS1110_MAX);
+    JsonArray adc = doc["adc"].to<JsonArray>();
+    for (uint8_t i = 0; i < count; i++) {
+      char addrStr[5];
+      snprintf(addrStr, sizeof(addrStr), "0x%02X", stats[i].address);
+
+      JsonObject a = adc.add<JsonObject>();
+      a["address"] = addrStr;
+      a["code"] = stats[i].code;
+      a["samples"] = stats[i].samples;
+      a["notReady"] = stats[i].notReady;
+      a["errors"] = stats[i].errors;
+      a["reconfigured"] = stats[i].reconfigured;
+      a["lastSampleMs"] = stats[i].lastSampleMs;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
+  // API: Change a probe's filter chain and persist it with the calibration
+  // POST /api/probes/filter (probe=0[, median=0|1][, alpha=0.3][, max_rate=5.0])
+  server.on("/api/probes/filter", HTTP_POST, [](AsyncWebServerRequest *request) {
+    ProbeManager& probes = ProbeManager::getInstance();
+    uint8_t index = request->hasParam("probe", true) ? request->getParam("probe", true)->value().toInt() : 0;
+
+    JsonDocument doc;
+    int status = 200;
+    ProbeFilterConfig filter;
+    if (!probes.getProbeFilter(index, filter)) {
+      status = 404;
+      doc["success"] = false;
+      doc["error"] = probes.getLastError();
+    } else {
+      if (request->hasParam("median", true)) {
+        filter.median = request->getParam("median", true)->value() == "1";
+      }
+      if (request->hasParam("alpha", true)) {
+        filter.alpha = ProbeFilterConfig::alphaFromFloat(request->getParam("alpha", true)->value().toFloat());
+      }
+      if (request->hasParam("max_rate", true)) {
+        float rate = request->getParam("max_rate", true)->value().toFloat();
+        filter.maxRate = (uint16_t)constrain(rate * 100.0f, 0.0f, 65535.0f);
+      }
+      probes.setProbeFilter(index, filter);
+      probes.saveCalibrationToNVS();
+      probes.saveCalibrationToLittleFS();
+
+      doc["success"] = true;
+      doc["median"] = filter.median;
+      doc["alpha"] = ProbeFilterConfig::alphaToFloat(filter.alpha);
+      doc["maxRate"] = filter.maxRate / 100.0f;
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(status, "application/json", response);
+  });
+}
+
+// ============================================================================
+// OVEN API ROUTES - Closed-loop oven temperature control
+// ============================================================================
+
+static void registerOvenApiRoutes(AsyncWebServer& server) {
+  // API: Controller state, PID terms and loop timing
+  // GET /api/oven
+  server.on("/api/oven", HTTP_GET, [](AsyncWebServerRequest *request) {
+    OvenController& oven = OvenController::getInstance();
+    OvenController::Status status = oven.getStatus();
+    OvenControlConfig config = oven.getConfig();
+
+    JsonDocument doc;
+    doc["mode"] = OvenController::modeName(status.mode);
+    doc["target"] = status.target;
+    doc["setpoint"] = status.setpoint;
+    doc["temperature"] = status.temperature;
+    doc["demand"] = status.demand;
+    doc["auger"] = status.augerOn;
+    doc["fanPercent"] = status.fanPercent;
+    doc["readFailures"] = status.readFailures;
+    doc["error"] = status.error;
+
+    JsonObject terms = doc["terms"].to<JsonObject>();
+    terms["p"] = status.terms.p;
+    terms["i"] = status.terms.i;
+    terms["d"] = status.terms.d;
+    terms["ff"] = status.terms.ff;
+    terms["limited"] = status.terms.limited;
+
+    JsonObject gains = doc["gains"].to<JsonObject>();
+    gains["kp"] = config.gains.kp;
+    gains["ki"] = config.gains.ki;
+    gains["kd"] = config.gains.kd;
+    gains["kff"] = config.ffPerDegree;
+    doc["ramp"] = config.rampPerMinute;
+
+    JsonObject timing = doc["timing"].to<JsonObject>();
+    timing["periodMs"] = OVEN_CTRL_PERIOD_MS;
+    timing["ticks"] = status.timing.ticks;
+    timing["lastJitterUs"] = status.timing.lastJitterUs;
+    timing["maxJitterUs"] = status.timing.maxJitterUs;
+    timing["meanJitterUs"] = status.timing.meanJitterUs;
+    timing["overruns"] = status.timing.overruns;
+    timing["lastTickUs"] = status.timing.lastTickUs;
+
+    JsonObject tune = doc["autotune"].to<JsonObject>();
+    tune["state"] = RelayAutotuner::stateName(status.tuneState);
+    tune["rule"] = RelayAutotuner::ruleName(status.tuneRule);
+    tune["cycles"] = status.tuneCycles;
+    tune["ku"] = status.tuneResult.ku;
+    tune["pu"] = status.tuneResult.pu;
+    tune["amplitude"] = status.tuneResult.amplitude;
+    tune["bias"] = status.tuneResult.bias;
+
+    JsonObject program = doc["program"].to<JsonObject>();
+    program["active"] = status.programActive;
+    program["name"] = status.programName;
+    program["stage"] = status.programStage;
+    program["stages"] = status.programStages;
+    program["stageName"] = status.stageName;
+    program["stageElapsedS"] = status.stageElapsedS;
+    program["lastTrigger"] = status.lastTrigger;
+    if (status.fanOverride == COOK_FAN_AUTO) {
+      program["fan"] = nullptr;
+    } else {
+      program["fan"] = status.fanOverride;
+    }
+    program["notifySeq"] = status.notifySeq;
+    program["notifyText"] = status.notifyText;
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
+  // API: Start/stop the loop or change the target
+  // POST /api/oven/control (action=start|stop|target[, target=110][, ramp=5])
+  server.on("/api/oven/control", HTTP_POST, [](AsyncWebServerRequest *request) {
+    OvenController& oven = OvenController::getInstance();
+    String action = request->hasParam("action", true) ? request->getParam("action", true)->value() : "";
+    float target = request->hasParam("target", true) ? request->getParam("target", true)->value().toFloat()
+                                                     : oven.getStatus().target;
+    if (request->hasParam("ramp", true)) {
+      oven.setRampRate(request->getParam("ramp", true)->value().toFloat());
+    }
+
+    bool ok = true;
+    if (action == "start") {
+      ok = oven.start(target);
+    } else if (action == "stop") {
+      oven.stop();
+    } else if (action == "target") {
+      ok = oven.setTarget(target);
+    } else {
+      request->send(400, "application/json", "{\"error\":\"action must be start, stop or target\"}");
+      return;
+    }
+
+    JsonDocument doc;
+    doc["success"] = ok;
+    doc["mode"] = OvenController::modeName(oven.getStatus().mode);
+    if (!ok) {
+      doc["error"] = "Target out of range, autotune or slave update running";
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(ok ? 200 : 400, "application/json", response);
+  });
+
+  // API: Relay autotune; runs in the control task, poll GET /api/oven for progress
+  // POST /api/oven/autotune (action=start|cancel[, target=110][, rule=tl|zn])
+  server.on("/api/oven/autotune", HTTP_POST, [](AsyncWebServerRequest *request) {
+    OvenController& oven = OvenController::getInstance();
+    String action = request->hasParam("action", true) ? request->getParam("action", true)->value() : "";
+
+    bool ok = true;
+    if (action == "start") {
+      float target = request->hasParam("target", true) ? request->getParam("target", true)->value().toFloat()
+                                                       : oven.getStatus().target;
+      AutotuneRule rule = request->hasParam("rule", true) && request->getParam("rule", true)->value() == "zn"
+                        ? TUNE_ZIEGLER_NICHOLS : TUNE_TYREUS_LUYBEN;
+      ok = oven.startAutotune(target, rule);
+    } else if (action == "cancel") {
+      oven.cancelAutotune();
+    } else {
+      request->send(400, "application/json", "{\"error\":\"action must be start or cancel\"}");
+      return;
+    }
+
+    JsonDocument doc;
+    doc["success"] = ok;
+    doc["mode"] = OvenController::modeName(oven.getStatus().mode);
+    if (!ok) {
+      doc["error"] = "Target out of range, program or slave update running";
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(ok ? 200 : 400, "application/json", response);
+  });
+
+  // API: Change gains/feed-forward; save=1 keeps them across reboots
+  // POST /api/oven/gains ([kp=5][, ki=0.01][, kd=100][, kff=0.2][, save=1])
+  server.on("/api/oven/gains", HTTP_POST, [](AsyncWebServerRequest *request) {
+    OvenController& oven = OvenController::getInstance();
+    OvenControlConfig config = oven.getConfig();
+    PidGains gains = config.gains;
+    float ffPerDegree = config.ffPerDegree;
+
+    if (request->hasParam("kp", true)) {
+      gains.kp = request->getParam("kp", true)->value().toFloat();
+    }
+    if (request->hasParam("ki", true)) {
+      gains.ki = request->getParam("ki", true)->value().toFloat();
+    }
+    if (request->hasParam("kd", true)) {
+      gains.kd = request->getParam("kd", true)->value().toFloat();
+    }
+    if (request->hasParam("kff", true)) {
+      ffPerDegree = request->getParam("kff", true)->value().toFloat();
+    }
+    if (gains.kp < 0.0f || gains.ki < 0.0f || gains.kd < 0.0f || ffPerDegree < 0.0f) {
+      request->send(400, "application/json", "{\"error\":\"Gains must not be negative\"}");
+      return;
+    }
+    bool save = request->hasParam("save", true) && request->getParam("save", true)->value() == "1";
+    oven.setGains(gains, ffPerDegree, save);
+
+    JsonDocument doc;
+    doc["success"] = true;
+    doc["kp"] = gains.kp;
+    doc["ki"] = gains.ki;
+    doc["kd"] = gains.kd;
+    doc["kff"] = ffPerDegree;
+    doc["saved"] = save;
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+}
+
+// ============================================================================
+// COOK PROGRAM API ROUTES - Stored profiles and the running program
+// ============================================================================
+
+static void registerCookApiRoutes(AsyncWebServer& server) {
+  // API: Stored profiles
+  // GET /api/cook/profiles
+  server.on("/api/cook/profiles", HTTP_GET, [](AsyncWebServerRequest *request) {
+    CookProfileStore::Entry entries[COOK_PROFILE_MAX_FILES];
+    uint8_t count = CookProfileStore::getInstance().list(entries, COOK_PROFILE_MAX_FILES);
+
+    JsonDocument doc;
+    JsonArray list = doc["profiles"].to<JsonArray>();
+    for (uint8_t i = 0; i < count; i++) {
+      JsonObject p = list.add<JsonObject>();
+      p["name"] = entries[i].name;
+      p["stages"] = entries[i].stageCount;
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
+  // API: One profile as JSON (format in cook_profile_store.h)
+  // GET /api/cook/profile?name=Brisket
+  server.on("/api/cook/profile", HTTP_GET, [](AsyncWebServerRequest *request) {
+    CookProfileStore& store = CookProfileStore::getInstance();
+    String name = request->hasParam("name") ? request->getParam("name")->value() : "";
+    std::unique_ptr<CookProfile> profile(new (std::nothrow) CookProfile());
+    if (!profile || !store.load(name.c_str(), *profile)) {
+      JsonDocument doc;
+      doc["error"] = profile ? store.getLastError() : "Out of memory";
+      String response;
+      serializeJson(doc, response);
+      request->send(404, "application/json", response);
+      return;
+    }
+
+    JsonDocument doc;
+    CookProfileStore::toJson(*profile, doc.to<JsonObject>());
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+  });
+
+  // API: Create or replace a profile (JSON body)
+  // POST /api/cook/profile
+  server.on("/api/cook/profile", HTTP_POST,
+    [](AsyncWebServerRequest *request) {},
+    nullptr,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      static String body;
+      if (index == 0) {
+        body = "";
+        if (total <= COOK_PROFILE_JSON_MAX) {
+          body.reserve(total);
+        }
+      }
+      if (total <= COOK_PROFILE_JSON_MAX) {
+        body.concat((const char*)data, len);
+      }
+      if (index + len != total) {
+        return;
+      }
+
+      JsonDocument doc;
+      int status = 200;
+      String error;
+      std::unique_ptr<CookProfile> profile(new (std::nothrow) CookProfile());
+      JsonDocument input;
+      if (total > COOK_PROFILE_JSON_MAX) {
+        status = 413;
+        error = "Profile too large";
+      } else if (!profile) {
+        status = 500;
+        error = "Out of memory";
+      } else if (deserializeJson(input, body)) {
+        status = 400;
+        error = "Invalid JSON";
+      } else if (!CookProfileStore::fromJson(input.as<JsonObject>(), *profile, error)) {
+        status = 400;
+      } else if (!CookProfileStore::getInstance().save(*profile)) {
+        status = 500;
+        error = CookProfileStore::getInstance().getLastError();
+      }
+      body = "";
+
+      doc["success"] = status == 200;
+      if (status != 200) {
+        doc["error"] = error;
+      }
+      String response;
+      serializeJson(doc, response);
+      request->send(status, "application/json", response);
+    });
+
+  // API: Delete a profile
+  // DELETE /api/cook/profile?name=Brisket
+  server.on("/api/cook/profile", HTTP_DELETE, [](AsyncWebServerRequest *request) {
+    String name = request->hasParam("name") ? request->getParam("name")->value() : "";
+    bool ok = CookProfileStore::getInstance().remove(name.c_str());
+
+    JsonDocument doc;
+    doc["success"] = ok;
+    if (!ok) {
+      doc["error"] = CookProfileStore::getInstance().getLastError();
+    }
+    String response;
+    serializeJson(doc, response);
+    request->send(ok ? 200 : 404, "application/json", response);
+  });
+
+  // API: Run a stored profile, skip a stage or end the program; progress
+  // is in GET /api/oven ("program")
+  // POST /api/cook/run (action=start&name=Brisket | action=next | action=stop)
+  server.on("/api/cook/run", HTTP_POST, [](AsyncWebServerRequest *request) {
+    OvenController& oven = OvenController::getInstance();
+    String action = request->hasParam("action", true) ? request->getParam("action", true)->value() : "";
+
+    JsonDocument doc;
+    int status = 200;
+    if (action == "start") {
+      String name = request->hasParam("name", true) ? request->getParam("name", true)->value() : "";
+      std::unique_ptr<CookProfile> profile(new (std::nothrow) CookProfile());
+      if (!profile || !CookProfileStore::getInstance().load(name.c_str(), *profile)) {
+        status = 404;
+        doc["error"] = profile ? CookProfileStore::getInstance().getLastError() : "Out of memory";
+      } else if (!oven.startProgram(*profile)) {
+        status = 409;
+        doc["error"] = "Autotune or slave update running";
+      }
+    } else if (action == "next") {
+      if (!oven.advanceProgram()) {
+        status = 409;
+        doc["error"] = "No program running";
+      }
+    } else if (action == "stop") {
+      oven.stopProgram();
+    } else {
+      request->send(400, "application/json", "{\"error\":\"action must be start, next or stop\"}");
+      return;
+    }
+
+    doc["success"] = status == 200;
+    doc["mode"] = OvenController::modeName(oven.getStatus().mode);
+    String response;
+    serializeJson(doc, response);
+    request->send(status, "application/json", response);
+  });
 }
 
 // ============================================================================
@@ -1350,6 +2197,26 @@ static void registerFileApiRoutes(AsyncWebServer& server) {
       if (uploadFile) {
         uploadFile.close();
       }
+      
+      // MS11-control firmware is kept as a decoded image: convert once here,
+      // stamped with the fw_version query/form field (BCD) when given
+      if (filename.endsWith(".hex")) {
+        String hexPath = "/" + filename;
+        String imagePath = hexPath.substring(0, hexPath.length() - 4) + MSIMG_EXTENSION;
+        const AsyncWebParameter* versionParam = request->hasParam("fw_version", true)
+                                                    ? request->getParam("fw_version", true)
+                                                    : request->getParam("fw_version");
+        uint8_t fwVersion = 0;
+        String error;
+        if (versionParam && !parseFirmwareVersion(versionParam->value(), fwVersion)) {
+          Serial.println("[MS11Image] ERROR: fw_version '" + versionParam->value() + "' is not BCD, keeping " +
+                         hexPath);
+        } else if (convertHexToImage(hexPath, imagePath, error, fwVersion)) {
+          LittleFS.remove(hexPath);
+        } else {
+          Serial.println("[MS11Image] ERROR: " + error + ", keeping " + hexPath);
+        }
+      }
     }
   });
 }
@@ -0,0 +1,234 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// ============================================================================
+// HOST ARDUINO SHIM (native test env only)
+// ============================================================================
+// Just enough of the Arduino core for the portable modules and the I2C
+// manager stack to build and run on the host: time, String, Serial and a
+// few helpers. Header-only so every test suite picks it up via -I.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HEX 16
+#define DEC 10
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ============================================================================
+// Time
+// ============================================================================
+
+inline const std::chrono::steady_clock::time_point& hostStartTime() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return start;
+}
+
+inline unsigned long millis() {
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - hostStartTime()).count();
+}
+
+inline unsigned long micros() {
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - hostStartTime()).count();
+}
+
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() { std::this_thread::yield(); }
+
+// No GPIO on the host: lines read high (idle bus)
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+
+#if defined(__GLIBC__)
+#define HOST_HAS_STRLCPY __GLIBC_PREREQ(2, 38)
+#else
+#define HOST_HAS_STRLCPY 1   // BSD libc (macOS)
+#endif
+#if !HOST_HAS_STRLCPY
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+#endif
+
+// ============================================================================
+// String
+// ============================================================================
+
+class String {
+public:
+  String() {}
+  String(const char* text) : value(text ? text : "") {}
+  String(const std::string& text) : value(text) {}
+  explicit String(char c) : value(1, c) {}
+  String(int number, unsigned char base = DEC) { format(base == HEX ? "%x" : "%d", number); }
+  String(unsigned int number, unsigned char base = DEC) { format(base == HEX ? "%x" : "%u", number); }
+  String(long number, unsigned char base = DEC) { format(base == HEX ? "%lx" : "%ld", number); }
+  String(unsigned long number, unsigned char base = DEC) { format(base == HEX ? "%lx" : "%lu", number); }
+  String(float number, unsigned int decimals = 2) { format("%.*f", (int)decimals, number); }
+  String(double number, unsigned int decimals = 2) { format("%.*f", (int)decimals, number); }
+
+  const char* c_str() const { return value.c_str(); }
+  unsigned int length() const { return (unsigned int)value.size(); }
+  bool isEmpty() const { return value.empty(); }
+  void reserve(unsigned int size) { value.reserve(size); }
+
+  char charAt(unsigned int index) const { return index < value.size() ? value[index] : '\0'; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  String& operator+=(const String& other) { value += other.value; return *this; }
+  String& operator+=(const char* other) { value += other ? other : ""; return *this; }
+  String& operator+=(char other) { value += other; return *this; }
+  bool concat(const String& other) { value += other.value; return true; }
+  bool concat(const char* other) { value += other ? other : ""; return true; }
+  bool concat(char other) { value += other; return true; }
+
+  friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+  friend String operator+(const String& a, const char* b) { return String(a.value + (b ? b : "")); }
+  friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.value); }
+
+  bool operator==(const String& other) const { return value == other.value; }
+  bool operator==(const char* other) const { return value == (other ? other : ""); }
+  bool operator!=(const String& other) const { return !(*this == other); }
+  bool operator!=(const char* other) const { return !(*this == other); }
+  bool operator<(const String& other) const { return value < other.value; }
+
+  bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+  bool endsWith(const String& suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t pos = value.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  int indexOf(const String& text, unsigned int from = 0) const {
+    size_t pos = value.find(text.value, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    return from < value.size() ? String(value.substr(from, to - from)) : String();
+  }
+
+  void trim() {
+    size_t first = value.find_first_not_of(" \t\r\n");
+    size_t last = value.find_last_not_of(" \t\r\n");
+    value = (first == std::string::npos) ? std::string() : value.substr(first, last - first + 1);
+  }
+  void toLowerCase() { for (char& c : value) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (char& c : value) c = (char)toupper((unsigned char)c); }
+  long toInt() const { return strtol(value.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(value.c_str(), nullptr); }
+
+private:
+  std::string value;
+
+  template <typename T>
+  void format(const char* fmt, T number) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), fmt, number);
+    value = buffer;
+  }
+  void format(const char* fmt, int decimals, double number) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), fmt, decimals, number);
+    value = buffer;
+  }
+};
+
+// ============================================================================
+// Streams
+// ============================================================================
+
+class Stream {
+public:
+  virtual ~Stream() {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (written < length && write(data[written])) {
+      written++;
+    }
+    return written;
+  }
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    int value;
+    while (count < length && (value = read()) >= 0) {
+      buffer[count++] = (uint8_t)value;
+    }
+    return count;
+  }
+};
+
+// ============================================================================
+// Serial (stdout)
+// ============================================================================
+
+class HostSerial {
+public:
+  void begin(unsigned long) {}
+  void flush() { fflush(stdout); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list args;
+    va_start(args, fmt);
+    int written = vprintf(fmt, args);
+    va_end(args);
+    return written > 0 ? (size_t)written : 0;
+  }
+
+  size_t print(const String& text) { return fputs(text.c_str(), stdout) >= 0 ? text.length() : 0; }
+  size_t print(const char* text) { return print(String(text)); }
+  size_t print(char c) { return fputc(c, stdout) == c ? 1 : 0; }
+  size_t print(int number) { return printf("%d", number); }
+  size_t print(unsigned int number) { return printf("%u", number); }
+  size_t print(long number) { return printf("%ld", number); }
+  size_t print(unsigned long number) { return printf("%lu", number); }
+  size_t print(double number, int decimals = 2) { return printf("%.*f", decimals, number); }
+
+  size_t println() { return print('\n'); }
+  template <typename T>
+  size_t println(const T& value) { return print(value) + println(); }
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,7 @@
+#ifndef HOST_DNS_SERVER_H
+#define HOST_DNS_SERVER_H
+
+// Host shim: app_state.h only declares the captive-portal DNS server
+class DNSServer;
+
+#endif // HOST_DNS_SERVER_H
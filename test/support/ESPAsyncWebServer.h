@@ -0,0 +1,7 @@
+#ifndef HOST_ESP_ASYNC_WEB_SERVER_H
+#define HOST_ESP_ASYNC_WEB_SERVER_H
+
+// Host shim: app_state.h only declares the server; no native module serves HTTP
+class AsyncWebServer;
+
+#endif // HOST_ESP_ASYNC_WEB_SERVER_H
@@ -0,0 +1,149 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// HOST FS SHIM (native test env only)
+// ============================================================================
+// In-memory file system behind the Arduino fs::FS / fs::File API, enough for
+// the flasher stack (image files, page cache, backups). Files live for the
+// whole test program; copies of a File share one handle and position, as on
+// the device. Opening with "w" replaces the file, handles still open on the
+// old contents keep reading them.
+
+namespace fs {
+
+class File : public Stream {
+public:
+  File() {}
+  File(std::shared_ptr<std::vector<uint8_t>> data, const std::string& path, bool writable)
+      : handle(std::make_shared<Handle>()) {
+    handle->data = data;
+    handle->path = path;
+    handle->writable = writable;
+  }
+
+  explicit operator bool() const { return handle && handle->data; }
+
+  size_t read(uint8_t* buffer, size_t length) {
+    if (!*this) return 0;
+    std::vector<uint8_t>& data = *handle->data;
+    size_t count = handle->position < data.size() ? min(length, data.size() - handle->position) : 0;
+    memcpy(buffer, data.data() + handle->position, count);
+    handle->position += count;
+    return count;
+  }
+  int read() override {
+    uint8_t value;
+    return read(&value, 1) == 1 ? value : -1;
+  }
+  int available() override {
+    return *this ? (int)(handle->data->size() - min(handle->position, handle->data->size())) : 0;
+  }
+
+  size_t write(const uint8_t* data, size_t length) override {
+    if (!*this || !handle->writable) return 0;
+    std::vector<uint8_t>& contents = *handle->data;
+    if (contents.size() < handle->position + length) {
+      contents.resize(handle->position + length);
+    }
+    memcpy(contents.data() + handle->position, data, length);
+    handle->position += length;
+    return length;
+  }
+  size_t write(uint8_t value) override { return write(&value, 1); }
+
+  bool seek(uint32_t position) {
+    if (!*this || position > handle->data->size()) return false;
+    handle->position = position;
+    return true;
+  }
+  size_t position() const { return *this ? handle->position : 0; }
+  size_t size() const { return *this ? handle->data->size() : 0; }
+  void flush() {}
+  void close() { handle.reset(); }
+  const char* name() const { return *this ? handle->path.c_str() : ""; }
+  bool isDirectory() const { return false; }
+  File openNextFile() { return File(); }
+
+private:
+  struct Handle {
+    std::shared_ptr<std::vector<uint8_t>> data;
+    std::string path;
+    size_t position = 0;
+    bool writable = false;
+  };
+  std::shared_ptr<Handle> handle;
+};
+
+class FS {
+public:
+  File open(const String& path, const char* mode = "r", bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  File open(const char* path, const char* mode = "r", bool create = false) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(path);
+    if (mode[0] == 'w') {
+      auto data = std::make_shared<std::vector<uint8_t>>();
+      files[path] = data;
+      return File(data, path, true);
+    }
+    if (it == files.end()) {
+      if (mode[0] != 'a') return File();
+      it = files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+    }
+    File file(it->second, path, mode[0] == 'a' || strchr(mode, '+') != nullptr);
+    if (mode[0] == 'a') {
+      file.seek(it->second->size());
+    }
+    return file;
+  }
+
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool exists(const char* path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.count(path) != 0;
+  }
+
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool remove(const char* path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.erase(path) != 0;
+  }
+
+  bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+  bool rename(const char* from, const char* to) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(from);
+    if (it == files.end()) return false;
+    auto data = it->second;
+    files.erase(it);
+    files[to] = data;
+    return true;
+  }
+
+  bool mkdir(const char* path) { return true; }
+  bool rmdir(const char* path) { return true; }
+
+  // Test helper: drop every file
+  void removeAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    files.clear();
+  }
+
+private:
+  std::mutex mutex;
+  std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+};
+
+}  // namespace fs
+
+using fs::File;
+
+#endif // HOST_FS_H
@@ -0,0 +1,26 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+// ============================================================================
+// HOST LITTLEFS SHIM (native test env only)
+// ============================================================================
+// The in-memory file system of FS.h under the name the firmware uses.
+
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs") {
+    return true;
+  }
+  void end() {}
+  bool format() {
+    removeAll();
+    return true;
+  }
+};
+
+inline LittleFSFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,130 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// HOST PREFERENCES SHIM (native test env only)
+// ============================================================================
+// NVS namespaces kept in memory for the life of the test program, so a
+// module can be torn down and "rebooted" onto the same stored state.
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr) {
+    space = name;
+    readOnlyMode = readOnly;
+    started = true;
+    return true;
+  }
+  void end() { started = false; }
+
+  bool clear() {
+    if (!writable()) return false;
+    std::lock_guard<std::mutex> lock(mutex());
+    store()[space].clear();
+    return true;
+  }
+  bool remove(const char* key) {
+    if (!writable()) return false;
+    std::lock_guard<std::mutex> lock(mutex());
+    return store()[space].erase(key) != 0;
+  }
+  bool isKey(const char* key) {
+    std::lock_guard<std::mutex> lock(mutex());
+    return started && store()[space].count(key) != 0;
+  }
+
+  size_t putBool(const char* key, bool value) { return putValue(key, (uint8_t)value); }
+  size_t putUChar(const char* key, uint8_t value) { return putValue(key, value); }
+  size_t putUShort(const char* key, uint16_t value) { return putValue(key, value); }
+  size_t putInt(const char* key, int32_t value) { return putValue(key, value); }
+  size_t putUInt(const char* key, uint32_t value) { return putValue(key, value); }
+  size_t putULong(const char* key, uint32_t value) { return putValue(key, value); }
+  size_t putFloat(const char* key, float value) { return putValue(key, value); }
+  size_t putString(const char* key, const String& value) {
+    return putBytes(key, value.c_str(), value.length() + 1);
+  }
+  size_t putBytes(const char* key, const void* value, size_t length) {
+    if (!writable()) return 0;
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    std::lock_guard<std::mutex> lock(mutex());
+    store()[space][key] = std::vector<uint8_t>(bytes, bytes + length);
+    return length;
+  }
+
+  bool getBool(const char* key, bool defaultValue = false) { return getValue<uint8_t>(key, defaultValue) != 0; }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  float getFloat(const char* key, float defaultValue = 0.0f) { return getValue(key, defaultValue); }
+  String getString(const char* key, const String& defaultValue = String()) {
+    std::vector<uint8_t> bytes;
+    if (!lookup(key, bytes) || bytes.empty()) return defaultValue;
+    return String(std::string(bytes.begin(), bytes.end() - 1));
+  }
+  size_t getBytesLength(const char* key) {
+    std::vector<uint8_t> bytes;
+    return lookup(key, bytes) ? bytes.size() : 0;
+  }
+  size_t getBytes(const char* key, void* buffer, size_t length) {
+    std::vector<uint8_t> bytes;
+    if (!lookup(key, bytes) || bytes.size() > length) return 0;
+    memcpy(buffer, bytes.data(), bytes.size());
+    return bytes.size();
+  }
+
+  // Test helper: forget every namespace
+  static void eraseAll() {
+    std::lock_guard<std::mutex> lock(mutex());
+    store().clear();
+  }
+
+private:
+  std::string space;
+  bool readOnlyMode = false;
+  bool started = false;
+
+  typedef std::map<std::string, std::map<std::string, std::vector<uint8_t>>> Store;
+  static Store& store() {
+    static Store instance;
+    return instance;
+  }
+  static std::mutex& mutex() {
+    static std::mutex instance;
+    return instance;
+  }
+
+  bool writable() const { return started && !readOnlyMode; }
+
+  bool lookup(const char* key, std::vector<uint8_t>& bytes) {
+    if (!started) return false;
+    std::lock_guard<std::mutex> lock(mutex());
+    auto& entries = store()[space];
+    auto it = entries.find(key);
+    if (it == entries.end()) return false;
+    bytes = it->second;
+    return true;
+  }
+
+  template <typename T>
+  size_t putValue(const char* key, T value) {
+    return putBytes(key, &value, sizeof(value));
+  }
+
+  template <typename T>
+  T getValue(const char* key, T defaultValue) {
+    std::vector<uint8_t> bytes;
+    if (!lookup(key, bytes) || bytes.size() != sizeof(T)) return defaultValue;
+    T value;
+    memcpy(&value, bytes.data(), sizeof(T));
+    return value;
+  }
+};
+
+#endif // HOST_PREFERENCES_H
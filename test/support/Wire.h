@@ -0,0 +1,37 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// HOST WIRE SHIM (native test env only)
+// ============================================================================
+// There is no I2C peripheral on the host: every address NACKs. Native builds
+// run I2CManager on SimBus (-D I2C_SIM_BUS); this only lets TwoWireBackend
+// compile.
+
+class TwoWire {
+public:
+  bool begin(int sda, int scl, uint32_t frequency) { clockHz = frequency; return true; }
+  void end() {}
+  bool setClock(uint32_t frequency) { clockHz = frequency; return true; }
+  uint32_t getClock() { return clockHz; }
+  void setTimeout(uint16_t timeout_ms) {}
+
+  void beginTransmission(uint8_t address) {}
+  size_t write(uint8_t value) { return 1; }
+  size_t write(const uint8_t* data, size_t length) { return length; }
+  uint8_t endTransmission(bool sendStop = true) { return 2; }
+
+  size_t requestFrom(uint16_t address, size_t length, bool sendStop = true) { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+
+private:
+  uint32_t clockHz = 100000;
+};
+
+inline TwoWire Wire;
+inline TwoWire Wire1;
+
+#endif // HOST_WIRE_H
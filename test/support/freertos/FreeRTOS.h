@@ -0,0 +1,92 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// ============================================================================
+// HOST FREERTOS SHIM (native test env only)
+// ============================================================================
+// Tasks are std::threads, semaphores and queues are mutex/condition-variable
+// objects. One tick is one millisecond. Priorities and core affinity are
+// ignored, so tests must not rely on preemption order.
+//
+// Threads cannot be killed: vTaskDelete() marks the task and it parks at its
+// next RTOS call. Deleted queues and semaphores are leaked on purpose, a
+// parked task may still be blocked on one.
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS 1
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+namespace hostrtos {
+
+// Critical sections share one lock (portMUX_TYPE only names the section)
+inline std::recursive_mutex& criticalLock() {
+  static std::recursive_mutex lock;
+  return lock;
+}
+
+// Wait on `cv` until `ready()` or the timeout (ticks) expires
+template <typename Predicate>
+inline bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                    TickType_t ticks, Predicate ready) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, ready);
+    return true;
+  }
+  return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+// Per-task state seen by every blocking call
+struct TaskState {
+  std::atomic<bool> deleted{false};
+};
+
+inline TaskState*& currentTaskState() {
+  static thread_local TaskState* state = nullptr;
+  return state;
+}
+
+// A deleted task never runs again
+inline void parkIfDeleted() {
+  TaskState* state = currentTaskState();
+  if (state && state->deleted.load()) {
+    for (;;) {
+      std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+  }
+}
+
+inline std::chrono::steady_clock::time_point& tickOrigin() {
+  static std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+  return origin;
+}
+
+}  // namespace hostrtos
+
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) hostrtos::criticalLock().lock()
+#define portEXIT_CRITICAL(mux) hostrtos::criticalLock().unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+
+#endif // HOST_FREERTOS_H
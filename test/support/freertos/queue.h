@@ -0,0 +1,63 @@
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+namespace hostrtos {
+
+// Fixed-depth queue of fixed-size items, copied in and out like FreeRTOS
+struct Queue {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t depth;
+  UBaseType_t itemSize;
+
+  Queue(UBaseType_t depth, UBaseType_t itemSize) : depth(depth), itemSize(itemSize) {}
+};
+
+}  // namespace hostrtos
+
+typedef hostrtos::Queue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t itemSize) {
+  return new hostrtos::Queue(depth, itemSize);
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+  hostrtos::parkIfDeleted();
+  {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!hostrtos::waitFor(queue->changed, lock, ticks, [queue] { return queue->items.size() < queue->depth; })) {
+      return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  }
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+#define xQueueSendToBack xQueueSend
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+  hostrtos::parkIfDeleted();
+  {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!hostrtos::waitFor(queue->changed, lock, ticks, [queue] { return !queue->items.empty(); })) {
+      return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+  }
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return (UBaseType_t)queue->items.size();
+}
+
+inline void vQueueDelete(QueueHandle_t) {}  // Leaked, see FreeRTOS.h
+
+#endif // HOST_FREERTOS_QUEUE_H
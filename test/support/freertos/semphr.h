@@ -0,0 +1,97 @@
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+namespace hostrtos {
+
+// Counting semaphore; a mutex is a counting semaphore of one
+struct Semaphore {
+  std::mutex mutex;
+  std::condition_variable cv;
+  UBaseType_t count;
+  UBaseType_t maxCount;
+  std::thread::id owner;   // Recursive mutex holder
+  UBaseType_t depth = 0;
+
+  Semaphore(UBaseType_t maxCount, UBaseType_t initial) : count(initial), maxCount(maxCount) {}
+};
+
+}  // namespace hostrtos
+
+typedef hostrtos::Semaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+  return new hostrtos::Semaphore(maxCount, initialCount);
+}
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return xSemaphoreCreateCounting(1, 1); }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return xSemaphoreCreateCounting(1, 0); }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  hostrtos::parkIfDeleted();
+  std::unique_lock<std::mutex> lock(sem->mutex);
+  if (!hostrtos::waitFor(sem->cv, lock, ticks, [sem] { return sem->count > 0; })) {
+    return pdFALSE;
+  }
+  sem->count--;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  hostrtos::parkIfDeleted();
+  {
+    std::lock_guard<std::mutex> lock(sem->mutex);
+    if (sem->count >= sem->maxCount) {
+      return pdFALSE;
+    }
+    sem->count++;
+  }
+  sem->cv.notify_one();
+  return pdTRUE;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return xSemaphoreCreateMutex(); }
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+  hostrtos::parkIfDeleted();
+  std::unique_lock<std::mutex> lock(sem->mutex);
+  if (sem->count == 0 && sem->owner == std::this_thread::get_id()) {
+    sem->depth++;
+    return pdTRUE;
+  }
+  if (!hostrtos::waitFor(sem->cv, lock, ticks, [sem] { return sem->count > 0; })) {
+    return pdFALSE;
+  }
+  sem->count--;
+  sem->owner = std::this_thread::get_id();
+  sem->depth = 1;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+  hostrtos::parkIfDeleted();
+  {
+    std::lock_guard<std::mutex> lock(sem->mutex);
+    if (sem->owner != std::this_thread::get_id()) {
+      return pdFALSE;
+    }
+    if (--sem->depth > 0) {
+      return pdTRUE;
+    }
+    sem->owner = std::thread::id();
+    sem->count++;
+  }
+  sem->cv.notify_one();
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+  if (woken) {
+    *woken = pdFALSE;
+  }
+  return xSemaphoreGive(sem);
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t) {}  // Leaked, see FreeRTOS.h
+
+#endif // HOST_FREERTOS_SEMPHR_H
@@ -0,0 +1,93 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+typedef void (*TaskFunction_t)(void*);
+
+namespace hostrtos {
+
+struct Task : TaskState {
+  std::thread thread;
+  Semaphore notify{0xFFFFFFFF, 0};   // Task notification value
+};
+
+// Task running on this thread (nullptr for the test runner's own thread)
+inline Task*& currentTask() {
+  static thread_local Task* task = nullptr;
+  return task;
+}
+
+}  // namespace hostrtos
+
+typedef hostrtos::Task* TaskHandle_t;
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                          void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                          BaseType_t core) {
+  hostrtos::Task* task = new hostrtos::Task();
+  task->thread = std::thread([task, function, parameter] {
+    hostrtos::currentTask() = task;
+    hostrtos::currentTaskState() = task;
+    function(parameter);
+  });
+  task->thread.detach();
+  if (handle) {
+    *handle = task;
+  }
+  return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                              void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+// Threads cannot be killed, see FreeRTOS.h
+inline void vTaskDelete(TaskHandle_t task) {
+  if (!task) {
+    task = hostrtos::currentTask();
+  }
+  if (task) {
+    task->deleted = true;
+  }
+  hostrtos::parkIfDeleted();
+}
+
+inline TickType_t xTaskGetTickCount() {
+  return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - hostrtos::tickOrigin()).count();
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+  hostrtos::parkIfDeleted();
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline BaseType_t xTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+  *previousWake += period;
+  int32_t remaining = (int32_t)(*previousWake - xTaskGetTickCount());
+  if (remaining <= 0) {
+    return pdFALSE;
+  }
+  vTaskDelay((TickType_t)remaining);
+  return pdTRUE;
+}
+inline void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) { xTaskDelayUntil(previousWake, period); }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) { return xSemaphoreGive(&task->notify); }
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  hostrtos::parkIfDeleted();
+  hostrtos::Semaphore& notify = hostrtos::currentTask()->notify;
+  std::unique_lock<std::mutex> lock(notify.mutex);
+  if (!hostrtos::waitFor(notify.cv, lock, ticks, [&notify] { return notify.count > 0; })) {
+    return 0;
+  }
+  uint32_t value = notify.count;
+  notify.count = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+#endif // HOST_FREERTOS_TASK_H
@@ -0,0 +1,262 @@
+// Interrupted MS11-control updates resume from the flash journal (native_flasher env)
+//
+// Each trial flashes a new image over random "old firmware" and aborts it
+// one to three times at a random point: a brown-out of the ATmega right
+// after a page commit (the page in flight is left torn), or a cancel when
+// the job enters a given phase. After every abort the master "reboots"
+// (fresh MD11SlaveUpdate, journal reloaded from NVS) and the journal must
+// never claim a page the slave does not hold. The final job must resume
+// at the journal checkpoint, pass the read-back verify and leave the whole
+// image on the slave.
+#include <unity.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include "slave_flasher.h"
+#include "flash_journal.h"
+#include "i2c_manager.h"
+#include "i2c_sim_bus.h"
+
+MD11SlaveUpdate* md11SlaveUpdater = nullptr;   // Defined in main.cpp on the device
+
+#define IMAGE_PATH     "/update.msimg"
+#define IMAGE_PAGES    40
+#define TRIALS         30
+#define JOB_TIMEOUT_MS 20000
+
+static uint8_t image[IMAGE_PAGES][HEX_PAGE_SIZE];
+static uint32_t seed = 0x4D533131;
+
+static uint32_t nextRandom() {
+  seed = seed * 1664525u + 1013904223u;
+  return seed >> 8;
+}
+
+static uint32_t randomBelow(uint32_t limit) {
+  return nextRandom() % limit;
+}
+
+static void fillRandom(uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    data[i] = (uint8_t)nextRandom();
+  }
+}
+
+// Sparse image: a gap after the first half, like a real build with a data table
+static uint16_t pageAddress(uint16_t index) {
+  return (index < IMAGE_PAGES / 2 ? index : index + 8) * HEX_PAGE_SIZE;
+}
+
+static SimAtmega328& slave() {
+  return SimBus::slaveDevice();
+}
+
+static SlaveFlasher& flasher() {
+  return SlaveFlasher::getInstance();
+}
+
+static bool pageOnSlave(uint16_t index) {
+  return memcmp(slave().getFlash() + pageAddress(index), image[index], HEX_PAGE_SIZE) == 0;
+}
+
+// Leading image pages the slave already holds
+static uint16_t committedPages() {
+  uint16_t count = 0;
+  while (count < IMAGE_PAGES && pageOnSlave(count)) {
+    count++;
+  }
+  return count;
+}
+
+static void writeImage() {
+  fillRandom(&image[0][0], sizeof(image));
+  const uint8_t signature[3] = MSIMG_SIG_ATMEGA328P;
+  File out = LittleFS.open(IMAGE_PATH, "w");
+  MsImageWriter writer;
+  TEST_ASSERT_TRUE(writer.begin(out, signature));
+  for (uint16_t i = 0; i < IMAGE_PAGES; i++) {
+    TEST_ASSERT_TRUE(writer.addPage(pageAddress(i), image[i]));
+  }
+  TEST_ASSERT_TRUE(writer.finish());
+  out.close();
+}
+
+// Master reset: everything in RAM is gone, LittleFS and NVS survive
+static void rebootMaster() {
+  delete md11SlaveUpdater;
+  md11SlaveUpdater = new MD11SlaveUpdate();
+}
+
+// ============================================================================
+// Aborts
+// ============================================================================
+
+static volatile uint32_t cancelJob = 0;
+static volatile SlaveFlasher::State cancelState = SlaveFlasher::FLASH_IDLE;
+
+static void onProgress(const SlaveFlasher::Progress& progress, void* context) {
+  if (progress.jobId == cancelJob && progress.state == cancelState) {
+    flasher().cancel(progress.jobId);
+  }
+}
+
+static SlaveFlasher::Progress runJob(SlaveFlasher::State cancelIn = SlaveFlasher::FLASH_IDLE) {
+  cancelState = cancelIn;
+  uint32_t job = flasher().start(IMAGE_PATH, true, false, SLAVE_I2C_ADDR, false);
+  TEST_ASSERT_NOT_EQUAL(0, job);
+  cancelJob = job;
+
+  uint32_t start = millis();
+  while (flasher().isBusy() && millis() - start < JOB_TIMEOUT_MS) {
+    delay(1);
+  }
+  SlaveFlasher::Progress progress = flasher().getProgress();
+  TEST_ASSERT_EQUAL_UINT32(job, progress.jobId);
+  TEST_ASSERT_FALSE_MESSAGE(flasher().isBusy(), "Job did not finish");
+  cancelJob = 0;
+  return progress;
+}
+
+// One interrupted attempt; false if the job got through anyway
+static bool abortedJob() {
+  static const SlaveFlasher::State phases[] = {
+    SlaveFlasher::FLASH_ENTER_BOOTLOADER, SlaveFlasher::FLASH_CHECK_SIGNATURE,
+    SlaveFlasher::FLASH_WRITE_PAGES, SlaveFlasher::FLASH_VERIFY, SlaveFlasher::FLASH_EXIT_BOOTLOADER};
+
+  SlaveFlasher::Progress progress;
+  if (randomBelow(2) == 0) {
+    slave().powerFailAfterPages(1 + randomBelow(IMAGE_PAGES - 1));
+    progress = runJob();
+    slave().powerFailAfterPages(0);
+    if (progress.state == SlaveFlasher::FLASH_FAILED && progress.page < IMAGE_PAGES) {
+      // The page in flight when the power went is half programmed
+      uint8_t torn[HEX_PAGE_SIZE];
+      fillRandom(torn, sizeof(torn));
+      slave().loadFlash(pageAddress(progress.page), torn, sizeof(torn));
+    }
+    slave().setConnected(true);
+  } else {
+    progress = runJob(phases[randomBelow(sizeof(phases) / sizeof(phases[0]))]);
+  }
+  if (progress.state == SlaveFlasher::FLASH_DONE) {
+    return false;  // Power cut came after the last page written by this job
+  }
+  TEST_ASSERT_TRUE_MESSAGE(progress.state == SlaveFlasher::FLASH_FAILED ||
+                           progress.state == SlaveFlasher::FLASH_CANCELLED, progress.error);
+  rebootMaster();
+  return true;
+}
+
+// The journal may lag the slave, never lead it
+static uint16_t checkJournal() {
+  FlashJournal::Entry entry;
+  if (!FlashJournal::getInstance().load(entry)) {
+    return 0;
+  }
+  TEST_ASSERT_EQUAL_STRING(IMAGE_PATH, entry.path.c_str());
+  TEST_ASSERT_EQUAL_HEX8(SLAVE_I2C_ADDR, entry.address);
+
+  uint16_t committed = committedPages();
+  if (entry.phase == FlashJournal::JOURNAL_WRITING) {
+    TEST_ASSERT_LESS_OR_EQUAL_UINT16(committed, entry.page);
+    return entry.page;
+  }
+  TEST_ASSERT_EQUAL_UINT16(IMAGE_PAGES, committed);
+  return IMAGE_PAGES;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+void setUp() {
+  static bool started = false;
+  if (!started) {
+    TEST_ASSERT_TRUE(I2CManager::getInstance().begin());
+    TEST_ASSERT_TRUE(flasher().begin());
+    flasher().setListener(onProgress, nullptr);
+    started = true;
+  }
+}
+
+void tearDown() {
+  slave().powerFailAfterPages(0);
+  slave().setConnected(true);
+}
+
+static void startTrial() {
+  uint8_t oldFirmware[SimAtmega328::BOOTLOADER_START];
+  fillRandom(oldFirmware, sizeof(oldFirmware));
+  slave().loadFlash(0, oldFirmware, sizeof(oldFirmware));
+
+  LittleFS.format();   // No page cache: every page is compared on the slave
+  Preferences::eraseAll();
+  rebootMaster();
+  writeImage();
+}
+
+static void test_uninterrupted_update() {
+  startTrial();
+  SlaveFlasher::Progress progress = runJob();
+  TEST_ASSERT_EQUAL_STRING("done", SlaveFlasher::stateName(progress.state));
+  TEST_ASSERT_EQUAL_UINT16(0, progress.resumePage);
+  TEST_ASSERT_EQUAL_UINT16(IMAGE_PAGES, progress.stats.pagesWritten);
+  TEST_ASSERT_EQUAL_UINT16(IMAGE_PAGES, committedPages());
+  TEST_ASSERT_EQUAL_UINT16(0, checkJournal());
+}
+
+static const char* refuseSlave(uint8_t target, void* context) {
+  return target == SLAVE_I2C_ADDR ? "Oven is running" : nullptr;
+}
+
+static void test_start_guard_refuses_job() {
+  startTrial();
+  SlaveFlasher::Progress before = flasher().getProgress();
+  flasher().setStartGuard(refuseSlave, nullptr);
+  uint32_t job = flasher().start(IMAGE_PATH, true, false, SLAVE_I2C_ADDR, false);
+  flasher().setStartGuard(nullptr, nullptr);
+
+  // Refused before the task saw it: previous job state kept, slave untouched
+  TEST_ASSERT_EQUAL_UINT32(0, job);
+  TEST_ASSERT_FALSE(flasher().isBusy());
+  TEST_ASSERT_EQUAL_UINT32(before.jobId, flasher().getProgress().jobId);
+  TEST_ASSERT_FALSE(slave().isInBootloader());
+  TEST_ASSERT_EQUAL_UINT16(0, committedPages());
+}
+
+static void test_resume_after_random_aborts() {
+  for (int trial = 0; trial < TRIALS; trial++) {
+    startTrial();
+
+    int aborts = 1 + randomBelow(3);
+    for (int i = 0; i < aborts && abortedJob(); i++) {
+      checkJournal();
+    }
+    uint16_t checkpoint = checkJournal();
+
+    SlaveFlasher::Progress progress = runJob();
+    char message[160];
+    snprintf(message, sizeof(message), "Trial %d: %s %s", trial,
+             SlaveFlasher::stateName(progress.state), progress.error);
+    TEST_ASSERT_EQUAL_MESSAGE(SlaveFlasher::FLASH_DONE, progress.state, message);
+    TEST_ASSERT_TRUE_MESSAGE(progress.stats.verified, message);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(checkpoint, progress.resumePage, message);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(checkpoint, progress.stats.pagesResumed, message);
+
+    // Every page was written, found unchanged or resumed - none skipped
+    const MD11SlaveUpdate::FlashStats& stats = progress.stats;
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(IMAGE_PAGES, stats.pagesWritten + stats.pagesUnchanged +
+                                     stats.pagesCached + stats.pagesResumed, message);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(IMAGE_PAGES, stats.pagesVerified, message);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(IMAGE_PAGES, committedPages(), message);
+    TEST_ASSERT_FALSE_MESSAGE(slave().isInBootloader(), message);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(0, checkJournal(), message);
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_uninterrupted_update);
+  RUN_TEST(test_start_guard_refuses_job);
+  RUN_TEST(test_resume_after_random_aborts);
+  return UNITY_END();
+}
@@ -0,0 +1,300 @@
+// Async transaction queue: I2CManager::submit() and the bus worker (native env)
+#include <unity.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "i2c_manager.h"
+#include "i2c_sim_bus.h"
+
+#define FAKE_ADDRESS  0x50
+#define GATE_MARKER   0xEE   // First byte of a write that blocks the worker until released
+
+// Scripted device on the simulated display bus: logs the first byte of every
+// write, can NACK, and can hold the worker inside a transaction.
+class FakeDevice : public SimDevice {
+public:
+  std::atomic<bool> hold{false};
+  std::atomic<bool> gateEntered{false};
+  std::atomic<bool> nack{false};
+
+  bool respondsTo(uint8_t address) const override { return address == FAKE_ADDRESS; }
+
+  bool onWrite(uint8_t address, const uint8_t* data, size_t length) override {
+    if (length == 0) {
+      return true;
+    }
+    if (data[0] == GATE_MARKER) {
+      gateEntered = true;
+      while (hold) {
+        delay(1);
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    log.push_back(data[0]);
+    return !nack;
+  }
+
+  size_t onRead(uint8_t address, uint8_t* buffer, size_t length) override {
+    for (size_t i = 0; i < length; i++) {
+      buffer[i] = (uint8_t)(0xA0 + i);
+    }
+    return length;
+  }
+
+  const char* name() const override { return "Fake"; }
+
+  std::vector<uint8_t> written() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return log;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    log.clear();
+    hold = false;
+    gateEntered = false;
+    nack = false;
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<uint8_t> log;
+};
+
+static FakeDevice fake;
+
+struct Completion {
+  std::atomic<int> calls{0};
+  std::atomic<int> result{-1};
+};
+
+static void onComplete(const I2CTransaction& txn, I2CErrorCode result, void* context) {
+  Completion* completion = static_cast<Completion*>(context);
+  completion->result = result;
+  completion->calls++;
+}
+
+static I2CManager& manager() {
+  return I2CManager::getInstance();
+}
+
+static I2CTransaction writeTxn(uint8_t first, I2CTransactionPriority priority = I2C_PRIORITY_NORMAL,
+                               Completion* completion = nullptr) {
+  I2CTransaction txn;
+  txn.type = I2C_TXN_WRITE;
+  txn.priority = priority;
+  txn.bus = I2C_BUS_DISPLAY;
+  txn.address = FAKE_ADDRESS;
+  txn.txData[0] = first;
+  txn.txData[1] = 0x00;
+  txn.txLength = 2;
+  txn.callback = completion ? onComplete : nullptr;
+  txn.context = completion;
+  return txn;
+}
+
+static uint32_t finished(const I2CManager::QueueStats& stats) {
+  return stats.completed + stats.failed + stats.dropped;
+}
+
+// Wait until the display worker has finished `count` more transactions than `before`
+static bool waitFinished(const I2CManager::QueueStats& before, uint32_t count, uint32_t timeoutMs = 2000) {
+  uint32_t start = millis();
+  while (millis() - start < timeoutMs) {
+    if (finished(manager().getQueueStats(I2C_BUS_DISPLAY)) >= finished(before) + count) {
+      return true;
+    }
+    delay(1);
+  }
+  return false;
+}
+
+// Park the worker inside a gate transaction
+static void holdWorker() {
+  fake.hold = true;
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(GATE_MARKER)));
+  uint32_t start = millis();
+  while (!fake.gateEntered && millis() - start < 1000) {
+    delay(1);
+  }
+  TEST_ASSERT_TRUE(fake.gateEntered);
+}
+
+void setUp() {
+  static bool attached = false;
+  if (!attached) {
+    SimBus::displayInstance().attach(&fake);
+    attached = true;
+  }
+  TEST_ASSERT_TRUE(manager().begin());
+  fake.reset();
+}
+
+void tearDown() {
+  fake.hold = false;
+}
+
+static void test_write_completes() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+  Completion completion;
+
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(0x10, I2C_PRIORITY_NORMAL, &completion)));
+  TEST_ASSERT_TRUE(waitFinished(before, 1));
+
+  I2CManager::QueueStats after = manager().getQueueStats(I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL(1, completion.calls.load());
+  TEST_ASSERT_EQUAL(I2C_OK, completion.result.load());
+  TEST_ASSERT_EQUAL_UINT32(before.submitted + 1, after.submitted);
+  TEST_ASSERT_EQUAL_UINT32(before.completed + 1, after.completed);
+  TEST_ASSERT_EQUAL(1, (int)fake.written().size());
+}
+
+static void test_write_read_fills_buffer() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+  Completion completion;
+  uint8_t rx[4] = {0};
+
+  I2CTransaction txn = writeTxn(0x20, I2C_PRIORITY_NORMAL, &completion);
+  txn.type = I2C_TXN_WRITE_READ;
+  txn.txLength = 1;
+  txn.rxBuffer = rx;
+  txn.rxLength = sizeof(rx);
+  TEST_ASSERT_TRUE(manager().submit(txn));
+  TEST_ASSERT_TRUE(waitFinished(before, 1));
+
+  const uint8_t expected[] = {0xA0, 0xA1, 0xA2, 0xA3};
+  TEST_ASSERT_EQUAL(I2C_OK, completion.result.load());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, rx, sizeof(rx));
+}
+
+static void test_high_priority_runs_first() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+  holdWorker();
+
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(1)));
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(2)));
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(3)));
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(9, I2C_PRIORITY_HIGH)));
+  fake.hold = false;
+  TEST_ASSERT_TRUE(waitFinished(before, 5));
+
+  const uint8_t expected[] = {GATE_MARKER, 9, 1, 2, 3};
+  std::vector<uint8_t> order = fake.written();
+  TEST_ASSERT_EQUAL(sizeof(expected), (int)order.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, order.data(), sizeof(expected));
+}
+
+static void test_stale_transaction_is_dropped() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+  Completion completion;
+  holdWorker();
+
+  I2CTransaction txn = writeTxn(0x30, I2C_PRIORITY_NORMAL, &completion);
+  txn.deadline_ms = millis() + 20;
+  TEST_ASSERT_TRUE(manager().submit(txn));
+  delay(50);
+  fake.hold = false;
+  TEST_ASSERT_TRUE(waitFinished(before, 2));
+
+  I2CManager::QueueStats after = manager().getQueueStats(I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL(I2C_ERROR_TIMEOUT, completion.result.load());
+  TEST_ASSERT_EQUAL_UINT32(before.dropped + 1, after.dropped);
+  TEST_ASSERT_EQUAL(1, (int)fake.written().size());   // Only the gate reached the bus
+}
+
+static void test_full_queue_rejects() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+  holdWorker();
+
+  for (uint8_t i = 0; i < I2C_QUEUE_DEPTH; i++) {
+    TEST_ASSERT_TRUE(manager().submit(writeTxn(i)));
+  }
+  TEST_ASSERT_FALSE(manager().submit(writeTxn(0x40)));
+  TEST_ASSERT_TRUE(manager().submit(writeTxn(0x41, I2C_PRIORITY_HIGH)));  // Separate queue
+
+  I2CManager::QueueStats full = manager().getQueueStats(I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL_UINT32(before.rejected + 1, full.rejected);
+  TEST_ASSERT_EQUAL_UINT32(before.submitted + I2C_QUEUE_DEPTH + 2, full.submitted);
+
+  fake.hold = false;
+  TEST_ASSERT_TRUE(waitFinished(before, I2C_QUEUE_DEPTH + 2));
+}
+
+static void test_invalid_transactions_are_refused() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+
+  I2CTransaction tooLong = writeTxn(0x50);
+  tooLong.txLength = I2C_TXN_MAX_DATA + 1;
+  I2CTransaction empty = writeTxn(0x51);
+  empty.txLength = 0;
+  I2CTransaction noBuffer = writeTxn(0x52);
+  noBuffer.type = I2C_TXN_READ;
+  noBuffer.rxLength = 2;
+
+  TEST_ASSERT_FALSE(manager().submit(tooLong));
+  TEST_ASSERT_FALSE(manager().submit(empty));
+  TEST_ASSERT_FALSE(manager().submit(noBuffer));
+
+  I2CManager::QueueStats after = manager().getQueueStats(I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL_UINT32(before.submitted, after.submitted);
+  TEST_ASSERT_EQUAL_UINT32(before.rejected, after.rejected);
+}
+
+static void test_nack_fails_after_retries() {
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+  Completion completion;
+  fake.nack = true;
+
+  I2CTransaction txn = writeTxn(0x60, I2C_PRIORITY_NORMAL, &completion);
+  txn.retries = 2;
+  TEST_ASSERT_TRUE(manager().submit(txn));
+  TEST_ASSERT_TRUE(waitFinished(before, 1));
+
+  I2CManager::QueueStats after = manager().getQueueStats(I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL(I2C_ERROR_NACK, completion.result.load());
+  TEST_ASSERT_EQUAL_UINT32(before.failed + 1, after.failed);
+  TEST_ASSERT_EQUAL(3, (int)fake.written().size());   // First attempt + 2 retries
+}
+
+static void test_concurrent_submitters_are_all_counted() {
+  const int threads = 4;
+  const int perThread = 200;
+  I2CManager::QueueStats before = manager().getQueueStats(I2C_BUS_DISPLAY);
+
+  std::vector<std::thread> submitters;
+  std::atomic<int> refused{0};
+  for (int t = 0; t < threads; t++) {
+    submitters.emplace_back([t, &refused] {
+      for (int i = 0; i < perThread; i++) {
+        I2CTransactionPriority priority = (i % 4 == 0) ? I2C_PRIORITY_HIGH : I2C_PRIORITY_NORMAL;
+        if (!manager().submit(writeTxn((uint8_t)t, priority), 1000)) {
+          refused++;
+        }
+      }
+    });
+  }
+  for (std::thread& submitter : submitters) {
+    submitter.join();
+  }
+  TEST_ASSERT_EQUAL(0, refused.load());
+  TEST_ASSERT_TRUE(waitFinished(before, threads * perThread, 10000));
+
+  I2CManager::QueueStats after = manager().getQueueStats(I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL_UINT32(before.submitted + threads * perThread, after.submitted);
+  TEST_ASSERT_EQUAL_UINT32(before.completed + threads * perThread, after.completed);
+  TEST_ASSERT_EQUAL_UINT32(before.rejected, after.rejected);
+  TEST_ASSERT_EQUAL(threads * perThread, (int)fake.written().size());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_write_completes);
+  RUN_TEST(test_write_read_fills_buffer);
+  RUN_TEST(test_high_priority_runs_first);
+  RUN_TEST(test_stale_transaction_is_dropped);
+  RUN_TEST(test_full_queue_rejects);
+  RUN_TEST(test_invalid_transactions_are_refused);
+  RUN_TEST(test_nack_fails_after_retries);
+  RUN_TEST(test_concurrent_submitters_are_all_counted);
+  return UNITY_END();
+}
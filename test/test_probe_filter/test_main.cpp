@@ -0,0 +1,213 @@
+// ProbeFilter chain on recorded probe traces (native env)
+//
+// Traces are {millis, centi-degrees} as logged by ProbeManager::readProbe
+// before the filter: the MS11 DS18B20 in a steady oven with bus glitches
+// (85.00 power-on value, -127.00 disconnect, all-zero read), the AHT10 at
+// room temperature, and a meat probe pushed into a 110 °C smoker.
+#include <unity.h>
+#include "probe_filter.h"
+
+struct Sample {
+  uint32_t ms;
+  int32_t centi;
+};
+
+#define TRACE_LENGTH(trace) (sizeof(trace) / sizeof(trace[0]))
+
+// ============================================================================
+// Recorded traces
+// ============================================================================
+
+// MS11 DS18B20, oven holding 107.5 °C, 0.0625 °C resolution
+static const Sample kOvenSpikes[] = {
+  {1017, 10762}, {2036, 10738}, {3053, 10738}, {4036, 10750}, {5061, 10738}, {6044, 10750},
+  {7016, 10744}, {8044, 10750}, {9009, 10744}, {10026, 10744}, {11064, 10744}, {12091, 10744},
+  {13059, 8500}, {14049, 10750}, {15085, 10756}, {16101, 10750}, {17136, 10756},
+  {18133, 10744}, {19156, 10756}, {20151, 10750}, {21163, 10775}, {22133, 10750},
+  {23125, 10750}, {24121, 10756}, {25084, 10762}, {26095, 10756}, {27068, 10756},
+  {28030, 10744}, {28990, 10756}, {29956, 10769}, {30976, -12700}, {31989, -12700},
+  {32958, 10744}, {33952, 10750}, {34955, 10756}, {35967, 10756}, {36942, 10756},
+  {37903, 10762}, {38870, 10744}, {39901, 10750}, {40885, 10744}, {41861, 10750},
+  {42874, 10750}, {43887, 10744}, {44874, 10769}, {45909, 0}, {46907, 10750}, {47890, 10750},
+  {48900, 10762}, {49933, 10750}, {50905, 10756}, {51921, 10750}, {52914, 10762},
+  {53911, 10750}, {54920, 10750}, {55954, 10750}, {56945, 10756}, {57984, 10750},
+  {59002, 10756}, {60035, 10756}
+};
+
+// AHT10, room at 23.4 °C
+static const Sample kAmbientNoise[] = {
+  {978, 2346}, {1957, 2333}, {2946, 2363}, {3931, 2325}, {4947, 2349}, {5977, 2363},
+  {6982, 2352}, {8008, 2375}, {9008, 2328}, {9984, 2330}, {10960, 2377}, {11945, 2349},
+  {12962, 2337}, {13984, 2329}, {15011, 2330}, {15992, 2333}, {17021, 2339}, {18005, 2334},
+  {19005, 2313}, {20014, 2329}, {20988, 2334}, {21971, 2373}, {22988, 2352}, {23986, 2341},
+  {24971, 2349}, {25964, 2343}, {26967, 2333}, {27960, 2337}, {28938, 2373}, {29950, 2313},
+  {30966, 2333}, {31944, 2321}, {32951, 2343}, {33979, 2341}, {34971, 2328}, {35942, 2303},
+  {36950, 2329}, {37966, 2327}, {38955, 2316}, {39929, 2392}, {40927, 2317}, {41954, 2333},
+  {42983, 2338}, {44003, 2317}, {45031, 2337}, {46031, 2345}, {47058, 2366}, {48088, 2354},
+  {49108, 2357}, {50078, 2343}, {51087, 2332}, {52057, 2328}, {53065, 2346}, {54042, 2343},
+  {55028, 2358}, {56022, 2323}, {57051, 2338}, {58049, 2320}, {59048, 2343}, {60066, 2335},
+  {61068, 2360}, {62068, 2344}, {63039, 2343}, {64040, 2363}, {65059, 2315}, {66045, 2318},
+  {67072, 2353}, {68085, 2341}, {69094, 2343}, {70121, 2349}, {71112, 2331}, {72139, 2326},
+  {73124, 2330}, {74106, 2360}, {75116, 2315}, {76144, 2351}, {77126, 2351}, {78133, 2330},
+  {79161, 2337}, {80162, 2347}
+};
+
+// Meat probe on the bench, pushed into the smoker after the third reading
+static const Sample kProbeInserted[] = {
+  {929, 2160}, {2043, 2133}, {2825, 2158}, {3661, 7454}, {4468, 8096}, {5327, 8666},
+  {6502, 9246}, {7504, 9651}, {8598, 9961}, {9667, 10228}, {10648, 10374}, {11540, 10523},
+  {12736, 10622}, {13629, 10697}, {14671, 10765}, {15709, 10837}, {16468, 10849},
+  {17315, 10875}, {18077, 10905}, {19225, 10920}, {20047, 10949}, {20856, 10924},
+  {21834, 10972}, {22911, 10979}, {24074, 10976}, {24925, 10986}, {25777, 10989},
+  {26892, 10982}, {27647, 10992}, {28415, 10980}, {29256, 10997}, {30282, 11013},
+  {31389, 11008}, {32526, 10994}, {33357, 10984}, {34570, 11009}, {35434, 11019},
+  {36553, 11011}, {37501, 11007}, {38571, 11007}
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static ProbeFilterConfig chain(bool median, float alpha, uint16_t maxRate) {
+  ProbeFilterConfig config;
+  config.median = median;
+  config.alpha = ProbeFilterConfig::alphaFromFloat(alpha);
+  config.maxRate = maxRate;
+  return config;
+}
+
+static void replay(ProbeFilter& filter, const Sample* trace, size_t length, int32_t* out) {
+  for (size_t i = 0; i < length; i++) {
+    out[i] = filter.apply(trace[i].centi, trace[i].ms);
+  }
+}
+
+static float rmsAround(const int32_t* values, size_t from, size_t to, float center) {
+  float sum = 0.0f;
+  for (size_t i = from; i < to; i++) {
+    sum += (values[i] - center) * (values[i] - center);
+  }
+  return sqrtf(sum / (to - from));
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_median_rejects_bus_glitches() {
+  ProbeFilter filter;
+  filter.configure(chain(true, 1.0f, 0));
+  int32_t out[TRACE_LENGTH(kOvenSpikes)];
+  replay(filter, kOvenSpikes, TRACE_LENGTH(kOvenSpikes), out);
+
+  // Single and back-to-back glitches never reach the output
+  for (size_t i = 0; i < TRACE_LENGTH(kOvenSpikes); i++) {
+    TEST_ASSERT_INT32_WITHIN(50, 10750, out[i]);
+  }
+}
+
+static void test_glitches_pass_without_median() {
+  ProbeFilter filter;
+  filter.configure(chain(false, 1.0f, 0));
+  int32_t out[TRACE_LENGTH(kOvenSpikes)];
+  replay(filter, kOvenSpikes, TRACE_LENGTH(kOvenSpikes), out);
+  TEST_ASSERT_EQUAL_INT32(8500, out[12]);
+  TEST_ASSERT_EQUAL_INT32(-12700, out[30]);
+}
+
+static void test_ema_reduces_noise() {
+  const size_t length = TRACE_LENGTH(kAmbientNoise);
+  int32_t raw[length];
+  int32_t out[length];
+  for (size_t i = 0; i < length; i++) {
+    raw[i] = kAmbientNoise[i].centi;
+  }
+  ProbeFilter filter;
+  filter.configure(chain(false, 0.3f, 0));
+  replay(filter, kAmbientNoise, length, out);
+
+  // White noise through an EMA: sigma shrinks by sqrt(alpha / (2 - alpha)) ~ 0.42
+  float before = rmsAround(raw, 10, length, 2340.0f);
+  float after = rmsAround(out, 10, length, 2340.0f);
+  TEST_ASSERT_LESS_THAN_FLOAT(0.6f * before, after);
+}
+
+static void test_ema_settles_on_a_step() {
+  // alpha 0.3: 1 % of a 35 °C step is left after ln(0.01) / ln(0.7) = 12.9 samples
+  ProbeFilter filter;
+  filter.configure(chain(false, 0.3f, 0));
+  filter.apply((int32_t)2500, 0);
+
+  int32_t value = 0;
+  for (uint32_t n = 1; n <= 12; n++) {
+    value = filter.apply((int32_t)6000, n * 1000);
+  }
+  TEST_ASSERT_GREATER_THAN(35, 6000 - value);
+  value = filter.apply((int32_t)6000, 13000);
+  TEST_ASSERT_INT32_WITHIN(35, 6000, value);
+
+  for (uint32_t n = 14; n <= 60; n++) {
+    value = filter.apply((int32_t)6000, n * 1000);
+  }
+  TEST_ASSERT_EQUAL_INT32(6000, value);   // Fixed point leaves no steady offset
+}
+
+static void test_rate_clamp_limits_slew() {
+  const size_t length = TRACE_LENGTH(kProbeInserted);
+  int32_t out[length];
+  ProbeFilter filter;
+  filter.configure(chain(false, 1.0f, 500));   // 5 °C per second
+  replay(filter, kProbeInserted, length, out);
+
+  for (size_t i = 1; i < length; i++) {
+    int32_t limit = 500 * (kProbeInserted[i].ms - kProbeInserted[i - 1].ms) / 1000;
+    TEST_ASSERT_LESS_OR_EQUAL(limit, abs(out[i] - out[i - 1]));
+    TEST_ASSERT_LESS_OR_EQUAL(abs(kProbeInserted[i].centi - out[i - 1]), abs(out[i] - out[i - 1]));
+  }
+  // The jump is rate-limited, then the output catches up with the probe
+  TEST_ASSERT_LESS_THAN(kProbeInserted[3].centi, out[3]);
+  TEST_ASSERT_EQUAL_INT32(kProbeInserted[length - 1].centi, out[length - 1]);
+}
+
+static void test_default_chain_on_recorded_traces() {
+  ProbeFilter filter;
+  filter.configure(chain(true, 0.3f, 500));
+  int32_t out[TRACE_LENGTH(kOvenSpikes)];
+  replay(filter, kOvenSpikes, TRACE_LENGTH(kOvenSpikes), out);
+  for (size_t i = 0; i < TRACE_LENGTH(kOvenSpikes); i++) {
+    TEST_ASSERT_INT32_WITHIN(30, 10750, out[i]);
+  }
+
+  filter.reset();
+  int32_t inserted[TRACE_LENGTH(kProbeInserted)];
+  replay(filter, kProbeInserted, TRACE_LENGTH(kProbeInserted), inserted);
+  TEST_ASSERT_INT32_WITHIN(50, 11000, inserted[TRACE_LENGTH(kProbeInserted) - 1]);
+}
+
+static void test_gap_restarts_the_chain() {
+  ProbeFilter filter;
+  filter.configure(chain(true, 0.3f, 500));
+  for (uint32_t n = 0; n < 10; n++) {
+    filter.apply((int32_t)2200, n * 1000);
+  }
+  // Probe replugged after a pause: no slewing from the old value
+  uint32_t back = 9000 + PROBE_FILTER_GAP_MS + 1;
+  TEST_ASSERT_EQUAL_INT32(9500, filter.apply((int32_t)9500, back));
+  TEST_ASSERT_EQUAL_INT32(9500, filter.apply((int32_t)9500, back + 1000));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_median_rejects_bus_glitches);
+  RUN_TEST(test_glitches_pass_without_median);
+  RUN_TEST(test_ema_reduces_noise);
+  RUN_TEST(test_ema_settles_on_a_step);
+  RUN_TEST(test_rate_clamp_limits_slew);
+  RUN_TEST(test_default_chain_on_recorded_traces);
+  RUN_TEST(test_gap_restarts_the_chain);
+  return UNITY_END();
+}
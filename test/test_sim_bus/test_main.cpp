@@ -0,0 +1,103 @@
+// I2CManager on the simulated buses (native env)
+#include <unity.h>
+#include "i2c_manager.h"
+#include "i2c_metrics.h"
+#include "i2c_sim_bus.h"
+#include "slave_controller.h"
+
+static I2CManager& manager() {
+  return I2CManager::getInstance();
+}
+
+void setUp() {
+  TEST_ASSERT_TRUE(manager().begin());
+}
+
+void tearDown() {}
+
+static void test_backends_are_simulated() {
+  TEST_ASSERT_EQUAL_STRING("SimBus-slave", manager().getBackend(I2C_BUS_SLAVE)->name());
+  TEST_ASSERT_EQUAL_STRING("SimBus-display", manager().getBackend(I2C_BUS_DISPLAY)->name());
+}
+
+static void test_scan_finds_display_devices() {
+  uint8_t found[16];
+  uint8_t count = 0;
+  TEST_ASSERT_TRUE(manager().scanBus(found, sizeof(found), count, I2C_BUS_DISPLAY));
+
+  const uint8_t expected[] = {0x27, 0x36, 0x38, 0x3C, 0x48};
+  TEST_ASSERT_EQUAL_UINT8(sizeof(expected), count);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, found, sizeof(expected));
+}
+
+static void test_routes_follow_the_device() {
+  TEST_ASSERT_EQUAL(I2C_BUS_SLAVE, manager().routeFor(SLAVE_I2C_ADDR));
+  TEST_ASSERT_EQUAL(I2C_BUS_DISPLAY, manager().routeFor(0x3C));
+  TEST_ASSERT_TRUE(manager().ping(SLAVE_I2C_ADDR, I2C_BUS_SLAVE));
+  TEST_ASSERT_FALSE(manager().ping(SLAVE_I2C_ADDR, I2C_BUS_DISPLAY));
+}
+
+static uint32_t displayWrites() {
+  return I2CMetrics::getInstance().getBus(I2C_BUS_DISPLAY).writeLatency.getCount();
+}
+
+static void test_absent_address_is_probed_once() {
+  uint8_t data[1] = {0x00};
+  const uint8_t absent = 0x5A;
+  TEST_ASSERT_FALSE(manager().hasRoute(absent));
+  uint32_t before = displayWrites();
+  TEST_ASSERT_FALSE(manager().write(absent, data, sizeof(data)));
+  TEST_ASSERT_FALSE(manager().write(absent, data, sizeof(data)));
+  TEST_ASSERT_FALSE(manager().write(absent, data, sizeof(data)));
+
+  // One discovery ping on the display bus; the held miss skips the rest
+  TEST_ASSERT_EQUAL_UINT32(1, displayWrites() - before);
+  TEST_ASSERT_FALSE(manager().hasRoute(absent));
+
+  manager().setRoute(absent, I2C_BUS_DISPLAY);
+  TEST_ASSERT_EQUAL(I2C_BUS_DISPLAY, manager().routeFor(absent));
+}
+
+static void test_register_read() {
+  uint8_t version = 0;
+  TEST_ASSERT_TRUE(manager().readRegister(SLAVE_I2C_ADDR, REG_PROTOCOL_VER, version));
+  TEST_ASSERT_EQUAL_HEX8(ms11::PROTOCOL_V3, version);
+}
+
+static void test_last_error_names_the_failure() {
+  uint8_t data[2] = {0x00, 0x00};
+  manager().setRoute(0x51, I2C_BUS_DISPLAY);
+  TEST_ASSERT_FALSE(manager().write(0x51, data, sizeof(data)));
+  TEST_ASSERT_EQUAL(I2C_ERROR_NACK, manager().getLastErrorCode());
+  TEST_ASSERT_EQUAL_STRING("NACK (device not responding) (Wire error: 2)", manager().getLastError().c_str());
+
+  TEST_ASSERT_TRUE(manager().write(0x3C, data, sizeof(data)));
+  TEST_ASSERT_EQUAL(I2C_OK, manager().getLastErrorCode());
+  TEST_ASSERT_EQUAL_STRING("OK", manager().getLastError().c_str());
+}
+
+static void test_stuck_bus_is_recovered() {
+  I2CManager::BusHealth before = manager().getBusHealth(I2C_BUS_SLAVE);
+
+  SimBus::slaveInstance().setStuck(true);
+  uint8_t value = 0;
+  TEST_ASSERT_FALSE(manager().readRegister(SLAVE_I2C_ADDR, REG_PROTOCOL_VER, value, 100, 0));
+
+  I2CManager::BusHealth after = manager().getBusHealth(I2C_BUS_SLAVE);
+  TEST_ASSERT_EQUAL_UINT32(before.recoveries + 1, after.recoveries);
+  TEST_ASSERT_LESS_THAN(before.clockHz, after.clockHz);
+  TEST_ASSERT_FALSE(SimBus::slaveInstance().isLineStuck());
+  TEST_ASSERT_TRUE(manager().readRegister(SLAVE_I2C_ADDR, REG_PROTOCOL_VER, value));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_backends_are_simulated);
+  RUN_TEST(test_scan_finds_display_devices);
+  RUN_TEST(test_routes_follow_the_device);
+  RUN_TEST(test_absent_address_is_probed_once);
+  RUN_TEST(test_register_read);
+  RUN_TEST(test_last_error_names_the_failure);
+  RUN_TEST(test_stuck_bus_is_recovered);
+  return UNITY_END();
+}
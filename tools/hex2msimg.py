@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Convert an MS11-control Intel HEX file into an .msimg firmware image.
+
+The image is a 64-byte header followed by sparse page records, see
+include/ms11_image.h for the layout. Data in the twiboot section is dropped,
+exactly as the on-device decoder does.
+
+Usage:
+  tools/hex2msimg.py firmware.hex -o data/firmware.msimg --fw-version 0x61
+  tools/hex2msimg.py --info data/firmware.msimg
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+
+MAGIC = b"MSIM"
+FORMAT_VERSION = 1
+HEADER_SIZE = 64
+PAGE_SIZE = 128
+BOOTLOADER_START = 0x7C00
+FLASH_END = 0x8000
+SIG_ATMEGA328P = bytes([0x1E, 0x95, 0x0F])
+
+# magic, format, header size, page size, signature, fw version, page count,
+# reserved0, sha256, reserved1
+HEADER = struct.Struct("<4sBBH3sBH6s32s12s")
+assert HEADER.size == HEADER_SIZE
+
+
+def parse_hex(path):
+    """Return {page address: bytearray(PAGE_SIZE)} for the application section."""
+    pages = {}
+    base = 0
+    with open(path, "r", encoding="ascii") as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if not line.startswith(":"):
+                raise ValueError(f"line {number}: not a record")
+            record = bytes.fromhex(line[1:])
+            if len(record) < 5 or len(record) != 5 + record[0]:
+                raise ValueError(f"line {number}: bad length")
+            if sum(record) & 0xFF:
+                raise ValueError(f"line {number}: checksum mismatch")
+
+            count, offset, kind = record[0], (record[1] << 8) | record[2], record[3]
+            data = record[4:4 + count]
+            if kind == 0x00:
+                for i, value in enumerate(data):
+                    address = base + offset + i
+                    if BOOTLOADER_START <= address < FLASH_END:
+                        continue  # Never overwrite the bootloader
+                    if address >= FLASH_END:
+                        raise ValueError(f"line {number}: address 0x{address:X} beyond flash")
+                    page = address & ~(PAGE_SIZE - 1)
+                    pages.setdefault(page, bytearray(b"\xFF" * PAGE_SIZE))[address - page] = value
+            elif kind == 0x01:
+                return pages
+            elif kind == 0x02:
+                base = int.from_bytes(data, "big") << 4
+            elif kind == 0x04:
+                base = int.from_bytes(data, "big") << 16
+            elif kind in (0x03, 0x05):
+                pass
+            else:
+                raise ValueError(f"line {number}: unsupported record type {kind:02X}")
+    raise ValueError("missing EOF record")
+
+
+def build_image(pages, signature, fw_version):
+    records = b"".join(struct.pack("<H", address) + bytes(pages[address])
+                       for address in sorted(pages))
+    header = HEADER.pack(MAGIC, FORMAT_VERSION, HEADER_SIZE, PAGE_SIZE, signature,
+                         fw_version, len(pages), bytes(6), hashlib.sha256(records).digest(),
+                         bytes(12))
+    return header + records
+
+
+def print_info(path):
+    with open(path, "rb") as f:
+        blob = f.read()
+    (magic, fmt, header_size, page_size, signature, fw_version, count, _, digest,
+     _) = HEADER.unpack_from(blob)
+    records = blob[HEADER_SIZE:]
+    ok = (magic == MAGIC and len(records) == count * (2 + page_size)
+          and hashlib.sha256(records).digest() == digest)
+    print(f"{path}: format {fmt}, {count} pages of {page_size} bytes, "
+          f"signature {signature.hex(' ').upper()}, firmware 0x{fw_version:02X}, "
+          f"sha256 {digest.hex()} {'OK' if ok else 'INVALID'}")
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", help="Intel HEX file (or .msimg with --info)")
+    parser.add_argument("-o", "--output", help="output image (default: input with .msimg)")
+    parser.add_argument("--fw-version", type=lambda v: int(v, 0), default=0,
+                        help="BCD version as reported by ms11::FwVersion, e.g. 0x61 for v0.6.1")
+    parser.add_argument("--signature", default=SIG_ATMEGA328P.hex(),
+                        help="target signature bytes (default 1e950f, ATmega328P)")
+    parser.add_argument("--info", action="store_true", help="describe and check an existing image")
+    args = parser.parse_args()
+
+    if args.info:
+        return 0 if print_info(args.input) else 1
+
+    signature = bytes.fromhex(args.signature)
+    if len(signature) != 3 or not 0 <= args.fw_version <= 0xFF:
+        parser.error("signature must be 3 bytes and the version one BCD byte")
+
+    try:
+        pages = parse_hex(args.input)
+    except (OSError, ValueError) as e:
+        print(f"{args.input}: {e}", file=sys.stderr)
+        return 1
+
+    output = args.output or args.input.rsplit(".", 1)[0] + ".msimg"
+    image = build_image(pages, signature, args.fw_version)
+    with open(output, "wb") as f:
+        f.write(image)
+    print(f"{output}: {len(pages)} pages, {len(image)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
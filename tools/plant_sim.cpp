@@ -0,0 +1,268 @@
+// Pellet smoker plant simulator for OvenControlLaw (include/pid_controller.h).
+//
+// Runs the firmware's control law, with the defaults from config.h, against
+// a lumped thermal model at the firmware's 1 s control period and prints
+// step-response figures, so gains can be compared without lighting a fire.
+//
+// Build and run on the host:
+//   g++ -O2 -std=c++17 -Iinclude tools/plant_sim.cpp src/pid_controller.cpp src/pid_autotune.cpp -o plant_sim
+//   ./plant_sim                       # default gains, scenario summary
+//   ./plant_sim --kp 3 --ki 0.01      # try other gains
+//   ./plant_sim --csv > run.csv       # per-second trace
+//   ./plant_sim --autotune tl         # relay autotune (zn|tl), then the scenario
+//                                     # with the gains it found
+//
+// Model (per second):
+//   auger on      -> pellets enter the fire pot after an ignition delay
+//   fire pot      -> burns mass * rate(fan); heat = burn * energy * efficiency
+//   oven          -> C dT/dt = heat - (UA + UA_fan * fan) * (T - ambient)
+//   sensor        -> whole degrees, like REG_OVEN_TEMP
+//
+// Scenario: start cold, target 110 °C; 135 °C at 2 h; lid open for 60 s at
+// 3 h; end at 4 h.
+//
+// --autotune first runs RelayAutotuner (include/pid_autotune.h) on a cold
+// smoker at 110 °C with the firmware defaults, like OvenController does.
+
+#include "config.h"
+#include "pid_controller.h"
+#include "pid_autotune.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct PlantParams {
+  float ambient = 15.0f;            // °C
+  float feedRate = 0.55f;           // g/s while the auger runs
+  uint32_t ignitionDelayS = 20;     // Feed -> burning
+  float burnRate = 1.0f / 40.0f;    // Fraction of pot mass per second at full fan
+  float burnAtNoFan = 0.3f;         // Relative burn rate with the fan off
+  float energy = 18000.0f;          // J/g
+  float efficiency = 0.35f;
+  float capacity = 20000.0f;        // J/K
+  float ua = 8.0f;                  // W/K
+  float uaFan = 4.0f;               // W/K extra at 100 % fan
+  float uaLidOpen = 40.0f;          // W/K extra with the lid open
+};
+
+class Smoker {
+public:
+  explicit Smoker(const PlantParams& p) : p(p), temperature(p.ambient) {
+    memset(delay, 0, sizeof(delay));
+  }
+
+  void step(bool auger, uint8_t fanPercent, bool lidOpen) {
+    // Ignition delay line
+    delay[head] = auger ? p.feedRate : 0.0f;
+    head = (head + 1) % p.ignitionDelayS;
+    potMass += delay[head];
+
+    float fan = fanPercent / 100.0f;
+    float burned = potMass * p.burnRate * (p.burnAtNoFan + (1.0f - p.burnAtNoFan) * fan);
+    potMass -= burned;
+
+    float heat = burned * p.energy * p.efficiency;
+    float ua = p.ua + p.uaFan * fan + (lidOpen ? p.uaLidOpen : 0.0f);
+    temperature += (heat - ua * (temperature - p.ambient)) / p.capacity;
+  }
+
+  float sensor() const { return floorf(temperature + 0.5f); }
+  float actual() const { return temperature; }
+
+private:
+  PlantParams p;
+  float temperature;
+  float potMass = 0.0f;
+  float delay[64];
+  uint32_t head = 0;
+};
+
+struct Segment {
+  const char* name;
+  uint32_t start;
+  uint32_t end;
+  float target;
+  // Results
+  uint32_t riseTime = 0;            // First time within 2 °C
+  uint32_t settleTime = 0;          // Last time outside 2 °C
+  float overshoot = 0.0f;
+  float iae = 0.0f;                 // °C·s after the ramp reached the target
+  float steadyRms = 0.0f;           // Last 30 min of the segment
+  uint32_t steadySamples = 0;
+};
+
+static float argValue(int argc, char** argv, const char* name, float fallback) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], name) == 0) {
+      return (float)atof(argv[i + 1]);
+    }
+  }
+  return fallback;
+}
+
+static const char* argString(int argc, char** argv, const char* name) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], name) == 0) {
+      return argv[i + 1];
+    }
+  }
+  return nullptr;
+}
+
+// Relay experiment on a fresh smoker; false if it did not converge
+static bool runAutotune(const OvenControlConfig& config, AutotuneRule rule, PidGains& gains,
+                        AutotuneResult& result) {
+  PlantParams params;
+  Smoker smoker(params);
+  OvenControlLaw law;
+  law.configure(config);
+  law.reset(smoker.sensor(), 0);
+
+  AutotuneConfig tuneConfig;
+  tuneConfig.amplitude = OVEN_AUTOTUNE_AMPLITUDE;
+  tuneConfig.hysteresis = OVEN_AUTOTUNE_HYSTERESIS_C;
+  tuneConfig.cycles = OVEN_AUTOTUNE_CYCLES;
+  tuneConfig.maxCycles = OVEN_AUTOTUNE_MAX_CYCLES;
+  tuneConfig.timeoutMs = OVEN_AUTOTUNE_TIMEOUT_MIN * 60000UL;
+  RelayAutotuner tuner;
+  tuner.configure(tuneConfig);
+  const float setpoint = 110.0f;
+  tuner.start(setpoint, config.ffBias + config.ffPerDegree * setpoint, 0);
+
+  uint32_t t = 0;
+  while (tuner.getState() == RelayAutotuner::TUNE_RUNNING) {
+    float demand = tuner.update(smoker.sensor(), t * 1000);
+    OvenControlLaw::Output out = law.drive(demand, t * 1000);
+    smoker.step(out.augerOn, out.fanPercent, false);
+    t++;
+  }
+
+  if (tuner.getState() != RelayAutotuner::TUNE_DONE) {
+    printf("autotune failed after %u s: %s\n", t, tuner.getError());
+    return false;
+  }
+  result = tuner.getResult();
+  gains = RelayAutotuner::gainsFor(result, rule);
+  printf("autotune (%s) %u s, %u cycles: Ku=%.2f %%/C Pu=%.0f s a=%.2f C bias=%.1f %%\n",
+         RelayAutotuner::ruleName(rule), t, tuner.getCycleCount(), result.ku, result.pu,
+         result.amplitude, result.bias);
+  return true;
+}
+
+static bool hasFlag(int argc, char** argv, const char* name) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  OvenControlConfig config;
+  config.gains.kp = argValue(argc, argv, "--kp", OVEN_PID_DEFAULT_KP);
+  config.gains.ki = argValue(argc, argv, "--ki", OVEN_PID_DEFAULT_KI);
+  config.gains.kd = argValue(argc, argv, "--kd", OVEN_PID_DEFAULT_KD);
+  config.ffBias = argValue(argc, argv, "--ffbias", OVEN_FF_DEFAULT_BIAS);
+  config.ffPerDegree = argValue(argc, argv, "--kff", OVEN_FF_DEFAULT_PER_DEGREE);
+  config.derivativeTau = OVEN_DERIVATIVE_TAU_S;
+  config.slewPerSecond = argValue(argc, argv, "--slew", OVEN_DEMAND_SLEW_PER_S);
+  config.rampPerMinute = argValue(argc, argv, "--ramp", OVEN_RAMP_DEFAULT_PER_MIN);
+  config.augerWindowMs = OVEN_AUGER_WINDOW_MS;
+  config.augerMinPulseMs = OVEN_AUGER_MIN_PULSE_MS;
+  config.fanMin = OVEN_FAN_MIN_PERCENT;
+  config.fanMax = OVEN_FAN_MAX_PERCENT;
+  bool csv = hasFlag(argc, argv, "--csv");
+
+  const char* tune = argString(argc, argv, "--autotune");
+  if (tune) {
+    AutotuneRule rule = strcmp(tune, "zn") == 0 ? TUNE_ZIEGLER_NICHOLS : TUNE_TYREUS_LUYBEN;
+    AutotuneResult result;
+    if (!runAutotune(config, rule, config.gains, result)) {
+      return 1;
+    }
+  }
+
+  PlantParams params;
+  Smoker smoker(params);
+  OvenControlLaw law;
+  law.configure(config);
+  law.reset(smoker.sensor(), 0);
+
+  Segment segments[] = {
+    {"110 C from cold", 0, 7200, 110.0f},
+    {"step to 135 C", 7200, 10800, 135.0f},
+    {"lid open 60 s", 10800, 14400, 135.0f},
+  };
+  const uint32_t lidOpenAt = 10800;
+  const uint32_t lidOpenFor = 60;
+
+  uint32_t augerSwitches = 0;
+  bool lastAuger = false;
+  float maxTemp = 0.0f;
+
+  if (csv) {
+    printf("t,setpoint,sensor,actual,demand,auger,fan,p,i,d,ff\n");
+  }
+
+  for (Segment& seg : segments) {
+    law.setTarget(seg.target);
+    bool reached = false;
+    for (uint32_t t = seg.start; t < seg.end; t++) {
+      OvenControlLaw::Output out = law.step(smoker.sensor(), 1.0f, t * 1000);
+      bool lidOpen = t >= lidOpenAt && t < lidOpenAt + lidOpenFor;
+      smoker.step(out.augerOn, out.fanPercent, lidOpen);
+
+      if (out.augerOn != lastAuger) {
+        augerSwitches++;
+        lastAuger = out.augerOn;
+      }
+      float temp = smoker.actual();
+      maxTemp = fmaxf(maxTemp, temp);
+      float error = temp - seg.target;
+
+      if (fabsf(error) <= 2.0f) {
+        if (seg.riseTime == 0) {
+          seg.riseTime = t - seg.start + 1;
+        }
+      } else if (seg.riseTime != 0 || t >= lidOpenAt) {
+        seg.settleTime = t - seg.start + 1;
+      }
+      if (out.setpoint == seg.target) {
+        reached = true;
+      }
+      if (reached) {
+        seg.iae += fabsf(error);
+        seg.overshoot = fmaxf(seg.overshoot, error);
+      }
+      if (t >= seg.end - 1800) {
+        seg.steadyRms += error * error;
+        seg.steadySamples++;
+      }
+
+      if (csv) {
+        printf("%u,%.2f,%.0f,%.2f,%.1f,%d,%u,%.2f,%.2f,%.2f,%.2f\n", t, out.setpoint,
+               smoker.sensor(), temp, out.demand, out.augerOn ? 1 : 0, out.fanPercent,
+               out.terms.p, out.terms.i, out.terms.d, out.terms.ff);
+      }
+    }
+    seg.steadyRms = sqrtf(seg.steadyRms / (seg.steadySamples ? seg.steadySamples : 1));
+  }
+
+  if (csv) {
+    return 0;
+  }
+
+  printf("gains kp=%.3f ki=%.4f kd=%.2f kff=%.3f ramp=%.1f C/min slew=%.1f %%/s\n",
+         config.gains.kp, config.gains.ki, config.gains.kd, config.ffPerDegree,
+         config.rampPerMinute, config.slewPerSecond);
+  printf("%-18s %8s %8s %10s %10s %10s\n", "segment", "rise s", "settle s", "overshoot",
+         "IAE C*s", "RMS last30");
+  for (const Segment& seg : segments) {
+    printf("%-18s %8u %8u %10.2f %10.0f %10.2f\n", seg.name, seg.riseTime, seg.settleTime,
+           seg.overshoot, seg.iae, seg.steadyRms);
+  }
+  printf("auger switches %u, max temperature %.1f C\n", augerSwitches, maxTemp);
+  return 0;
+}